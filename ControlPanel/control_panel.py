@@ -3,6 +3,7 @@ import threading
 from datetime import datetime, timedelta
 import sys
 import json
+import time
 import eventlet # Importa eventlet
 
 from flask import Flask, render_template, request, redirect, url_for, flash, jsonify
@@ -112,6 +113,12 @@ def forward_data():
     device_id = parsed_data.get('id')
     if not device_id: return jsonify({"status": "ok"}), 200
 
+    if parsed_data.get('event') == 'command_failed':
+        # Generato dal bridge, non dal dispositivo: non conta come segno di vita.
+        parsed_data['deviceId'] = device_id
+        socketio.emit('game_update', parsed_data)
+        return jsonify({"status": "ok"}), 200
+
     with devices_lock:
         needs_full_update = False
         if device_id not in devices:
@@ -126,11 +133,19 @@ def forward_data():
         device['status'] = 'ONLINE'
         device['last_heartbeat'] = datetime.utcnow()
         device['addr'] = tuple(device_ip_info)
+        # Qualità del collegamento calcolata dal bridge sui numeri di sequenza.
+        if 'rx_lost' in parsed_data:
+            device['rx_lost'] = parsed_data['rx_lost']
+            device['rx_reordered'] = parsed_data.get('rx_reordered', '0')
+        if 'rtt' in parsed_data:
+            device['clock_rtt'] = parsed_data['rtt']
         
-        if parsed_data.get('event') == 'mode_exit':
+        # Gli eventi reinviati dal diario del dispositivo sono storia: non cambiano la modalità attuale.
+        live = parsed_data.get('replay') != '1'
+        if live and parsed_data.get('event') == 'mode_exit':
             if device.get('mode') != 'main_menu':
                 device['mode'] = 'main_menu'; needs_full_update = True
-        elif 'mode' in parsed_data:
+        elif live and 'mode' in parsed_data:
             if device.get('mode') != parsed_data['mode']:
                 device['mode'] = parsed_data['mode']; needs_full_update = True
         
@@ -139,6 +154,8 @@ def forward_data():
 
     if parsed_data.get('event') != 'heartbeat':
         parsed_data['deviceId'] = device_id
+        # Ora del server all'inoltro: il browser ne ricava lo scarto del proprio orologio.
+        parsed_data['server_time'] = int(time.time() * 1000)
         socketio.emit('game_update', parsed_data)
 
     return jsonify({"status": "ok"}), 200
@@ -152,20 +169,25 @@ def handle_connect():
 
 @socketio.on('send_command')
 def handle_send_command(json_data):
-    command = json_data.get('command'); target_id = json_data.get('target_id')
-    if command and target_id:
-        with devices_lock:
+    # 'target_ids' invia lo stesso comando a più dispositivi: con "AT:+ms" partono insieme.
+    command = json_data.get('command')
+    target_ids = json_data.get('target_ids') or [json_data.get('target_id')]
+    online_ids = []
+    with devices_lock:
+        for target_id in target_ids:
             target_device = devices.get(target_id)
-        if target_device and target_device['status'] == 'ONLINE':
-            payload = {'command': command, 'target_id': target_id}
-            try:
-                with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
-                    sock.sendto(json.dumps(payload).encode('utf-8'), ('127.0.0.1', BRIDGE_CMD_PORT))
-                    print(f"Comando '{command}' inoltrato al bridge per {target_id}")
-            except Exception as e:
-                print(f"ERRORE invio comando al bridge: {e}")
-        else:
-            print(f"Errore: dispositivo {target_id} non trovato o offline.")
+            if target_device and target_device['status'] == 'ONLINE':
+                online_ids.append(target_id)
+            else:
+                print(f"Errore: dispositivo {target_id} non trovato o offline.")
+    if command and online_ids:
+        payload = {'command': command, 'target_ids': online_ids}
+        try:
+            with socket.socket(socket.AF_INET, socket.SOCK_DGRAM) as sock:
+                sock.sendto(json.dumps(payload).encode('utf-8'), ('127.0.0.1', BRIDGE_CMD_PORT))
+                print(f"Comando '{command}' inoltrato al bridge per {', '.join(online_ids)}")
+        except Exception as e:
+            print(f"ERRORE invio comando al bridge: {e}")
 
 # --- Avvio ---
 if __name__ == '__main__':
@@ -101,6 +101,9 @@ document.addEventListener('DOMContentLoaded', () => {
         let captureTime = 10, armTime = 5, defuseTime = 10;
         let gameTimerInterval = null;
         let gameTimerSeconds = 0;
+        // Timer ancorati: il dispositivo invia solo la scadenza, il conto alla rovescia è locale.
+        let timerAnchorInterval = null;
+        let serverClockOffset = 0; // Ora del server - ora del browser (ms)
 
         // --- Funzioni Helper ---
         function findOnlineDevice(devices) {
@@ -201,11 +204,26 @@ document.addEventListener('DOMContentLoaded', () => {
             });
 
         socket.on('game_update', (data) => {
-            // Log grezzo
+            if (data.server_time) {
+                serverClockOffset = data.server_time - Date.now();
+            }
+            // Log grezzo, dal più recente. Gli eventi reinviati dal diario del dispositivo
+            // arrivano in ritardo: si inseriscono al loro posto secondo il tempo dell'evento.
             if (logList) {
                 const newLogEntry = document.createElement('li');
                 newLogEntry.textContent = JSON.stringify(data);
-                logList.prepend(newLogEntry);
+                newLogEntry.dataset.ts = data.ts || '';
+                let next = logList.firstElementChild;
+                if (data.ts) {
+                    while (next && next.dataset.ts && Number(next.dataset.ts) > Number(data.ts)) {
+                        next = next.nextElementSibling;
+                    }
+                }
+                logList.insertBefore(newLogEntry, next);
+            }
+            // Storia di quando il dispositivo era scollegato: solo nel log, non cambia la vista.
+            if (data.replay === '1') {
+                return;
             }
 
             // ** GESTIONE TRANSIZIONE DI STATO (MODE_ENTER) **
@@ -472,12 +490,9 @@ document.addEventListener('DOMContentLoaded', () => {
                 lastGameState = (data.event === 'game_start') ? 'ZONA NEUTRA' : `Partita inizia in ${data.duration || data.time}s...`;
                 domGameState.innerHTML = lastGameState;
             }
-            if (data.event === 'countdown_update') {
-                lastGameState = `Partita inizia in ${data.time}s...`;
-                domGameState.innerHTML = lastGameState;
-            }
-            if (data.event === 'time_update') {
-                updateTimerDisplay(domTimer, parseInt(data.time, 10));
+            if (data.event === 'timer_anchor') {
+                // Il conto alla rovescia iniziale va nella riga di stato, quello di gioco nel timer.
+                applyTimerAnchor(data, data.timer === 'countdown' ? null : domTimer);
             }
             if (data.event === 'capture_start') {
                 lastGameState = domGameState.innerHTML;
@@ -499,6 +514,7 @@ document.addEventListener('DOMContentLoaded', () => {
                 scoreTeam2.textContent = formatMilliseconds(data.team2_score);
             }
             if (data.event === 'game_end') {
+                stopTimerAnchor();
                 domTimer.textContent = "00:00";
                 domGameState.innerHTML = "Partita Terminata!";
                 forceEndDomBtn.classList.add('hidden');
@@ -540,8 +556,8 @@ document.addEventListener('DOMContentLoaded', () => {
                 stopProgressBar();
                 sdBombState.textContent = 'BOMBA INNESCATA!';
             }
-            if (data.event === 'time_update') {
-                updateTimerDisplay(sdBombTimer, parseInt(data.time, 10));
+            if (data.event === 'timer_anchor') {
+                applyTimerAnchor(data, sdBombTimer);
             }
             if (data.event === 'defuse_start') {
                 sdBombState.textContent = 'Disinnesco in corso...';
@@ -556,6 +572,7 @@ document.addEventListener('DOMContentLoaded', () => {
             }
             if (data.event === 'game_end') {
                 stopGameTimer();
+                stopTimerAnchor();
                 stopProgressBar();
                 forceEndSdBtn.classList.add('hidden');
                 let winnerText = data.winner === 'terrorists' ? 'squadra <span class="team-red">T</span>' : 'squadra <span class="team-green">CT</span>';
@@ -633,8 +650,10 @@ document.addEventListener('DOMContentLoaded', () => {
             gameDurationWrapper.classList.add('hidden');
             forceEndSdBtn.classList.remove('hidden');
             updateTimerDisplay(sdGameTimer, gameTimerSeconds);
+            // Il tempo rimanente si ricalcola dalla scadenza: setInterval da solo accumula ritardo.
+            const deadline = Date.now() + gameTimerSeconds * 1000;
             gameTimerInterval = setInterval(() => {
-                gameTimerSeconds--;
+                gameTimerSeconds = Math.max(0, Math.ceil((deadline - Date.now()) / 1000));
                 updateTimerDisplay(sdGameTimer, gameTimerSeconds);
                 if (gameTimerSeconds <= 0) {
                     stopGameTimer();
@@ -643,7 +662,7 @@ document.addEventListener('DOMContentLoaded', () => {
                         socket.emit('send_command', { command: 'CMD:FORCE_END_GAME', target_id: activeDeviceId });
                     }
                 }
-            }, 1000);
+            }, 250);
         }
         
         function stopGameTimer() {
@@ -662,8 +681,46 @@ document.addEventListener('DOMContentLoaded', () => {
         
         function stopAllTimers() {
             stopGameTimer();
+            stopTimerAnchor();
             stopProgressBar();
         }
+
+        function serverNow() {
+            return Date.now() + serverClockOffset;
+        }
+
+        /**
+         * Mostra un timer a partire dalla sua ancora ("termina all'istante ends_at").
+         * Il tempo rimanente è ricalcolato dall'orologio a ogni aggiornamento:
+         * non accumula deriva e non dipende dall'arrivo di altri pacchetti.
+         * Con element null il tempo va nella riga di stato del Dominio.
+         */
+        function applyTimerAnchor(data, element) {
+            stopTimerAnchor();
+            const running = data.running === '1';
+            const render = () => {
+                const remainingMs = running ? Math.max(0, parseInt(data.ends_at, 10) - serverNow()) : parseInt(data.remaining, 10);
+                const seconds = Math.ceil(remainingMs / 1000);
+                if (element) {
+                    updateTimerDisplay(element, seconds);
+                } else if (domGameState) {
+                    lastGameState = `Partita inizia in ${seconds}s...`;
+                    domGameState.innerHTML = lastGameState;
+                }
+                if (remainingMs <= 0) {
+                    stopTimerAnchor();
+                }
+            };
+            render();
+            if (running) {
+                timerAnchorInterval = setInterval(render, 200);
+            }
+        }
+
+        function stopTimerAnchor() {
+            clearInterval(timerAnchorInterval);
+            timerAnchorInterval = null;
+        }
         
         function updateTimerDisplay(element, totalSeconds) {
             if(!element) {
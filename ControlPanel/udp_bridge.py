@@ -1,15 +1,131 @@
 import socket
 import threading
 import json
+import re
 import sys
+import time
 import requests
 
 # --- Variabili Globali Condivise ---
 main_socket = None
+FORWARD_URL = 'http://127.0.0.1:5000/internal/forward_data'
 # Dizionario per memorizzare l'indirizzo (IP, porta) di ogni dispositivo
 last_known_device_addrs = {} 
 addr_lock = threading.Lock()
 
+# --- Protocollo binario (vedi src/Network/WireCodec.h) ---
+# L'indice è l'identificativo trasmesso: le liste DEVONO restare allineate con
+# WIRE_EVENTS / WIRE_FIELDS del firmware. Aggiungere nuovi nomi solo in coda.
+WIRE_PROTOCOL_VERSION = 2
+WIRE_FRAME_MAGIC = 0xB0
+WIRE_EVENTS = [
+    "heartbeat", "device_online", "mode_enter", "mode_exit", "settings_update",
+    "remote_start", "round_reset", "game_start", "game_end", "countdown_start",
+    "countdown_update", "time_update", "capture_start", "capture_cancel", "capture_progress",
+    "zone_captured", "score_update", "arm_start", "arm_cancel", "arm_progress",
+    "arm_pin_wrong", "bomb_armed", "defuse_start", "defuse_cancel", "defuse_progress",
+    "defuse_pin_wrong", "ack", "time_sync", "timer_anchor",
+]
+WIRE_FIELDS = [
+    "status", "version", "mode", "duration", "capture",
+    "countdown", "time", "team", "progress", "team1_score",
+    "team2_score", "winner", "bomb_time", "arm_pin", "disarm_pin",
+    "arm_time", "defuse_time", "use_arm_pin", "use_disarm_pin", "txq_hw",
+    "txq_drop", "wire", "cid",
+    "rxq_drop", "rx_trunc", "ts", "t0", "rtt",
+    "timer", "running", "remaining", "ends_at", "replay",
+    "evq_hw", "evq_drop",
+]
+
+# Handle numerici assegnati ai dispositivi che parlano il protocollo binario.
+device_handles = {}   # id dispositivo -> handle
+handle_devices = {}   # handle -> id dispositivo
+
+# --- Numeri di sequenza (vedi src/Network/DatagramBatcher.h) ---
+# Ogni evento porta un numero di sequenza crescente: il bridge ne ricava perdite,
+# riordinamenti e duplicati per ogni dispositivo.
+SEQ_WINDOW = 256          # Sequenze recenti ricordate per riconoscere i duplicati
+SEQ_STATS_PERIOD_S = 60   # Intervallo di stampa delle statistiche
+seq_stats = {}            # id dispositivo -> statistiche
+
+def track_sequence(device_id, seq):
+    """Aggiorna le statistiche di sequenza. Ritorna False se l'evento è un duplicato."""
+    stats = seq_stats.get(device_id)
+    if stats is None or seq == 0 or seq + SEQ_WINDOW < stats['highest']:
+        # Primo evento o dispositivo riavviato: si riparte da capo.
+        stats = {'highest': seq, 'received': 1, 'lost': 0, 'reordered': 0, 'duplicates': 0, 'recent': {seq}}
+        seq_stats[device_id] = stats
+        return True
+
+    if seq in stats['recent']:
+        stats['duplicates'] += 1
+        return False
+    stats['recent'].add(seq)
+    if len(stats['recent']) > SEQ_WINDOW:
+        stats['recent'] = {s for s in stats['recent'] if s + SEQ_WINDOW > seq}
+    stats['received'] += 1
+
+    if seq > stats['highest']:
+        # Un buco nella sequenza è contato come perdita finché l'evento non arriva.
+        stats['lost'] += seq - stats['highest'] - 1
+        stats['highest'] = seq
+    else:
+        stats['reordered'] += 1
+        stats['lost'] = max(0, stats['lost'] - 1)
+    return True
+
+def print_sequence_stats():
+    for device_id, stats in seq_stats.items():
+        total = stats['received'] + stats['lost']
+        loss = 100.0 * stats['lost'] / total if total else 0.0
+        print(f"[SEQ] {device_id}: ricevuti {stats['received']}, persi {stats['lost']} ({loss:.1f}%), "
+              f"riordinati {stats['reordered']}, duplicati {stats['duplicates']}")
+
+# --- Comandi affidabili ---
+# Ogni comando parte con il prefisso "CID:n;" e viene ritrasmesso con backoff
+# esponenziale finché il dispositivo non risponde con "event:ack;cid:n;" o scade
+# la deadline. Il dispositivo scarta le ritrasmissioni di comandi già eseguiti.
+COMMAND_RTO_INITIAL_S = 0.1   # Primo timeout di ritrasmissione
+COMMAND_RTO_MAX_S = 1.6       # Tetto del backoff
+COMMAND_DEADLINE_S = 5.0      # Oltre questo tempo il comando è dichiarato fallito
+# Gli ID partono da un valore legato all'orario: dopo un riavvio del bridge non
+# collidono con quelli ancora ricordati dai dispositivi.
+next_command_id = int(time.time() * 1000) & 0x3FFFFFFF
+pending_commands = {}   # cid -> stato del comando in attesa di conferma
+command_rtt = {}        # nome comando -> [conteggio, somma RTT, RTT massimo]
+command_lock = threading.Lock()
+
+# --- Sincronizzazione degli orologi (vedi src/Network/ClockSync.h) ---
+# Il tempo server è l'ora Unix del bridge in millisecondi, ridotta a 31 bit quando
+# viaggia verso/dai dispositivi. Il dispositivo invia "event:time_sync;t0:..;" e il
+# bridge risponde subito con gli istanti di ricezione (T1) e di risposta (T2).
+SERVER_TIME_MASK = 0x7FFFFFFF
+# "AT:+500" in un comando del pannello diventa l'istante assoluto now + 500 ms.
+RELATIVE_AT_PATTERN = re.compile(r'AT:\+(\d+)')
+
+def server_time_ms():
+    return int(time.time() * 1000)
+
+def expand_server_time(ts, reference_ms):
+    """Ricostruisce il tempo server completo da 31 bit, scegliendo il valore più vicino al riferimento."""
+    diff = (ts - reference_ms) & SERVER_TIME_MASK
+    if diff > SERVER_TIME_MASK >> 1:
+        diff -= SERVER_TIME_MASK + 1
+    return reference_ms + diff
+
+def answer_time_sync(data, addr, received_ms):
+    """Risponde a una richiesta di sincronizzazione il prima possibile dopo la ricezione."""
+    t0 = parse_message(data.decode('utf-8', errors='ignore')).get('t0', '')
+    if not t0.isdigit():
+        return
+    reply = f"CMD:TIME_SYNC;T0:{t0};T1:{received_ms & SERVER_TIME_MASK};T2:{server_time_ms() & SERVER_TIME_MASK};"
+    main_socket.sendto(reply.encode('utf-8'), addr)
+
+def resolve_execute_at(command):
+    """Sostituisce "AT:+ms" con l'istante assoluto in tempo server (lo stesso per ogni destinatario)."""
+    now_ms = server_time_ms()
+    return RELATIVE_AT_PATTERN.sub(lambda m: f"AT:{(now_ms + int(m.group(1))) & SERVER_TIME_MASK}", command)
+
 def parse_message(data_str):
     parts = data_str.strip().split(';')
     message_dict = {}
@@ -19,13 +135,70 @@ def parse_message(data_str):
             message_dict[key] = value
     return message_dict
 
+def read_varint(data, pos):
+    result = 0
+    shift = 0
+    while True:
+        byte = data[pos]
+        pos += 1
+        result |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return result, pos
+        shift += 7
+        if shift > 28:
+            raise ValueError("varint troppo lungo")
+
+def decode_wire_message(data, pos):
+    """Decodifica un messaggio binario a partire da pos. Ritorna (dizionario, nuova posizione)."""
+    event_id, field_count = data[pos], data[pos + 1]
+    pos += 2
+    message_dict = {'event': WIRE_EVENTS[event_id]}
+    for _ in range(field_count):
+        tag = data[pos]
+        pos += 1
+        key = WIRE_FIELDS[tag >> 1]
+        raw, pos = read_varint(data, pos)
+        if tag & 1:
+            message_dict[key] = data[pos:pos + raw].decode('utf-8', errors='ignore')
+            pos += raw
+        else:
+            message_dict[key] = str((raw >> 1) ^ -(raw & 1))
+    return message_dict, pos
+
+def decode_wire_frame(data):
+    """Decodifica un frame binario. Ritorna (versione, handle, lista di messaggi).
+
+    I messaggi del frame hanno sequenze consecutive a partire da quella dell'header.
+    """
+    version = data[0] & 0x0F
+    handle, pos = read_varint(data, 1)
+    if version != WIRE_PROTOCOL_VERSION:
+        return version, handle, []
+    seq, pos = read_varint(data, pos)
+    messages = []
+    while pos < len(data):
+        message_dict, pos = decode_wire_message(data, pos)
+        message_dict['seq'] = str(seq)
+        messages.append(message_dict)
+        seq += 1
+    return version, handle, messages
+
+def assign_wire_handle(device_id):
+    """Ritorna l'handle del dispositivo, assegnandone uno nuovo se necessario."""
+    with addr_lock:
+        handle = device_handles.get(device_id)
+        if handle is None:
+            handle = len(device_handles) + 1
+            device_handles[device_id] = handle
+            handle_devices[handle] = device_id
+        return handle
+
 def esp_listener():
     """Thread che ascolta i pacchetti in arrivo dagli ESP32."""
     global main_socket
 
     UDP_PORT = 1234
     HOST_IP = '0.0.0.0'
-    FORWARD_URL = 'http://127.0.0.1:5000/internal/forward_data'
     
     print(f"[LISTENER ESP] Avvio su {HOST_IP}:{UDP_PORT}...")
     main_socket = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
@@ -34,25 +207,107 @@ def esp_listener():
         main_socket.bind((HOST_IP, UDP_PORT))
         print(f"[LISTENER ESP] Bind OK. Inoltro dati a {FORWARD_URL}")
         
+        next_stats_time = time.monotonic() + SEQ_STATS_PERIOD_S
         while True:
-            data, addr = main_socket.recvfrom(1024)
-            message_str = data.decode('utf-8', errors='ignore')
-            parsed_data = parse_message(message_str)
-            device_id = parsed_data.get('id')
+            # Un datagramma può contenere più eventi (fino a 1400 byte).
+            data, addr = main_socket.recvfrom(2048)
+            received_ms = server_time_ms()
+
+            if data.startswith(b"event:time_sync;"):
+                answer_time_sync(data, addr, received_ms)
+                continue
+            if data.startswith(b"event:discover;"):
+                # Ricerca in LAN (vedi src/Network/ServerDiscovery.h): il mittente della
+                # risposta diventa l'indirizzo del server per il dispositivo.
+                print(f"[LISTENER ESP] Richiesta di ricerca da {addr}, rispondo.")
+                main_socket.sendto(b"CMD:SERVER_HERE;", addr)
+                continue
+
+            if time.monotonic() >= next_stats_time:
+                print_sequence_stats()
+                next_stats_time = time.monotonic() + SEQ_STATS_PERIOD_S
+
+            events = []
+            if data and (data[0] & 0xF0) == WIRE_FRAME_MAGIC:
+                try:
+                    version, handle, messages = decode_wire_frame(data)
+                except (IndexError, ValueError) as e:
+                    print(f"[LISTENER ESP] Frame binario non valido da {addr}: {e}")
+                    continue
+                with addr_lock:
+                    device_id = handle_devices.get(handle)
+                if version != WIRE_PROTOCOL_VERSION or device_id is None:
+                    # Handle sconosciuto (es. bridge riavviato): il dispositivo torna al testo
+                    # e rinegozia con il messaggio successivo.
+                    main_socket.sendto(b"CMD:WIRE;VER:0;", addr)
+                    continue
+                for parsed_data in messages:
+                    parsed_data['id'] = device_id
+                    events.append(parsed_data)
+            else:
+                # Formato testuale: un evento per riga.
+                for line in data.decode('utf-8', errors='ignore').split('\n'):
+                    parsed_data = parse_message(line)
+                    device_id = parsed_data.get('id')
+                    if not device_id:
+                        continue
+
+                    # Il dispositivo annuncia il supporto binario finché non riceve un handle.
+                    wire_version = parsed_data.pop('wire', None)
+                    # Un valore non numerico (pacchetto corrotto, firmware vecchio) vale come nessun annuncio.
+                    if wire_version and wire_version.isdigit() and int(wire_version) >= WIRE_PROTOCOL_VERSION:
+                        handle = assign_wire_handle(device_id)
+                        reply = f"CMD:WIRE;VER:{WIRE_PROTOCOL_VERSION};HANDLE:{handle};"
+                        main_socket.sendto(reply.encode('utf-8'), addr)
+                    events.append(parsed_data)
+
+            for parsed_data in events:
+                device_id = parsed_data['id']
+                seq = parsed_data.pop('seq', None)
+                # Gli eventi reinviati dal diario del dispositivo (vedi src/Network/EventJournal.h)
+                # possono arrivare due volte se il dispositivo si è spento a metà reinvio:
+                # il numero di sequenza li scarta come ogni altro duplicato.
+                if seq is not None and seq.isdigit() and not track_sequence(device_id, int(seq)):
+                    continue
+
+                # Tempo dell'evento: quello del dispositivo se sincronizzato, altrimenti l'arrivo.
+                ts = parsed_data.get('ts', '')
+                parsed_data['ts'] = str(expand_server_time(int(ts), received_ms) if ts.isdigit() else received_ms)
+
+                if parsed_data.get('event') == 'timer_anchor' and parsed_data.get('running') == '1':
+                    # Il pannello riceve sempre la scadenza assoluta: dal dispositivo se
+                    # sincronizzato, altrimenti dal tempo rimanente all'istante dell'evento.
+                    ends_at = parsed_data.get('ends_at', '')
+                    remaining = parsed_data.get('remaining', '')
+                    if ends_at.isdigit():
+                        parsed_data['ends_at'] = str(expand_server_time(int(ends_at), received_ms))
+                    elif remaining.isdigit():
+                        parsed_data['ends_at'] = str(int(parsed_data['ts']) + int(remaining))
+                    else:
+                        # Senza scadenza il pannello non saprebbe cosa mostrare: vale l'ancora successiva.
+                        print(f"[LISTENER ESP] Ancora del timer senza scadenza da {device_id}, scartata.")
+                        continue
+
+                if parsed_data.get('event') == 'ack':
+                    # Le conferme restano nel bridge: il pannello vede solo i fallimenti.
+                    with addr_lock:
+                        last_known_device_addrs[device_id] = addr
+                    complete_command(parsed_data.get('cid', ''))
+                    continue
+
+                if parsed_data.get('event') == 'heartbeat' and device_id in seq_stats:
+                    # Il pannello mostra la qualità del collegamento insieme al battito.
+                    parsed_data['rx_lost'] = str(seq_stats[device_id]['lost'])
+                    parsed_data['rx_reordered'] = str(seq_stats[device_id]['reordered'])
 
-            if device_id:
                 # Memorizza l'indirizzo del dispositivo per poter rispondere ai comandi
                 with addr_lock:
                     last_known_device_addrs[device_id] = addr
                 
-                print(f"[LISTENER ESP] Ricevuto da {device_id}@{addr}, inoltro a web server...")
-                
-                try:
-                    # Invia l'indirizzo completo (ip, porta) al pannello di controllo
-                    payload = { "parsed_data": parsed_data, "device_ip_info": addr }
-                    requests.post(FORWARD_URL, json=payload, timeout=0.5)
-                except requests.exceptions.RequestException as e:
-                    print(f"  - ERRORE durante l'inoltro a {FORWARD_URL}: {e}")
+                origin = "dal diario di" if parsed_data.get('replay') == '1' else "da"
+                print(f"[LISTENER ESP] Ricevuto {origin} {device_id}@{addr}, inoltro a web server...")
+                # Invia l'indirizzo completo (ip, porta) al pannello di controllo
+                forward_to_panel(parsed_data, addr)
 
     except Exception as e:
         print(f"[!!!] ERRORE CRITICO in esp_listener: {e}")
@@ -61,6 +316,72 @@ def esp_listener():
         if main_socket:
             main_socket.close()
 
+def forward_to_panel(parsed_data, addr):
+    try:
+        payload = { "parsed_data": parsed_data, "device_ip_info": addr }
+        requests.post(FORWARD_URL, json=payload, timeout=0.5)
+    except requests.exceptions.RequestException as e:
+        print(f"  - ERRORE durante l'inoltro a {FORWARD_URL}: {e}")
+
+def send_reliable_command(command, target_id, target_addr):
+    """Assegna un ID al comando, lo invia e lo registra per le ritrasmissioni."""
+    global next_command_id
+    with command_lock:
+        next_command_id = (next_command_id + 1) & 0xFFFFFFFF or 1
+        cid = next_command_id
+        now = time.monotonic()
+        pending_commands[cid] = {
+            'datagram': f"CID:{cid};{command}".encode('utf-8'),
+            'name': command.split(';')[0],
+            'target_id': target_id,
+            'addr': target_addr,
+            'first_sent': now,
+            'last_sent': now,
+            'rto': COMMAND_RTO_INITIAL_S,
+            'attempts': 1,
+        }
+        datagram = pending_commands[cid]['datagram']
+    main_socket.sendto(datagram, target_addr)
+
+def complete_command(cid_str):
+    """Gestisce la conferma di un comando e ne registra la latenza."""
+    if not cid_str.isdigit():
+        return
+    with command_lock:
+        entry = pending_commands.pop(int(cid_str), None)
+        if entry is None:
+            return  # Conferma di una ritrasmissione già confermata
+        rtt = time.monotonic() - entry['first_sent']
+        stats = command_rtt.setdefault(entry['name'], [0, 0.0, 0.0])
+        stats[0] += 1
+        stats[1] += rtt
+        stats[2] = max(stats[2], rtt)
+        average = stats[1] / stats[0]
+    print(f"[SENDER ESP] {entry['name']} confermato da {entry['target_id']} in {rtt * 1000:.0f} ms "
+          f"({entry['attempts']} invii; media {average * 1000:.0f} ms, max {stats[2] * 1000:.0f} ms)")
+
+def command_retransmitter():
+    """Thread che ritrasmette i comandi non confermati con backoff esponenziale."""
+    while True:
+        time.sleep(0.02)
+        now = time.monotonic()
+        resend = []
+        expired = []
+        with command_lock:
+            for cid, entry in list(pending_commands.items()):
+                if now - entry['first_sent'] >= COMMAND_DEADLINE_S:
+                    expired.append(pending_commands.pop(cid))
+                elif now - entry['last_sent'] >= entry['rto']:
+                    entry['last_sent'] = now
+                    entry['rto'] = min(entry['rto'] * 2, COMMAND_RTO_MAX_S)
+                    entry['attempts'] += 1
+                    resend.append((entry['datagram'], entry['addr']))
+        for datagram, addr in resend:
+            main_socket.sendto(datagram, addr)
+        for entry in expired:
+            print(f"[!] {entry['name']} per {entry['target_id']} non confermato dopo {entry['attempts']} invii.")
+            forward_to_panel({'event': 'command_failed', 'command': entry['name'], 'id': entry['target_id']}, entry['addr'])
+
 def command_sender():
     """Thread che ascolta i comandi dal web server e li invia all'ESP32 corretto."""
     global main_socket
@@ -80,19 +401,21 @@ def command_sender():
                 try:
                     # Ora il comando arriva in formato JSON, quindi lo decodifichiamo
                     payload = json.loads(data.decode('utf-8'))
-                    command = payload['command']
-                    target_id = payload['target_id']
-                    
-                    target_addr = None
-                    with addr_lock:
-                        target_addr = last_known_device_addrs.get(target_id)
+                    # Più destinatari ricevono lo stesso istante AT: e partono insieme.
+                    command = resolve_execute_at(payload['command'])
+                    target_ids = payload.get('target_ids') or [payload['target_id']]
 
-                    if target_addr and main_socket:
-                        print(f"[SENDER ESP] Invio comando '{command}' a {target_id} @ {target_addr}")
-                        # Usa il socket principale (quello sulla porta 1234) per inviare il dato!
-                        main_socket.sendto(command.encode('utf-8'), target_addr)
-                    else:
-                        print(f"[!] Ricevuto comando per {target_id}, ma il suo indirizzo non è noto.")
+                    for target_id in target_ids:
+                        target_addr = None
+                        with addr_lock:
+                            target_addr = last_known_device_addrs.get(target_id)
+
+                        if target_addr and main_socket:
+                            print(f"[SENDER ESP] Invio comando '{command}' a {target_id} @ {target_addr}")
+                            # Usa il socket principale (quello sulla porta 1234) per inviare il dato!
+                            send_reliable_command(command, target_id, target_addr)
+                        else:
+                            print(f"[!] Ricevuto comando per {target_id}, ma il suo indirizzo non è noto.")
                 except (json.JSONDecodeError, KeyError) as e:
                     print(f"[!] ERRORE nel formato del comando ricevuto dal pannello: {e}")
 
@@ -105,9 +428,11 @@ if __name__ == '__main__':
     
     esp_thread = threading.Thread(target=esp_listener, daemon=True)
     cmd_thread = threading.Thread(target=command_sender, daemon=True)
+    retx_thread = threading.Thread(target=command_retransmitter, daemon=True)
     
     esp_thread.start()
     cmd_thread.start()
+    retx_thread.start()
     
     # Mantiene il programma principale in esecuzione per permettere ai thread di lavorare
     esp_thread.join()
@@ -0,0 +1,282 @@
+// bench/command_router/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Benchmark e fuzzing sull'host del CommandRouter.
+ * @details Esecuzione: pio run -e bench_router && .pio/build/bench_router/program [cartella corpus]
+ * (di default bench/command_router/corpus, relativa alla cartella del progetto).
+ *
+ * 1. Ogni file del corpus viene analizzato dal router e da un parser di
+ *    riferimento equivalente a quello precedente (split su ';' e startsWith):
+ *    comando e valori dei campi devono coincidere.
+ * 2. Fuzzing: lo stesso confronto su varianti casuali (ma riproducibili) del
+ *    corpus, controllando anche che ogni vista resti dentro il buffer.
+ * 3. Avvii programmati (AT:): con gli slot tutti occupati, o un testo troppo
+ *    lungo, canAccept() e dispatch() rifiutano il comando, che quindi non
+ *    viene confermato al bridge; runDue() libera gli slot.
+ * 4. Throughput del router rispetto al parser di riferimento.
+ * Il programma termina con codice 1 se anche una sola verifica fallisce.
+ */
+
+#include <chrono>
+#include <dirent.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "Network/CommandRouter.h"
+
+/** @brief Risultato del parser di riferimento. */
+struct ReferenceResult {
+    int id;                                 // CMD_UNKNOWN se non riconosciuto
+    bool present[FIELD_COUNT];
+    std::string fields[FIELD_COUNT];
+};
+
+/** @brief Parser con la semantica di TerminalMode::parseCommand prima del router. */
+static ReferenceResult referenceParse(const std::string& text) {
+    std::vector<std::string> parts;
+    size_t last = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        if (text[i] == ';') {
+            parts.push_back(text.substr(last, i - last));
+            last = i + 1;
+        }
+    }
+    parts.push_back(text.substr(last));
+
+    ReferenceResult result;
+    result.id = CMD_UNKNOWN;
+    for (const auto& part : parts) {
+        if (part.compare(0, 4, "CMD:") == 0) {
+            std::string name = part.substr(4);
+            for (int c = 0; c < CMD_COUNT; c++) {
+                if (name == COMMAND_NAMES[c]) {
+                    result.id = c;
+                }
+            }
+            break;
+        }
+    }
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        result.present[f] = false;
+        std::string prefix = std::string(FIELD_NAMES[f]) + ":";
+        for (const auto& part : parts) {
+            if (part.compare(0, prefix.size(), prefix) == 0) {
+                result.present[f] = true;
+                result.fields[f] = part.substr(prefix.size());
+            }
+        }
+    }
+    return result;
+}
+
+static bool within(const TextView& view, const std::string& buffer) {
+    if (view.data == nullptr || view.length == 0) {
+        return true;
+    }
+    return view.data >= buffer.c_str() && view.data + view.length <= buffer.c_str() + buffer.size();
+}
+
+/** @brief Confronta router e riferimento su un input. Ritorna false se divergono. */
+static bool check(const std::string& input) {
+    ParsedCommand parsed;
+    CommandRouter::parse(input.c_str(), parsed);
+    ReferenceResult reference = referenceParse(input);
+
+    if ((int)parsed.id != reference.id) {
+        return false;
+    }
+    for (int f = 0; f < FIELD_COUNT; f++) {
+        const TextView& view = parsed.fields[f];
+        if (parsed.has((FieldId)f) != reference.present[f] || !within(view, input)) {
+            return false;
+        }
+        if (reference.present[f] && std::string(view.data, view.length) != reference.fields[f]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::vector<std::string> loadCorpus(const char* path) {
+    std::vector<std::string> corpus;
+    DIR* dir = opendir(path);
+    if (dir == nullptr) {
+        return corpus;
+    }
+    struct dirent* entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string file = std::string(path) + "/" + entry->d_name;
+        FILE* f = fopen(file.c_str(), "rb");
+        if (f == nullptr) {
+            continue;
+        }
+        std::string content;
+        char buffer[512];
+        size_t n;
+        while ((n = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+            content.append(buffer, n);
+        }
+        fclose(f);
+        corpus.push_back(content);
+    }
+    closedir(dir);
+    return corpus;
+}
+
+/** @brief Generatore xorshift32: stesse varianti a ogni esecuzione. */
+static uint32_t fuzzState = 0x2545F491u;
+static uint32_t nextRandom() {
+    fuzzState ^= fuzzState << 13;
+    fuzzState ^= fuzzState >> 17;
+    fuzzState ^= fuzzState << 5;
+    return fuzzState;
+}
+
+static std::string mutate(const std::vector<std::string>& corpus) {
+    static const char ALPHABET[] = ";:CMD_0123456789-+ARM_PINDURATION\xff";
+    std::string s = corpus[nextRandom() % corpus.size()];
+    int edits = 1 + nextRandom() % 4;
+    for (int e = 0; e < edits; e++) {
+        size_t pos = s.empty() ? 0 : nextRandom() % (s.size() + 1);
+        switch (nextRandom() % 5) {
+            case 0: // Inserisce un carattere
+                s.insert(pos, 1, ALPHABET[nextRandom() % (sizeof(ALPHABET) - 1)]);
+                break;
+            case 1: // Cancella un carattere
+                if (pos < s.size()) s.erase(pos, 1);
+                break;
+            case 2: // Sostituisce un carattere
+                if (pos < s.size()) s[pos] = ALPHABET[nextRandom() % (sizeof(ALPHABET) - 1)];
+                break;
+            case 3: // Tronca
+                s.resize(pos);
+                break;
+            default: { // Unisce con un altro elemento del corpus
+                const std::string& other = corpus[nextRandom() % corpus.size()];
+                s.insert(pos, other.substr(nextRandom() % (other.size() + 1)));
+                break;
+            }
+        }
+    }
+    return s;
+}
+
+static void countCommand(const ParsedCommand& command, void* context) {
+    (void)command;
+    (*static_cast<int*>(context))++;
+}
+
+/** @brief Riempie gli slot degli avvii programmati e controlla i rifiuti. */
+static int checkSchedule() {
+    int failures = 0;
+    int started = 0;
+    CommandRouter router;
+    router.on(CMD_START_DOM_GAME, countCommand, &started);
+    router.on(CMD_FORCE_END_GAME, countCommand, &started);
+    // Scarto di 1000 ms: all'istante locale 0 il server è a 1000.
+    ClockSync clock;
+    clock.addSample(0, 1000, 1000, 0);
+    const char* future = "CMD:START_DOM_GAME;AT:5000;";
+
+    std::string tooLong = future + std::string(COMMAND_SCHEDULE_MAX_LEN, 'X');
+    if (router.canAccept(tooLong.c_str(), clock, 0) || router.dispatch(tooLong.c_str(), clock, 0)) {
+        printf("FALLITO  programmato: accettato un comando piu' lungo di uno slot\n");
+        failures++;
+    }
+    for (int i = 0; i < COMMAND_SCHEDULE_SLOTS; i++) {
+        if (!router.canAccept(future, clock, 0) || !router.dispatch(future, clock, 0)) {
+            printf("FALLITO  programmato: slot %d rifiutato\n", i);
+            failures++;
+        }
+    }
+    if (router.canAccept(future, clock, 0) || router.dispatch(future, clock, 0)) {
+        printf("FALLITO  programmato: accettato con gli slot tutti occupati\n");
+        failures++;
+    }
+    // Gli slot pieni non riguardano i comandi immediati né quelli sconosciuti.
+    if (!router.canAccept("CMD:FORCE_END_GAME;", clock, 0) || !router.dispatch("CMD:FORCE_END_GAME;", clock, 0) ||
+        !router.canAccept("CMD:START_DOM_GAME;AT:500;", clock, 0) || !router.canAccept("CMD:NOPE;AT:5000;", clock, 0)) {
+        printf("FALLITO  programmato: rifiutato un comando da eseguire subito\n");
+        failures++;
+    }
+    if (started != 1) {
+        printf("FALLITO  programmato: %d comandi eseguiti prima di AT invece di 1\n", started);
+        failures++;
+    }
+    router.runDue(clock, 4000);
+    if (started != 1 + COMMAND_SCHEDULE_SLOTS || !router.canAccept(future, clock, 3000)) {
+        printf("FALLITO  programmato: %d comandi eseguiti a AT, slot non liberati\n", started - 1);
+        failures++;
+    }
+    printf("Avvii programmati: %d slot, %d errori\n", COMMAND_SCHEDULE_SLOTS, failures);
+    return failures;
+}
+
+int main(int argc, char** argv) {
+    const char* corpusPath = argc > 1 ? argv[1] : "bench/command_router/corpus";
+    std::vector<std::string> corpus = loadCorpus(corpusPath);
+    if (corpus.empty()) {
+        printf("FALLITO  corpus vuoto o non trovato: %s\n", corpusPath);
+        return 1;
+    }
+
+    // --- Corpus ---
+    int failures = 0;
+    for (const auto& input : corpus) {
+        if (!check(input)) {
+            printf("FALLITO  corpus: \"%s\"\n", input.c_str());
+            failures++;
+        }
+    }
+    printf("Corpus: %zu input, %d errori\n", corpus.size(), failures);
+
+    // --- Fuzzing ---
+    const int fuzzIterations = 200000;
+    int fuzzFailures = 0;
+    for (int it = 0; it < fuzzIterations; it++) {
+        std::string input = mutate(corpus);
+        if (!check(input)) {
+            if (fuzzFailures < 10) {
+                printf("FALLITO  fuzz: \"%s\"\n", input.c_str());
+            }
+            fuzzFailures++;
+        }
+    }
+    printf("Fuzzing: %d varianti, %d errori\n", fuzzIterations, fuzzFailures);
+    failures += fuzzFailures;
+
+    // --- Avvii programmati ---
+    failures += checkSchedule();
+
+    // --- Throughput ---
+    const char* sample = "CMD:SET_SD_SETTINGS;BOMB_TIME:10;ARM_TIME:5;DEFUSE_TIME:10;"
+                         "USE_ARM_PIN:1;ARM_PIN:1234;USE_DEFUSE_PIN:0;DEFUSE_PIN:0042;";
+    const int iterations = 200000;
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        ParsedCommand parsed;
+        CommandRouter::parse(sample, parsed);
+        sink += parsed.id + parsed.fields[FIELD_DEFUSE_PIN].length;
+    }
+    auto mid = std::chrono::steady_clock::now();
+    std::string sampleString(sample);
+    for (int it = 0; it < iterations; it++) {
+        ReferenceResult reference = referenceParse(sampleString);
+        sink += reference.id + reference.fields[FIELD_DEFUSE_PIN].size();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double routerNs = std::chrono::duration<double, std::nano>(mid - start).count() / iterations;
+    double referenceNs = std::chrono::duration<double, std::nano>(end - mid).count() / iterations;
+    printf("Router: %.0f ns/comando, riferimento (split + startsWith): %.0f ns/comando (%.1fx)\n",
+           routerNs, referenceNs, referenceNs / routerNs);
+    printf("(checksum %zu)\n", sink);
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+// bench/event_bus/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Verifica e benchmark sull'host dell'EventBus e dell'EventEncoder.
+ * @details Esecuzione: pio run -e bench_event_bus && .pio/build/bench_event_bus/program
+ * 1. Ogni evento di gioco viene codificato e confrontato con il messaggio che
+ *    le modalità formattavano a mano prima del bus: il pannello non deve vedere differenze.
+ * 2. Coda: ordine di consegna, filtro per maschera, scarto oltre la capacità,
+ *    eventi pubblicati durante la consegna rimandati alla dispatch() successiva.
+ * 3. Costo di publish() + dispatch() per evento con 1..EVENT_BUS_MAX_SUBSCRIBERS iscritti.
+ * Il programma termina con codice 1 se anche una sola verifica fallisce.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include "EventBus.h"
+#include "Network/EventEncoder.h"
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    if (!condition) {
+        printf("ERRORE: %s\n", what);
+        failures++;
+    }
+}
+
+struct EncodingCase {
+    GameEvent event;
+    const char* expected;
+};
+
+static const EncodingCase ENCODING_CASES[] = {
+    { { GameEventId::MODE_ENTER, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:mode_enter;mode:sd;" },
+    { { GameEventId::MODE_EXIT, GameEventMode::DOMINATION, 0, 0, 0 }, "event:mode_exit;mode:domination;" },
+    { { GameEventId::MODE_ENTER, GameEventMode::MAIN_MENU, 0, 0, 0 }, "event:mode_enter;mode:main_menu;" },
+    { { GameEventId::MODE_EXIT, GameEventMode::TEST_HARDWARE, 0, 0, 0 }, "event:mode_exit;mode:testhw;" },
+    { { GameEventId::REMOTE_START, GameEventMode::TERMINAL, 0, 0, 0 }, "event:remote_start;mode:terminal;" },
+    { { GameEventId::GAME_START, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:game_start;" },
+    { { GameEventId::GAME_START, GameEventMode::DOMINATION, 0, 20, 0 }, "event:game_start;mode:domination;duration:20" },
+    { { GameEventId::GAME_END, GameEventMode::SEARCH_DESTROY, SD_TEAM_TERRORISTS, 0, 0 }, "event:game_end;winner:terrorists;" },
+    { { GameEventId::GAME_END, GameEventMode::SEARCH_DESTROY, SD_TEAM_COUNTER_TERRORISTS, 0, 0 }, "event:game_end;winner:counter-terrorists;" },
+    { { GameEventId::GAME_END, GameEventMode::DOMINATION, 0, 0, 0 }, "event:game_end;winner:0" },
+    { { GameEventId::ROUND_RESET, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:round_reset;" },
+    { { GameEventId::COUNTDOWN_START, GameEventMode::DOMINATION, 0, 10, 0 }, "event:countdown_start;duration:10;" },
+    { { GameEventId::ARM_START, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:arm_start;" },
+    { { GameEventId::ARM_PROGRESS, GameEventMode::SEARCH_DESTROY, 0, 42, 0 }, "event:arm_progress;progress:42;" },
+    { { GameEventId::ARM_CANCEL, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:arm_cancel;" },
+    { { GameEventId::ARM_PIN_WRONG, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:arm_pin_wrong;" },
+    { { GameEventId::BOMB_ARMED, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:bomb_armed;" },
+    { { GameEventId::DEFUSE_START, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:defuse_start;" },
+    { { GameEventId::DEFUSE_PROGRESS, GameEventMode::SEARCH_DESTROY, 0, 99, 0 }, "event:defuse_progress;progress:99;" },
+    { { GameEventId::DEFUSE_CANCEL, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:defuse_cancel;" },
+    { { GameEventId::DEFUSE_PIN_WRONG, GameEventMode::SEARCH_DESTROY, 0, 0, 0 }, "event:defuse_pin_wrong;" },
+    { { GameEventId::CAPTURE_START, GameEventMode::DOMINATION, 1, 0, 0 }, "event:capture_start;team:1;" },
+    { { GameEventId::CAPTURE_PROGRESS, GameEventMode::DOMINATION, 2, 7, 0 }, "event:capture_progress;team:2;progress:7;" },
+    { { GameEventId::CAPTURE_CANCEL, GameEventMode::DOMINATION, 2, 0, 0 }, "event:capture_cancel;team:2;" },
+    { { GameEventId::ZONE_CAPTURED, GameEventMode::DOMINATION, 1, 0, 0 }, "event:zone_captured;team:1;" },
+    { { GameEventId::SCORE_UPDATE, GameEventMode::DOMINATION, 0, 61000, 1500 }, "event:score_update;team1_score:61000;team2_score:1500;" },
+};
+
+static void checkEncoding() {
+    char out[224];
+    bool covered[(uint8_t)GameEventId::COUNT] = {};
+    for (const EncodingCase& c : ENCODING_CASES) {
+        size_t length = EventEncoder::encode(c.event, out, sizeof(out));
+        if (length != strlen(c.expected) || strcmp(out, c.expected) != 0) {
+            printf("ERRORE: codifica \"%s\", atteso \"%s\"\n", length ? out : "", c.expected);
+            failures++;
+        }
+        covered[(uint8_t)c.event.id] = true;
+    }
+    for (uint8_t i = 0; i < (uint8_t)GameEventId::COUNT; i++) {
+        if (!covered[i]) {
+            printf("ERRORE: evento %u senza caso di codifica\n", i);
+            failures++;
+        }
+    }
+    GameEvent event = { GameEventId::SCORE_UPDATE, GameEventMode::DOMINATION, 0, 61000, 1500 };
+    expect(EventEncoder::encode(event, out, 10) == 0, "codifica troncata accettata");
+    printf("Codifica: %zu casi\n", sizeof(ENCODING_CASES) / sizeof(ENCODING_CASES[0]));
+}
+
+// --- Coda ---
+
+static GameEventId received[64];
+static int receivedCount = 0;
+static EventBus* republishBus = nullptr;
+
+static void recordEvent(const GameEvent& event, void*) {
+    received[receivedCount++ % 64] = event.id;
+}
+
+static void republishEvent(const GameEvent& event, void*) {
+    if (event.id == GameEventId::ARM_START) {
+        republishBus->publish(GameEventId::BOMB_ARMED);
+    }
+}
+
+static void checkQueue() {
+    EventBus bus;
+    int counted = 0;
+    expect(bus.subscribe(gameEventBit(GameEventId::ARM_START) | gameEventBit(GameEventId::BOMB_ARMED),
+                         recordEvent, nullptr), "iscrizione");
+    expect(bus.subscribe(GAME_EVENT_ALL, [](const GameEvent&, void* context) {
+        (*static_cast<int*>(context))++;
+    }, &counted), "iscrizione");
+    republishBus = &bus;
+    expect(bus.subscribe(GAME_EVENT_ALL, republishEvent, nullptr), "iscrizione");
+    expect(bus.subscribe(GAME_EVENT_ALL, recordEvent, nullptr), "iscrizione");
+    expect(!bus.subscribe(GAME_EVENT_ALL, recordEvent, nullptr), "iscritto oltre la capacità accettato");
+
+    receivedCount = 0;
+    bus.publish(GameEventId::ROUND_RESET);
+    bus.publish(GameEventId::ARM_START);
+    bus.dispatch();
+    // ROUND_RESET solo all'ultimo iscritto, ARM_START al primo e all'ultimo.
+    expect(receivedCount == 3 && received[0] == GameEventId::ROUND_RESET &&
+           received[1] == GameEventId::ARM_START && received[2] == GameEventId::ARM_START, "ordine o maschera");
+    expect(counted == 2, "iscritto a tutti gli eventi");
+    // BOMB_ARMED pubblicato durante la consegna arriva alla dispatch() successiva.
+    bus.dispatch();
+    expect(receivedCount == 5 && received[3] == GameEventId::BOMB_ARMED, "evento pubblicato durante la consegna");
+
+    for (int i = 0; i < EVENT_BUS_QUEUE_SIZE + 3; i++) {
+        bus.publish(GameEventId::ARM_PROGRESS, GameEventMode::SEARCH_DESTROY, 0, i);
+    }
+    expect(bus.getDroppedCount() == 3, "conteggio degli scarti");
+    expect(bus.getQueueHighWater() == EVENT_BUS_QUEUE_SIZE, "massimo della coda");
+    counted = 0;
+    bus.dispatch();
+    expect(counted == EVENT_BUS_QUEUE_SIZE, "consegna della coda piena");
+    printf("Coda: %s\n", failures == 0 ? "ok" : "errori");
+}
+
+// --- Costo ---
+
+static volatile uint32_t sink = 0;
+static void cheapHandler(const GameEvent& event, void*) { sink += event.value; }
+
+static void measureDispatch() {
+    const int rounds = 200000;
+    for (uint8_t subscribers = 1; subscribers <= EVENT_BUS_MAX_SUBSCRIBERS; subscribers++) {
+        EventBus bus;
+        for (uint8_t i = 0; i < subscribers; i++) {
+            bus.subscribe(GAME_EVENT_ALL, cheapHandler, nullptr);
+        }
+        auto start = std::chrono::steady_clock::now();
+        for (int r = 0; r < rounds; r++) {
+            // Una passata tipica del loop(): qualche evento, poi la consegna.
+            bus.publish(GameEventId::CAPTURE_PROGRESS, GameEventMode::DOMINATION, 1, r);
+            bus.publish(GameEventId::SCORE_UPDATE, GameEventMode::DOMINATION, 0, r, r);
+            bus.dispatch();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        printf("Iscritti %u: %.1f ns/evento (publish + dispatch)\n", subscribers, ns / (rounds * 2.0));
+    }
+    printf("(checksum %u)\n", sink);
+}
+
+int main() {
+    checkEncoding();
+    checkQueue();
+    measureDispatch();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,257 @@
+// bench/mode_loop/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Costo per passata di ogni stato di Cerca & Distruggi e Dominio, sul dispositivo simulato.
+ * @details Esecuzione: pio run -e bench_mode_loop && .pio/build/bench_mode_loop/program [risultati.json]
+ * Per ogni ModeState delle due modalità un copione porta il dispositivo
+ * simulato (sim/SimGame.h) nello stato, con gli ingressi che lo mantengono
+ * (es. il pulsante di innesco premuto), poi misura MEASURED_PASSES passate del
+ * loop() al millisecondo dopo WARMUP_PASSES di assestamento. Per passata:
+ * - pass_ns: tempo dell'intera passata (ingressi, melodia, effetti, rete, modalità);
+ * - loop_ns, loop_p99_ns: solo loop() della modalità, dalla sonda dello stato nel Profiler;
+ * - allocs, alloc_bytes: allocazioni sull'heap (operator new), String comprese;
+ * - io: chiamate di HardwareManager all'LCD (lcd_prints, lcd_clears) e operazioni
+ *   sulle periferiche (caratteri e spostamenti del cursore dell'LCD, refresh
+ *   degli OLED, show della striscia, cambi del buzzer, messaggi di rete).
+ * Il risultato è un documento JSON sullo stdout (o nel file indicato), da
+ * confrontare tra commit. Il programma termina con codice 1 se un copione non
+ * raggiunge il suo stato o se lo stato cambia durante la misura.
+ */
+
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include "SimGame.h"
+#include "Profiler.h"
+#include "GameModes/SearchDestroySettings.h"
+#include "GameModes/DominationSettings.h"
+
+static const uint32_t WARMUP_PASSES = 50;
+static const uint32_t MEASURED_PASSES = 500;
+static const uint32_t SETUP_TICK_MS = 10;       // Copioni: passo lungo, conta solo lo stato raggiunto
+static const uint32_t COARSE_TICK_MS = 250;     // Attesa della fine del timer della bomba
+static const uint32_t MARGIN_MS = 100;
+
+// Impostazioni: ogni stato a tempo dura più della misura (il timer della bomba più dell'intero copione).
+static const int BOMB_MIN = 10;
+static const int GAME_MIN = 10;
+static const int ACTION_S = 5;                  // Innesco, disinnesco, conquista, conto alla rovescia
+static const char* const ARM_PIN = "1234";
+static const char* const DEFUSE_PIN = "4321";
+
+// --- Conteggio delle allocazioni ---
+
+static bool countAllocations = false;
+static uint64_t allocationCount = 0;
+static uint64_t allocationBytes = 0;
+
+void* operator new(size_t size) {
+    if (countAllocations) {
+        allocationCount++;
+        allocationBytes += size;
+    }
+    void* p = malloc(size > 0 ? size : 1);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// --- Copioni ---
+
+/** @brief Preme un pulsante e lo lascia premuto, oltre l'anti-rimbalzo. */
+static void pressAndKeep(SimGame& game, uint8_t button) {
+    simBoard.setButton(button, true);
+    game.run(SIM_SETTLE_MS + game.getTickMs());
+}
+
+static void sdSubMenu(SimGame& game) { game.enterMode(APP_STATE_SEARCH_DESTROY_MODE); }
+static void sdSettings(SimGame& game) { sdSubMenu(game); game.type("8"); game.press(2); }
+template <int item>
+static void sdEdit(SimGame& game) {
+    sdSettings(game);
+    for (int i = 0; i < item; i++) {
+        game.type("8");
+    }
+    game.press(2);
+}
+static void sdConfirm(SimGame& game) { sdSubMenu(game); game.press(2); }
+static void sdAwaitArm(SimGame& game) { sdConfirm(game); game.press(2); }
+static void sdArming(SimGame& game) { sdAwaitArm(game); pressAndKeep(game, 1); }
+static void sdEnterArmPin(SimGame& game) { sdAwaitArm(game); game.hold(1, ACTION_S * 1000 + MARGIN_MS); }
+static void sdArmed(SimGame& game) { sdEnterArmPin(game); game.type(ARM_PIN); }
+static void sdCountdown(SimGame& game) { sdArmed(game); game.run(1000 + MARGIN_MS); }
+static void sdDefusing(SimGame& game) { sdCountdown(game); pressAndKeep(game, 2); }
+static void sdEnterDefusePin(SimGame& game) { sdCountdown(game); game.hold(2, ACTION_S * 1000 + MARGIN_MS); }
+static void sdDefused(SimGame& game) { sdEnterDefusePin(game); game.type(DEFUSE_PIN); }
+static void sdEnded(SimGame& game) { sdCountdown(game); game.run(BOMB_MIN * 60000 + MARGIN_MS, COARSE_TICK_MS); }
+
+static void domSubMenu(SimGame& game) { game.enterMode(APP_STATE_DOMINATION_MODE); }
+static void domSettings(SimGame& game) { domSubMenu(game); game.type("8"); game.press(2); }
+template <int item>
+static void domEdit(SimGame& game) {
+    domSettings(game);
+    for (int i = 0; i < item; i++) {
+        game.type("8");
+    }
+    game.press(2);
+}
+static void domConfirm(SimGame& game) { domSubMenu(game); game.press(2); }
+static void domCountdown(SimGame& game) { domConfirm(game); game.press(2); }
+static void domNeutral(SimGame& game) { domCountdown(game); game.run(ACTION_S * 1000 + MARGIN_MS); }
+static void domCapturing1(SimGame& game) { domNeutral(game); pressAndKeep(game, 1); }
+static void domTeam1Captured(SimGame& game) { domNeutral(game); game.hold(1, ACTION_S * 1000 + MARGIN_MS); }
+static void domCapturing2(SimGame& game) { domTeam1Captured(game); pressAndKeep(game, 2); }
+static void domTeam2Captured(SimGame& game) { domTeam1Captured(game); game.hold(2, ACTION_S * 1000 + MARGIN_MS); }
+static void domGameOver(SimGame& game) { domNeutral(game); game.command("CMD:FORCE_END_GAME;"); }
+
+struct StateCase {
+    const char* mode;       // Gruppo delle sonde di stato della modalità nel Profiler
+    const char* state;      // Nome del ModeState, come nella tabella della modalità
+    void (*reach)(SimGame& game);
+};
+
+static const StateCase CASES[] = {
+    { "sd",  "MODE_SUB_MENU",            sdSubMenu },
+    { "sd",  "MENU_SETTINGS",            sdSettings },
+    { "sd",  "EDIT_BOMB_TIME",           sdEdit<0> },
+    { "sd",  "EDIT_ARM_PIN",             sdEdit<1> },
+    { "sd",  "EDIT_DISARM_PIN",          sdEdit<2> },
+    { "sd",  "EDIT_ARM_TIME",            sdEdit<3> },
+    { "sd",  "EDIT_DEFUSE_TIME",         sdEdit<4> },
+    { "sd",  "EDIT_USE_ARM_PIN",         sdEdit<5> },
+    { "sd",  "EDIT_USE_DISARM_PIN",      sdEdit<6> },
+    { "sd",  "IN_GAME_CONFIRM",          sdConfirm },
+    { "sd",  "IN_GAME_AWAIT_ARM",        sdAwaitArm },
+    { "sd",  "IN_GAME_IS_ARMING",        sdArming },
+    { "sd",  "IN_GAME_ENTER_ARM_PIN",    sdEnterArmPin },
+    { "sd",  "IN_GAME_ARMED",            sdArmed },
+    { "sd",  "IN_GAME_COUNTDOWN",        sdCountdown },
+    { "sd",  "IN_GAME_IS_DEFUSING",      sdDefusing },
+    { "sd",  "IN_GAME_ENTER_DEFUSE_PIN", sdEnterDefusePin },
+    { "sd",  "IN_GAME_DEFUSED",          sdDefused },
+    { "sd",  "IN_GAME_ENDED",            sdEnded },
+    { "dom", "MODE_SUB_MENU",            domSubMenu },
+    { "dom", "MENU_SETTINGS",            domSettings },
+    { "dom", "EDIT_DURATION",            domEdit<0> },
+    { "dom", "EDIT_CAPTURE_TIME",        domEdit<1> },
+    { "dom", "EDIT_COUNTDOWN",           domEdit<2> },
+    { "dom", "IN_GAME_CONFIRM",          domConfirm },
+    { "dom", "IN_GAME_COUNTDOWN",        domCountdown },
+    { "dom", "IN_GAME_NEUTRAL",          domNeutral },
+    { "dom", "CAPTURING_TEAM1",          domCapturing1 },
+    { "dom", "CAPTURING_TEAM2",          domCapturing2 },
+    { "dom", "TEAM1_CAPTURED",           domTeam1Captured },
+    { "dom", "TEAM2_CAPTURED",           domTeam2Captured },
+    { "dom", "GAME_OVER",                domGameOver },
+};
+static const size_t CASE_COUNT = sizeof(CASES) / sizeof(CASES[0]);
+
+static void configureSettings() {
+    SearchDestroySettings sd;
+    sd.setBombTime(BOMB_MIN);
+    sd.setArmingTime(ACTION_S);
+    sd.setDefuseTime(ACTION_S);
+    sd.setArmingPin(ARM_PIN);
+    sd.setDisarmingPin(DEFUSE_PIN);
+    sd.setUseArmingPin(true);
+    sd.setUseDisarmingPin(true);
+    sd.saveParameters();
+
+    DominationSettings dom;
+    dom.setGameDuration(GAME_MIN);
+    dom.setCaptureTime(ACTION_S);
+    dom.setCountdownDuration(ACTION_S);
+    dom.saveParameters();
+}
+
+/** @brief Campioni della sonda dall'ultimo reset del Profiler. */
+static ProfilerSummary probeSummary(const char* group, const char* name) {
+    ProfilerSummary summary;
+    profiler.summarize((uint8_t)profiler.add(group, name), summary);
+    return summary;
+}
+
+/**
+ * @brief Porta il dispositivo nello stato del caso, misura e scrive l'oggetto JSON.
+ * @return false se lo stato non è quello atteso per tutta la misura.
+ */
+static bool measure(const StateCase& c, FILE* out, bool first) {
+    SimGame game;
+    game.setTickMs(SETUP_TICK_MS);
+    c.reach(game);
+    game.setTickMs(SIM_TICK_MS);
+    game.run(WARMUP_PASSES);
+
+    profiler.reset();
+    simBoard.resetCounters();
+    allocationCount = 0;
+    allocationBytes = 0;
+    countAllocations = true;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < MEASURED_PASSES; i++) {
+        game.step();
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    countAllocations = false;
+
+    ProfilerSummary loop = probeSummary(c.mode, c.state);
+    ProfilerSummary lcdPrints = probeSummary("hw", "lcd_print");
+    ProfilerSummary lcdClears = probeSummary("hw", "lcd_clear");
+    const SimCounters& io = simBoard.getCounters();
+    const double n = MEASURED_PASSES;
+
+    fprintf(out, "%s\n    {\"mode\": \"%s\", \"state\": \"%s\", \"pass_ns\": %.1f, \"loop_ns\": %.1f, \"loop_p99_ns\": %.1f, "
+                 "\"allocs\": %.3f, \"alloc_bytes\": %.1f,\n"
+                 "     \"io\": {\"lcd_prints\": %.3f, \"lcd_clears\": %.3f, \"lcd_chars\": %.3f, \"lcd_cursor_moves\": %.3f, "
+                 "\"oled_refreshes\": %.3f, \"strip_shows\": %.3f, \"tone_changes\": %.3f, \"network_sends\": %.3f}}",
+            first ? "" : ",", c.mode, c.state, ns / n,
+            loop.count > 0 ? loop.totalUs * 1000.0 / loop.count : 0.0, loop.p99Us * 1000.0,
+            allocationCount / n, allocationBytes / n,
+            lcdPrints.count / n, lcdClears.count / n, io.lcdChars / n, io.lcdCursorMoves / n,
+            io.oledRefreshes / n, io.stripShows / n, io.toneChanges / n, io.networkSends / n);
+
+    if (loop.count != MEASURED_PASSES) {
+        fprintf(stderr, "ERRORE: %s.%s eseguito in %lu passate su %lu\n", c.mode, c.state,
+                (unsigned long)loop.count, (unsigned long)MEASURED_PASSES);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    FILE* out = stdout;
+    if (argc > 1) {
+        out = fopen(argv[1], "w");
+        if (out == nullptr) {
+            fprintf(stderr, "ERRORE: impossibile scrivere %s\n", argv[1]);
+            return 1;
+        }
+    }
+    configureSettings();
+
+    int failures = 0;
+    fprintf(out, "{\n  \"benchmark\": \"mode_loop\",\n  \"firmware\": \"%s\",\n  \"passes\": %lu,\n  \"tick_ms\": %u,\n  \"states\": [",
+            FIRMWARE_VERSION, (unsigned long)MEASURED_PASSES, (unsigned)SIM_TICK_MS);
+    for (size_t i = 0; i < CASE_COUNT; i++) {
+        if (!measure(CASES[i], out, i == 0)) {
+            failures++;
+        }
+    }
+    fprintf(out, "\n  ]\n}\n");
+    if (out != stdout) {
+        fclose(out);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,160 @@
+// bench/scheduler/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Prova sull'host dello Scheduler su un orologio virtuale.
+ * @details Esecuzione: pio run -e bench_scheduler && .pio/build/bench_scheduler/program
+ * Riproduce i lavori del loop(): ingressi a 1 kHz, rete a 200 Hz, LED a 40 Hz e
+ * una logica di modalità che ogni 200 ms ridisegna i display con 6 scritture I2C da
+ * 10 ms. Ogni lavoro fa avanzare l'orologio virtuale della propria durata, quindi
+ * l'esito è deterministico. Scenari:
+ * 1. senza punti di attesa: gli ingressi restano fermi per tutto il ridisegno;
+ * 2. con runUrgent() dopo ogni scrittura I2C, come fa HardwareManager;
+ * 3. lunga durata: l'orologio avanza a passi di 100 ms oltre 2^31 us (36 minuti)
+ *    e oltre il giro di micros() a 2^32 us (71 minuti).
+ * Si misura l'intervallo massimo tra due letture degli ingressi e si stampano le
+ * statistiche dei lavori. Il programma termina con codice 1 se nel secondo
+ * scenario gli ingressi restano fermi più di una scrittura I2C, se le
+ * statistiche non corrispondono al carico simulato o se nel terzo un lavoro
+ * salta una passata.
+ */
+
+#include <stdio.h>
+#include "Scheduler.h"
+
+static const uint32_t SIMULATED_US = 10000000;   // 10 secondi
+static const uint32_t I2C_WRITE_US = 10000;
+static const uint32_t REDRAW_PERIOD_US = 200000;
+static const uint32_t REDRAW_WRITES = 6;
+static const uint32_t LONG_STEP_US = 100000;
+static const uint64_t LONG_RUN_US = 4300000000ULL;  // Oltre 2^32 us
+
+static uint32_t virtualNow = 0;
+static uint32_t virtualClock() { return virtualNow; }
+
+static Scheduler* current = nullptr;
+static bool useBusWait = false;
+static uint32_t lastInput = 0;
+static uint32_t maxInputGap = 0;
+static uint32_t nextRedraw = 0;
+
+static void inputJob(void*) {
+    if (lastInput != 0 && virtualNow - lastInput > maxInputGap) {
+        maxInputGap = virtualNow - lastInput;
+    }
+    lastInput = virtualNow;
+    virtualNow += 20;
+}
+
+static void networkJob(void*) { virtualNow += 300; }
+static void ledJob(void*) { virtualNow += 800; }
+
+static void modeJob(void*) {
+    virtualNow += 50;
+    if ((int32_t)(virtualNow - nextRedraw) < 0) {
+        return;
+    }
+    nextRedraw += REDRAW_PERIOD_US;
+    for (uint32_t i = 0; i < REDRAW_WRITES; i++) {
+        virtualNow += I2C_WRITE_US;
+        if (useBusWait) {
+            current->runUrgent(virtualClock);
+        }
+    }
+}
+
+static void printStats(const Scheduler& scheduler) {
+    for (uint8_t i = 0; i < scheduler.getJobCount(); i++) {
+        const SchedulerJobStats& stats = scheduler.getStats(i);
+        printf("  %-8s esecuzioni %6u, jitter max %6u us, durata max %6u us, sforamenti %4u, periodi persi %5u\n",
+               scheduler.getJobName(i), stats.runs, stats.maxJitterUs, stats.maxDurationUs,
+               stats.overruns, stats.missed);
+    }
+}
+
+/** @brief Esegue lo scenario e ritorna l'intervallo massimo tra due letture degli ingressi (us). */
+static uint32_t runScenario(bool busWait, Scheduler& scheduler) {
+    virtualNow = 1000;
+    lastInput = 0;
+    maxInputGap = 0;
+    nextRedraw = virtualNow;
+    useBusWait = busWait;
+    current = &scheduler;
+
+    scheduler.add("input", 1000, 500, inputJob, nullptr, true);
+    scheduler.add("network", 5000, 5000, networkJob, nullptr);
+    scheduler.add("leds", 25000, 10000, ledJob, nullptr);
+    scheduler.add("mode", 0, 50000, modeJob, nullptr);
+
+    uint32_t end = virtualNow + SIMULATED_US;
+    while ((int32_t)(virtualNow - end) < 0) {
+        scheduler.run(virtualClock);
+        virtualNow += 10;   // Costo della passata stessa
+    }
+    return maxInputGap;
+}
+
+static uint32_t longPassRuns = 0;
+static uint32_t longPeriodicRuns = 0;
+static void longPassJob(void*) { longPassRuns++; }
+static void longPeriodicJob(void*) { longPeriodicRuns++; }
+
+/**
+ * @brief Scenario di lunga durata: ritorna il numero di passate.
+ * @details I lavori a ogni passata e quelli periodici (periodo sotto il passo)
+ * devono girare a ogni passata, anche dopo 2^31 us e dopo il giro dell'orologio.
+ */
+static uint32_t runLongScenario(Scheduler& scheduler) {
+    virtualNow = 1000;
+    longPassRuns = 0;
+    longPeriodicRuns = 0;
+    scheduler.add("periodic", 1000, 500, longPeriodicJob, nullptr, true);
+    scheduler.add("pass", 0, 50000, longPassJob, nullptr);
+
+    uint32_t passes = 0;
+    for (uint64_t elapsed = 0; elapsed < LONG_RUN_US; elapsed += LONG_STEP_US) {
+        scheduler.run(virtualClock);
+        passes++;
+        virtualNow += LONG_STEP_US;
+    }
+    return passes;
+}
+
+int main() {
+    bool ok = true;
+
+    Scheduler plain;
+    uint32_t gapPlain = runScenario(false, plain);
+    printf("Senza punti di attesa: ingressi fermi al massimo %u us\n", gapPlain);
+    printStats(plain);
+
+    Scheduler yielding;
+    uint32_t gapYield = runScenario(true, yielding);
+    printf("Con runUrgent() alle scritture I2C: ingressi fermi al massimo %u us\n", gapYield);
+    printStats(yielding);
+
+    // Un ridisegno (60 ms, oltre la scadenza da 50 ms) ogni 200 ms: al più 50 sforamenti in 10 s.
+    const SchedulerJobStats& mode = yielding.getStats(3);
+    if (gapYield > I2C_WRITE_US + 2000 || gapYield >= gapPlain) {
+        printf("ERRORE: gli ingressi restano fermi durante le scritture I2C.\n");
+        ok = false;
+    }
+    if (mode.overruns == 0 || mode.overruns > SIMULATED_US / REDRAW_PERIOD_US + 1) {
+        printf("ERRORE: sforamenti della modalità inattesi (%u).\n", mode.overruns);
+        ok = false;
+    }
+    if (plain.getStats(0).missed == 0) {
+        printf("ERRORE: senza punti di attesa gli ingressi dovrebbero perdere periodi.\n");
+        ok = false;
+    }
+
+    Scheduler longRun;
+    uint32_t passes = runLongScenario(longRun);
+    printf("Lunga durata (%.0f s simulati): %u passate, lavoro a ogni passata %u, periodico %u\n",
+           LONG_RUN_US / 1e6, passes, longPassRuns, longPeriodicRuns);
+    if (longPassRuns != passes || longPeriodicRuns != passes) {
+        printf("ERRORE: dopo 2^31 us un lavoro ha smesso di girare.\n");
+        ok = false;
+    }
+    return ok ? 0 : 1;
+}
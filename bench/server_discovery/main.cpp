@@ -0,0 +1,109 @@
+// bench/server_discovery/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Prova sull'host della ricerca del server in LAN (ServerDiscovery).
+ * @details Esecuzione: pio run -e bench_discovery && .pio/build/bench_discovery/program
+ * Dispositivo e bridge di prova sono collegati da LoopbackTransport e avanzano
+ * su un orologio virtuale a passi di 10 ms, quindi l'esito è deterministico.
+ * Il bridge di prova risponde alle sonde come ControlPanel/udp_bridge.py.
+ * Scenari:
+ * 1. il bridge risponde alla prima sonda;
+ * 2. la prima sonda va persa, risponde alla seconda;
+ * 3. nessun bridge in LAN: la ricerca termina e si ripiega sul DNS.
+ * Il programma termina con codice 1 se uno scenario non dà l'esito atteso.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "Network/LoopbackTransport.h"
+#include "Network/ServerDiscovery.h"
+
+static const uint16_t PORT = 1234;
+static const uint32_t STEP_MS = 10;
+
+struct Outcome {
+    ServerDiscovery::State state;
+    uint32_t server;
+    uint32_t elapsedMs;
+    int probesSeen;     // Sonde arrivate al bridge
+};
+
+/**
+ * @brief Esegue una ricerca completa.
+ * @param answerFrom Numero della sonda (da 1) a cui il bridge inizia a rispondere; 0 = mai.
+ */
+static Outcome runDiscovery(int answerFrom) {
+    LoopbackTransport prop(LoopbackTransport::makeAddress(192, 168, 1, 50), "AA:BB:CC:DD:EE:FF");
+    LoopbackTransport bridge(LoopbackTransport::makeAddress(192, 168, 1, 2), "bridge");
+    LoopbackTransport::connect(prop, bridge);
+    prop.begin(PORT);
+    bridge.begin(PORT);
+
+    ServerDiscovery discovery;
+    Outcome outcome = { ServerDiscovery::DISCOVERY_IDLE, 0, 0, 0 };
+    uint32_t now = 1000;
+    discovery.start(now);
+
+    for (uint32_t t = 0; t < 10000; t += STEP_MS, now += STEP_MS) {
+        // Task di rete del dispositivo.
+        if (discovery.update(prop, PORT, now)) {
+            outcome.state = discovery.getState();
+            outcome.server = discovery.getServerAddress();
+            outcome.elapsedMs = t;
+            return outcome;
+        }
+
+        // Bridge di prova.
+        uint8_t buffer[256];
+        uint32_t from;
+        bool truncated;
+        int length;
+        while ((length = bridge.receive(buffer, sizeof(buffer) - 1, from, truncated)) >= 0) {
+            buffer[length] = '\0';
+            if (strncmp((const char*)buffer, "event:discover;", 15) == 0) {
+                outcome.probesSeen++;
+                if (answerFrom != 0 && outcome.probesSeen >= answerFrom) {
+                    const char* reply = "CMD:SERVER_HERE;";
+                    bridge.send(from, PORT, (const uint8_t*)reply, strlen(reply));
+                }
+            }
+        }
+
+        // Loop di gioco del dispositivo.
+        char packet[256];
+        while ((length = prop.receive((uint8_t*)packet, sizeof(packet) - 1, from, truncated)) >= 0) {
+            packet[length] = '\0';
+            discovery.handleReply(packet, from);
+        }
+    }
+    return outcome;
+}
+
+static bool report(const char* name, const Outcome& outcome, ServerDiscovery::State expected, uint32_t expectedServer) {
+    bool ok = outcome.state == expected && outcome.server == expectedServer;
+    printf("%-8s %-36s esito %s in %u ms, %d sonde\n", ok ? "OK" : "FALLITO", name,
+           outcome.state == ServerDiscovery::DISCOVERY_FOUND ? "trovato" :
+           outcome.state == ServerDiscovery::DISCOVERY_NOT_FOUND ? "non trovato (DNS)" : "in corso",
+           outcome.elapsedMs, outcome.probesSeen);
+    return ok;
+}
+
+int main() {
+    uint32_t bridgeAddress = LoopbackTransport::makeAddress(192, 168, 1, 2);
+    int failures = 0;
+
+    failures += !report("Bridge in LAN", runDiscovery(1),
+                        ServerDiscovery::DISCOVERY_FOUND, bridgeAddress);
+    failures += !report("Prima sonda persa", runDiscovery(2),
+                        ServerDiscovery::DISCOVERY_FOUND, bridgeAddress);
+
+    Outcome absent = runDiscovery(0);
+    failures += !report("Nessun bridge in LAN", absent, ServerDiscovery::DISCOVERY_NOT_FOUND, 0);
+    if (absent.probesSeen != DISCOVERY_PROBES) {
+        printf("FALLITO  attese %d sonde, inviate %d\n", DISCOVERY_PROBES, absent.probesSeen);
+        failures++;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
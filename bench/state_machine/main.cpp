@@ -0,0 +1,209 @@
+// bench/state_machine/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Verifica e benchmark sull'host della StateMachine.
+ * @details Esecuzione: pio run -e bench_state_machine && .pio/build/bench_state_machine/program
+ * 1. Validazione in compilazione: indice delle righe per stato e tabelle
+ *    sbagliate rifiutate da isValid().
+ * 2. Semantica di handle() e update() su una tabella con guardie, transizioni
+ *    interne, righe ANY ed eventi senza riga: ordine di uscita, azione e
+ *    ingresso, precedenza delle righe dello stato su quelle ANY.
+ * 3. Costo di handle() per evento, con e senza passaggio alle righe ANY.
+ * Il programma termina con codice 1 se anche una sola verifica fallisce.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string>
+#include "StateMachine.h"
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what) {
+    if (!condition) {
+        printf("ERRORE: %s\n", what);
+        failures++;
+    }
+}
+
+enum class BenchState : uint8_t { IDLE, ARMED, DONE };
+enum class BenchEvent : uint8_t { PRESS, RELEASE, TICK, END, NOP };
+
+/**
+ * @brief Proprietario di prova: ogni azione annota il proprio nome in _trace,
+ * insieme allo stato che vede.
+ */
+class BenchOwner {
+public:
+    typedef StateMachine<BenchOwner, BenchState, BenchEvent> Machine;
+    struct Tables;
+
+    BenchOwner();
+
+    Machine machine;
+    bool armAllowed;
+    std::string trace;
+    uint32_t ticks;
+
+    void enterIdle() { note("enter:IDLE"); }
+    void exitIdle() { note("exit:IDLE"); }
+    void enterArmed() { note("enter:ARMED"); }
+    void exitArmed() { note("exit:ARMED"); }
+    void enterDone() { note("enter:DONE"); }
+    void updateState() { note(std::string("update:") + machine.getStateName()); }
+
+    bool canArm() const { return armAllowed; }
+    bool isNotDone() const { return machine.getState() != BenchState::DONE; }
+
+    void arm() { note(std::string("arm@") + machine.getStateName()); }
+    void refuse() { note("refuse"); }
+    void resetIdle() { note("reset"); }
+    void tick() { ticks++; }
+    void finish() { note(std::string("finish@") + machine.getStateName()); }
+
+private:
+    void note(const std::string& text) {
+        if (!trace.empty()) {
+            trace += ' ';
+        }
+        trace += text;
+    }
+};
+
+struct BenchOwner::Tables {
+    typedef BenchOwner O;
+    typedef BenchState S;
+    typedef BenchEvent E;
+
+    static constexpr Machine::StateSpec STATES[] = {
+        { S::IDLE,  "IDLE",  &O::enterIdle,  &O::updateState, &O::exitIdle },
+        { S::ARMED, "ARMED", &O::enterArmed, &O::updateState, &O::exitArmed },
+        { S::DONE,  "DONE",  &O::enterDone,  nullptr,         nullptr },
+    };
+
+    static constexpr Machine::Transition TRANSITIONS[] = {
+        // Stessa coppia stato/evento: vale la prima riga con la guardia soddisfatta.
+        { S::IDLE,         E::PRESS,   &O::canArm,    &O::arm,       S::ARMED },
+        { S::IDLE,         E::PRESS,   nullptr,       &O::refuse,    S::IDLE },
+        // Riga dello stato con lo stesso evento di una riga ANY: deve prevalere.
+        { S::IDLE,         E::END,     nullptr,       &O::resetIdle, S::IDLE },
+        { S::ARMED,        E::TICK,    nullptr,       &O::tick,      S::ARMED },
+        { S::ARMED,        E::RELEASE, nullptr,       nullptr,       S::IDLE },
+        { Machine::ANY,    E::END,     &O::isNotDone, &O::finish,    S::DONE },
+    };
+
+    static constexpr size_t STATE_COUNT = sizeof(STATES) / sizeof(STATES[0]);
+    static constexpr size_t TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+    static constexpr Machine::StateTable<STATE_COUNT, TRANSITION_COUNT> TABLE{ STATES, TRANSITIONS };
+
+    // --- 1. Validazione in compilazione ---
+    static_assert(TABLE.isValid(), "Tabella di prova valida");
+    static_assert(TABLE.countFrom(S::IDLE) == 3 && TABLE.countFrom(S::ARMED) == 2 &&
+                  TABLE.countFrom(S::DONE) == 0 && TABLE.firstAny == 5, "Righe indicizzate per stato");
+
+    static constexpr Machine::StateSpec STATES_OUT_OF_ORDER[] = {
+        { S::ARMED, "ARMED", nullptr, nullptr, nullptr },
+        { S::IDLE,  "IDLE",  nullptr, nullptr, nullptr },
+        { S::DONE,  "DONE",  nullptr, nullptr, nullptr },
+    };
+    static constexpr Machine::Transition ANY_NOT_LAST[] = {
+        { S::IDLE,      E::PRESS, nullptr, nullptr, S::ARMED },
+        { Machine::ANY, E::END,   nullptr, nullptr, S::DONE },
+        { S::ARMED,     E::TICK,  nullptr, nullptr, S::ARMED },
+    };
+    static constexpr Machine::Transition ROWS_NOT_GROUPED[] = {
+        { S::ARMED, E::TICK,  nullptr, nullptr, S::ARMED },
+        { S::IDLE,  E::PRESS, nullptr, nullptr, S::ARMED },
+    };
+    static constexpr Machine::Transition MISSING_TARGET[] = {
+        { S::IDLE, E::PRESS, nullptr, nullptr, static_cast<S>(7) },
+    };
+    static_assert(!Machine::StateTable<STATE_COUNT, TRANSITION_COUNT>{ STATES_OUT_OF_ORDER, TRANSITIONS }.isValid(),
+                  "Stati fuori dall'ordine dell'enum");
+    static_assert(!Machine::StateTable<STATE_COUNT, 3>{ STATES, ANY_NOT_LAST }.isValid(), "Riga ANY prima della fine");
+    static_assert(!Machine::StateTable<STATE_COUNT, 2>{ STATES, ROWS_NOT_GROUPED }.isValid(),
+                  "Righe non nell'ordine degli stati");
+    static_assert(!Machine::StateTable<STATE_COUNT, 1>{ STATES, MISSING_TARGET }.isValid(), "Arrivo inesistente");
+};
+
+BenchOwner::BenchOwner() :
+    machine(this, Tables::TABLE, BenchState::IDLE),
+    armAllowed(false),
+    ticks(0)
+{}
+
+/** @brief Consegna un evento e confronta risultato, traccia delle azioni e stato finale. */
+static void expectHandle(BenchOwner& owner, BenchEvent event, bool fired, const char* trace, BenchState state,
+                         const char* what) {
+    owner.trace.clear();
+    bool result = owner.machine.handle(event);
+    if (result != fired || owner.trace != trace || owner.machine.getState() != state) {
+        printf("ERRORE: %s: handle() = %d, traccia \"%s\", stato %s\n", what, result, owner.trace.c_str(),
+               owner.machine.getStateName());
+        failures++;
+    }
+}
+
+// --- 2. Semantica ---
+static void checkSemantics() {
+    BenchOwner owner;
+    owner.machine.start(BenchState::IDLE);
+    expect(owner.trace == "enter:IDLE" && owner.machine.getState() == BenchState::IDLE,
+           "start() esegue solo l'ingresso dello stato");
+
+    expectHandle(owner, BenchEvent::PRESS, true, "refuse", BenchState::IDLE,
+                 "guardia falsa: vale la riga successiva, interna (niente uscita né ingresso)");
+    expectHandle(owner, BenchEvent::NOP, false, "", BenchState::IDLE, "evento senza riga");
+    expectHandle(owner, BenchEvent::END, true, "reset", BenchState::IDLE,
+                 "la riga dello stato prevale sulla riga ANY con lo stesso evento");
+
+    owner.armAllowed = true;
+    expectHandle(owner, BenchEvent::PRESS, true, "exit:IDLE arm@IDLE enter:ARMED", BenchState::ARMED,
+                 "guardia vera: uscita, azione (nello stato di partenza), ingresso");
+    expectHandle(owner, BenchEvent::PRESS, false, "", BenchState::ARMED, "riga di un altro stato ignorata");
+
+    owner.trace.clear();
+    owner.machine.update();
+    expect(owner.trace == "update:ARMED", "update() esegue l'aggiornamento dello stato corrente");
+
+    expectHandle(owner, BenchEvent::TICK, true, "", BenchState::ARMED, "transizione interna senza uscita né ingresso");
+    expect(owner.ticks == 1, "azione della transizione interna eseguita");
+    expectHandle(owner, BenchEvent::RELEASE, true, "exit:ARMED enter:IDLE", BenchState::IDLE,
+                 "transizione senza azione");
+    expectHandle(owner, BenchEvent::TICK, false, "", BenchState::IDLE, "evento gestito solo in un altro stato");
+
+    owner.machine.start(BenchState::ARMED);
+    expectHandle(owner, BenchEvent::END, true, "exit:ARMED finish@ARMED enter:DONE", BenchState::DONE,
+                 "riga ANY quando lo stato non ha righe per l'evento");
+    expectHandle(owner, BenchEvent::END, false, "", BenchState::DONE, "guardia falsa sull'unica riga ANY");
+
+    owner.trace.clear();
+    owner.machine.update();
+    expect(owner.trace.empty(), "stato senza azione di aggiornamento");
+}
+
+// --- 3. Costo ---
+static void measure(const char* what, BenchState state, BenchEvent event) {
+    const int iterations = 10000000;
+    BenchOwner owner;
+    owner.machine.start(state);
+    uint32_t fired = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        fired += owner.machine.handle(event) ? 1 : 0;
+    }
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / iterations;
+    printf("handle() %-42s %6.2f ns/evento (scattate %u)\n", what, ns, (unsigned)fired);
+}
+
+int main() {
+    checkSemantics();
+    printf("Semantica: %d errori\n", failures);
+
+    measure("transizione interna (prima riga ARMED):", BenchState::ARMED, BenchEvent::TICK);
+    measure("nessuna riga (righe IDLE + ANY):", BenchState::IDLE, BenchEvent::NOP);
+    measure("guardia falsa sulla riga ANY:", BenchState::DONE, BenchEvent::END);
+
+    return failures == 0 ? 0 : 1;
+}
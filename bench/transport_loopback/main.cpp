@@ -0,0 +1,282 @@
+// bench/transport_loopback/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Benchmark sull'host del percorso eventi dispositivo -> bridge su LoopbackTransport.
+ * @details Esecuzione: pio run -e bench_loopback && .pio/build/bench_loopback/program
+ * 1. Codec: un thread simula il dispositivo: a ogni tick accoda un gruppo di
+ *    eventi, li impacchetta con DatagramBatcher (protocollo binario) e li invia.
+ *    Un secondo thread fa da bridge: riceve, decodifica con WireCodec e verifica
+ *    che le sequenze arrivino tutte e in ordine. Si misurano throughput degli
+ *    eventi e latenza dall'accodamento alla decodifica.
+ * 2. NetworkManager: quello del firmware, con runNetworkRound() al posto del
+ *    task di rete e SimBridge dall'altra parte (orologio virtuale della scheda).
+ *    Eventi inviati col collegamento attivo, poi durante una caduta (vanno nel
+ *    diario) e dopo il ritorno (reinvio del diario con "replay:1;"): devono
+ *    arrivare tutti una volta sola e nell'ordine delle sequenze.
+ * Il programma termina con codice 1 se un evento va perso, arriva corrotto o
+ * fuori ordine.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+#include <vector>
+#include "Network/DatagramBatcher.h"
+#include "Network/LoopbackTransport.h"
+#include "Network/WireCodec.h"
+#include "NetworkManager.h"
+#include "SimBoard.h"
+#include "SimBridge.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static const uint16_t PORT = 1234;
+static const uint16_t WIRE_HANDLE = 7;
+static const uint32_t EVENT_COUNT = 200000;
+static const uint32_t EVENTS_PER_TICK = 8;
+// Parte 2, in tempo simulato
+static const uint32_t NET_TICK_MS = 5;          // Periodo del lavoro di rete in main.cpp
+static const uint32_t SETTLE_MS = 2000;
+static const uint32_t REPLAY_TIMEOUT_MS = 10000;
+static const uint32_t ONLINE_EVENTS = 200;
+static const uint32_t OFFLINE_EVENTS = 150;
+static const uint32_t RETURN_EVENTS = 50;
+
+// Eventi tipici di un tick di gioco.
+static const char* const TICK_EVENTS[] = {
+    "event:time_update;time:874;",
+    "event:score_update;team1_score:1234;team2_score:987;",
+    "event:capture_progress;team:2;progress:57;",
+    "event:heartbeat;txq_hw:3;txq_drop:0;rxq_drop:0;rx_trunc:0;",
+};
+static const size_t TICK_EVENT_COUNT = sizeof(TICK_EVENTS) / sizeof(TICK_EVENTS[0]);
+
+/** @brief Parte 1: DatagramBatcher e WireCodec su due thread. */
+static int runCodecBench() {
+    LoopbackTransport prop(LoopbackTransport::makeAddress(192, 168, 1, 50), "AA:BB:CC:DD:EE:FF");
+    LoopbackTransport bridge(LoopbackTransport::makeAddress(192, 168, 1, 2), "bridge");
+    LoopbackTransport::connect(prop, bridge);
+    prop.begin(PORT);
+    bridge.begin(PORT);
+
+    // Istante di accodamento di ogni evento, indicizzato per numero di sequenza.
+    std::vector<Clock::time_point> queuedAt(EVENT_COUNT);
+    std::vector<double> latencyUs;
+    latencyUs.reserve(EVENT_COUNT);
+    std::atomic<bool> propDone(false);
+    uint32_t received = 0;
+    uint32_t errors = 0;
+    uint32_t datagrams = 0;
+
+    auto start = Clock::now();
+
+    std::thread bridgeThread([&]() {
+        uint8_t buffer[LOOPBACK_MAX_DATAGRAM];
+        char text[256];
+        uint32_t expected = 0;
+        while (received < EVENT_COUNT) {
+            uint32_t from;
+            bool truncated;
+            int length = bridge.receive(buffer, sizeof(buffer), from, truncated);
+            if (length < 0) {
+                if (propDone.load() && bridge.receive(buffer, sizeof(buffer), from, truncated) < 0) {
+                    break; // Il dispositivo ha finito e la coda è vuota: eventi persi
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            datagrams++;
+            uint8_t version;
+            uint16_t handle;
+            uint32_t seq;
+            size_t pos = WireCodec::readHeader(buffer, length, &version, &handle, &seq);
+            if (pos == 0 || handle != WIRE_HANDLE) {
+                errors++;
+                continue;
+            }
+            while (pos < (size_t)length) {
+                size_t consumed = 0;
+                if (WireCodec::decodeMessage(buffer + pos, length - pos, &consumed, text, sizeof(text)) == 0) {
+                    errors++;
+                    break;
+                }
+                pos += consumed;
+                if (seq != expected || seq >= EVENT_COUNT) {
+                    errors++;
+                } else {
+                    latencyUs.push_back(std::chrono::duration<double, std::micro>(Clock::now() - queuedAt[seq]).count());
+                }
+                expected = seq + 1;
+                seq++;
+                received++;
+            }
+        }
+    });
+
+    // --- Dispositivo simulato ---
+    DatagramBatcher batcher;
+    uint32_t seq = 0;
+    while (seq < EVENT_COUNT) {
+        uint32_t tickStart = seq;
+        uint32_t tickEnd = std::min(EVENT_COUNT, seq + EVENTS_PER_TICK);
+        for (uint32_t s = tickStart; s < tickEnd; s++) {
+            queuedAt[s] = Clock::now();
+        }
+        batcher.reset(WIRE_HANDLE, prop.deviceId());
+        for (; seq < tickEnd; seq++) {
+            const char* event = TICK_EVENTS[seq % TICK_EVENT_COUNT];
+            if (!batcher.append(event, strlen(event), seq)) {
+                prop.send(bridge.localAddress(), PORT, batcher.data(), batcher.length());
+                batcher.reset(WIRE_HANDLE, prop.deviceId());
+                batcher.append(event, strlen(event), seq);
+            }
+        }
+        // Qui si misura il codec, non le perdite: se la coda del bridge è piena si
+        // ritenta. Il task di rete non lo sa (UDP) e il datagramma andrebbe perso.
+        while (!batcher.isEmpty()) {
+            uint32_t droppedBefore = bridge.getDroppedCount();
+            prop.send(bridge.localAddress(), PORT, batcher.data(), batcher.length());
+            if (bridge.getDroppedCount() == droppedBefore) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+    }
+    propDone.store(true);
+    bridgeThread.join();
+
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    std::sort(latencyUs.begin(), latencyUs.end());
+    auto percentile = [&](double p) {
+        return latencyUs.empty() ? 0.0 : latencyUs[(size_t)(p * (latencyUs.size() - 1))];
+    };
+
+    printf("Eventi: %u/%u ricevuti in %u datagrammi, %u errori\n", received, EVENT_COUNT, datagrams, errors);
+    printf("Throughput: %.0f eventi/s (%.1f eventi per datagramma)\n",
+           received / seconds, datagrams ? (double)received / datagrams : 0.0);
+    printf("Latenza accodamento -> decodifica: p50 %.1f us, p99 %.1f us, max %.1f us\n",
+           percentile(0.50), percentile(0.99), percentile(1.0));
+
+    return (received == EVENT_COUNT && errors == 0) ? 0 : 1;
+}
+
+/** @brief Una passata del dispositivo: fine tick del gioco, giro del task di rete, bridge. */
+static void networkTick(NetworkManager& network, SimBridge& bridge) {
+    network.update();
+    while (network.nextReceivedMessage() != nullptr) {
+    }
+    network.runNetworkRound();
+    bridge.update();
+    simBoard.advanceMs(NET_TICK_MS);
+}
+
+/** @brief Invia count eventi, EVENTS_PER_TICK per passata, numerati da *next in poi. */
+static void sendEvents(NetworkManager& network, SimBridge& bridge, uint32_t count, uint32_t* next) {
+    char event[64];
+    for (uint32_t i = 0; i < count; i++) {
+        snprintf(event, sizeof(event), "event:score_update;team1_score:%u;", (unsigned)(*next)++);
+        network.sendStatus(event);
+        if ((i + 1) % EVENTS_PER_TICK == 0) {
+            networkTick(network, bridge);
+        }
+    }
+    networkTick(network, bridge);
+}
+
+/**
+ * @brief Controlla gli eventi arrivati al bridge (registro SIM_NETWORK).
+ * @return Numero di errori; in *replayed gli eventi arrivati con "replay:1;".
+ */
+static uint32_t checkDelivery(uint32_t expected, uint32_t* replayed) {
+    uint32_t errors = 0;
+    uint32_t arrived = 0;
+    uint32_t firstSeq = 0;
+    *replayed = 0;
+    for (const SimLogEntry& entry : simBoard.getLog()) {
+        const char* text = entry.text.c_str();
+        if (entry.device != SIM_NETWORK || strncmp(text, "event:score_update;", 19) != 0) {
+            continue;
+        }
+        const char* seq = strstr(text, "seq:");
+        unsigned long score = strtoul(strstr(text, "team1_score:") + 12, nullptr, 10);
+        if (seq == nullptr) {
+            errors++;
+            continue;
+        }
+        if (arrived == 0) {
+            firstSeq = strtoul(seq + 4, nullptr, 10) - score;
+        }
+        // Una sequenza per evento, nell'ordine di invio: niente buchi, doppioni o scambi.
+        if (score != arrived || strtoul(seq + 4, nullptr, 10) != firstSeq + score) {
+            if (errors < 5) {
+                printf("FALLITO  evento %u fuori ordine: %s\n", (unsigned)arrived, text);
+            }
+            errors++;
+        }
+        if (strstr(text, "replay:1;") != nullptr) {
+            (*replayed)++;
+        }
+        arrived++;
+    }
+    if (arrived != expected) {
+        printf("FALLITO  %u eventi arrivati su %u\n", (unsigned)arrived, (unsigned)expected);
+        errors++;
+    }
+    return errors;
+}
+
+/** @brief Parte 2: NetworkManager su LoopbackTransport, con una caduta del collegamento. */
+static int runNetworkManagerBench() {
+    simBoard.reset();
+    simBoard.setLogMask(SIM_LOG_BIT(SIM_NETWORK));
+    LoopbackTransport device(LoopbackTransport::makeAddress(192, 168, 1, 50), "AA:BB:CC:DD:EE:FF");
+    SimBridge bridge(device);
+    NetworkManager network(&device);
+    network.initialize();
+
+    // Ricerca del server e raffica di sincronizzazione dell'orologio.
+    for (uint32_t t = 0; t < SETTLE_MS; t += NET_TICK_MS) {
+        networkTick(network, bridge);
+    }
+    uint32_t next = 0;
+    sendEvents(network, bridge, ONLINE_EVENTS, &next);
+
+    device.setLinkUp(false);
+    sendEvents(network, bridge, OFFLINE_EVENTS, &next);
+    for (uint32_t t = 0; t < SETTLE_MS; t += NET_TICK_MS) {
+        networkTick(network, bridge);
+    }
+    uint32_t replayed;
+    uint32_t beforeReturn = simBoard.getLog().size();
+    uint32_t errors = checkDelivery(ONLINE_EVENTS, &replayed);
+
+    // Al ritorno gli eventi nuovi seguono il diario, anche durante il reinvio.
+    device.setLinkUp(true);
+    sendEvents(network, bridge, RETURN_EVENTS, &next);
+    for (uint32_t t = 0; t < REPLAY_TIMEOUT_MS && simBoard.getLog().size() < beforeReturn + OFFLINE_EVENTS + RETURN_EVENTS;
+         t += NET_TICK_MS) {
+        networkTick(network, bridge);
+    }
+    errors += checkDelivery(next, &replayed);
+    if (replayed < OFFLINE_EVENTS) {
+        printf("FALLITO  solo %u eventi reinviati dal diario su %u\n", (unsigned)replayed, (unsigned)OFFLINE_EVENTS);
+        errors++;
+    }
+    if (network.getTxDroppedCount() != 0) {
+        printf("FALLITO  %u eventi scartati dalla coda di trasmissione\n", (unsigned)network.getTxDroppedCount());
+        errors++;
+    }
+    printf("NetworkManager: %u eventi (%u durante la caduta, %u reinviati dal diario), %u errori\n",
+           (unsigned)next, (unsigned)OFFLINE_EVENTS, (unsigned)replayed, (unsigned)errors);
+    return errors == 0 ? 0 : 1;
+}
+
+int main() {
+    int codec = runCodecBench();
+    int network = runNetworkManagerBench();
+    return (codec == 0 && network == 0) ? 0 : 1;
+}
@@ -0,0 +1,154 @@
+// bench/wire_codec/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Benchmark sull'host del codec binario: verifica di andata/ritorno e throughput.
+ * @details Esecuzione: pio run -e bench_wire && .pio/build/bench_wire/program
+ * Ogni messaggio del campione viene codificato e decodificato; il risultato deve
+ * coincidere con la forma canonica del testo (ogni campo chiuso da ';').
+ * Verifica anche l'impacchettamento di più eventi in un solo datagramma.
+ * Il programma termina con codice 1 se anche una sola verifica fallisce.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "Network/DatagramBatcher.h"
+#include "Network/WireCodec.h"
+
+// Campione rappresentativo dei messaggi generati dal firmware.
+static const char* const SAMPLES[] = {
+    "event:heartbeat;txq_hw:3;txq_drop:0;",
+    "event:device_online;status:ready;version:0.3.4;",
+    "event:mode_enter;mode:domination;",
+    "event:settings_update;duration:15;capture:10;countdown:10;",
+    "event:settings_update;bomb_time:10;arm_pin:1234;disarm_pin:0042;arm_time:5;defuse_time:10;use_arm_pin:1;use_disarm_pin:0;",
+    "event:game_start;mode:domination;duration:15",
+    "event:time_update;time:874;",
+    "event:score_update;team1_score:123456;team2_score:98765;",
+    "event:capture_progress;team:2;progress:57;",
+    "event:zone_captured;team:1;",
+    "event:game_end;winner:counter-terrorists;",
+    "event:countdown_update;time:-1;",
+};
+static const size_t SAMPLE_COUNT = sizeof(SAMPLES) / sizeof(SAMPLES[0]);
+
+/** @brief Forma canonica attesa dopo la decodifica. */
+static std::string canonical(const char* text) {
+    std::string s(text);
+    if (!s.empty() && s.back() != ';') {
+        s += ';';
+    }
+    return s;
+}
+
+int main() {
+    uint8_t frame[256];
+    char decoded[256];
+    int failures = 0;
+    size_t textBytes = 0;
+    size_t wireBytes = 0;
+
+    // --- Verifica di andata e ritorno ---
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        size_t header = WireCodec::writeHeader(7, (uint32_t)i, frame, sizeof(frame));
+        size_t body = WireCodec::encodeMessage(SAMPLES[i], strlen(SAMPLES[i]), frame + header, sizeof(frame) - header);
+        if (body == 0) {
+            printf("FALLITO  codifica: %s\n", SAMPLES[i]);
+            failures++;
+            continue;
+        }
+
+        uint8_t version = 0;
+        uint16_t handle = 0;
+        uint32_t seq = 0;
+        size_t consumed = 0;
+        size_t read = WireCodec::readHeader(frame, header + body, &version, &handle, &seq);
+        size_t length = WireCodec::decodeMessage(frame + read, header + body - read, &consumed, decoded, sizeof(decoded));
+        bool ok = read == header && version == WIRE_PROTOCOL_VERSION && handle == 7 && seq == i &&
+                  consumed == body && length > 0 && canonical(SAMPLES[i]) == decoded;
+        if (!ok) {
+            printf("FALLITO  andata/ritorno: %s -> %s\n", SAMPLES[i], decoded);
+            failures++;
+        }
+        // Testo effettivamente trasmesso: messaggio + "id:<MAC>;" (23 byte)
+        textBytes += strlen(SAMPLES[i]) + 23;
+        wireBytes += header + body;
+    }
+
+    // Un evento sconosciuto deve essere rifiutato (verrà inviato come testo).
+    const char* unknown = "event:not_a_real_event;team:1;";
+    if (WireCodec::encodeMessage(unknown, strlen(unknown), frame, sizeof(frame)) != 0) {
+        printf("FALLITO  evento sconosciuto accettato\n");
+        failures++;
+    }
+
+    // --- Impacchettamento: tutto il campione in un frame, sequenze consecutive ---
+    DatagramBatcher batcher;
+    batcher.reset(7, "AA:BB:CC:DD:EE:FF");
+    for (size_t i = 0; i < SAMPLE_COUNT; i++) {
+        if (!batcher.append(SAMPLES[i], strlen(SAMPLES[i]), 100 + i)) {
+            printf("FALLITO  impacchettamento: %s\n", SAMPLES[i]);
+            failures++;
+        }
+    }
+    {
+        uint8_t version = 0;
+        uint16_t handle = 0;
+        uint32_t seq = 0;
+        size_t pos = WireCodec::readHeader(batcher.data(), batcher.length(), &version, &handle, &seq);
+        size_t decodedCount = 0;
+        while (pos > 0 && pos < batcher.length()) {
+            size_t consumed = 0;
+            if (WireCodec::decodeMessage(batcher.data() + pos, batcher.length() - pos, &consumed, decoded, sizeof(decoded)) == 0 ||
+                canonical(SAMPLES[decodedCount]) != decoded) {
+                printf("FALLITO  frame multiplo, messaggio %zu\n", decodedCount);
+                failures++;
+                break;
+            }
+            pos += consumed;
+            decodedCount++;
+        }
+        if (seq != 100 || decodedCount != SAMPLE_COUNT) {
+            printf("FALLITO  frame multiplo: seq %u, %zu messaggi\n", (unsigned)seq, decodedCount);
+            failures++;
+        }
+        printf("Frame multiplo: %zu eventi in %zu byte\n", decodedCount, batcher.length());
+    }
+    // Sequenza non consecutiva: il frame corrente va chiuso.
+    if (batcher.append(SAMPLES[0], strlen(SAMPLES[0]), 500)) {
+        printf("FALLITO  sequenza non consecutiva accettata\n");
+        failures++;
+    }
+
+    printf("Andata/ritorno: %zu messaggi, %d errori\n", SAMPLE_COUNT, failures);
+    printf("Byte medi per messaggio: testo %.1f, binario %.1f (%.0f%%)\n",
+           (double)textBytes / SAMPLE_COUNT, (double)wireBytes / SAMPLE_COUNT,
+           100.0 * wireBytes / textBytes);
+
+    // --- Throughput ---
+    const int iterations = 200000;
+    size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        const char* text = SAMPLES[it % SAMPLE_COUNT];
+        sink += WireCodec::encodeMessage(text, strlen(text), frame, sizeof(frame));
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int it = 0; it < iterations; it++) {
+        const char* text = SAMPLES[it % SAMPLE_COUNT];
+        size_t body = WireCodec::encodeMessage(text, strlen(text), frame, sizeof(frame));
+        size_t consumed;
+        sink += WireCodec::decodeMessage(frame, body, &consumed, decoded, sizeof(decoded));
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double encodeNs = std::chrono::duration<double, std::nano>(mid - start).count() / iterations;
+    double roundTripNs = std::chrono::duration<double, std::nano>(end - mid).count() / iterations;
+    printf("Codifica: %.0f ns/messaggio (%.2f M msg/s)\n", encodeNs, 1000.0 / encodeNs);
+    printf("Codifica+decodifica: %.0f ns/messaggio (%.2f M msg/s)\n", roundTripNs, 1000.0 / roundTripNs);
+    printf("(checksum %zu)\n", sink);
+
+    return failures == 0 ? 0 : 1;
+}
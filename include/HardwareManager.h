@@ -22,12 +22,20 @@
 #include <Adafruit_SSD1306.h> // Schermi OLED
 #include <PN532_I2C.h>
 #include <PN532.h>
+#include "EffectTimeline.h"
+
+#define LCD_SHADOW_COLS 20          // Dimensioni della copia in memoria dell'LCD (almeno quelle del display)
+#define LCD_SHADOW_ROWS 4
+#define LCD_CUSTOM_CHAR_COUNT 8     // Caratteri personalizzati dell'HD44780 (CGRAM)
 
 /**
  * @class HardwareManager
  * @brief Gestisce tutte le interazioni con i componenti hardware fisici.
  * @details Un unico oggetto di questa classe viene creato nel main.cpp per garantire
  * che ci sia un solo "padrone" dell'hardware, evitando conflitti.
+ * I metodi non sono protetti da lock: vanno chiamati solo dal task di gioco
+ * (setup()/loop(), core 1), mai dal task di rete. Il bus I2C, la striscia LED
+ * e il buzzer sono usati solo da quel task.
  */
 class HardwareManager {
 public:
@@ -43,17 +51,28 @@ public:
     // --- Funzioni di Output (Display, LED, Suoni) ---
 
     // Funzioni LCD
+    // Le funzioni di scrittura cambiano solo la copia in memoria dello schermo:
+    // all'LCD arriva flushLcd(), con le sole celle cambiate.
     /** @brief Stampa del testo sull'LCD a coordinate specifiche. */
     void printLcd(int col, int row, const String& text);
     /** @brief Pulisce completamente lo schermo LCD. */
     void clearLcd();
+    /**
+     * @brief Invia all'LCD le celle cambiate dall'ultimo invio.
+     * @details Le celle cambiate adiacenti sulla stessa riga partono con un solo
+     * spostamento del cursore. Ridisegnare uno schermo uguale non scrive nulla e
+     * un clearLcd() seguito dal nuovo testo non fa sfarfallare il display.
+     * Chiamata dal loop() dopo la logica di modalità; chi blocca il loop()
+     * (attese, download) la chiama prima, perché il messaggio sia visibile.
+     */
+    void flushLcd();
     /** @brief Ritorna il numero di righe dell'LCD */
     int getLcdRows();
     /** @brief Ritorna il numero di colonne dell'LCD */
     int getLcdCols();
     /** @brief Crea i caratteri personalizzati per la barra di avanzamento sull'LCD. */
     void createProgressBarChars();
-    /** @brief Stampa uno dei caratteri personalizzati sull'LCD. */
+    /** @brief Stampa uno dei caratteri personalizzati sull'LCD, dopo l'ultimo testo stampato. */
     void writeCustomChar(uint8_t charIndex);
 
     // Funzioni schermi OLED
@@ -101,8 +120,12 @@ public:
     void setBrightness(uint8_t brightness);
     /** @brief Ritorna il numero di LED nella striscia. */
     int getStripLedCount();
-    /** @brief Esegue un flash a massima luminosità del colore attuale. Usato per eventi di gioco. */
+    /** @brief Accoda un flash a massima luminosità del colore attuale (non bloccante). Usato per eventi di gioco. */
     void flashCurrentColor(int count, int duration);
+    /** @brief Salva colori e luminosità della striscia, per restoreStrip(). */
+    void saveStrip();
+    /** @brief Ripristina e mostra colori e luminosità salvati da saveStrip(). */
+    void restoreStrip();
     /** @brief Esegue un'animazione "a onda". Usata a fine partita. */
     void updateWinnerWaveEffect(uint8_t r, uint8_t g, uint8_t b, float base_brightness, float peak_brightness, int wave_width);
 
@@ -111,7 +134,11 @@ public:
     DateTime getRTCTime();
 
     // Funzioni Buzzer
-    /** @brief Riproduce un suono semplice per una data durata. Usato per i feedback dei menu. */
+    /**
+     * @brief Riproduce un suono semplice per una data durata. Usato per i feedback dei menu.
+     * @details Non bloccante: il silenzio arriva da updateEffects() dopo 'duration' ms.
+     * Con duration 0 il suono resta acceso fino a noTone(). Per più note in fila usare effects().
+     */
     void playTone(unsigned int frequency, unsigned long duration);
     /** @brief Ferma qualsiasi suono. */
     void noTone();
@@ -126,9 +153,22 @@ public:
     /** @brief Ritorna 'true' se una melodia è in esecuzione. */
     bool isMidiTunePlaying();
 
+    // Funzioni Effetti
+    /** @brief Timeline degli effetti temporizzati (suoni, LED, messaggi) delle modalità. */
+    EffectTimeline& effects();
+    /** @brief Fa avanzare la timeline degli effetti e chiude i suoni a tempo. Da chiamare nel loop(). */
+    void updateEffects();
+
     // Funzione RFID
     String readRFID(uint16_t timeout = 1000);
 
+    /**
+     * @brief Imposta la funzione chiamata dopo ogni scrittura I2C lenta (LCD e OLED).
+     * @details Un aggiornamento completo dei display dura decine di millisecondi:
+     * il loop() vi aggancia lo Scheduler perché gli ingressi continuino a essere letti.
+     */
+    void setBusWaitHook(void (*hook)(void*), void* context);
+
 private:
 
     // Oggetti che rappresentano i componenti hardware fisici.
@@ -165,6 +205,33 @@ private:
     bool _isMidiNotePlaying;
 
     int _lcdRows, _lcdCols;
+
+    // Copia in memoria dell'LCD: _lcdShadow è lo schermo voluto, _lcdSent quello
+    // già inviato. Le celle contengono i codici dei caratteri (0-7 personalizzati).
+    uint8_t _lcdShadow[LCD_SHADOW_ROWS][LCD_SHADOW_COLS];
+    uint8_t _lcdSent[LCD_SHADOW_ROWS][LCD_SHADOW_COLS];
+    int _lcdCursorCol, _lcdCursorRow;       // Dove scrive il prossimo carattere della copia
+    int _lcdSentCol, _lcdSentRow;           // Cursore dell'LCD, -1 se non noto
+    bool _lcdDirty;                         // Copia cambiata dall'ultimo flushLcd()
+    uint8_t _lcdGlyphs[LCD_CUSTOM_CHAR_COUNT][8];
+    uint8_t _lcdGlyphsLoaded;               // Un bit per carattere personalizzato caricato
+
+    /** @brief Scrive un carattere nella copia al cursore e lo fa avanzare come l'HD44780. */
+    void putLcdChar(uint8_t ch);
+    /** @brief Carica un carattere personalizzato, se diverso da quello già nell'LCD. */
+    void loadCustomChar(uint8_t location, const uint8_t charmap[8]);
+
+    EffectTimeline _effects;
+    bool _toneTimed;                // Un playTone() a tempo è in corso
+    unsigned long _toneStartTime;
+    unsigned long _toneDuration;
+    uint32_t* _savedPixels;         // Colori salvati da saveStrip()
+    uint8_t _savedBrightness;
+
+    /** @brief Chiama la funzione impostata con setBusWaitHook(), se presente. */
+    void busWait();
+    void (*_busWaitHook)(void*);
+    void* _busWaitContext;
 };
 
 #endif // HARDWARE_MANAGER_H
\ No newline at end of file
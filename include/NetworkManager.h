@@ -3,18 +3,83 @@
 /**
  * @file NetworkManager.h
  * @brief Dichiarazione della classe NetworkManager per la gestione della connettività WiFi e della comunicazione UDP.
- * @details Questa classe astrae tutta la logica di rete. Si occupa di connettere
- * l'ESP32 a una rete WiFi e fornisce metodi semplici per inviare e ricevere
- * messaggi di stato tramite il protocollo UDP Broadcast.
+ * @details Questa classe astrae tutta la logica di rete. Fornisce metodi semplici
+ * per inviare e ricevere messaggi di stato; il mezzo fisico (WiFi + UDP sul
+ * dispositivo) è un Transport passato al costruttore.
+ *
+ * Modello dei task:
+ * - task di gioco (loop() di Arduino, core GAME_TASK_CORE): logica delle modalità
+ *   e tutto l'I/O di HardwareManager. Chiama i metodi pubblici di NetworkManager.
+ * - task di rete (core NETWORK_TASK_CORE, con lo stack WiFi): l'unico che usa il
+ *   Transport. Riceve i datagrammi, trasmette gli eventi, gestisce collegamento,
+ *   ricerca del server, DNS e diario in flash.
+ * I due task comunicano solo tramite le code SpscRing (_txQueue verso la rete,
+ * _rxQueue verso il gioco) e alcuni valori std::atomic; ogni altro campo ha un
+ * solo proprietario, indicato accanto alla dichiarazione. NetworkManager non
+ * conosce HardwareManager: il task di rete non può toccare display, LED o buzzer.
  */
 
 #ifndef NETWORK_MANAGER_H
 #define NETWORK_MANAGER_H
 
 #include <Arduino.h>
-#include <WiFi.h>
-#include <WiFiUdp.h>
-#include "HardwareManager.h"
+#include <IPAddress.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include "EventBus.h"
+#include "Network/ClockSync.h"
+#include "Network/DatagramBatcher.h"
+#include "Network/EventJournal.h"
+#include "Network/ServerDiscovery.h"
+#include "Network/SpscRing.h"
+#include "Network/TelemetryPublisher.h"
+#include "Network/Transport.h"
+#include "Network/WireCodec.h"
+#include <atomic>
+
+/** @brief Lunghezza massima (terminatore incluso) di un evento in coda di trasmissione. */
+#define OUTBOUND_EVENT_MAX_LEN 224
+/** @brief Numero di slot della coda di trasmissione (potenza di 2). */
+#define OUTBOUND_QUEUE_SIZE 32
+/** @brief Dimensione di uno slot di ricezione (terminatore incluso). */
+#define INBOUND_PACKET_MAX_LEN 256
+/** @brief Numero di slot della coda di ricezione (potenza di 2). */
+#define INBOUND_QUEUE_SIZE 8
+/** @brief Numero di ID comando recenti ricordati per scartare le ritrasmissioni. */
+#define COMMAND_ID_HISTORY 16
+/** @brief Lunghezza massima (terminatore incluso) del nome di un timer di gioco. */
+#define TIMER_ANCHOR_NAME_LEN 16
+/** @brief Core del task di rete, lo stesso dello stack WiFi. */
+#define NETWORK_TASK_CORE 0
+/** @brief Core del task di gioco: il loop() di Arduino vi è già vincolato. */
+#define GAME_TASK_CORE 1
+
+/**
+ * @struct OutboundEvent
+ * @brief Evento in attesa di trasmissione, copiato per valore nella coda.
+ */
+struct OutboundEvent {
+    uint32_t seq;       // Numero di sequenza assegnato all'accodamento
+    uint32_t queuedAt;  // millis() all'accodamento, convertito in tempo server all'invio
+    uint16_t length;
+    char data[OUTBOUND_EVENT_MAX_LEN];
+};
+
+/**
+ * @struct InboundPacket
+ * @brief Comando ricevuto in attesa di essere letto dal loop di gioco.
+ */
+struct InboundPacket {
+    uint32_t receivedAt;    // millis() alla ricezione (t3 della sincronizzazione)
+    uint16_t length;
+    char data[INBOUND_PACKET_MAX_LEN];
+};
+
+/**
+ * @brief Decide se un comando affidabile può essere confermato (vedi NetworkManager::setCommandFilter()).
+ * @return false per lasciarlo senza conferma: il bridge lo ritrasmetterà.
+ */
+typedef bool (*CommandFilter)(const char* command, void* context);
 
 /**
  * @class NetworkManager
@@ -27,46 +92,294 @@ class NetworkManager {
 public:
     /**
      * @brief Costruttore. Inizializza i parametri di rete di base.
+     * @param transport Canale a datagrammi da usare (UdpTransport sul dispositivo).
      */
-    NetworkManager();
+    NetworkManager(Transport* transport);
     /**
-     * @brief Inizializza la connessione WiFi e il servizio UDP.
-     * @details Tenta di connettersi alla rete WiFi specificata. Se ha successo,
-     * configura e avvia un listener UDP sulla porta predefinita. Questa funzione
-     * è bloccante finché la connessione WiFi non viene stabilita.
+     * @brief Avvia il WiFi, il listener UDP e il task di rete.
+     * @details Non attende la connessione: scansione, connessione alle reti
+     * conosciute e riconnessione dopo una caduta avvengono in background nel
+     * task di rete. Il loop di gioco è informato tramite wasLinkUp()/wasLinkDown().
      * Va chiamata una sola volta nel setup().
      */
-    void initialize(HardwareManager* hardware);
+    void initialize();
     /**
-     * @brief Aggiorna lo stato del listener di rete.
-     * @details Da chiamare ad ogni ciclo del loop() principale. Controlla se sono
-     * arrivati nuovi pacchetti UDP sulla rete e in futuro gestirà la loro
-     * elaborazione.
+     * @brief Fine del tick di rete del loop di gioco.
+     * @details Da chiamare ad ogni ciclo del loop() principale. Quando è trascorso
+     * il periodo accoda gli ultimi valori di telemetria e ripete l'ancora del timer.
+     * Infine sveglia il task di rete se ci sono eventi in coda: quelli accodati
+     * nello stesso tick partono insieme.
      */
     void update();
     /**
-     * @brief Invia un messaggio di stato in broadcast sulla rete.
+     * @brief Un giro del task di rete: collegamento, ricezione, ricerca del server e trasmissione.
+     * @details Solo dal task di rete. Sull'host, dove non ci sono task FreeRTOS
+     * (sim/, bench/), il chiamante la invoca al posto del task a ogni passata.
+     */
+    void runNetworkRound();
+    /**
+     * @brief Accoda un messaggio di stato (evento discreto) per l'invio al server.
      * @param status Una stringa di caratteri (C-style string) contenente il messaggio da inviare.
-     * @details Il messaggio viene inviato a tutti i dispositivi sulla stessa rete locale
-     * che sono in ascolto sulla porta UDP corretta.
+     * @details Il messaggio viene copiato nella coda di trasmissione e la funzione
+     * ritorna subito: la trasmissione vera e propria avviene nel task di rete sul
+     * core 0, che al successivo update() invia insieme tutti gli eventi del tick.
+     * Se la coda è piena l'evento viene scartato e conteggiato.
+     * Senza collegamento gli eventi passano nel diario persistente (EventJournal)
+     * e vengono reinviati, con il campo "replay:1;", quando il collegamento torna.
+     * Quando l'orologio è sincronizzato col server l'evento riceve il campo
+     * "ts:" (tempo server all'accodamento, vedi ClockSync).
+     * La telemetria in attesa viene accodata prima dell'evento, così l'ordine
+     * rispetto ai valori continui è preservato.
      */
     void sendStatus(const char* status);
+    /**
+     * @brief Pubblica un valore continuo (punteggio, tempo, avanzamento).
+     * @details Sostituisce il valore precedente della stessa chiave; solo l'ultimo
+     * viene inviato, alla frequenza impostata con setTelemetryRate().
+     */
+    void publishTelemetry(TelemetryKey key, const char* status);
+    /** @brief Imposta la frequenza massima di invio della telemetria (Hz). */
+    void setTelemetryRate(uint16_t hz);
+    /**
+     * @brief Invia un evento del bus di gioco nel formato del pannello (vedi EventEncoder).
+     * @details Avanzamenti e punteggi passano per la telemetria, gli altri per sendStatus().
+     * Va iscritta all'EventBus nel setup().
+     */
+    void sendGameEvent(const GameEvent& event);
+    /**
+     * @brief Pubblica l'ancora di un timer di gioco: "termina all'istante T" in tempo server.
+     * @details Sostituisce gli aggiornamenti al secondo del tempo rimanente: il
+     * pannello calcola da sé il conto alla rovescia. Va chiamata solo quando la
+     * scadenza cambia (avvio, pausa, ripresa). Finché il timer è attivo l'ancora
+     * viene ripetuta di rado, così un datagramma perso non lascia il pannello senza timer.
+     * @param timer Nome del timer ("game", "bomb", "countdown").
+     * @param remainingMs Tempo rimanente in millisecondi.
+     * @param running false se il timer è fermo (il pannello mostra remainingMs).
+     */
+    void publishTimerAnchor(const char* timer, uint32_t remainingMs, bool running = true);
+    /** @brief Il timer non è più attivo (partita finita o abbandonata): smette di ripetere l'ancora. */
+    void clearTimerAnchor() { _anchorActive = false; }
 
-    String getReceivedMessage();
+    /**
+     * @brief Ritorna il prossimo comando ricevuto, oppure nullptr se non ce ne sono.
+     * @details Il puntatore fa riferimento direttamente allo slot della coda di
+     * ricezione e resta valido fino alla chiamata successiva: chi deve
+     * conservarlo più a lungo ne faccia una copia.
+     * Le risposte di sincronizzazione dell'orologio passano dalla stessa coda e
+     * vengono consumate qui, perché ClockSync appartiene al task di gioco.
+     * I comandi affidabili arrivano dal bridge come "CID:n;CMD:...": il prefisso
+     * viene confermato con "event:ack;cid:n;" e rimosso, quindi qui si riceve il
+     * comando originale una sola volta anche se è stato ritrasmesso.
+     */
+    const char* nextReceivedMessage();
+    /**
+     * @brief Filtro chiamato da nextReceivedMessage() prima di confermare un comando "CID:n;".
+     * @details Un comando rifiutato non viene né confermato né ricordato tra gli ID
+     * recenti: la ritrasmissione del bridge lo ripresenta più tardi. Le
+     * ritrasmissioni di un comando già consegnato sono confermate senza filtro.
+     * @param filter nullptr (predefinito) per confermare tutti i comandi.
+     */
+    void setCommandFilter(CommandFilter filter, void* context);
+
+    /** @brief Ritorna true se il collegamento WiFi è attivo. */
+    bool isConnected() const { return _connected.load(); }
+    /**
+     * @brief Ritorna true una sola volta dopo che il collegamento è diventato attivo.
+     * @note Rappresenta l'EVENTO, come Button::wasPressed().
+     */
+    bool wasLinkUp() { return _linkUpEvent.exchange(false); }
+    /** @brief Ritorna true una sola volta dopo che il collegamento è caduto. */
+    bool wasLinkDown() { return _linkDownEvent.exchange(false); }
+
+    /**
+     * @brief Orologio sincronizzato con il server tramite lo scambio "time_sync".
+     * @details Va letto solo dal loop di gioco (è aggiornato da nextReceivedMessage()).
+     */
+    const ClockSync& getClock() const { return _clock; }
+
+    /** @brief Ritorna true se il bridge ha concordato il protocollo binario. */
+    bool isBinaryWireActive() const { return _wireHandle.load() != 0; }
+
+    /** @brief Massimo numero di eventi rimasti contemporaneamente in coda dall'avvio. */
+    uint32_t getTxQueueHighWater() const { return _txHighWater; }
+    /** @brief Numero di eventi scartati perché la coda di trasmissione era piena. */
+    uint32_t getTxDroppedCount() const { return _txDropped; }
+    /** @brief Numero di comandi scartati perché la coda di ricezione era piena. */
+    uint32_t getRxOverflowCount() const { return _rxOverflow.load(); }
+    /** @brief Numero di comandi scartati perché più lunghi di uno slot. */
+    uint32_t getRxTruncatedCount() const { return _rxTruncated.load(); }
 
 private:
-    // Credenziali per la rete WiFi.
-    const char* _ssid;
-    const char* _password;
-    // Oggetto per la gestione del protocollo UDP.
-    WiFiUDP _udp;
+    /**
+     * @brief Risolve SERVER_HOSTNAME e aggiorna la cache. Chiamata bloccante.
+     * @details Usata solo in fase di connessione e dal task di rete,
+     * mai dal percorso di gioco.
+     * @return true se la risoluzione è andata a buon fine.
+     */
+    bool resolveServerAddress();
+    /** @brief Ricerca in LAN conclusa: adotta il bridge trovato o risolve il nome DDNS. Solo task di rete. */
+    void onDiscoveryFinished();
+    /**
+     * @brief Ritorna l'indirizzo a cui inviare i messaggi: il server in cache o, in mancanza, il broadcast.
+     */
+    IPAddress getDestinationAddress();
+    /** @brief Copia un messaggio nella coda di trasmissione assegnandogli il numero di sequenza. */
+    void enqueue(const char* status);
+    /** @brief Accoda tutti i valori di telemetria in attesa. */
+    void flushTelemetry();
+    /** @brief Accoda l'ancora del timer attivo, ricalcolata sull'istante corrente. */
+    void sendTimerAnchor();
+    /**
+     * @brief Gestisce la negoziazione del protocollo ("CMD:WIRE;VER:n;HANDLE:h;").
+     * @return true se il pacchetto era un comando di negoziazione (già consumato).
+     */
+    bool handleWireCommand(const char* packet);
+    /**
+     * @brief Conferma un comando con ID ("CID:n;...") e ne rimuove il prefisso.
+     * @return Il comando senza prefisso, oppure nullptr se è una ritrasmissione
+     * di un comando già consegnato (la conferma viene comunque ripetuta) o se il
+     * filtro lo ha rifiutato (nessuna conferma).
+     */
+    const char* acknowledgeCommand(const char* packet);
+    /**
+     * @brief Gestisce la risposta del bridge a una richiesta di sincronizzazione
+     * ("CMD:TIME_SYNC;T0:..;T1:..;T2:..;").
+     * @param receivedAt millis() alla ricezione del pacchetto (t3).
+     * @return true se il pacchetto era una risposta di sincronizzazione (già consumata).
+     */
+    bool handleTimeSync(const char* packet, uint32_t receivedAt);
+    /**
+     * @brief Invia subito una richiesta di sincronizzazione, fuori dalla coda eventi
+     * perché t0 sia l'istante effettivo di invio. Solo task di rete.
+     */
+    void sendTimeSyncRequest();
+    /**
+     * @brief Legge nella coda di ricezione tutti i pacchetti in attesa sul socket. Solo task di rete.
+     * @details Le risposte della ricerca e la negoziazione del protocollo si
+     * consumano qui; il resto passa al task di gioco.
+     */
+    void drainSocket();
+    /**
+     * @brief Svuota la coda impacchettando gli eventi nel minor numero di datagrammi.
+     * @details Eseguita solo dal task di rete. Gli eventi codificabili vanno in frame
+     * binari se il protocollo è negoziato, gli altri in datagrammi testuali.
+     * Un evento lascia la coda solo dopo l'invio del suo datagramma; se l'invio
+     * non riesce la coda passa nel diario (journalQueue()).
+     */
+    void drainQueue();
+    /**
+     * @brief Invia il datagramma corrente del batcher. Eseguita solo dal task di rete.
+     * @return false se il datagramma non è partito (nessuna destinazione o invio fallito).
+     */
+    bool sendDatagram();
+    /**
+     * @brief Converte un istante locale (millis()) in tempo server con l'ultimo scarto noto.
+     * @return false se l'orologio non è ancora sincronizzato.
+     */
+    bool toServerTime(uint32_t localMs, uint32_t& serverMs) const;
+    /**
+     * @brief Prepara il testo da trasmettere: l'evento seguito da "ts:" e, per i reinvii, "replay:1;".
+     * @param out Buffer di almeno OUTBOUND_EVENT_MAX_LEN + 32 byte.
+     * @return Lunghezza del testo in out.
+     */
+    size_t formatEvent(char* out, size_t size, const char* data, uint16_t length,
+                       bool hasTime, uint32_t serverMs, bool replay) const;
+    /**
+     * @brief Sposta la coda di trasmissione nel diario (collegamento assente o reinvio in corso). Solo task di rete.
+     * @details Al più una volta ogni JOURNAL_WRITE_INTERVAL_MS, o prima se la coda è
+     * piena a metà: ogni scrittura in flash ferma anche il task di gioco.
+     */
+    void journalQueue();
+    /** @brief Reinvia dal diario un datagramma di eventi, rimuovendoli se l'invio riesce. Solo task di rete. */
+    void replayJournal();
+    /** @brief Collegamento attivo: aggiorna il broadcast, avvia la ricerca del server e segnala l'evento. Solo task di rete. */
+    void onLinkUp();
+    /** @brief Collegamento caduto: segnala l'evento. Solo task di rete. */
+    void onLinkDown();
+    /**
+     * @brief Corpo del task FreeRTOS che gestisce il WiFi, svuota la coda di trasmissione e rinnova la cache DNS.
+     */
+    static void networkTask(void* param);
+
+    // Canale a datagrammi: usato solo dal task di rete (dopo initialize()).
+    Transport* _transport;
     // Porta UDP su cui il dispositivo invia e riceve i dati.
     const int _udpPort;
     // Indirizzo IP di broadcast calcolato dopo la connessione.
     IPAddress _broadcastIP;
 
-    IPAddress _lastSenderIP;
-    String _lastMessage;
+    // Cache dell'indirizzo del server (0.0.0.0 = non ancora risolto). Usata solo dal task di rete.
+    IPAddress _serverIP;
+    // Ricerca del bridge in LAN (usata solo dal task di rete).
+    ServerDiscovery _discovery;
+    // Il prossimo rinnovo dell'indirizzo del server è dovuto dopo questo istante (millis()).
+    unsigned long _nextResolveTime;
+    // false finché non è partito il primo datagramma dall'avvio (per misurarne il tempo).
+    bool _firstDatagramSent;
+
+    // Coda eventi in uscita: il loop di gioco produce, il task di rete consuma.
+    SpscRing<OutboundEvent, OUTBOUND_QUEUE_SIZE> _txQueue;
+    // Statistiche della coda, aggiornate solo dal produttore.
+    uint32_t _txHighWater;
+    uint32_t _txDropped;
+    // Prossimo numero di sequenza da assegnare (solo produttore).
+    uint32_t _nextSeq;
+    // Datagramma in costruzione (usato solo dal task di rete).
+    DatagramBatcher _batcher;
+    // Diario degli eventi non inviati, prossimo reinvio e prossima scrittura della
+    // coda (usati solo dal task di rete dopo initialize()).
+    EventJournal _journal;
+    unsigned long _nextReplayTime;
+    unsigned long _nextJournalTime;
+    // Handle numerico assegnato dal bridge: 0 = protocollo testuale.
+    // Scritto dal task di rete alla ricezione di CMD:WIRE, letto anche da isBinaryWireActive().
+    std::atomic<uint16_t> _wireHandle;
+
+    // Ultimi valori continui in attesa di invio (usato solo dal loop di gioco).
+    TelemetryPublisher _telemetry;
+
+    // Ancora del timer di gioco (usata solo dal loop di gioco).
+    char _anchorTimer[TIMER_ANCHOR_NAME_LEN];
+    uint32_t _anchorDeadline;       // millis() di fine, se il timer scorre
+    uint32_t _anchorRemaining;      // Tempo rimanente, se il timer è fermo
+    bool _anchorRunning;
+    bool _anchorActive;
+    unsigned long _nextAnchorTime;  // Prossima ripetizione dell'ancora
+
+    // Handle del task di rete (nullptr finché la connessione non è attiva).
+    TaskHandle_t _networkTaskHandle;
+
+    // ID degli ultimi comandi consegnati, per scartare i duplicati (0 = slot libero).
+    // Usati solo dal loop di gioco, che conferma i comandi accodando l'ack.
+    uint32_t _recentCommandIds[COMMAND_ID_HISTORY];
+    uint8_t _recentCommandIndex;
+    // Filtro dei comandi prima della conferma (usato solo dal loop di gioco).
+    CommandFilter _commandFilter;
+    void* _commandFilterContext;
+
+    // Coda dei pacchetti ricevuti: il task di rete produce, il loop di gioco consuma
+    // con nextReceivedMessage().
+    SpscRing<InboundPacket, INBOUND_QUEUE_SIZE> _rxQueue;
+    // true se lo slot in testa è stato consegnato e va liberato alla prossima lettura (solo consumatore).
+    bool _rxHeld;
+    // Statistiche della ricezione, aggiornate solo dal task di rete.
+    std::atomic<uint32_t> _rxOverflow;
+    std::atomic<uint32_t> _rxTruncated;
+
+    // Stima dello scarto dall'orologio del server (usato solo dal loop di gioco).
+    ClockSync _clock;
+    // Prossima richiesta di sincronizzazione e richieste rimaste della raffica
+    // iniziale (usati solo dal task di rete).
+    unsigned long _nextTimeSyncTime;
+    uint8_t _timeSyncBurst;
+    // Copia dello scarto di _clock per il task di rete, che marca gli eventi all'invio.
+    std::atomic<uint32_t> _serverOffset;
+    std::atomic<bool> _serverOffsetValid;
+
+    // Stato del collegamento: scritto dal task di rete, letto dal loop di gioco.
+    std::atomic<bool> _connected;
+    std::atomic<bool> _linkUpEvent;
+    std::atomic<bool> _linkDownEvent;
 };
 
 #endif // NETWORK_MANAGER_H
\ No newline at end of file
@@ -0,0 +1,309 @@
+// sim/SimArduino.cpp
+
+/**
+ * @file SimArduino.cpp
+ * @brief Nucleo di Arduino per la simulazione sull'host: tempo, pin, LEDC, String e Serial.
+ */
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include "SimBoard.h"
+
+HardwareSerial Serial;
+
+// --- Tempo ---
+
+unsigned long millis() { return simBoard.millis(); }
+unsigned long micros() { return simBoard.micros(); }
+void delay(unsigned long ms) { simBoard.advanceMs(ms); }
+void delayMicroseconds(unsigned int us) { simBoard.advanceUs(us); }
+
+// --- Pin ---
+
+void pinMode(uint8_t pin, uint8_t mode) { (void)pin; (void)mode; }
+int digitalRead(uint8_t pin) { return simBoard.readPin(pin); }
+void digitalWrite(uint8_t pin, uint8_t level) { simBoard.setPin(pin, level); }
+int analogRead(uint8_t pin) { return simBoard.readAnalog(pin); }
+
+long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// --- LEDC: un solo canale, quello del buzzer ---
+
+double ledcSetup(uint8_t channel, double frequency, uint8_t resolution) {
+    (void)channel; (void)resolution;
+    return frequency;
+}
+void ledcAttachPin(uint8_t pin, uint8_t channel) { (void)pin; (void)channel; }
+void ledcWrite(uint8_t channel, uint32_t duty) {
+    (void)channel;
+    if (duty == 0) {
+        simBoard.buzzer(0);
+    }
+}
+double ledcWriteTone(uint8_t channel, double frequency) {
+    (void)channel;
+    simBoard.buzzer((uint32_t)frequency);
+    return frequency;
+}
+
+// --- String ---
+
+#define STRING_INIT _buffer(_sso), _length(0), _capacity(SIM_STRING_SSO_LEN)
+
+String::String(const char* text) : STRING_INIT {
+    _sso[0] = '\0';
+    if (text != nullptr) {
+        assign(text, strlen(text));
+    }
+}
+
+String::String(const String& other) : STRING_INIT {
+    assign(other._buffer, other._length);
+}
+
+String::String(String&& other) noexcept : STRING_INIT {
+    takeFrom(other);
+}
+
+String::String(char c) : STRING_INIT {
+    assign(&c, 1);
+}
+
+static String formatInteger(unsigned long value, bool negative, unsigned char base) {
+    char text[34];
+    char* p = text + sizeof(text) - 1;
+    *p = '\0';
+    if (base < 2) {
+        base = 10;
+    }
+    do {
+        unsigned digit = value % base;
+        *--p = (char)(digit < 10 ? '0' + digit : 'a' + digit - 10);
+        value /= base;
+    } while (value > 0);
+    if (negative) {
+        *--p = '-';
+    }
+    return String(p);
+}
+
+String::String(unsigned char value, unsigned char base) : String(formatInteger(value, false, base)) {}
+String::String(int value, unsigned char base) : String((long)value, base) {}
+String::String(unsigned int value, unsigned char base) : String(formatInteger(value, false, base)) {}
+String::String(long value, unsigned char base) :
+    String(base == 10 && value < 0 ? formatInteger(0UL - (unsigned long)value, true, base)
+                                   : formatInteger((unsigned long)value, false, base)) {}
+String::String(unsigned long value, unsigned char base) : String(formatInteger(value, false, base)) {}
+
+String::String(double value, unsigned int decimals) : STRING_INIT {
+    char text[40];
+    snprintf(text, sizeof(text), "%.*f", (int)decimals, value);
+    assign(text, strlen(text));
+}
+
+String::~String() {
+    if (isHeap()) {
+        delete[] _buffer;
+    }
+}
+
+String& String::operator=(const String& other) {
+    if (this != &other) {
+        assign(other._buffer, other._length);
+    }
+    return *this;
+}
+
+String& String::operator=(String&& other) noexcept {
+    if (this != &other) {
+        if (isHeap()) {
+            delete[] _buffer;
+        }
+        takeFrom(other);
+    }
+    return *this;
+}
+
+String& String::operator=(const char* text) {
+    assign(text != nullptr ? text : "", text != nullptr ? strlen(text) : 0);
+    return *this;
+}
+
+// Spostamento: il buffer sull'heap passa di mano, un testo corto si copia.
+void String::takeFrom(String& other) {
+    if (other.isHeap()) {
+        _buffer = other._buffer;
+        _capacity = other._capacity;
+    } else {
+        _buffer = _sso;
+        _capacity = SIM_STRING_SSO_LEN;
+        memcpy(_sso, other._sso, other._length + 1);
+    }
+    _length = other._length;
+    other._buffer = other._sso;
+    other._capacity = SIM_STRING_SSO_LEN;
+    other._length = 0;
+    other._sso[0] = '\0';
+}
+
+// Come WString: il buffer cresce solo quando serve e alla misura richiesta.
+bool String::reserve(unsigned int size) {
+    if (size <= _capacity) {
+        return true;
+    }
+    char* buffer = new char[size + 1];
+    memcpy(buffer, _buffer, _length + 1);
+    if (isHeap()) {
+        delete[] _buffer;
+    }
+    _buffer = buffer;
+    _capacity = size;
+    return true;
+}
+
+void String::assign(const char* text, size_t length) {
+    reserve((unsigned int)length);
+    memmove(_buffer, text, length);
+    _buffer[length] = '\0';
+    _length = (unsigned int)length;
+}
+
+String& String::concat(const char* text, size_t length) {
+    if (length == 0) {
+        return *this;
+    }
+    if (text >= _buffer && text < _buffer + _length) {
+        String copy(*this);     // Testo preso da se stessa: il buffer potrebbe spostarsi
+        return concat(copy._buffer + (text - _buffer), length);
+    }
+    reserve(_length + (unsigned int)length);
+    memcpy(_buffer + _length, text, length);
+    _length += (unsigned int)length;
+    _buffer[_length] = '\0';
+    return *this;
+}
+
+int String::indexOf(char c, unsigned int from) const {
+    if (from >= _length) {
+        return -1;
+    }
+    const char* found = strchr(_buffer + from, c);
+    return found != nullptr ? (int)(found - _buffer) : -1;
+}
+
+int String::indexOf(const char* text, unsigned int from) const {
+    if (from >= _length) {
+        return -1;
+    }
+    const char* found = strstr(_buffer + from, text);
+    return found != nullptr ? (int)(found - _buffer) : -1;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (to > _length) {
+        to = _length;
+    }
+    if (from >= to) {
+        return String();
+    }
+    String result;
+    result.assign(_buffer + from, to - from);
+    return result;
+}
+
+void String::remove(unsigned int index, unsigned int count) {
+    if (index >= _length) {
+        return;
+    }
+    if (count > _length - index) {
+        count = _length - index;
+    }
+    memmove(_buffer + index, _buffer + index + count, _length - index - count + 1);
+    _length -= count;
+}
+
+void String::toUpperCase() {
+    for (unsigned int i = 0; i < _length; i++) {
+        _buffer[i] = (char)toupper((unsigned char)_buffer[i]);
+    }
+}
+
+void String::toLowerCase() {
+    for (unsigned int i = 0; i < _length; i++) {
+        _buffer[i] = (char)tolower((unsigned char)_buffer[i]);
+    }
+}
+
+void String::trim() {
+    unsigned int begin = 0;
+    while (begin < _length && isspace((unsigned char)_buffer[begin])) {
+        begin++;
+    }
+    unsigned int end = _length;
+    while (end > begin && isspace((unsigned char)_buffer[end - 1])) {
+        end--;
+    }
+    remove(end);
+    remove(0, begin);
+}
+
+String operator+(const String& left, const String& right) {
+    String result(left);
+    result += right;
+    return result;
+}
+
+String operator+(const String& left, const char* right) {
+    String result(left);
+    result += right;
+    return result;
+}
+
+String operator+(const char* left, const String& right) {
+    String result(left);
+    result += right;
+    return result;
+}
+
+String operator+(const String& left, char right) {
+    String result(left);
+    result += right;
+    return result;
+}
+
+// --- Serial ---
+
+size_t HardwareSerial::write(const char* text, size_t length) {
+    simBoard.serialWrite(text, length);
+    return length;
+}
+
+size_t HardwareSerial::print(long value, int base) {
+    String text(value, (unsigned char)base);
+    return write(text.c_str(), text.length());
+}
+
+size_t HardwareSerial::print(unsigned long value, int base) {
+    String text(value, (unsigned char)base);
+    return write(text.c_str(), text.length());
+}
+
+size_t HardwareSerial::print(double value, int decimals) {
+    char text[40];
+    int length = snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return write(text, length > 0 ? (size_t)length : 0);
+}
+
+size_t HardwareSerial::printf(const char* format, ...) {
+    char text[256];
+    va_list args;
+    va_start(args, format);
+    int length = vsnprintf(text, sizeof(text), format, args);
+    va_end(args);
+    if (length < 0) {
+        return 0;
+    }
+    return write(text, (size_t)length < sizeof(text) ? (size_t)length : sizeof(text) - 1);
+}
@@ -0,0 +1,268 @@
+// sim/SimBoard.cpp
+
+/**
+ * @file SimBoard.cpp
+ * @brief Implementazione della classe SimBoard.
+ */
+
+#include "SimBoard.h"
+#include <stdio.h>
+#include <string.h>
+
+SimBoard simBoard;
+
+// Righe dell'LCD 20x4 nella memoria dati dell'HD44780: la riga 0 prosegue nella 2
+// e la 1 nella 3, come sul display vero quando un testo supera le 20 colonne.
+static const uint8_t LCD_ROW_OFFSETS[SIM_LCD_ROWS] = {0x00, 0x40, 0x14, 0x54};
+
+SimBoard::SimBoard() :
+    _serialEcho(false),
+    _logMask(SIM_LOG_NONE)
+{
+    reset();
+}
+
+void SimBoard::reset() {
+    _nowUs = 0;
+    _rtcEpoch = SIM_RTC_DEFAULT_EPOCH;
+    memset(_pins, 1, sizeof(_pins)); // Pull-up: tutto a riposo
+    _keyHead = 0;
+    _keyCount = 0;
+    _cardLength = 0;
+    _rxHead = 0;
+    _rxCount = 0;
+    _rxHeld = false;
+
+    memset(_ddram, ' ', sizeof(_ddram));
+    _lcdAddress = 0;
+    for (uint8_t i = 0; i < SIM_OLED_COUNT; i++) {
+        _oledText[i][0] = '\0';
+    }
+    _strip.clear();
+    _stripBrightness = 0;
+    _toneFrequency = 0;
+
+    _log.clear();
+    resetCounters();
+}
+
+// --- Ingressi ---
+
+void SimBoard::setPin(uint8_t pin, int level) {
+    if (pin < SIM_PIN_COUNT) {
+        _pins[pin] = level ? 1 : 0;
+    }
+}
+
+int SimBoard::readPin(uint8_t pin) const {
+    return pin < SIM_PIN_COUNT ? _pins[pin] : 1;
+}
+
+int SimBoard::readAnalog(uint8_t pin) const {
+    return readPin(pin) ? 4095 : 0;
+}
+
+void SimBoard::setButton(uint8_t button, bool pressed) {
+    setPin(button == 1 ? SIM_BUTTON1_PIN : SIM_BUTTON2_PIN, pressed ? 0 : 1);
+}
+
+void SimBoard::setKeySwitch(uint8_t key, bool turned) {
+    setPin(key == 1 ? SIM_KEY1_PIN : SIM_KEY2_PIN, turned ? 0 : 1);
+}
+
+bool SimBoard::typeKey(char key) {
+    if (_keyCount >= SIM_KEY_QUEUE_SIZE) {
+        return false;
+    }
+    _keys[(_keyHead + _keyCount) % SIM_KEY_QUEUE_SIZE] = key;
+    _keyCount++;
+    return true;
+}
+
+void SimBoard::typeKeys(const char* keys) {
+    while (*keys != '\0' && typeKey(*keys)) {
+        keys++;
+    }
+}
+
+char SimBoard::takeKey() {
+    _counters.keypadReads++;
+    if (_keyCount == 0) {
+        return '\0'; // NO_KEY
+    }
+    char key = _keys[_keyHead];
+    _keyHead = (_keyHead + 1) % SIM_KEY_QUEUE_SIZE;
+    _keyCount--;
+    return key;
+}
+
+void SimBoard::presentCard(const uint8_t* uid, uint8_t length) {
+    _cardLength = length < SIM_CARD_UID_LEN ? length : SIM_CARD_UID_LEN;
+    memcpy(_cardUid, uid, _cardLength);
+}
+
+uint8_t SimBoard::readCard(uint8_t* uid) const {
+    memcpy(uid, _cardUid, _cardLength);
+    return _cardLength;
+}
+
+bool SimBoard::receive(const char* message) {
+    if (_rxCount >= SIM_RX_QUEUE_SIZE) {
+        return false;
+    }
+    char* slot = _rx[(_rxHead + _rxCount) % SIM_RX_QUEUE_SIZE];
+    strncpy(slot, message, SIM_RX_MESSAGE_LEN - 1);
+    slot[SIM_RX_MESSAGE_LEN - 1] = '\0';
+    _rxCount++;
+    return true;
+}
+
+const char* SimBoard::nextReceived() {
+    // Come la coda di ricezione vera: lo slot consegnato si libera alla lettura successiva.
+    if (_rxHeld) {
+        _rxHead = (_rxHead + 1) % SIM_RX_QUEUE_SIZE;
+        _rxCount--;
+        _rxHeld = false;
+    }
+    if (_rxCount == 0) {
+        return nullptr;
+    }
+    _rxHeld = true;
+    return _rx[_rxHead];
+}
+
+// --- LCD ---
+
+uint8_t SimBoard::ddramAddress(uint8_t col, uint8_t row) {
+    if (row >= SIM_LCD_ROWS) {
+        row = SIM_LCD_ROWS - 1;
+    }
+    return (uint8_t)((LCD_ROW_OFFSETS[row] + col) & (SIM_LCD_DDRAM_SIZE - 1));
+}
+
+void SimBoard::lcdClear() {
+    _counters.lcdClears++;
+    memset(_ddram, ' ', sizeof(_ddram));
+    _lcdAddress = 0;
+    if (_logMask & SIM_LOG_BIT(SIM_LCD)) {
+        log(SIM_LCD, "clear");
+    }
+}
+
+void SimBoard::lcdSetCursor(uint8_t col, uint8_t row) {
+    _counters.lcdCursorMoves++;
+    _lcdAddress = ddramAddress(col, row);
+}
+
+void SimBoard::lcdWrite(uint8_t ch) {
+    _counters.lcdChars++;
+    _ddram[_lcdAddress] = ch;
+    _lcdAddress = (_lcdAddress + 1) & (SIM_LCD_DDRAM_SIZE - 1);
+}
+
+void SimBoard::lcdPrint(const char* text, size_t length) {
+    if (_logMask & SIM_LOG_BIT(SIM_LCD)) {
+        char prefix[16];
+        snprintf(prefix, sizeof(prefix), "@%02x ", _lcdAddress);
+        log(SIM_LCD, std::string(prefix) + std::string(text, length));
+    }
+    for (size_t i = 0; i < length; i++) {
+        lcdWrite((uint8_t)text[i]);
+    }
+}
+
+void SimBoard::lcdCreateChar(uint8_t location) {
+    (void)location;
+    _counters.lcdCustomChars++;
+}
+
+std::string SimBoard::lcdRow(uint8_t row) const {
+    std::string text(SIM_LCD_COLS, ' ');
+    for (uint8_t col = 0; col < SIM_LCD_COLS; col++) {
+        uint8_t ch = lcdCell(col, row);
+        text[col] = ch < 8 ? '#' : (char)ch;
+    }
+    return text;
+}
+
+uint8_t SimBoard::lcdCell(uint8_t col, uint8_t row) const {
+    return _ddram[ddramAddress(col, row)];
+}
+
+// --- OLED, striscia, buzzer, rete, seriale ---
+
+void SimBoard::oledShow(uint8_t index, const char* text) {
+    if (index >= SIM_OLED_COUNT) {
+        return;
+    }
+    _counters.oledRefreshes++;
+    strncpy(_oledText[index], text, SIM_OLED_TEXT_LEN - 1);
+    _oledText[index][SIM_OLED_TEXT_LEN - 1] = '\0';
+    if (_logMask & SIM_LOG_BIT(SIM_OLED)) {
+        log(SIM_OLED, std::string(index == 0 ? "1: " : "2: ") + _oledText[index]);
+    }
+}
+
+void SimBoard::stripShow(const uint32_t* pixels, uint16_t count, uint8_t brightness) {
+    _counters.stripShows++;
+    _strip.assign(pixels, pixels + count);
+    _stripBrightness = brightness;
+    if (_logMask & SIM_LOG_BIT(SIM_STRIP)) {
+        char text[32];
+        snprintf(text, sizeof(text), "%06lx x%u b%u", count > 0 ? (unsigned long)pixels[0] : 0UL,
+                 (unsigned)count, (unsigned)brightness);
+        log(SIM_STRIP, text);
+    }
+}
+
+uint32_t SimBoard::stripPixel(uint16_t index) const {
+    return index < _strip.size() ? _strip[index] : 0;
+}
+
+void SimBoard::buzzer(uint32_t frequency) {
+    if (frequency == _toneFrequency) {
+        return;
+    }
+    _counters.toneChanges++;
+    _toneFrequency = frequency;
+    if (_logMask & SIM_LOG_BIT(SIM_BUZZER)) {
+        log(SIM_BUZZER, std::to_string(frequency));
+    }
+}
+
+void SimBoard::networkSend(const char* message) {
+    _counters.networkSends++;
+    if (_logMask & SIM_LOG_BIT(SIM_NETWORK)) {
+        log(SIM_NETWORK, message);
+    }
+}
+
+void SimBoard::serialWrite(const char* text, size_t length) {
+    if (_serialEcho) {
+        fwrite(text, 1, length, stdout);
+    }
+    if (_logMask & SIM_LOG_BIT(SIM_SERIAL)) {
+        log(SIM_SERIAL, std::string(text, length));
+    }
+}
+
+// --- Registro e contatori ---
+
+// I chiamanti controllano la maschera prima di comporre il testo: a registro
+// spento le uscite non allocano memoria.
+void SimBoard::log(SimDevice device, const std::string& text) {
+    _log.push_back({millis(), device, text});
+}
+
+bool SimBoard::logContains(SimDevice device, const char* text) const {
+    for (const SimLogEntry& entry : _log) {
+        if (entry.device == device && entry.text.find(text) != std::string::npos) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SimBoard::resetCounters() {
+    memset(&_counters, 0, sizeof(_counters));
+}
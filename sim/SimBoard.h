@@ -0,0 +1,212 @@
+// sim/SimBoard.h
+
+/**
+ * @file SimBoard.h
+ * @brief Dichiarazione della classe SimBoard, la scheda virtuale della simulazione sull'host.
+ * @details Le librerie di Arduino e dei componenti (sim/include) sono sostituite
+ * da versioni che leggono e scrivono questa scheda: HardwareManager e le
+ * modalità si compilano senza modifiche e vedono pulsanti, tastierino, chiavi
+ * e card impostati dallo scenario, mentre LCD, OLED, striscia LED, buzzer e
+ * rete finiscono in buffer consultabili e in un registro delle uscite.
+ *
+ * Il tempo è un orologio virtuale: millis(), micros() e l'RTC avanzano solo
+ * con advanceMs()/advanceUs() e con delay(). La stessa sequenza di ingressi
+ * produce quindi sempre la stessa sequenza di uscite, a qualunque velocità
+ * giri l'host.
+ *
+ * Un solo oggetto globale (simBoard), usato da un solo thread.
+ */
+
+#ifndef SIM_BOARD_H
+#define SIM_BOARD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#define SIM_PIN_COUNT 40            // GPIO dell'ESP32
+#define SIM_LCD_COLS 20
+#define SIM_LCD_ROWS 4
+#define SIM_LCD_DDRAM_SIZE 128      // Memoria dati dell'HD44780 (indirizzi a 7 bit)
+#define SIM_OLED_COUNT 2
+#define SIM_OLED_TEXT_LEN 64
+#define SIM_KEY_QUEUE_SIZE 64
+#define SIM_RX_QUEUE_SIZE 8
+#define SIM_RX_MESSAGE_LEN 256
+#define SIM_CARD_UID_LEN 7
+#define SIM_RTC_DEFAULT_EPOCH 1735689600UL   // 2025-01-01 00:00:00
+
+// Pin degli ingressi, gli stessi di HardwareManager.cpp
+#define SIM_BUTTON1_PIN 32
+#define SIM_BUTTON2_PIN 33
+#define SIM_KEY1_PIN 35
+#define SIM_KEY2_PIN 34
+
+/** @brief Origine di una riga del registro delle uscite. */
+enum SimDevice : uint8_t {
+    SIM_LCD = 0,
+    SIM_OLED,
+    SIM_STRIP,
+    SIM_BUZZER,
+    SIM_NETWORK,
+    SIM_SERIAL,
+    SIM_DEVICE_COUNT
+};
+
+/** @brief Maschere per setLogMask(). */
+#define SIM_LOG_NONE 0
+#define SIM_LOG_ALL  ((1u << SIM_DEVICE_COUNT) - 1)
+#define SIM_LOG_BIT(device) (1u << (device))
+
+/**
+ * @struct SimCounters
+ * @brief Operazioni di I/O eseguite dall'ultimo resetCounters().
+ * @details Contano le chiamate alle librerie, cioè il traffico che sul
+ * dispositivo passa per il bus I2C, la striscia e il radio.
+ */
+struct SimCounters {
+    uint32_t lcdClears;         // clear() dell'LCD
+    uint32_t lcdCursorMoves;    // setCursor()
+    uint32_t lcdChars;          // Caratteri scritti (print() e write())
+    uint32_t lcdCustomChars;    // createChar()
+    uint32_t oledRefreshes;     // display() di uno dei due OLED
+    uint32_t stripShows;        // show() della striscia
+    uint32_t toneChanges;       // Cambi di frequenza del buzzer
+    uint32_t networkSends;      // Eventi arrivati al bridge di prova
+    uint32_t keypadReads;       // getKey()
+};
+
+/** @brief Riga del registro delle uscite. */
+struct SimLogEntry {
+    uint32_t timeMs;
+    SimDevice device;
+    std::string text;
+};
+
+class SimBoard {
+public:
+    SimBoard();
+
+    /**
+     * @brief Riporta la scheda allo stato di accensione.
+     * @details Orologio a zero, ingressi rilasciati, display e striscia spenti,
+     * contatori e registro vuoti. La memoria Preferences non viene toccata,
+     * come la flash del dispositivo.
+     */
+    void reset();
+
+    // --- Orologio virtuale ---
+    uint32_t millis() const { return (uint32_t)(_nowUs / 1000); }
+    uint32_t micros() const { return (uint32_t)_nowUs; }
+    void advanceUs(uint32_t us) { _nowUs += us; }
+    void advanceMs(uint32_t ms) { _nowUs += (uint64_t)ms * 1000; }
+    /** @brief Ora Unix dell'RTC all'istante zero dell'orologio virtuale. */
+    void setRtcEpoch(uint32_t unixTime) { _rtcEpoch = unixTime; }
+    /** @brief Ora Unix dell'RTC, che avanza con l'orologio virtuale. */
+    uint32_t rtcNow() const { return _rtcEpoch + (uint32_t)(_nowUs / 1000000); }
+
+    // --- Ingressi (scenario -> firmware) ---
+    /** @brief Livello logico di un pin; i pulsanti sono in pull-up (HIGH a riposo). */
+    void setPin(uint8_t pin, int level);
+    int readPin(uint8_t pin) const;
+    /** @brief Lettura analogica: 4095 per HIGH, 0 per LOW (le chiavi su ADC1). */
+    int readAnalog(uint8_t pin) const;
+    /** @brief Preme (true) o rilascia il pulsante 1 o 2. */
+    void setButton(uint8_t button, bool pressed);
+    /** @brief Gira (true) o riporta a riposo la chiave 1 o 2. */
+    void setKeySwitch(uint8_t key, bool turned);
+    /** @brief Accoda un tasto del tastierino; getKey() ne consegna uno per chiamata. */
+    bool typeKey(char key);
+    /** @brief Accoda tutti i tasti della stringa. */
+    void typeKeys(const char* keys);
+    char takeKey();
+    size_t pendingKeys() const { return _keyCount; }
+    /** @brief Avvicina una card al lettore; resta presente fino a removeCard(). */
+    void presentCard(const uint8_t* uid, uint8_t length);
+    void removeCard() { _cardLength = 0; }
+    /** @return Lunghezza dell'UID copiato in uid, 0 se non c'è nessuna card. */
+    uint8_t readCard(uint8_t* uid) const;
+    /** @brief Accoda un comando come se fosse arrivato dal server: lo invia il bridge di prova. */
+    bool receive(const char* message);
+    /** @brief Prossimo comando da inviare, nullptr se non ce ne sono. Valido fino alla chiamata successiva. */
+    const char* nextReceived();
+
+    // --- Uscite (firmware -> scheda) ---
+    void lcdClear();
+    void lcdSetCursor(uint8_t col, uint8_t row);
+    void lcdWrite(uint8_t ch);
+    /** @brief Scrive un testo dalla posizione del cursore: una sola riga di registro. */
+    void lcdPrint(const char* text, size_t length);
+    void lcdCreateChar(uint8_t location);
+    /**
+     * @brief Testo di una riga dell'LCD così come è visibile.
+     * @details I caratteri personalizzati (0-7) sono resi come '#'.
+     */
+    std::string lcdRow(uint8_t row) const;
+    /** @brief Codice del carattere in una cella (0-7 per i personalizzati). */
+    uint8_t lcdCell(uint8_t col, uint8_t row) const;
+
+    /** @brief Un OLED ha mostrato il testo indicato (vuoto se cancellato). */
+    void oledShow(uint8_t index, const char* text);
+    const char* oledText(uint8_t index) const { return _oledText[index]; }
+
+    void stripShow(const uint32_t* pixels, uint16_t count, uint8_t brightness);
+    uint32_t stripPixel(uint16_t index) const;
+    uint8_t stripBrightness() const { return _stripBrightness; }
+
+    /** @brief Frequenza del buzzer, 0 per il silenzio. */
+    void buzzer(uint32_t frequency);
+    uint32_t toneFrequency() const { return _toneFrequency; }
+
+    /** @brief Evento arrivato al bridge di prova (vedi sim/SimBridge.cpp). */
+    void networkSend(const char* message);
+
+    /** @brief Testo stampato sulla seriale; va sullo stdout solo se l'eco è attiva. */
+    void serialWrite(const char* text, size_t length);
+    void setSerialEcho(bool echo) { _serialEcho = echo; }
+
+    // --- Registro e contatori ---
+    /** @brief Dispositivi da registrare (SIM_LOG_BIT()); il registro costa una stringa per uscita. */
+    void setLogMask(uint32_t mask) { _logMask = mask; }
+    const std::vector<SimLogEntry>& getLog() const { return _log; }
+    void clearLog() { _log.clear(); }
+    /** @brief Ritorna true se una riga del dispositivo contiene il testo. */
+    bool logContains(SimDevice device, const char* text) const;
+    const SimCounters& getCounters() const { return _counters; }
+    void resetCounters();
+
+private:
+    void log(SimDevice device, const std::string& text);
+    static uint8_t ddramAddress(uint8_t col, uint8_t row);
+
+    uint64_t _nowUs;
+    uint32_t _rtcEpoch;
+
+    uint8_t _pins[SIM_PIN_COUNT];
+    char _keys[SIM_KEY_QUEUE_SIZE];
+    size_t _keyHead;
+    size_t _keyCount;
+    uint8_t _cardUid[SIM_CARD_UID_LEN];
+    uint8_t _cardLength;
+    char _rx[SIM_RX_QUEUE_SIZE][SIM_RX_MESSAGE_LEN];
+    size_t _rxHead;
+    size_t _rxCount;
+    bool _rxHeld;
+
+    uint8_t _ddram[SIM_LCD_DDRAM_SIZE];
+    uint8_t _lcdAddress;
+    char _oledText[SIM_OLED_COUNT][SIM_OLED_TEXT_LEN];
+    std::vector<uint32_t> _strip;
+    uint8_t _stripBrightness;
+    uint32_t _toneFrequency;
+    bool _serialEcho;
+
+    uint32_t _logMask;
+    std::vector<SimLogEntry> _log;
+    SimCounters _counters;
+};
+
+extern SimBoard simBoard;
+
+#endif // SIM_BOARD_H
@@ -0,0 +1,103 @@
+// sim/SimBridge.cpp
+
+/**
+ * @file SimBridge.cpp
+ * @brief Implementazione della classe SimBridge.
+ */
+
+#include "SimBridge.h"
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Network/ClockSync.h"
+#include "SimBoard.h"
+
+SimBridge::SimBridge(LoopbackTransport& device) :
+    _link(LoopbackTransport::makeAddress(192, 168, 1, 2), "bridge"),
+    _device(device),
+    _pendingCount(0),
+    _nextCid(1)
+{
+    LoopbackTransport::connect(_device, _link);
+    _link.begin(SIM_BRIDGE_PORT);
+}
+
+void SimBridge::update() {
+    uint8_t datagram[LOOPBACK_MAX_DATAGRAM + 1];
+    uint32_t from;
+    bool truncated;
+    int length;
+    while ((length = _link.receive(datagram, LOOPBACK_MAX_DATAGRAM, from, truncated)) >= 0) {
+        if (truncated || length == 0) {
+            continue;
+        }
+        datagram[length] = '\0';
+        // Un datagramma testuale porta un evento per riga.
+        char* line = (char*)datagram;
+        while (line != nullptr && *line != '\0') {
+            char* next = strchr(line, '\n');
+            if (next != nullptr) {
+                *next++ = '\0';
+            }
+            handleLine(line, from);
+            line = next;
+        }
+    }
+
+    // Comandi nuovi dalla scheda: partono con un ID e restano in attesa della conferma.
+    while (_pendingCount < SIM_BRIDGE_PENDING) {
+        const char* text = simBoard.nextReceived();
+        if (text == nullptr) {
+            break;
+        }
+        PendingCommand& command = _pending[_pendingCount++];
+        command.cid = _nextCid++;
+        command.nextSendTime = millis();
+        snprintf(command.text, sizeof(command.text), "CID:%lu;%s", (unsigned long)command.cid, text);
+    }
+    for (uint8_t i = 0; i < _pendingCount; i++) {
+        PendingCommand& command = _pending[i];
+        if ((long)(millis() - command.nextSendTime) >= 0) {
+            sendText(_device.localAddress(), command.text);
+            command.nextSendTime = millis() + SIM_BRIDGE_RETRY_MS;
+        }
+    }
+}
+
+void SimBridge::handleLine(const char* line, uint32_t from) {
+    if (strncmp(line, "event:discover;", 15) == 0) {
+        sendText(from, "CMD:SERVER_HERE;");
+        return;
+    }
+    if (strncmp(line, "event:time_sync;", 16) == 0) {
+        const char* t0 = strstr(line, "t0:");
+        if (t0 == nullptr) {
+            return;
+        }
+        unsigned long serverMs = (millis() + SIM_BRIDGE_TIME_OFFSET_MS) & SERVER_TIME_MASK;
+        char reply[96];
+        snprintf(reply, sizeof(reply), "CMD:TIME_SYNC;T0:%lu;T1:%lu;T2:%lu;",
+                 strtoul(t0 + 3, nullptr, 10), serverMs, serverMs);
+        sendText(from, reply);
+        return;
+    }
+    if (strncmp(line, "event:ack;cid:", 14) == 0) {
+        acknowledge(strtoul(line + 14, nullptr, 10));
+    }
+    simBoard.networkSend(line);
+}
+
+void SimBridge::acknowledge(uint32_t cid) {
+    for (uint8_t i = 0; i < _pendingCount; i++) {
+        if (_pending[i].cid == cid) {
+            // Gli altri restano nell'ordine di invio.
+            memmove(&_pending[i], &_pending[i + 1], (_pendingCount - i - 1) * sizeof(PendingCommand));
+            _pendingCount--;
+            return;
+        }
+    }
+}
+
+void SimBridge::sendText(uint32_t address, const char* text) {
+    _link.send(address, SIM_BRIDGE_PORT, (const uint8_t*)text, strlen(text));
+}
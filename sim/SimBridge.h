@@ -0,0 +1,66 @@
+// sim/SimBridge.h
+
+/**
+ * @file SimBridge.h
+ * @brief Dichiarazione della classe SimBridge, il bridge di prova della simulazione.
+ * @details Il dispositivo simulato usa il NetworkManager vero su un
+ * LoopbackTransport; SimBridge è l'altro capo del collegamento e risponde come
+ * bridge/bridge.py per la parte testuale del protocollo:
+ * - "event:discover;" riceve "CMD:SERVER_HERE;";
+ * - "event:time_sync;" riceve "CMD:TIME_SYNC;T0:;T1:;T2:;" con il tempo server
+ *   (millis() della scheda più un offset fisso);
+ * - ogni altra riga di un datagramma è un evento, consegnato a
+ *   simBoard.networkSend() con i campi aggiunti dal dispositivo (ts, seq, id);
+ * - i comandi accodati con simBoard.receive() partono come "CID:n;<comando>" e
+ *   sono ritrasmessi finché non arriva "event:ack;cid:n;".
+ * Non risponde mai a CMD:WIRE: il dispositivo resta sul protocollo testuale.
+ * Funziona a passate (update()), sullo stesso thread del dispositivo.
+ */
+
+#ifndef SIM_BRIDGE_H
+#define SIM_BRIDGE_H
+
+#include "Network/LoopbackTransport.h"
+
+#define SIM_BRIDGE_PORT 1234                // Porta UDP del NetworkManager
+#define SIM_BRIDGE_PENDING 8                // Comandi in attesa di conferma
+#define SIM_BRIDGE_COMMAND_LEN 256
+#define SIM_BRIDGE_RETRY_MS 200             // Ritrasmissione di un comando non confermato
+#define SIM_BRIDGE_TIME_OFFSET_MS 1000000UL // Tempo server = millis() della scheda + offset
+
+class SimBridge {
+public:
+    /**
+     * @param device Endpoint del dispositivo, a cui il bridge si collega.
+     */
+    explicit SimBridge(LoopbackTransport& device);
+
+    /**
+     * @brief Una passata del bridge: risponde ai datagrammi arrivati, poi
+     * invia i comandi nuovi e ritrasmette quelli non confermati.
+     */
+    void update();
+    /** @brief true se ci sono comandi non ancora confermati dal dispositivo. */
+    bool hasPendingCommands() const { return _pendingCount > 0; }
+
+private:
+    struct PendingCommand {
+        uint32_t cid;
+        unsigned long nextSendTime;
+        char text[SIM_BRIDGE_COMMAND_LEN];
+    };
+
+    /** @brief Gestisce una riga di un datagramma ricevuto. */
+    void handleLine(const char* line, uint32_t from);
+    /** @brief Toglie dall'elenco il comando confermato. */
+    void acknowledge(uint32_t cid);
+    void sendText(uint32_t address, const char* text);
+
+    LoopbackTransport _link;
+    LoopbackTransport& _device;
+    PendingCommand _pending[SIM_BRIDGE_PENDING];
+    uint8_t _pendingCount;
+    uint32_t _nextCid;
+};
+
+#endif // SIM_BRIDGE_H
@@ -0,0 +1,228 @@
+// sim/SimGame.cpp
+
+/**
+ * @file SimGame.cpp
+ * @brief Implementazione della classe SimGame.
+ * @details I lavori sono quelli di main.cpp, con gli stessi periodi e lo
+ * stesso ordine di priorità, così i tempi di reazione misurati qui sono quelli
+ * del dispositivo a meno della durata delle scritture sul bus.
+ */
+
+#include "SimGame.h"
+#include "GameModes/SearchDestroyMode.h"
+#include "GameModes/DominationMode.h"
+#include "GameModes/MusicRoomMode.h"
+#include "GameModes/TerminalMode.h"
+#include "Profiler.h"
+
+// Periodi e scadenze di main.cpp, in microsecondi
+static const uint32_t INPUT_PERIOD_US = 1000;
+static const uint32_t INPUT_BUDGET_US = 500;
+static const uint32_t AUDIO_PERIOD_US = 1000;
+static const uint32_t AUDIO_BUDGET_US = 500;
+static const uint32_t EFFECTS_PERIOD_US = 1000;
+static const uint32_t EFFECTS_BUDGET_US = 5000;
+static const uint32_t NETWORK_PERIOD_US = 5000;
+static const uint32_t NETWORK_BUDGET_US = 5000;
+static const uint32_t MODE_BUDGET_US = 50000;
+
+SimGame* SimGame::_current = nullptr;
+
+SimGame::SimGame() :
+    _link(LoopbackTransport::makeAddress(192, 168, 1, 50), "AA:BB:CC:DD:EE:FF"),
+    _bridge(_link),
+    _network(&_link),
+    _appState(APP_STATE_MAIN_MENU),
+    _registry({&_hardware, &_network, &_events, nullptr, &_appState, displayMainMenu, &_registry}),
+    _tickMs(SIM_TICK_MS),
+    _passes(0),
+    _mainMenuCount(0)
+{
+    _current = this;
+    simBoard.reset();
+    // Il contatore di cicli dell'host conta nanosecondi.
+    profiler.setCyclesPerUs(1000);
+
+    // Come setup(), senza Test Hardware: l'aggiornamento OTA non esiste sull'host.
+    _registry.add<SearchDestroyMode>(APP_STATE_SEARCH_DESTROY_MODE, "Cerca & Distruggi");
+    _registry.add<DominationMode>(APP_STATE_DOMINATION_MODE, "Dominio");
+    _registry.add<MusicRoomMode>(APP_STATE_MUSIC_ROOM, "Stanza dei Suoni");
+    _registry.add<TerminalMode>(APP_STATE_TERMINAL_MODE, "Mod. Terminale");
+
+    _router.on(CMD_FORCE_END_GAME, handleForceEndGame, this);
+    TerminalMode::registerCommands(_router, _registry);
+    _network.setCommandFilter(acceptCommand, this);
+    _events.subscribe(GAME_EVENT_ALL, forwardEvent, &_network);
+
+    _hardware.initialize();
+    _network.initialize();
+
+    _scheduler.add("input", INPUT_PERIOD_US, INPUT_BUDGET_US, inputJob, this, true);
+    _scheduler.add("audio", AUDIO_PERIOD_US, AUDIO_BUDGET_US, audioJob, this, true);
+    _scheduler.add("effects", EFFECTS_PERIOD_US, EFFECTS_BUDGET_US, effectsJob, this);
+    _scheduler.add("network", NETWORK_PERIOD_US, NETWORK_BUDGET_US, networkJob, this);
+    _scheduler.add("mode", 0, MODE_BUDGET_US, modeJob, this);
+    _hardware.setBusWaitHook(runUrgentJobs, this);
+
+    displayMainMenu();
+}
+
+SimGame::~SimGame() {
+    _registry.deactivate();
+    if (_current == this) {
+        _current = nullptr;
+    }
+}
+
+GameMode* SimGame::enterMode(AppState state) {
+    _registry.deactivate();
+    GameMode* mode = _registry.activate(state);
+    if (mode != nullptr) {
+        _appState = state;
+        mode->enter();
+    }
+    return mode;
+}
+
+void SimGame::step(uint32_t tickMs) {
+    _scheduler.run(schedulerClock);
+    _network.runNetworkRound();
+    _bridge.update();
+    _passes++;
+    simBoard.advanceMs(tickMs);
+}
+
+void SimGame::run(uint32_t ms, uint32_t tickMs) {
+    for (uint32_t elapsed = 0; elapsed < ms; elapsed += tickMs) {
+        step(tickMs);
+    }
+}
+
+// Un passo in più dell'anti-rimbalzo: almeno una lettura dopo che Button ha accettato il cambio.
+void SimGame::press(uint8_t button) {
+    simBoard.setButton(button, true);
+    run(SIM_SETTLE_MS + _tickMs);
+    simBoard.setButton(button, false);
+    run(SIM_SETTLE_MS + _tickMs);
+}
+
+void SimGame::hold(uint8_t button, uint32_t ms) {
+    simBoard.setButton(button, true);
+    run(SIM_SETTLE_MS + _tickMs + ms);
+    simBoard.setButton(button, false);
+    run(SIM_SETTLE_MS + _tickMs);
+}
+
+void SimGame::type(const char* keys) {
+    for (const char* key = keys; *key != '\0'; key++) {
+        simBoard.typeKey(*key);
+        // Il tasto è consumato dalla prima passata della logica di modalità.
+        while (simBoard.pendingKeys() > 0) {
+            step();
+        }
+    }
+    // Le modalità controllano il testo inserito nella passata successiva (es. PIN completo).
+    step();
+}
+
+void SimGame::command(const char* text) {
+    simBoard.receive(text);
+    // La conferma parte quando il lavoro di rete ha letto il comando.
+    uint32_t elapsed = 0;
+    do {
+        step();
+        elapsed += _tickMs;
+    } while (_bridge.hasPendingCommands() && elapsed < SIM_COMMAND_TIMEOUT_MS);
+}
+
+// --- Lavori ---
+
+uint32_t SimGame::schedulerClock() {
+    return micros();
+}
+
+void SimGame::inputJob(void* context) {
+    static_cast<SimGame*>(context)->_hardware.updateButtons();
+}
+
+void SimGame::audioJob(void* context) {
+    static_cast<SimGame*>(context)->_hardware.updateMidiTune();
+}
+
+void SimGame::effectsJob(void* context) {
+    static_cast<SimGame*>(context)->_hardware.updateEffects();
+}
+
+void SimGame::networkJob(void* context) {
+    SimGame* game = static_cast<SimGame*>(context);
+    game->_network.update();
+    if (game->_network.wasLinkUp()) {
+        char onlineMessage[100];
+        snprintf(onlineMessage, sizeof(onlineMessage), "event:device_online;status:ready;version:%s;", FIRMWARE_VERSION);
+        game->_network.sendStatus(onlineMessage);
+    }
+    const char* command;
+    while ((command = game->_network.nextReceivedMessage()) != nullptr) {
+        game->_router.dispatch(command, game->_network.getClock(), millis());
+    }
+    game->_router.runDue(game->_network.getClock(), millis());
+}
+
+void SimGame::modeJob(void* context) {
+    SimGame* game = static_cast<SimGame*>(context);
+    if (game->_appState == APP_STATE_MAIN_MENU) {
+        // Il menu resta fermo: le modalità si scelgono con enterMode().
+        game->_registry.deactivate();
+    } else {
+        GameMode* mode = game->_registry.getActive(game->_appState);
+        if (mode != nullptr) {
+            mode->loop();
+        }
+    }
+    game->_events.dispatch();
+    game->_hardware.flushLcd();
+}
+
+bool SimGame::acceptCommand(const char* command, void* context) {
+    SimGame* game = static_cast<SimGame*>(context);
+    return game->_router.canAccept(command, game->_network.getClock(), millis());
+}
+
+void SimGame::runUrgentJobs(void* context) {
+    static_cast<SimGame*>(context)->_scheduler.runUrgent(schedulerClock);
+}
+
+void SimGame::forwardEvent(const GameEvent& event, void* context) {
+    static_cast<NetworkManager*>(context)->sendGameEvent(event);
+}
+
+void SimGame::handleForceEndGame(const ParsedCommand& command, void* context) {
+    (void)command;
+    SimGame* game = static_cast<SimGame*>(context);
+    GameMode* mode = game->_registry.getActive(game->_appState);
+    switch (game->_appState) {
+        case APP_STATE_SEARCH_DESTROY_MODE:
+            static_cast<SearchDestroyMode*>(mode)->forceEndGame();
+            break;
+        case APP_STATE_DOMINATION_MODE:
+            static_cast<DominationMode*>(mode)->forceEndGame();
+            break;
+        default:
+            break;
+    }
+}
+
+void SimGame::displayMainMenu() {
+    if (_current == nullptr) {
+        return;
+    }
+    HardwareManager& hardware = _current->_hardware;
+    _current->_mainMenuCount++;
+    hardware.clearLcd();
+    hardware.printLcd(0, 0, "MENU PRINCIPALE");
+    for (uint8_t i = 0; i < _current->_registry.getCount() && i < hardware.getLcdRows() - 1; i++) {
+        hardware.printLcd(2, i + 1, _current->_registry.getName(i));
+    }
+    hardware.clearOled1();
+    hardware.printOled2("CONFERMA", 2, 18, 25);
+}
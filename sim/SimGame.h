@@ -0,0 +1,126 @@
+// sim/SimGame.h
+
+/**
+ * @file SimGame.h
+ * @brief Dichiarazione della classe SimGame, il dispositivo simulato completo.
+ * @details Contiene gli stessi oggetti di main.cpp (HardwareManager,
+ * NetworkManager, EventBus, ModeRegistry, CommandRouter, Scheduler) collegati
+ * alla scheda virtuale, e ripete i lavori del loop() che riguardano le
+ * modalità: ingressi, melodia, effetti, rete e logica di modalità, con gli
+ * stessi periodi. Mancano l'animazione dei menu, il battito e le statistiche.
+ * NetworkManager è quello del dispositivo, su un LoopbackTransport collegato a
+ * un SimBridge: al posto del task di rete gira un runNetworkRound() per passata.
+ *
+ * Ogni step() è una passata dello Scheduler seguita da un avanzamento
+ * dell'orologio virtuale: il tempo simulato non dipende dalla velocità
+ * dell'host. I metodi press()/hold()/type() rispettano l'anti-rimbalzo dei
+ * pulsanti (50 ms) come una persona al dispositivo.
+ *
+ * Un solo SimGame alla volta: la scheda virtuale è globale.
+ */
+
+#ifndef SIM_GAME_H
+#define SIM_GAME_H
+
+#include "HardwareManager.h"
+#include "NetworkManager.h"
+#include "EventBus.h"
+#include "Scheduler.h"
+#include "GameModes/ModeRegistry.h"
+#include "Network/CommandRouter.h"
+#include "Network/LoopbackTransport.h"
+#include "SimBoard.h"
+#include "SimBridge.h"
+#include "app_common.h"
+
+#define SIM_TICK_MS 1               // Passo predefinito dell'orologio tra due passate: il periodo dei lavori più frequenti
+#define SIM_SETTLE_MS 60            // Un ingresso resta fermo così a lungo perché Button lo accetti (50 ms + margine)
+#define SIM_COMMAND_TIMEOUT_MS 2000 // Attesa massima della conferma di un comando remoto
+
+class SimGame {
+public:
+    /**
+     * @brief Accende il dispositivo simulato.
+     * @details Azzera la scheda, inizializza hardware e rete, registra le
+     * modalità (tutte tranne Test Hardware, che usa l'aggiornamento OTA) e i
+     * comandi remoti. L'applicazione parte nel menu principale.
+     */
+    SimGame();
+    ~SimGame();
+
+    HardwareManager& hardware() { return _hardware; }
+    NetworkManager& network() { return _network; }
+    EventBus& events() { return _events; }
+    ModeRegistry& modes() { return _registry; }
+    AppState getAppState() const { return _appState; }
+    /** @brief Numero di passate eseguite dall'accensione. */
+    uint32_t getPasses() const { return _passes; }
+    /**
+     * @brief Passo dell'orologio tra due passate.
+     * @details Con un passo più lungo di SIM_TICK_MS i lavori a 1 kHz girano una
+     * volta per passo (lo Scheduler conta i periodi saltati) e i tempi di gioco
+     * hanno la risoluzione del passo. Per l'anti-rimbalzo il passo resta sotto i 50 ms.
+     */
+    void setTickMs(uint32_t tickMs) { _tickMs = tickMs > 0 ? tickMs : SIM_TICK_MS; }
+    uint32_t getTickMs() const { return _tickMs; }
+    /** @brief Numero di ritorni al menu principale (chiamate a displayMainMenu()). */
+    uint32_t getMainMenuCount() const { return _mainMenuCount; }
+
+    /**
+     * @brief Entra in una modalità come dal menu principale (activate() ed enter()).
+     * @return La modalità, nullptr se lo stato non è registrato.
+     */
+    GameMode* enterMode(AppState state);
+
+    /** @brief Una passata del loop() e del task di rete, poi l'orologio avanza di un passo. */
+    void step() { step(_tickMs); }
+    void step(uint32_t tickMs);
+    /** @brief Passate consecutive per ms millisecondi di tempo simulato. */
+    void run(uint32_t ms) { run(ms, _tickMs); }
+    void run(uint32_t ms, uint32_t tickMs);
+
+    // --- Ingressi ---
+    /** @brief Preme e rilascia un pulsante (1 o 2). */
+    void press(uint8_t button);
+    /** @brief Tiene premuto un pulsante per ms millisecondi (oltre all'anti-rimbalzo), poi lo rilascia. */
+    void hold(uint8_t button, uint32_t ms);
+    /** @brief Digita i tasti sul tastierino, una passata di gioco per tasto più una per la reazione all'ultimo. */
+    void type(const char* keys);
+    /**
+     * @brief Consegna un comando remoto tramite il bridge ed esegue le passate
+     * finché il dispositivo non lo ha confermato (al più SIM_COMMAND_TIMEOUT_MS).
+     */
+    void command(const char* text);
+
+private:
+    static void inputJob(void* context);
+    static void audioJob(void* context);
+    static void effectsJob(void* context);
+    static void networkJob(void* context);
+    static void modeJob(void* context);
+    static void runUrgentJobs(void* context);
+    static void forwardEvent(const GameEvent& event, void* context);
+    static bool acceptCommand(const char* command, void* context);
+    static void handleForceEndGame(const ParsedCommand& command, void* context);
+    static uint32_t schedulerClock();
+    /** @brief displayMainMenu() delle modalità: il menu con le voci del registro. */
+    static void displayMainMenu();
+
+    HardwareManager _hardware;
+    LoopbackTransport _link;
+    SimBridge _bridge;
+    NetworkManager _network;
+    EventBus _events;
+    AppState _appState;
+    ModeRegistry _registry;
+    CommandRouter _router;
+    Scheduler _scheduler;
+    uint32_t _tickMs;
+    uint32_t _passes;
+    uint32_t _mainMenuCount;
+
+    // Il dispositivo acceso, per displayMainMenu() che non riceve contesto.
+    static SimGame* _current;
+};
+
+#endif // SIM_GAME_H
@@ -0,0 +1,348 @@
+// sim/SimLibraries.cpp
+
+/**
+ * @file SimLibraries.cpp
+ * @brief Librerie dei componenti per la simulazione sull'host: tutte scrivono o leggono la scheda virtuale.
+ */
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <LiquidCrystal_I2C.h>
+#include <Keypad.h>
+#include <Adafruit_NeoPixel.h>
+#include <Adafruit_SSD1306.h>
+#include <RTClib.h>
+#include <PN532.h>
+#include <Preferences.h>
+#include <SPIFFS.h>
+#include "SimBoard.h"
+#include <algorithm>
+#include <map>
+#include <string>
+#include <vector>
+
+TwoWire Wire(0);
+SPIFFSFS SPIFFS;
+
+// --- LCD ---
+
+void LiquidCrystal_I2C::clear() { simBoard.lcdClear(); }
+void LiquidCrystal_I2C::setCursor(uint8_t col, uint8_t row) { simBoard.lcdSetCursor(col, row); }
+void LiquidCrystal_I2C::createChar(uint8_t location, uint8_t charmap[]) {
+    (void)charmap;
+    simBoard.lcdCreateChar(location & 0x7);
+}
+size_t LiquidCrystal_I2C::write(uint8_t value) {
+    simBoard.lcdWrite(value);
+    return 1;
+}
+size_t LiquidCrystal_I2C::print(const char* text) {
+    size_t length = strlen(text);
+    simBoard.lcdPrint(text, length);
+    return length;
+}
+
+// --- Tastierino ---
+
+char Keypad::getKey() { return simBoard.takeKey(); }
+
+// --- Striscia LED ---
+
+Adafruit_NeoPixel::Adafruit_NeoPixel(uint16_t count, int16_t pin, uint16_t type) :
+    _count(count),
+    _pixels(new uint32_t[count]),
+    _brightness(255)
+{
+    (void)pin; (void)type;
+    memset(_pixels, 0, count * sizeof(uint32_t));
+}
+
+Adafruit_NeoPixel::~Adafruit_NeoPixel() {
+    delete[] _pixels;
+}
+
+void Adafruit_NeoPixel::show() {
+    simBoard.stripShow(_pixels, _count, _brightness);
+}
+
+void Adafruit_NeoPixel::fill(uint32_t color, uint16_t first, uint16_t count) {
+    if (first >= _count) {
+        return;
+    }
+    uint16_t end = (count == 0 || first + count > _count) ? _count : first + count;
+    for (uint16_t i = first; i < end; i++) {
+        _pixels[i] = color;
+    }
+}
+
+void Adafruit_NeoPixel::setPixelColor(uint16_t n, uint32_t color) {
+    if (n < _count) {
+        _pixels[n] = color;
+    }
+}
+
+// Stesso algoritmo della libreria: sei settori di 65536/6 sul cerchio dei colori.
+uint32_t Adafruit_NeoPixel::ColorHSV(uint16_t hue, uint8_t sat, uint8_t val) {
+    uint8_t r, g, b;
+    hue = (hue * 1530L + 32768) / 65536;
+    if (hue < 510) {
+        b = 0;
+        if (hue < 255) { r = 255; g = hue; } else { r = 510 - hue; g = 255; }
+    } else if (hue < 1020) {
+        r = 0;
+        if (hue < 765) { g = 255; b = hue - 510; } else { g = 1020 - hue; b = 255; }
+    } else if (hue < 1530) {
+        g = 0;
+        if (hue < 1275) { r = hue - 1020; b = 255; } else { r = 255; b = 1530 - hue; }
+    } else {
+        r = 255; g = 0; b = 0;
+    }
+    uint32_t v1 = 1 + val;
+    uint16_t s1 = 1 + sat;
+    uint8_t s2 = 255 - sat;
+    return ((((((r * s1) >> 8) + s2) * v1) & 0xff00) << 8) |
+           (((((g * s1) >> 8) + s2) * v1) & 0xff00) |
+           (((((b * s1) >> 8) + s2) * v1) >> 8);
+}
+
+uint32_t Adafruit_NeoPixel::gamma32(uint32_t color) {
+    uint32_t result = 0;
+    for (int shift = 0; shift < 24; shift += 8) {
+        float channel = ((color >> shift) & 0xFF) / 255.0f;
+        result |= (uint32_t)(powf(channel, 2.6f) * 255.0f + 0.5f) << shift;
+    }
+    return result;
+}
+
+// --- OLED ---
+
+void Adafruit_SSD1306::display() {
+    // Il ritorno a capo finale di println() non fa parte del testo mostrato.
+    size_t length = _length;
+    if (length > 0 && _text[length - 1] == '\n') {
+        length--;
+    }
+    char text[SIM_OLED_BUFFER_LEN];
+    memcpy(text, _text, length);
+    text[length] = '\0';
+    simBoard.oledShow(_wire->getBus(), text);
+}
+
+size_t Adafruit_SSD1306::print(const char* text) {
+    size_t length = strlen(text);
+    if (length > SIM_OLED_BUFFER_LEN - 1 - _length) {
+        length = SIM_OLED_BUFFER_LEN - 1 - _length;
+    }
+    memcpy(_text + _length, text, length);
+    _length += length;
+    _text[_length] = '\0';
+    return length;
+}
+
+// --- RTC ---
+
+static const char* const MONTH_NAMES = "JanFebMarAprMayJunJulAugSepOctNovDec";
+
+// Conversioni tra giorni dal 1970 e data civile (calendario gregoriano).
+static int32_t daysFromCivil(int32_t y, uint32_t m, uint32_t d) {
+    y -= m <= 2;
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t)(y - era * 400);
+    uint32_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int32_t)doe - 719468;
+}
+
+DateTime::DateTime(uint32_t unixTime) {
+    setUnixTime(unixTime);
+}
+
+DateTime::DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) :
+    _year(year), _month(month), _day(day), _hour(hour), _minute(minute), _second(second) {}
+
+DateTime::DateTime(const char* date, const char* time) {
+    const char* month = strstr(MONTH_NAMES, std::string(date, 3).c_str());
+    _month = month != nullptr ? (uint8_t)((month - MONTH_NAMES) / 3 + 1) : 1;
+    _day = (uint8_t)atoi(date + 4);
+    _year = (uint16_t)atoi(date + 7);
+    _hour = (uint8_t)atoi(time);
+    _minute = (uint8_t)atoi(time + 3);
+    _second = (uint8_t)atoi(time + 6);
+}
+
+void DateTime::setUnixTime(uint32_t unixTime) {
+    int32_t days = (int32_t)(unixTime / 86400);
+    uint32_t seconds = unixTime % 86400;
+    _hour = seconds / 3600;
+    _minute = seconds / 60 % 60;
+    _second = seconds % 60;
+
+    int32_t z = days + 719468;
+    int32_t era = z / 146097;
+    uint32_t doe = (uint32_t)(z - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+    _day = (uint8_t)(doy - (153 * mp + 2) / 5 + 1);
+    _month = (uint8_t)(mp < 10 ? mp + 3 : mp - 9);
+    _year = (uint16_t)((int32_t)yoe + era * 400 + (_month <= 2));
+}
+
+uint32_t DateTime::unixtime() const {
+    return (uint32_t)daysFromCivil(_year, _month, _day) * 86400UL + _hour * 3600UL + _minute * 60UL + _second;
+}
+
+DateTime RTC_DS3231::now() {
+    return DateTime(simBoard.rtcNow());
+}
+
+void RTC_DS3231::adjust(const DateTime& time) {
+    simBoard.setRtcEpoch(time.unixtime() - simBoard.millis() / 1000);
+}
+
+// --- Lettore RFID ---
+
+bool PN532::readPassiveTargetID(uint8_t cardBaudRate, uint8_t* uid, uint8_t* uidLength, uint16_t timeout) {
+    (void)cardBaudRate;
+    *uidLength = simBoard.readCard(uid);
+    if (*uidLength == 0) {
+        simBoard.advanceMs(timeout);    // La chiamata vera attende la card fino al timeout
+        return false;
+    }
+    return true;
+}
+
+// --- SPIFFS ---
+
+typedef std::vector<uint8_t> FileData;
+
+// Tutti i file, per la durata del processo.
+static std::map<std::string, FileData>& fileStore() {
+    static std::map<std::string, FileData> store;
+    return store;
+}
+
+size_t File::size() const {
+    return _data != nullptr ? static_cast<FileData*>(_data)->size() : 0;
+}
+
+size_t File::read(uint8_t* buffer, size_t length) {
+    if (_data == nullptr) {
+        return 0;
+    }
+    FileData& data = *static_cast<FileData*>(_data);
+    size_t count = _position < data.size() ? std::min(length, data.size() - _position) : 0;
+    memcpy(buffer, data.data() + _position, count);
+    _position += count;
+    return count;
+}
+
+size_t File::write(const uint8_t* buffer, size_t length) {
+    if (_data == nullptr) {
+        return 0;
+    }
+    FileData& data = *static_cast<FileData*>(_data);
+    if (data.size() < _position + length) {
+        data.resize(_position + length);
+    }
+    memcpy(data.data() + _position, buffer, length);
+    _position += length;
+    return length;
+}
+
+bool File::seek(uint32_t position, SeekMode mode) {
+    if (_data == nullptr) {
+        return false;
+    }
+    size_t base = mode == SeekSet ? 0 : mode == SeekCur ? _position : size();
+    if (base + position > size()) {
+        return false;
+    }
+    _position = base + position;
+    return true;
+}
+
+bool SPIFFSFS::exists(const char* path) {
+    return fileStore().count(path) > 0;
+}
+
+File SPIFFSFS::open(const char* path, const char* mode) {
+    if (mode[0] == 'w') {
+        FileData& data = fileStore()[path];
+        data.clear();
+        return File(&data);
+    }
+    auto found = fileStore().find(path);
+    return found != fileStore().end() ? File(&found->second) : File();
+}
+
+// --- Preferences ---
+
+typedef std::map<std::string, std::vector<uint8_t>> PreferenceSpace;
+
+// Tutti gli spazi dei nomi, per la durata del processo.
+static std::map<std::string, PreferenceSpace>& preferenceStore() {
+    static std::map<std::string, PreferenceSpace> store;
+    return store;
+}
+
+bool Preferences::begin(const char* name, bool readOnly) {
+    _namespace = &preferenceStore()[name];
+    _readOnly = readOnly;
+    return true;
+}
+
+bool Preferences::clear() {
+    if (_namespace == nullptr || _readOnly) {
+        return false;
+    }
+    static_cast<PreferenceSpace*>(_namespace)->clear();
+    return true;
+}
+
+bool Preferences::remove(const char* key) {
+    if (_namespace == nullptr || _readOnly) {
+        return false;
+    }
+    return static_cast<PreferenceSpace*>(_namespace)->erase(key) > 0;
+}
+
+bool Preferences::isKey(const char* key) {
+    return _namespace != nullptr && static_cast<PreferenceSpace*>(_namespace)->count(key) > 0;
+}
+
+size_t Preferences::putBytes(const char* key, const void* value, size_t length) {
+    if (_namespace == nullptr || _readOnly) {
+        return 0;
+    }
+    const uint8_t* bytes = static_cast<const uint8_t*>(value);
+    (*static_cast<PreferenceSpace*>(_namespace))[key].assign(bytes, bytes + length);
+    return length;
+}
+
+size_t Preferences::getBytesLength(const char* key) {
+    if (_namespace == nullptr) {
+        return 0;
+    }
+    PreferenceSpace& space = *static_cast<PreferenceSpace*>(_namespace);
+    PreferenceSpace::const_iterator entry = space.find(key);
+    return entry != space.end() ? entry->second.size() : 0;
+}
+
+size_t Preferences::getBytes(const char* key, void* buffer, size_t length) {
+    size_t stored = getBytesLength(key);
+    if (stored == 0 || stored > length) {
+        return 0;
+    }
+    memcpy(buffer, (*static_cast<PreferenceSpace*>(_namespace))[key].data(), stored);
+    return stored;
+}
+
+String Preferences::getString(const char* key, const String& defaultValue) {
+    size_t stored = getBytesLength(key);
+    if (stored == 0) {
+        return defaultValue;
+    }
+    const std::vector<uint8_t>& value = (*static_cast<PreferenceSpace*>(_namespace))[key];
+    return String((const char*)value.data());
+}
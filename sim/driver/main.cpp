@@ -0,0 +1,213 @@
+// sim/driver/main.cpp
+
+/**
+ * @file main.cpp
+ * @brief Partite simulate sull'host di Cerca & Distruggi e Dominio.
+ * @details Esecuzione: pio run -e native && .pio/build/native/program [partite] [passo ms]
+ * Il dispositivo simulato (SimGame) gioca in sequenza, per il numero di partite
+ * indicato (predefinito 1000), cinque copioni completi dal menu principale al
+ * ritorno nel menu:
+ * 1. C&D disinnescata: innesco con PIN, un PIN di disinnesco errato, poi quello giusto;
+ * 2. C&D esplosa: innesco con PIN, il timer della bomba arriva a zero;
+ * 3. Dominio a tempo: la squadra 1 conquista la zona e vince allo scadere;
+ * 4. Dominio interrotto: CMD:FORCE_END_GAME durante una conquista della squadra 2;
+ * 5. C&D con la timeline degli effetti piena: il PIN errato arriva a coda
+ *    piena, il tastierino deve tornare attivo e il PIN giusto disinnescare.
+ * Le impostazioni sono le più brevi accettate (1 minuto di partita, 1 secondo di
+ * innesco, disinnesco, conquista e conto alla rovescia). Ogni copione verifica
+ * lo stato dell'applicazione e gli eventi inviati al server. Il tempo simulato
+ * avanza a passi di DEFAULT_TICK_MS (1 per la cadenza del dispositivo) e di
+ * COARSE_TICK_MS nelle attese senza ingressi. Alla fine si stampano partite al
+ * secondo, rapporto tra tempo simulato e tempo reale e il riassunto del
+ * Profiler per stato. Il programma termina con codice 1 alla prima partita che
+ * non segue il copione.
+ */
+
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include "SimGame.h"
+#include "Profiler.h"
+#include "GameModes/SearchDestroySettings.h"
+#include "GameModes/DominationSettings.h"
+
+static const int DEFAULT_ROUNDS = 1000;
+static const uint32_t DEFAULT_TICK_MS = 10;    // Ben sotto l'anti-rimbalzo (50 ms) e i tempi di gioco
+static const uint32_t COARSE_TICK_MS = 250;    // Attese senza ingressi: i timer di gioco contano secondi
+static const uint32_t ACTION_MS = 1000;        // Innesco, disinnesco, conquista e conto alla rovescia
+static const uint32_t ACTION_MARGIN_MS = 100;
+static const uint32_t ARMED_DELAY_MS = 1000;   // Pausa tra innesco e avvio del timer della bomba
+static const uint32_t WRONG_PIN_MESSAGE_MS = 2500;   // Tono di errore (500 ms) e messaggio (2 s)
+static const uint32_t GAME_MS = 60000;
+static const uint16_t FILL_TONE_HZ = 400;      // Passi che riempiono la timeline degli effetti
+static const uint16_t FILL_STEP_MS = 10;
+static const char* const ARM_PIN = "1234";
+static const char* const DEFUSE_PIN = "4321";
+
+static int failures = 0;
+
+static void expect(bool condition, const char* what, int round) {
+    if (!condition) {
+        printf("ERRORE (partita %d): %s\n", round, what);
+        failures++;
+    }
+}
+
+/** @brief Impostazioni brevi, salvate come dal menu: le modalità le caricano alla costruzione. */
+static void configureSettings() {
+    SearchDestroySettings sd;
+    sd.setBombTime(GAME_MS / 60000);
+    sd.setArmingTime(ACTION_MS / 1000);
+    sd.setDefuseTime(ACTION_MS / 1000);
+    sd.setArmingPin(ARM_PIN);
+    sd.setDisarmingPin(DEFUSE_PIN);
+    sd.setUseArmingPin(true);
+    sd.setUseDisarmingPin(true);
+    sd.saveParameters();
+
+    DominationSettings dom;
+    dom.setGameDuration(GAME_MS / 60000);
+    dom.setCaptureTime(ACTION_MS / 1000);
+    dom.setCountdownDuration(ACTION_MS / 1000);
+    dom.saveParameters();
+}
+
+/** @brief Dal sottomenu della modalità: "Inizia Partita" e conferma. */
+static void startGame(SimGame& game) {
+    game.press(2);
+    game.press(2);
+}
+
+/** @brief Ritorno al menu principale da una partita conclusa. */
+static void leaveGame(SimGame& game, int round) {
+    game.press(1);
+    expect(game.getAppState() == APP_STATE_MAIN_MENU, "ritorno al menu principale", round);
+    game.step();
+    expect(game.modes().getActive() == nullptr, "modalità distrutta nel menu principale", round);
+}
+
+static void armBomb(SimGame& game, int round) {
+    game.hold(1, ACTION_MS + ACTION_MARGIN_MS);
+    expect(simBoard.lcdRow(0).find("INSERIRE PIN INNESCO") != std::string::npos, "richiesta del PIN di innesco", round);
+    game.type(ARM_PIN);
+    game.run(ARMED_DELAY_MS + ACTION_MARGIN_MS);
+    expect(simBoard.logContains(SIM_NETWORK, "event:bomb_armed;"), "bomba innescata", round);
+}
+
+static void playDefusedRound(SimGame& game, int round) {
+    game.enterMode(APP_STATE_SEARCH_DESTROY_MODE);
+    startGame(game);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_start;"), "inizio partita C&D", round);
+    armBomb(game, round);
+
+    game.hold(2, ACTION_MS + ACTION_MARGIN_MS);
+    game.type("0000");
+    expect(simBoard.logContains(SIM_NETWORK, "event:defuse_pin_wrong;"), "PIN di disinnesco errato", round);
+    game.run(WRONG_PIN_MESSAGE_MS + ACTION_MARGIN_MS);
+    game.type(DEFUSE_PIN);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_end;winner:counter-terrorists;"), "vittoria CT", round);
+    leaveGame(game, round);
+}
+
+static void playExplodedRound(SimGame& game, int round) {
+    game.enterMode(APP_STATE_SEARCH_DESTROY_MODE);
+    startGame(game);
+    armBomb(game, round);
+    game.run(GAME_MS + ACTION_MARGIN_MS, COARSE_TICK_MS);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_end;winner:terrorists;"), "vittoria T", round);
+    expect(simBoard.lcdRow(1).find("BOMBA ESPLOSA!") != std::string::npos, "schermata dell'esplosione", round);
+    leaveGame(game, round);
+}
+
+static void playDominationRound(SimGame& game, int round) {
+    game.enterMode(APP_STATE_DOMINATION_MODE);
+    startGame(game);
+    game.run(ACTION_MS + ACTION_MARGIN_MS);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_start;"), "inizio partita Dominio", round);
+    game.hold(1, ACTION_MS + ACTION_MARGIN_MS);
+    expect(simBoard.logContains(SIM_NETWORK, "event:zone_captured;team:1;"), "conquista della squadra 1", round);
+    game.run(GAME_MS, COARSE_TICK_MS);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_end;winner:1"), "vittoria della squadra 1", round);
+    leaveGame(game, round);
+}
+
+static void playForcedRound(SimGame& game, int round) {
+    game.enterMode(APP_STATE_DOMINATION_MODE);
+    startGame(game);
+    game.run(ACTION_MS + ACTION_MARGIN_MS);
+    simBoard.setButton(2, true);
+    game.run(SIM_SETTLE_MS + ACTION_MS / 2);
+    game.command("CMD:FORCE_END_GAME;");
+    simBoard.setButton(2, false);
+    game.run(SIM_SETTLE_MS);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_end;winner:0"), "fine forzata in parità", round);
+    leaveGame(game, round);
+}
+
+static void playFullTimelineRound(SimGame& game, int round) {
+    game.enterMode(APP_STATE_SEARCH_DESTROY_MODE);
+    startGame(game);
+    armBomb(game, round);
+
+    game.hold(2, ACTION_MS + ACTION_MARGIN_MS);
+    EffectTimeline& effects = game.hardware().effects();
+    uint32_t dropped = effects.getDroppedCount();
+    for (int i = 0; i < EFFECT_TIMELINE_CAPACITY; i++) {
+        effects.tone(FILL_TONE_HZ, FILL_STEP_MS);
+    }
+    // Il messaggio del PIN errato non trova posto, la sua fine sì.
+    game.type("0000");
+    expect(simBoard.logContains(SIM_NETWORK, "event:defuse_pin_wrong;"), "PIN errato a timeline piena", round);
+    expect(effects.getDroppedCount() > dropped, "timeline degli effetti piena", round);
+    game.run(EFFECT_TIMELINE_CAPACITY * FILL_STEP_MS + WRONG_PIN_MESSAGE_MS + ACTION_MARGIN_MS);
+    game.type(DEFUSE_PIN);
+    expect(simBoard.logContains(SIM_NETWORK, "event:game_end;winner:counter-terrorists;"),
+           "tastierino di nuovo attivo dopo il messaggio", round);
+    leaveGame(game, round);
+}
+
+typedef void (*Scenario)(SimGame& game, int round);
+
+int main(int argc, char** argv) {
+    int rounds = argc > 1 ? atoi(argv[1]) : DEFAULT_ROUNDS;
+    if (rounds <= 0) {
+        rounds = DEFAULT_ROUNDS;
+    }
+    uint32_t tickMs = argc > 2 ? (uint32_t)atoi(argv[2]) : DEFAULT_TICK_MS;
+    configureSettings();
+
+    const Scenario scenarios[] = { playDefusedRound, playExplodedRound, playDominationRound, playForcedRound,
+                                   playFullTimelineRound };
+    const int scenarioCount = sizeof(scenarios) / sizeof(scenarios[0]);
+
+    SimGame game;
+    game.setTickMs(tickMs);
+    // Solo gli eventi di rete: sono quelli verificati dai copioni.
+    simBoard.setLogMask(SIM_LOG_BIT(SIM_NETWORK));
+    profiler.reset();
+
+    uint64_t simulatedMs = 0;
+    int played = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (; played < rounds && failures == 0; played++) {
+        simBoard.clearLog();
+        uint32_t roundStart = simBoard.millis();
+        scenarios[played % scenarioCount](game, played);
+        simulatedMs += simBoard.millis() - roundStart;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    printf("Partite: %d in %.2f s (%.0f partite/s), passo %u ms, %u passate, tempo simulato %.0fx il reale\n",
+           played, seconds, played / seconds, game.getTickMs(), game.getPasses(), simulatedMs / 1000.0 / seconds);
+    printf("Ritorni al menu principale: %u\n", game.getMainMenuCount());
+    printf("%-28s %9s %9s %9s %9s %9s\n", "sonda", "n", "min us", "p50 us", "p99 us", "max us");
+    for (uint8_t i = 0; i < profiler.getProbeCount(); i++) {
+        ProfilerSummary summary;
+        profiler.summarize(i, summary);
+        if (summary.count > 0) {
+            printf("%-28s %9lu %9.2f %9.2f %9.2f %9.2f\n", summary.name, (unsigned long)summary.count,
+                   summary.minUs, summary.p50Us, summary.p99Us, summary.maxUs);
+        }
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+// sim/include/Adafruit_NeoPixel.h
+
+/**
+ * @file Adafruit_NeoPixel.h
+ * @brief Striscia LED per la simulazione sull'host.
+ * @details I colori restano nel buffer dell'oggetto e passano alla scheda
+ * virtuale a ogni show(), con la luminosità globale a parte (il buffer non
+ * viene riscalato come nella libreria vera).
+ */
+
+#ifndef SIM_ADAFRUIT_NEOPIXEL_H
+#define SIM_ADAFRUIT_NEOPIXEL_H
+
+#include <Arduino.h>
+
+#define NEO_GRB    ((1 << 6) | (1 << 4) | (0 << 2) | (2))
+#define NEO_KHZ800 0x0000
+
+class Adafruit_NeoPixel {
+public:
+    Adafruit_NeoPixel(uint16_t count, int16_t pin, uint16_t type);
+    ~Adafruit_NeoPixel();
+
+    void begin() {}
+    void show();
+    void clear() { fill(0, 0, 0); }
+    void fill(uint32_t color = 0, uint16_t first = 0, uint16_t count = 0);
+    void setPixelColor(uint16_t n, uint32_t color);
+    void setPixelColor(uint16_t n, uint8_t r, uint8_t g, uint8_t b) { setPixelColor(n, Color(r, g, b)); }
+    uint32_t getPixelColor(uint16_t n) const { return n < _count ? _pixels[n] : 0; }
+    uint16_t numPixels() const { return _count; }
+    void setBrightness(uint8_t brightness) { _brightness = brightness; }
+    uint8_t getBrightness() const { return _brightness; }
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) {
+        return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+    }
+    static uint32_t ColorHSV(uint16_t hue, uint8_t sat = 255, uint8_t val = 255);
+    static uint32_t gamma32(uint32_t color);
+
+private:
+    uint16_t _count;
+    uint32_t* _pixels;
+    uint8_t _brightness;
+};
+
+#endif // SIM_ADAFRUIT_NEOPIXEL_H
@@ -0,0 +1,48 @@
+// sim/include/Adafruit_SSD1306.h
+
+/**
+ * @file Adafruit_SSD1306.h
+ * @brief Display OLED per la simulazione sull'host: conserva solo il testo.
+ * @details display() pubblica sulla scheda virtuale il testo stampato dall'ultimo
+ * clearDisplay(); l'OLED è riconosciuto dal bus I2C (Wire = OLED 1).
+ */
+
+#ifndef SIM_ADAFRUIT_SSD1306_H
+#define SIM_ADAFRUIT_SSD1306_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+#define SSD1306_SWITCHCAPVCC 0x02
+#define SSD1306_BLACK 0
+#define SSD1306_WHITE 1
+
+#define SIM_OLED_BUFFER_LEN 64
+
+class Adafruit_SSD1306 {
+public:
+    Adafruit_SSD1306(uint8_t width, uint8_t height, TwoWire* wire, int8_t resetPin) :
+        _wire(wire), _length(0)
+    {
+        (void)width; (void)height; (void)resetPin;
+        _text[0] = '\0';
+    }
+
+    bool begin(uint8_t vcc, uint8_t address) { (void)vcc; (void)address; return true; }
+    void clearDisplay() { _length = 0; _text[0] = '\0'; }
+    void display();
+    void setTextSize(uint8_t size) { (void)size; }
+    void setTextColor(uint16_t color) { (void)color; }
+    void setCursor(int16_t x, int16_t y) { (void)x; (void)y; }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(const char* text);
+    size_t println(const String& text) { return print(text.c_str()) + print("\n"); }
+    size_t println(const char* text) { return print(text) + print("\n"); }
+
+private:
+    TwoWire* _wire;
+    size_t _length;
+    char _text[SIM_OLED_BUFFER_LEN];
+};
+
+#endif // SIM_ADAFRUIT_SSD1306_H
@@ -0,0 +1,171 @@
+// sim/include/Arduino.h
+
+/**
+ * @file Arduino.h
+ * @brief Nucleo di Arduino per la simulazione sull'host (vedi sim/SimBoard.h).
+ * @details Solo la parte usata dal firmware: tipi, pin, tempo, String, Serial e
+ * LEDC. Tempo e pin sono quelli della scheda virtuale. String alloca sull'heap
+ * come quella dell'ESP32: fino a SIM_STRING_SSO_LEN caratteri il testo sta
+ * nell'oggetto, oltre va in un buffer che cresce alla misura richiesta. Così i
+ * conteggi di allocazione misurati sull'host valgono anche per il dispositivo.
+ * ARDUINO resta non definita: il codice che legge registri dell'ESP32 (es. il
+ * contatore di cicli del Profiler) usa la sua variante per l'host.
+ */
+
+#ifndef SIM_ARDUINO_H
+#define SIM_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <math.h>
+#include <algorithm>
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 0x1
+#define LOW  0x0
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+#define HEX 16
+#define DEC 10
+
+/** @brief Caratteri di un String senza allocazione: il buffer interno di WString su 32 bit, meno il terminatore. */
+#define SIM_STRING_SSO_LEN 10
+
+#define F(text) (text)
+#define PROGMEM
+
+// Costanti binarie usate dai caratteri personalizzati dell'LCD
+#define B10000 16
+#define B11000 24
+#define B11100 28
+#define B11110 30
+#define B11111 31
+
+using std::min;
+using std::max;
+
+// --- Tempo (orologio virtuale) ---
+unsigned long millis();
+unsigned long micros();
+/** @brief Fa avanzare l'orologio virtuale: sull'host non attende. */
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// --- Pin ---
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t level);
+int analogRead(uint8_t pin);
+
+long map(long x, long inMin, long inMax, long outMin, long outMax);
+
+// --- LEDC (buzzer) ---
+double ledcSetup(uint8_t channel, double frequency, uint8_t resolution);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcWrite(uint8_t channel, uint32_t duty);
+double ledcWriteTone(uint8_t channel, double frequency);
+
+/**
+ * @class String
+ * @brief Testo dinamico con l'interfaccia di WString dell'ESP32.
+ */
+class String {
+public:
+    String(const char* text = "");
+    String(const String& other);
+    String(String&& other) noexcept;
+    explicit String(char c);
+    explicit String(unsigned char value, unsigned char base = 10);
+    explicit String(int value, unsigned char base = 10);
+    explicit String(unsigned int value, unsigned char base = 10);
+    explicit String(long value, unsigned char base = 10);
+    explicit String(unsigned long value, unsigned char base = 10);
+    explicit String(double value, unsigned int decimals = 2);
+    ~String();
+
+    String& operator=(const String& other);
+    String& operator=(String&& other) noexcept;
+    String& operator=(const char* text);
+
+    String& operator+=(const String& other) { return concat(other._buffer, other._length); }
+    String& operator+=(const char* text) { return concat(text, strlen(text)); }
+    String& operator+=(char c) { return concat(&c, 1); }
+    String& operator+=(int value) { return *this += String(value); }
+    String& operator+=(unsigned int value) { return *this += String(value); }
+    String& operator+=(long value) { return *this += String(value); }
+    String& operator+=(unsigned long value) { return *this += String(value); }
+
+    bool operator==(const String& other) const { return equals(other._buffer); }
+    bool operator==(const char* text) const { return equals(text); }
+    bool operator!=(const String& other) const { return !equals(other._buffer); }
+    bool operator!=(const char* text) const { return !equals(text); }
+    char operator[](unsigned int index) const { return index < _length ? _buffer[index] : '\0'; }
+
+    unsigned int length() const { return _length; }
+    const char* c_str() const { return _buffer; }
+    bool reserve(unsigned int size);
+    bool equals(const char* text) const { return strcmp(_buffer, text != nullptr ? text : "") == 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+    int indexOf(char c, unsigned int from = 0) const;
+    int indexOf(const char* text, unsigned int from = 0) const;
+    String substring(unsigned int from, unsigned int to = (unsigned int)-1) const;
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1);
+    void toUpperCase();
+    void toLowerCase();
+    void trim();
+    long toInt() const { return atol(_buffer); }
+    float toFloat() const { return (float)atof(_buffer); }
+
+private:
+    String& concat(const char* text, size_t length);
+    void assign(const char* text, size_t length);
+
+    bool isHeap() const { return _buffer != _sso; }
+    void takeFrom(String& other);
+
+    char* _buffer;          // _sso o un buffer sull'heap; sempre terminato
+    unsigned int _length;
+    unsigned int _capacity; // Caratteri disponibili, terminatore escluso
+    char _sso[SIM_STRING_SSO_LEN + 1];
+};
+
+String operator+(const String& left, const String& right);
+String operator+(const String& left, const char* right);
+String operator+(const char* left, const String& right);
+String operator+(const String& left, char right);
+
+/**
+ * @class HardwareSerial
+ * @brief Seriale di debug: il testo passa alla scheda virtuale (stdout solo con l'eco attiva).
+ */
+class HardwareSerial {
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    size_t write(const char* text, size_t length);
+    size_t print(const String& text) { return write(text.c_str(), text.length()); }
+    size_t print(const char* text) { return write(text, strlen(text)); }
+    size_t print(char c) { return write(&c, 1); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+    size_t println() { return write("\r\n", 2); }
+    template <typename T>
+    size_t println(T value) { return print(value) + println(); }
+    template <typename T>
+    size_t println(T value, int format) { return print(value, format) + println(); }
+    size_t printf(const char* format, ...) __attribute__((format(printf, 2, 3)));
+};
+
+extern HardwareSerial Serial;
+
+#endif // SIM_ARDUINO_H
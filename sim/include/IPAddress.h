@@ -0,0 +1,33 @@
+// sim/include/IPAddress.h
+
+/**
+ * @file IPAddress.h
+ * @brief Indirizzo IPv4 per la simulazione sull'host.
+ */
+
+#ifndef SIM_IP_ADDRESS_H
+#define SIM_IP_ADDRESS_H
+
+#include <Arduino.h>
+
+class IPAddress {
+public:
+    IPAddress() : _address(0) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) :
+        _address((uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24)) {}
+    IPAddress(uint32_t address) : _address(address) {}
+
+    operator uint32_t() const { return _address; }
+    uint8_t operator[](int index) const { return (uint8_t)(_address >> (8 * index)); }
+    bool operator==(const IPAddress& other) const { return _address == other._address; }
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(text);
+    }
+
+private:
+    uint32_t _address;  // Ordine di rete, come sull'ESP32
+};
+
+#endif // SIM_IP_ADDRESS_H
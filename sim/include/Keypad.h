@@ -0,0 +1,26 @@
+// sim/include/Keypad.h
+
+/**
+ * @file Keypad.h
+ * @brief Tastierino a matrice per la simulazione sull'host.
+ * @details getKey() consegna i tasti accodati nella scheda virtuale con
+ * SimBoard::typeKey(), uno per chiamata, come un tasto premuto e rilasciato.
+ */
+
+#ifndef SIM_KEYPAD_H
+#define SIM_KEYPAD_H
+
+#include <Arduino.h>
+
+#define NO_KEY '\0'
+#define makeKeymap(x) ((char*)x)
+
+class Keypad {
+public:
+    Keypad(char* userKeymap, byte* rowPins, byte* colPins, byte numRows, byte numCols) {
+        (void)userKeymap; (void)rowPins; (void)colPins; (void)numRows; (void)numCols;
+    }
+    char getKey();
+};
+
+#endif // SIM_KEYPAD_H
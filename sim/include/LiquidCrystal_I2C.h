@@ -0,0 +1,31 @@
+// sim/include/LiquidCrystal_I2C.h
+
+/**
+ * @file LiquidCrystal_I2C.h
+ * @brief LCD a caratteri per la simulazione sull'host: scrive nella memoria dati della scheda virtuale.
+ */
+
+#ifndef SIM_LIQUID_CRYSTAL_I2C_H
+#define SIM_LIQUID_CRYSTAL_I2C_H
+
+#include <Arduino.h>
+
+class LiquidCrystal_I2C {
+public:
+    LiquidCrystal_I2C(uint8_t address, uint8_t cols, uint8_t rows) {
+        (void)address; (void)cols; (void)rows;
+    }
+    void init() {}
+    void begin() {}
+    void backlight() {}
+    void noBacklight() {}
+    void clear();
+    void home() { setCursor(0, 0); }
+    void setCursor(uint8_t col, uint8_t row);
+    void createChar(uint8_t location, uint8_t charmap[]);
+    size_t write(uint8_t value);
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t print(const char* text);
+};
+
+#endif // SIM_LIQUID_CRYSTAL_I2C_H
@@ -0,0 +1,29 @@
+// sim/include/PN532.h
+
+/**
+ * @file PN532.h
+ * @brief Lettore RFID/NFC per la simulazione sull'host.
+ * @details Legge la card avvicinata con SimBoard::presentCard(). Senza card la
+ * ricerca fa trascorrere il suo timeout sull'orologio virtuale, come la
+ * chiamata bloccante della libreria vera.
+ */
+
+#ifndef SIM_PN532_H
+#define SIM_PN532_H
+
+#include <Arduino.h>
+#include "PN532_I2C.h"
+
+#define PN532_MIFARE_ISO14443A 0x00
+
+class PN532 {
+public:
+    explicit PN532(PN532_I2C& interface) { (void)interface; }
+    void begin() {}
+    /** @brief Chip PN532, firmware 1.6. */
+    uint32_t getFirmwareVersion() { return 0x32010607; }
+    bool SAMConfig() { return true; }
+    bool readPassiveTargetID(uint8_t cardBaudRate, uint8_t* uid, uint8_t* uidLength, uint16_t timeout = 0);
+};
+
+#endif // SIM_PN532_H
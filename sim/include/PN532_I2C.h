@@ -0,0 +1,18 @@
+// sim/include/PN532_I2C.h
+
+/**
+ * @file PN532_I2C.h
+ * @brief Interfaccia I2C del lettore PN532 per la simulazione sull'host.
+ */
+
+#ifndef SIM_PN532_I2C_H
+#define SIM_PN532_I2C_H
+
+#include <Wire.h>
+
+class PN532_I2C {
+public:
+    explicit PN532_I2C(TwoWire& wire) { (void)wire; }
+};
+
+#endif // SIM_PN532_I2C_H
@@ -0,0 +1,52 @@
+// sim/include/Preferences.h
+
+/**
+ * @file Preferences.h
+ * @brief Memoria non volatile per la simulazione sull'host.
+ * @details Gli spazi dei nomi stanno in memoria per tutta la durata del
+ * processo: sopravvivono a SimBoard::reset() come la flash a un riavvio.
+ */
+
+#ifndef SIM_PREFERENCES_H
+#define SIM_PREFERENCES_H
+
+#include <Arduino.h>
+
+class Preferences {
+public:
+    Preferences() : _namespace(nullptr), _readOnly(true) {}
+
+    bool begin(const char* name, bool readOnly = false);
+    void end() { _namespace = nullptr; }
+    bool clear();
+    bool remove(const char* key);
+    bool isKey(const char* key);
+
+    size_t putBool(const char* key, bool value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUChar(const char* key, uint8_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putInt(const char* key, int32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putUInt(const char* key, uint32_t value) { return putBytes(key, &value, sizeof(value)); }
+    size_t putString(const char* key, const String& value) { return putBytes(key, value.c_str(), value.length() + 1); }
+    size_t putString(const char* key, const char* value) { return putBytes(key, value, strlen(value) + 1); }
+    size_t putBytes(const char* key, const void* value, size_t length);
+
+    bool getBool(const char* key, bool defaultValue = false) { return getValue(key, defaultValue); }
+    uint8_t getUChar(const char* key, uint8_t defaultValue = 0) { return getValue(key, defaultValue); }
+    int32_t getInt(const char* key, int32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    uint32_t getUInt(const char* key, uint32_t defaultValue = 0) { return getValue(key, defaultValue); }
+    String getString(const char* key, const String& defaultValue = String());
+    size_t getBytesLength(const char* key);
+    size_t getBytes(const char* key, void* buffer, size_t length);
+
+private:
+    template <typename T>
+    T getValue(const char* key, T defaultValue) {
+        T value;
+        return getBytes(key, &value, sizeof(value)) == sizeof(value) ? value : defaultValue;
+    }
+
+    void* _namespace;   // Spazio dei nomi aperto (vedi sim/SimLibraries.cpp)
+    bool _readOnly;
+};
+
+#endif // SIM_PREFERENCES_H
@@ -0,0 +1,64 @@
+// sim/include/RTClib.h
+
+/**
+ * @file RTClib.h
+ * @brief Orologio DS3231 per la simulazione sull'host: segue l'orologio virtuale.
+ * @details now() è l'ora Unix della scheda virtuale (SimBoard::rtcNow()), che
+ * avanza di un secondo ogni 1000 ms di millis(), come sul dispositivo.
+ */
+
+#ifndef SIM_RTCLIB_H
+#define SIM_RTCLIB_H
+
+#include <Arduino.h>
+#include <Wire.h>
+
+class TimeSpan {
+public:
+    TimeSpan(int32_t seconds = 0) : _seconds(seconds) {}
+    int16_t days() const { return _seconds / 86400L; }
+    int8_t hours() const { return _seconds / 3600 % 24; }
+    int8_t minutes() const { return _seconds / 60 % 60; }
+    int8_t seconds() const { return _seconds % 60; }
+    int32_t totalseconds() const { return _seconds; }
+
+private:
+    int32_t _seconds;
+};
+
+class DateTime {
+public:
+    /** @brief Ora Unix (secondi dal 1970). */
+    DateTime(uint32_t unixTime = 946684800UL);
+    DateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour = 0, uint8_t minute = 0, uint8_t second = 0);
+    /** @brief Da __DATE__ ("Mmm dd yyyy") e __TIME__ ("hh:mm:ss"). */
+    DateTime(const char* date, const char* time);
+
+    uint16_t year() const { return _year; }
+    uint8_t month() const { return _month; }
+    uint8_t day() const { return _day; }
+    uint8_t hour() const { return _hour; }
+    uint8_t minute() const { return _minute; }
+    uint8_t second() const { return _second; }
+    uint32_t unixtime() const;
+
+    TimeSpan operator-(const DateTime& right) const {
+        return TimeSpan((int32_t)(unixtime() - right.unixtime()));
+    }
+
+private:
+    void setUnixTime(uint32_t unixTime);
+
+    uint16_t _year;
+    uint8_t _month, _day, _hour, _minute, _second;
+};
+
+class RTC_DS3231 {
+public:
+    bool begin(TwoWire* wire = &Wire) { (void)wire; return true; }
+    DateTime now();
+    bool lostPower() { return false; }
+    void adjust(const DateTime& time);
+};
+
+#endif // SIM_RTCLIB_H
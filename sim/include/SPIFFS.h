@@ -0,0 +1,46 @@
+// sim/include/SPIFFS.h
+
+/**
+ * @file SPIFFS.h
+ * @brief File system in flash per la simulazione sull'host.
+ * @details I file stanno in memoria per tutta la durata del processo, come gli
+ * spazi dei nomi di Preferences: sopravvivono a SimBoard::reset() come la
+ * flash a un riavvio. Solo le operazioni usate da EventJournal.
+ */
+
+#ifndef SIM_SPIFFS_H
+#define SIM_SPIFFS_H
+
+#include <Arduino.h>
+
+enum SeekMode { SeekSet = 0, SeekCur = 1, SeekEnd = 2 };
+
+class File {
+public:
+    File() : _data(nullptr), _position(0) {}
+    explicit File(void* data) : _data(data), _position(0) {}
+
+    explicit operator bool() const { return _data != nullptr; }
+    size_t size() const;
+    size_t read(uint8_t* buffer, size_t length);
+    size_t write(const uint8_t* buffer, size_t length);
+    bool seek(uint32_t position, SeekMode mode);
+    void flush() {}
+    void close() { _data = nullptr; }
+
+private:
+    void* _data;        // Contenuto del file (vedi sim/SimLibraries.cpp)
+    size_t _position;
+};
+
+class SPIFFSFS {
+public:
+    bool begin(bool formatOnFail = false) { (void)formatOnFail; return true; }
+    bool exists(const char* path);
+    /** @brief "r", "r+" aprono un file esistente; "w", "w+" lo creano vuoto. */
+    File open(const char* path, const char* mode);
+};
+
+extern SPIFFSFS SPIFFS;
+
+#endif // SIM_SPIFFS_H
@@ -0,0 +1,30 @@
+// sim/include/Wire.h
+
+/**
+ * @file Wire.h
+ * @brief Bus I2C per la simulazione sull'host: solo il numero del bus.
+ * @details I dispositivi simulati scrivono direttamente sulla scheda virtuale;
+ * il bus serve a distinguere i due OLED (Wire = bus 0).
+ */
+
+#ifndef SIM_WIRE_H
+#define SIM_WIRE_H
+
+#include <Arduino.h>
+
+class TwoWire {
+public:
+    explicit TwoWire(uint8_t bus) : _bus(bus) {}
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) {
+        (void)sda; (void)scl; (void)frequency;
+        return true;
+    }
+    uint8_t getBus() const { return _bus; }
+
+private:
+    uint8_t _bus;
+};
+
+extern TwoWire Wire;
+
+#endif // SIM_WIRE_H
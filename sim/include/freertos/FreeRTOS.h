@@ -0,0 +1,24 @@
+// sim/include/freertos/FreeRTOS.h
+
+/**
+ * @file FreeRTOS.h
+ * @brief Tipi di FreeRTOS per la simulazione sull'host, che non ha un task di rete.
+ */
+
+#ifndef SIM_FREERTOS_H
+#define SIM_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define pdPASS  pdTRUE
+
+/** @brief Sull'host un tick vale un millisecondo. */
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif // SIM_FREERTOS_H
@@ -0,0 +1,31 @@
+// sim/include/freertos/task.h
+
+/**
+ * @file task.h
+ * @brief Task di FreeRTOS per la simulazione sull'host.
+ * @details Sull'host non si creano task: chi usa NetworkManager ne chiama
+ * runNetworkRound() a ogni passata. La creazione restituisce comunque un
+ * handle valido, così NetworkManager accetta gli eventi come sul dispositivo.
+ */
+
+#ifndef SIM_FREERTOS_TASK_H
+#define SIM_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+
+typedef void* TaskHandle_t;
+typedef void (*TaskFunction_t)(void*);
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t, const char*, uint32_t, void* param,
+                                          UBaseType_t, TaskHandle_t* handle, BaseType_t) {
+    if (handle != nullptr) {
+        *handle = param;
+    }
+    return pdPASS;
+}
+
+inline void xTaskNotifyGive(TaskHandle_t) {}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+
+#endif // SIM_FREERTOS_TASK_H
@@ -0,0 +1,187 @@
+// src/EffectTimeline.cpp
+
+/**
+ * @file EffectTimeline.cpp
+ * @brief Implementazione della classe EffectTimeline.
+ */
+
+#include "EffectTimeline.h"
+#include "HardwareManager.h"
+
+EffectTimeline::EffectTimeline(HardwareManager* hardware) :
+    _hardware(hardware),
+    _head(0),
+    _count(0),
+    _stripSteps(0),
+    _stepActive(false),
+    _stripSaved(false),
+    _stepStart(0),
+    _dropped(0)
+{
+}
+
+bool EffectTimeline::hasRoom(uint16_t steps) const {
+    return _count + steps <= EFFECT_TIMELINE_CAPACITY - EFFECT_TIMELINE_CALL_RESERVE;
+}
+
+EffectTimeline::Step* EffectTimeline::push(StepType type, uint16_t durationMs) {
+    // Gli ultimi posti restano ai call(): vedi EFFECT_TIMELINE_CALL_RESERVE.
+    uint8_t limit = (type == StepType::CALL) ? EFFECT_TIMELINE_CAPACITY
+                                             : EFFECT_TIMELINE_CAPACITY - EFFECT_TIMELINE_CALL_RESERVE;
+    if (_count >= limit) {
+        _dropped++;
+        return nullptr;
+    }
+    Step& step = _steps[(_head + _count) % EFFECT_TIMELINE_CAPACITY];
+    step.type = type;
+    step.r = step.g = step.b = 0;
+    step.durationMs = durationMs;
+    step.frequency = 0;
+    step.text = nullptr;
+    step.function = nullptr;
+    step.context = nullptr;
+    _count++;
+    if (isStripStep(type)) {
+        _stripSteps++;
+    }
+    return &step;
+}
+
+EffectTimeline& EffectTimeline::tone(uint16_t frequency, uint16_t durationMs) {
+    Step* step = push(StepType::TONE, durationMs);
+    if (step) step->frequency = frequency;
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::wait(uint16_t durationMs) {
+    push(StepType::WAIT, durationMs);
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::fill(uint8_t r, uint8_t g, uint8_t b, uint16_t holdMs) {
+    Step* step = push(StepType::FILL, holdMs);
+    if (step) { step->r = r; step->g = g; step->b = b; }
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::stripOff(uint16_t holdMs) {
+    push(StepType::STRIP_OFF, holdMs);
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::brightness(uint8_t value) {
+    Step* step = push(StepType::BRIGHTNESS, 0);
+    if (step) step->r = value;
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::flash(uint8_t count, uint16_t onMs, uint16_t offMs) {
+    // Tutto o niente: un salvataggio senza il suo ripristino lascerebbe la striscia
+    // accesa sul colore del lampeggio.
+    uint16_t steps = 2 + 2 * (uint16_t)count;
+    if (!hasRoom(steps)) {
+        _dropped += steps;
+        return *this;
+    }
+    push(StepType::STRIP_SAVE, 0);
+    for (uint8_t i = 0; i < count; i++) {
+        push(StepType::STRIP_FLASH, onMs);
+        push(StepType::STRIP_OFF, (i < count - 1) ? offMs : 0);
+    }
+    push(StepType::STRIP_RESTORE, 0);
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::lcdClear() {
+    push(StepType::LCD_CLEAR, 0);
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::lcdText(uint8_t col, uint8_t row, const char* text) {
+    Step* step = push(StepType::LCD_TEXT, 0);
+    if (step) { step->r = col; step->g = row; step->text = text; }
+    return *this;
+}
+
+EffectTimeline& EffectTimeline::call(EffectCallback function, void* context) {
+    Step* step = push(StepType::CALL, 0);
+    if (step) { step->function = function; step->context = context; }
+    else if (function) { function(context); }
+    return *this;
+}
+
+void EffectTimeline::update(unsigned long nowMs) {
+    // I passi senza durata si eseguono di seguito nella stessa chiamata.
+    while (_count > 0) {
+        Step& step = _steps[_head];
+        if (!_stepActive) {
+            _stepActive = true;
+            _stepStart = nowMs;
+            startStep(step);
+            // Un passo call() può aver cancellato la coda.
+            if (!_stepActive) {
+                continue;
+            }
+        }
+        if (nowMs - _stepStart < step.durationMs) {
+            return;
+        }
+        finishStep(step);
+        _stepActive = false;
+        _head = (_head + 1) % EFFECT_TIMELINE_CAPACITY;
+        _count--;
+    }
+}
+
+void EffectTimeline::cancel() {
+    if (_count > 0 && _stepActive && _steps[_head].type == StepType::TONE) {
+        _hardware->noTone();
+    }
+    if (_stripSaved) {
+        _hardware->restoreStrip();
+        _stripSaved = false;
+    }
+    _head = 0;
+    _count = 0;
+    _stripSteps = 0;
+    _stepActive = false;
+}
+
+void EffectTimeline::startStep(const Step& step) {
+    switch (step.type) {
+        case StepType::TONE:          _hardware->updateTone(step.frequency); break;
+        case StepType::WAIT:          break;
+        case StepType::FILL:          _hardware->setStripColor(step.r, step.g, step.b); break;
+        case StepType::STRIP_OFF:     _hardware->turnOffStrip(); break;
+        case StepType::BRIGHTNESS:    _hardware->setBrightness(step.r); break;
+        case StepType::STRIP_SAVE:    _hardware->saveStrip(); _stripSaved = true; break;
+        case StepType::STRIP_FLASH:   _hardware->restoreStrip(); _hardware->setBrightness(255); break;
+        case StepType::STRIP_RESTORE: _hardware->restoreStrip(); _stripSaved = false; break;
+        case StepType::LCD_CLEAR:     _hardware->clearLcd(); break;
+        case StepType::LCD_TEXT:      _hardware->printLcd(step.r, step.g, step.text); break;
+        case StepType::CALL:          step.function(step.context); break;
+    }
+}
+
+void EffectTimeline::finishStep(const Step& step) {
+    if (step.type == StepType::TONE) {
+        _hardware->noTone();
+    }
+    if (isStripStep(step.type)) {
+        _stripSteps--;
+    }
+}
+
+bool EffectTimeline::isStripStep(StepType type) {
+    switch (type) {
+        case StepType::FILL:
+        case StepType::STRIP_OFF:
+        case StepType::BRIGHTNESS:
+        case StepType::STRIP_SAVE:
+        case StepType::STRIP_FLASH:
+        case StepType::STRIP_RESTORE:
+            return true;
+        default:
+            return false;
+    }
+}
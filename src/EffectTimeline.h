@@ -0,0 +1,131 @@
+// src/EffectTimeline.h
+
+/**
+ * @file EffectTimeline.h
+ * @brief Dichiarazione della classe EffectTimeline, la coda non bloccante degli effetti di gioco.
+ * @details Le modalità non aspettano più con delay() la fine di un suono o di un
+ * lampeggio: accodano una sequenza di passi temporizzati e ritornano subito.
+ * Il loop() fa avanzare la sequenza con update() (lavoro "effects" dello Scheduler).
+ *
+ * Ogni passo esegue un'azione all'avvio e poi occupa la sequenza per la sua durata:
+ * tone(1000, 80).tone(1200, 80) suona due note una dopo l'altra, come facevano
+ * due playTone() bloccanti. Le sequenze accodate mentre un'altra è in corso
+ * partono quando questa finisce; cancel() le scarta tutte (es. a fine partita).
+ *
+ * Mentre restano passi sulla striscia LED, le animazioni continue di
+ * HardwareManager (arcobaleno, respiro, onda) si sospendono: vedi usesStrip().
+ */
+
+#ifndef EFFECT_TIMELINE_H
+#define EFFECT_TIMELINE_H
+
+#include <stdint.h>
+
+class HardwareManager;
+
+/** @brief Numero massimo di passi in coda. I passi oltre il limite vengono scartati. */
+#define EFFECT_TIMELINE_CAPACITY 48
+/**
+ * @brief Posti in coda riservati ai passi call().
+ * @details Le sequenze finiscono spesso con un call() che sblocca la modalità
+ * (es. la fine di un messaggio): una coda piena di suoni e lampeggi scarta
+ * questi ultimi, non il call().
+ */
+#define EFFECT_TIMELINE_CALL_RESERVE 4
+
+/** @brief Funzione eseguita da un passo call(); context è quello passato all'accodamento. */
+typedef void (*EffectCallback)(void* context);
+
+class EffectTimeline {
+public:
+    explicit EffectTimeline(HardwareManager* hardware);
+
+    // --- Passi accodabili (ritornano la timeline per concatenarli) ---
+
+    /** @brief Suona una nota per durationMs, poi silenzio. */
+    EffectTimeline& tone(uint16_t frequency, uint16_t durationMs);
+    /** @brief Pausa: la sequenza resta ferma per durationMs. */
+    EffectTimeline& wait(uint16_t durationMs);
+    /** @brief Colora tutta la striscia e la mantiene per holdMs. */
+    EffectTimeline& fill(uint8_t r, uint8_t g, uint8_t b, uint16_t holdMs = 0);
+    /** @brief Spegne la striscia e la mantiene spenta per holdMs. */
+    EffectTimeline& stripOff(uint16_t holdMs = 0);
+    /** @brief Cambia la luminosità globale della striscia. */
+    EffectTimeline& brightness(uint8_t value);
+    /**
+     * @brief Lampeggia i colori attuali della striscia a piena luminosità.
+     * @details Alla fine ripristina colori e luminosità di partenza. Se la coda non
+     * ha posto per tutti i passi del lampeggio non ne accoda nessuno.
+     */
+    EffectTimeline& flash(uint8_t count, uint16_t onMs, uint16_t offMs = 500);
+    /** @brief Pulisce l'LCD. */
+    EffectTimeline& lcdClear();
+    /** @brief Stampa text sull'LCD. text deve restare valido fino all'esecuzione (stringa costante). */
+    EffectTimeline& lcdText(uint8_t col, uint8_t row, const char* text);
+    /**
+     * @brief Chiama function(context) quando la sequenza arriva a questo punto.
+     * @details Se anche i posti riservati sono occupati la chiamata avviene subito:
+     * una funzione di fine sequenza non va mai persa.
+     */
+    EffectTimeline& call(EffectCallback function, void* context);
+
+    /**
+     * @brief Fa avanzare la sequenza. Da chiamare nel loop() almeno ogni millisecondo.
+     * @param nowMs Tempo corrente in millisecondi (millis()).
+     */
+    void update(unsigned long nowMs);
+    /** @brief Scarta tutti i passi in coda, zittisce il buzzer e ripristina la striscia se lampeggiava. */
+    void cancel();
+
+    /** @brief true finché ci sono passi in coda o in esecuzione. */
+    bool isRunning() const { return _count > 0; }
+    /** @brief true finché restano passi sulla striscia LED da completare. */
+    bool usesStrip() const { return _stripSteps > 0; }
+    /** @brief Passi scartati perché la coda era piena. */
+    uint32_t getDroppedCount() const { return _dropped; }
+
+private:
+    enum class StepType : uint8_t {
+        TONE,
+        WAIT,
+        FILL,
+        STRIP_OFF,
+        BRIGHTNESS,
+        STRIP_SAVE,         // Salva colori e luminosità prima di un lampeggio
+        STRIP_FLASH,        // Colori salvati a piena luminosità
+        STRIP_RESTORE,      // Ripristina colori e luminosità salvati
+        LCD_CLEAR,
+        LCD_TEXT,
+        CALL
+    };
+
+    struct Step {
+        StepType type;
+        uint8_t r, g, b;        // Colore; r è anche la luminosità o la colonna, g la riga
+        uint16_t durationMs;
+        uint16_t frequency;
+        const char* text;
+        EffectCallback function;
+        void* context;
+    };
+
+    /** @brief true se steps passi (non call()) entrano in coda lasciando liberi i posti riservati. */
+    bool hasRoom(uint16_t steps) const;
+    /** @brief Aggiunge un passo in coda; ritorna nullptr se la coda è piena. */
+    Step* push(StepType type, uint16_t durationMs);
+    void startStep(const Step& step);
+    void finishStep(const Step& step);
+    static bool isStripStep(StepType type);
+
+    HardwareManager* _hardware;
+    Step _steps[EFFECT_TIMELINE_CAPACITY];
+    uint8_t _head;
+    uint8_t _count;
+    uint8_t _stripSteps;    // Passi sulla striscia non ancora completati
+    bool _stepActive;       // Il passo in testa è già stato avviato
+    bool _stripSaved;       // Un lampeggio ha salvato la striscia e non l'ha ancora ripristinata
+    unsigned long _stepStart;
+    uint32_t _dropped;
+};
+
+#endif // EFFECT_TIMELINE_H
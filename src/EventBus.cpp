@@ -0,0 +1,62 @@
+// src/EventBus.cpp
+
+/**
+ * @file EventBus.cpp
+ * @brief Implementazione della classe EventBus.
+ */
+
+#include "EventBus.h"
+#include "Profiler.h"
+
+EventBus::EventBus() :
+    _head(0),
+    _count(0),
+    _highWater(0),
+    _dropped(0),
+    _subscriberCount(0)
+{
+}
+
+bool EventBus::subscribe(uint32_t mask, GameEventHandler handler, void* context) {
+    if (_subscriberCount >= EVENT_BUS_MAX_SUBSCRIBERS) {
+        return false;
+    }
+    _subscribers[_subscriberCount++] = { mask, handler, context };
+    return true;
+}
+
+bool EventBus::publish(const GameEvent& event) {
+    if (_count >= EVENT_BUS_QUEUE_SIZE) {
+        _dropped++;
+        return false;
+    }
+    _queue[(_head + _count) % EVENT_BUS_QUEUE_SIZE] = event;
+    _count++;
+    if (_count > _highWater) {
+        _highWater = _count;
+    }
+    return true;
+}
+
+bool EventBus::publish(GameEventId id, GameEventMode mode, uint8_t team, int32_t value, int32_t value2) {
+    GameEvent event = { id, mode, team, value, value2 };
+    return publish(event);
+}
+
+void EventBus::dispatch() {
+    uint8_t pending = _count;
+    while (pending-- > 0) {
+        // Copia: un iscritto può pubblicare e riusare lo slot appena liberato.
+        GameEvent event = _queue[_head];
+        _head = (_head + 1) % EVENT_BUS_QUEUE_SIZE;
+        _count--;
+
+        PROFILE_SCOPE("bus", "dispatch");
+        uint32_t bit = gameEventBit(event.id);
+        for (uint8_t i = 0; i < _subscriberCount; i++) {
+            if (_subscribers[i].mask & bit) {
+                _subscribers[i].handler(event, _subscribers[i].context);
+            }
+        }
+    }
+}
@@ -0,0 +1,139 @@
+// src/EventBus.h
+
+/**
+ * @file EventBus.h
+ * @brief Dichiarazione della classe EventBus, il bus interno degli eventi di gioco.
+ * @details Le modalità non formattano più messaggi di rete: pubblicano fatti
+ * tipizzati (innesco iniziato, zona conquistata dalla squadra 2, ...) e chi è
+ * interessato si iscrive. Il codificatore per il pannello (EventEncoder) è solo
+ * uno degli iscritti; giornale, statistiche o reazioni dei LED si aggiungono
+ * senza toccare le modalità.
+ *
+ * Nessuna allocazione: gli eventi sono POD di pochi byte in una coda di
+ * capacità fissa, gli iscritti stanno in una tabella fissa riempita nel setup().
+ * publish() accoda e ritorna subito; dispatch(), chiamata dal loop(), consegna
+ * ogni evento agli iscritti la cui maschera lo comprende. Il costo per evento
+ * è costante (al più EVENT_BUS_MAX_SUBSCRIBERS confronti di maschera più gli
+ * iscritti stessi) ed è misurato dalla sonda "bus.dispatch" del Profiler.
+ *
+ * Va usato da un solo task (quello di gioco).
+ */
+
+#ifndef EVENT_BUS_H
+#define EVENT_BUS_H
+
+#include <stdint.h>
+
+/** @brief Eventi in coda in attesa di dispatch(). Quelli oltre il limite vengono scartati. */
+#define EVENT_BUS_QUEUE_SIZE 16
+/** @brief Numero massimo di iscritti. */
+#define EVENT_BUS_MAX_SUBSCRIBERS 4
+
+/** @brief Tipi di evento di gioco. Al massimo 32 (vedi maschera degli iscritti). */
+enum class GameEventId : uint8_t {
+    MODE_ENTER,         // mode
+    MODE_EXIT,          // mode
+    REMOTE_START,       // mode: partita avviata dal pannello
+    GAME_START,         // mode, value = durata (Dominio)
+    GAME_END,           // mode, team = vincitore (0 = pareggio)
+    ROUND_RESET,
+    COUNTDOWN_START,    // value = durata del conto alla rovescia
+    ARM_START,
+    ARM_PROGRESS,       // value = percentuale
+    ARM_CANCEL,
+    ARM_PIN_WRONG,
+    BOMB_ARMED,
+    DEFUSE_START,
+    DEFUSE_PROGRESS,    // value = percentuale
+    DEFUSE_CANCEL,
+    DEFUSE_PIN_WRONG,
+    CAPTURE_START,      // team
+    CAPTURE_PROGRESS,   // team, value = percentuale
+    CAPTURE_CANCEL,     // team
+    ZONE_CAPTURED,      // team
+    SCORE_UPDATE,       // value = possesso squadra 1 (ms), value2 = squadra 2
+    COUNT
+};
+
+static_assert((uint8_t)GameEventId::COUNT <= 32, "La maschera degli iscritti ha 32 bit");
+
+/** @brief Modalità o schermata a cui si riferisce un evento. */
+enum class GameEventMode : uint8_t {
+    NONE,
+    MAIN_MENU,
+    TEST_HARDWARE,
+    SEARCH_DESTROY,
+    DOMINATION,
+    TERMINAL
+};
+
+/** @brief Squadre di Cerca & Distruggi nel campo team. */
+#define SD_TEAM_TERRORISTS 1
+#define SD_TEAM_COUNTER_TERRORISTS 2
+
+/**
+ * @struct GameEvent
+ * @brief Un evento di gioco. I campi non usati da un tipo restano a zero.
+ */
+struct GameEvent {
+    GameEventId id;
+    GameEventMode mode;
+    uint8_t team;
+    int32_t value;
+    int32_t value2;
+};
+
+/** @brief Maschera di iscrizione che comprende l'evento id. */
+constexpr uint32_t gameEventBit(GameEventId id) { return 1u << (uint8_t)id; }
+/** @brief Maschera che comprende tutti gli eventi. */
+#define GAME_EVENT_ALL 0xFFFFFFFFu
+
+/** @brief Funzione di un iscritto; context è quello passato a subscribe(). */
+typedef void (*GameEventHandler)(const GameEvent& event, void* context);
+
+class EventBus {
+public:
+    EventBus();
+
+    /**
+     * @brief Iscrive un gestore agli eventi della maschera (es. gameEventBit(...) | ...).
+     * @details Gli iscritti ricevono gli eventi in ordine di iscrizione.
+     * @return false se la tabella è piena.
+     */
+    bool subscribe(uint32_t mask, GameEventHandler handler, void* context);
+
+    /** @brief Accoda un evento. Ritorna false (e lo conta come scartato) se la coda è piena. */
+    bool publish(const GameEvent& event);
+    /** @brief Scorciatoia per gli eventi con i soli campi principali. */
+    bool publish(GameEventId id, GameEventMode mode = GameEventMode::NONE, uint8_t team = 0,
+                 int32_t value = 0, int32_t value2 = 0);
+
+    /**
+     * @brief Consegna agli iscritti gli eventi in coda. Da chiamare nel loop().
+     * @details Gli eventi pubblicati dagli iscritti durante la consegna aspettano
+     * la chiamata successiva.
+     */
+    void dispatch();
+
+    /** @brief Eventi scartati perché la coda era piena. */
+    uint32_t getDroppedCount() const { return _dropped; }
+    /** @brief Massimo numero di eventi in coda osservato. */
+    uint8_t getQueueHighWater() const { return _highWater; }
+
+private:
+    struct Subscriber {
+        uint32_t mask;
+        GameEventHandler handler;
+        void* context;
+    };
+
+    GameEvent _queue[EVENT_BUS_QUEUE_SIZE];
+    uint8_t _head;
+    uint8_t _count;
+    uint8_t _highWater;
+    uint32_t _dropped;
+    Subscriber _subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+    uint8_t _subscriberCount;
+};
+
+#endif // EVENT_BUS_H
@@ -7,10 +7,18 @@
 
 FirmwareUpdater::FirmwareUpdater(HardwareManager* hardware) : _hardware(hardware) {}
 
+// Il controllo blocca il loop(), che non invia più l'LCD: ogni attesa lo invia prima.
+void FirmwareUpdater::pause(unsigned long ms) {
+    _hardware->flushLcd();
+    delay(ms);
+}
+
 void FirmwareUpdater::checkForUpdates() {
     _hardware->clearLcd();
     _hardware->printLcd(0, 1, "Controllo aggiorn...");
     
+    _hardware->flushLcd();
+
     HTTPClient http;
     http.begin(_manifestUrl);
     int httpCode = http.GET();
@@ -22,7 +30,7 @@ void FirmwareUpdater::checkForUpdates() {
         char errStr[20];
         sprintf(errStr, "Codice HTTP: %d", httpCode);
         _hardware->printLcd(0, 2, errStr);
-        delay(4000);
+        pause(4000);
         return;
     }
 
@@ -32,7 +40,7 @@ void FirmwareUpdater::checkForUpdates() {
     JsonDocument doc;
     if (deserializeJson(doc, payload) != DeserializationError::Ok) {
         _hardware->printLcd(0, 2, "Errore JSON!");
-        delay(3000);
+        pause(3000);
         return;
     }
     
@@ -44,6 +52,7 @@ void FirmwareUpdater::checkForUpdates() {
         _hardware->printLcd(0, 1, "Nuova vers. trovata!");
         _hardware->printLcd(0, 2, "Download in corso...");
         
+        _hardware->flushLcd();
         const char* firmwareUrl = doc["url"];
         
         http.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
@@ -54,7 +63,7 @@ void FirmwareUpdater::checkForUpdates() {
             http.end();
             _hardware->printLcd(0, 3, "Errore Download FW!");
             Serial.printf("Errore HTTP download: %d\n", firmwareHttpCode);
-            delay(3000);
+            pause(3000);
             return;
         }
 
@@ -62,7 +71,7 @@ void FirmwareUpdater::checkForUpdates() {
         if (contentLength <= 0) {
             http.end();
             _hardware->printLcd(0, 3, "Errore: File vuoto!");
-            delay(3000);
+            pause(3000);
             return;
         }
 
@@ -72,7 +81,7 @@ void FirmwareUpdater::checkForUpdates() {
             _hardware->printLcd(0, 1, "ERRORE OTA!");
             _hardware->printLcd(0, 2, "Partizioni errate?");
             Serial.printf("Update.begin() fallito. Errore: %u\n", Update.getError());
-            delay(5000);
+            pause(5000);
             return;
         }
         
@@ -86,7 +95,7 @@ void FirmwareUpdater::checkForUpdates() {
             _hardware->printLcd(0, 1, "ERRORE SCRITTURA!");
             _hardware->printLcd(0, 2, "Download fallito.");
             Serial.printf("Scrittura fallita. Scritto %d di %d bytes\n", written, contentLength);
-            delay(5000);
+            pause(5000);
             return;
         }
 
@@ -96,7 +105,7 @@ void FirmwareUpdater::checkForUpdates() {
                 _hardware->printLcd(2, 1, "AGGIORNAMENTO OK!");
                 _hardware->printLcd(4, 2, "Riavvio in corso...");
                 Serial.println("Aggiornamento completato. Riavvio.");
-                delay(2000);
+                pause(2000);
                 ESP.restart();
             }
         } else {
@@ -107,13 +116,13 @@ void FirmwareUpdater::checkForUpdates() {
             sprintf(errStr, "Verifica fallita: #%u", errCode);
             _hardware->printLcd(0, 2, errStr);
             Serial.printf("Errore OTA durante Update.end(): %u\n", errCode);
-            delay(5000);
+            pause(5000);
         }
         
         http.end();
 
     } else {
         _hardware->printLcd(0, 2, "Nessun aggiornamento");
-        delay(2000);
+        pause(2000);
     }
 }
\ No newline at end of file
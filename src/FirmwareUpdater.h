@@ -12,6 +12,9 @@ public:
     void checkForUpdates();
 
 private:
+    /** @brief Mostra i messaggi scritti sull'LCD e attende ms millisecondi. */
+    void pause(unsigned long ms);
+
     HardwareManager* _hardware;
     const char* _manifestUrl = "https://raw.githubusercontent.com/Lopagg/Zulu-Game-System/main/firmware/firmware.json";
 };
@@ -1,27 +1,133 @@
 // src/GameModes/DominationMode.cpp
 
 #include "DominationMode.h"
+#include "Profiler.h"
+#include <new>
+
+/**
+ * @brief Tabelle della macchina a stati del Dominio.
+ * @details Ogni passata del loop() esegue l'aggiornamento dello stato corrente
+ * e poi consegna gli ingressi come eventi (vedi loop()). Le schermate si
+ * disegnano all'ingresso negli stati; suoni, messaggi e impostazioni stanno
+ * nelle azioni delle transizioni.
+ */
+struct DominationMode::Tables {
+    typedef DominationMode D;
+    typedef D::ModeState S;
+    typedef D::ModeEvent E;
+
+    static constexpr Machine::StateSpec STATES[] = {
+        // stato                  nome                 ingresso                       aggiornamento             uscita
+        { S::MODE_SUB_MENU,     "MODE_SUB_MENU",     &D::displaySubMenu,            nullptr,                  nullptr },
+        { S::MENU_SETTINGS,     "MENU_SETTINGS",     &D::displaySettingsMenu,       nullptr,                  nullptr },
+        { S::EDIT_DURATION,     "EDIT_DURATION",     &D::updateDisplayForCurrentState, nullptr,               nullptr },
+        { S::EDIT_CAPTURE_TIME, "EDIT_CAPTURE_TIME", &D::updateDisplayForCurrentState, nullptr,               nullptr },
+        { S::EDIT_COUNTDOWN,    "EDIT_COUNTDOWN",    &D::updateDisplayForCurrentState, nullptr,               nullptr },
+        { S::IN_GAME_CONFIRM,   "IN_GAME_CONFIRM",   &D::displayConfirmScreen,      nullptr,                  nullptr },
+        { S::IN_GAME_COUNTDOWN, "IN_GAME_COUNTDOWN", &D::startCountdown,            &D::handleCountdown,      nullptr },
+        { S::IN_GAME_NEUTRAL,   "IN_GAME_NEUTRAL",   &D::displayZoneScreen,         &D::handleNeutralState,   nullptr },
+        { S::CAPTURING_TEAM1,   "CAPTURING_TEAM1",   &D::startCapture,              &D::handleCapturingState, &D::stopCaptureTone },
+        { S::CAPTURING_TEAM2,   "CAPTURING_TEAM2",   &D::startCapture,              &D::handleCapturingState, &D::stopCaptureTone },
+        { S::TEAM1_CAPTURED,    "TEAM1_CAPTURED",    &D::displayZoneScreen,         &D::handleCapturedState,  nullptr },
+        { S::TEAM2_CAPTURED,    "TEAM2_CAPTURED",    &D::displayZoneScreen,         &D::handleCapturedState,  nullptr },
+        { S::GAME_OVER,         "GAME_OVER",         nullptr,                       &D::handleGameOverState,  nullptr },
+    };
+
+    static constexpr Machine::Transition TRANSITIONS[] = {
+        // da                     evento              guardia                     azione                   a
+        { S::MODE_SUB_MENU,     E::MENU_UP,        nullptr,                    &D::selectPreviousItem,  S::MODE_SUB_MENU },
+        { S::MODE_SUB_MENU,     E::MENU_DOWN,      nullptr,                    &D::selectNextItem,      S::MODE_SUB_MENU },
+        { S::MODE_SUB_MENU,     E::BACK,           nullptr,                    &D::leaveModeWithTone,   S::MODE_SUB_MENU },
+        { S::MODE_SUB_MENU,     E::CONFIRM,        &D::isStartSelected,        &D::playConfirmTone,     S::IN_GAME_CONFIRM },
+        { S::MODE_SUB_MENU,     E::CONFIRM,        &D::isSettingsSelected,     &D::openSettings,        S::MENU_SETTINGS },
+
+        { S::MENU_SETTINGS,     E::MENU_UP,        nullptr,                    &D::selectPreviousItem,  S::MENU_SETTINGS },
+        { S::MENU_SETTINGS,     E::MENU_DOWN,      nullptr,                    &D::selectNextItem,      S::MENU_SETTINGS },
+        { S::MENU_SETTINGS,     E::BACK,           nullptr,                    &D::closeSettings,       S::MODE_SUB_MENU },
+        { S::MENU_SETTINGS,     E::CONFIRM,        &D::isSettingSelected<0>,   &D::startEdit,           S::EDIT_DURATION },
+        { S::MENU_SETTINGS,     E::CONFIRM,        &D::isSettingSelected<1>,   &D::startEdit,           S::EDIT_CAPTURE_TIME },
+        { S::MENU_SETTINGS,     E::CONFIRM,        &D::isSettingSelected<2>,   &D::startEdit,           S::EDIT_COUNTDOWN },
+
+        { S::EDIT_DURATION,     E::DIGIT,          nullptr,                    &D::appendDigit,         S::EDIT_DURATION },
+        { S::EDIT_DURATION,     E::ERASE,          nullptr,                    &D::eraseDigit,          S::EDIT_DURATION },
+        { S::EDIT_DURATION,     E::BACK,           nullptr,                    &D::playBackTone,        S::MENU_SETTINGS },
+        { S::EDIT_DURATION,     E::CONFIRM,        nullptr,                    &D::saveEdit,            S::MENU_SETTINGS },
+
+        { S::EDIT_CAPTURE_TIME, E::DIGIT,          nullptr,                    &D::appendDigit,         S::EDIT_CAPTURE_TIME },
+        { S::EDIT_CAPTURE_TIME, E::ERASE,          nullptr,                    &D::eraseDigit,          S::EDIT_CAPTURE_TIME },
+        { S::EDIT_CAPTURE_TIME, E::BACK,           nullptr,                    &D::playBackTone,        S::MENU_SETTINGS },
+        { S::EDIT_CAPTURE_TIME, E::CONFIRM,        nullptr,                    &D::saveEdit,            S::MENU_SETTINGS },
+
+        { S::EDIT_COUNTDOWN,    E::DIGIT,          nullptr,                    &D::appendDigit,         S::EDIT_COUNTDOWN },
+        { S::EDIT_COUNTDOWN,    E::ERASE,          nullptr,                    &D::eraseDigit,          S::EDIT_COUNTDOWN },
+        { S::EDIT_COUNTDOWN,    E::BACK,           nullptr,                    &D::playBackTone,        S::MENU_SETTINGS },
+        { S::EDIT_COUNTDOWN,    E::CONFIRM,        nullptr,                    &D::saveEdit,            S::MENU_SETTINGS },
+
+        { S::IN_GAME_CONFIRM,   E::BACK,           nullptr,                    nullptr,                 S::MODE_SUB_MENU },
+        { S::IN_GAME_CONFIRM,   E::CONFIRM,        nullptr,                    nullptr,                 S::IN_GAME_COUNTDOWN },
+
+        { S::IN_GAME_COUNTDOWN, E::COUNTDOWN_DONE, nullptr,                    &D::startGame,           S::IN_GAME_NEUTRAL },
+
+        { S::IN_GAME_NEUTRAL,   E::TEAM1_HOLD,     nullptr,                    nullptr,                 S::CAPTURING_TEAM1 },
+        { S::IN_GAME_NEUTRAL,   E::TEAM2_HOLD,     nullptr,                    nullptr,                 S::CAPTURING_TEAM2 },
+
+        // Conquista interrotta: si torna allo stato della zona prima del tentativo.
+        { S::CAPTURING_TEAM1,   E::TEAM1_RELEASE,  &D::isZoneNeutral,          &D::cancelCapture,       S::IN_GAME_NEUTRAL },
+        { S::CAPTURING_TEAM1,   E::TEAM1_RELEASE,  &D::isZoneTeam2,            &D::cancelCapture,       S::TEAM2_CAPTURED },
+        { S::CAPTURING_TEAM1,   E::CAPTURE_DONE,   nullptr,                    &D::completeCapture,     S::TEAM1_CAPTURED },
+
+        { S::CAPTURING_TEAM2,   E::TEAM2_RELEASE,  &D::isZoneNeutral,          &D::cancelCapture,       S::IN_GAME_NEUTRAL },
+        { S::CAPTURING_TEAM2,   E::TEAM2_RELEASE,  &D::isZoneTeam1,            &D::cancelCapture,       S::TEAM1_CAPTURED },
+        { S::CAPTURING_TEAM2,   E::CAPTURE_DONE,   nullptr,                    &D::completeCapture,     S::TEAM2_CAPTURED },
+
+        { S::TEAM1_CAPTURED,    E::TEAM2_HOLD,     nullptr,                    nullptr,                 S::CAPTURING_TEAM2 },
+        { S::TEAM2_CAPTURED,    E::TEAM1_HOLD,     nullptr,                    nullptr,                 S::CAPTURING_TEAM1 },
+
+        { S::GAME_OVER,         E::ANY_INPUT,      nullptr,                    &D::leaveMode,           S::GAME_OVER },
+
+        // TIME_UP arriva solo dagli stati di gioco; FORCE_END (CMD:FORCE_END_GAME) da qualunque stato.
+        { Machine::ANY,         E::TIME_UP,        nullptr,                    &D::endGameOnTime,       S::GAME_OVER },
+        { Machine::ANY,         E::FORCE_END,      &D::isNotGameOver,          &D::endGameForced,       S::GAME_OVER },
+    };
+
+    static constexpr size_t STATE_COUNT = sizeof(STATES) / sizeof(STATES[0]);
+    static constexpr size_t TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+    static constexpr Machine::StateTable<STATE_COUNT, TRANSITION_COUNT> TABLE{ STATES, TRANSITIONS };
+
+    static_assert(STATE_COUNT == (size_t)S::GAME_OVER + 1, "Una riga per ogni ModeState");
+    static_assert(TABLE.isValid(), "Stati nell'ordine di ModeState, transizioni raggruppate per stato");
+};
 
 // Costruttore
-DominationMode::DominationMode(HardwareManager* hardware, NetworkManager* network, DominationSettings* settings, AppState* appState, MainMenuDisplayFunction displayFunc)
+DominationMode::DominationMode(HardwareManager* hardware, NetworkManager* network, EventBus* events, AppState* appState, MainMenuDisplayFunction displayFunc)
     : _hardware(hardware),
       _network(network),
-      _settings(settings),
+      _events(events),
       _appStatePtr(appState),
       _mainMenuDisplayFunc(displayFunc),
-      _currentState(ModeState::MODE_SUB_MENU),
+      _machine(this, Tables::TABLE, ModeState::MODE_SUB_MENU),
       _lastZoneState(ModeState::IN_GAME_NEUTRAL),
+      _key(NO_KEY),
       _subMenuIndex(0),
       _menuIndex(0) {
+    if (_stateProbes < 0) {
+        _stateProbes = profiler.addGroup("dom", Tables::TABLE.names, Tables::STATE_COUNT);
+    }
+}
+
+int8_t DominationMode::_stateProbes = -1;
+
+GameMode* DominationMode::create(void* arena, const ModeContext& context) {
+    return new (arena) DominationMode(context.hardware, context.network, context.events,
+                                      context.appState, context.displayMainMenu);
 }
 
 void DominationMode::enter() {
     Serial.println("Entrato in modalita' Dominio");
-    _currentState = ModeState::MODE_SUB_MENU;
     _subMenuIndex = 0;
-    displaySubMenu();
+    _machine.start(ModeState::MODE_SUB_MENU);
     _hardware->setStripColor(0, 255, 255);
-    _network->sendStatus("event:mode_enter;mode:domination;");
+    _events->publish(GameEventId::MODE_ENTER, GameEventMode::DOMINATION);
     sendSettingsStatus();
 }
 
@@ -31,90 +137,51 @@ void DominationMode::enter() {
  */
 void DominationMode::enterInGame() {
     Serial.println("Entrato in modalita' Dominio (remoto)");
-    _network->sendStatus("event:mode_enter;mode:domination;");
-    // Salta direttamente allo stato di gioco attivo
-    _currentState = ModeState::IN_GAME_NEUTRAL;
-    _lastZoneState = ModeState::IN_GAME_NEUTRAL;
-    _gameStartTime = _hardware->getRTCTime();
-    _lastGameSecond = -1;
-    _team1PossessionTime = 0;
-    _team2PossessionTime = 0;
-
-    // Esegui effetti visivi e sonori di inizio partita
-    _hardware->playTone(1500, 500);
-    _hardware->setBrightness(255);
-    _hardware->turnOffStrip();
-    delay(100);
-    _hardware->setStripColor(255, 255, 255);
-    delay(500);
-    _hardware->turnOffStrip();
-    _hardware->setBrightness(80);
-
-    // Disegna la schermata di gioco iniziale
-    _hardware->clearLcd();
-    _hardware->printLcd(4, 1, "ZONA NEUTRA");
-    _hardware->printOled1("CONQUISTA", 2, 8, 25);
-    _hardware->printOled2("CONQUISTA", 2, 8, 25);
-
-    // Invia il messaggio di inizio partita
-    char message[50];
-    sprintf(message, "event:game_start;mode:domination;duration:%d", _settings->getGameDuration());
-    _network->sendStatus(message);
+    _events->publish(GameEventId::MODE_ENTER, GameEventMode::DOMINATION);
+    startGame();
+    _machine.start(ModeState::IN_GAME_NEUTRAL);
 }
 
 void DominationMode::loop() {
-    char key = _hardware->getKey();
+    // La passata è attribuita allo stato in cui inizia.
+    ModeState state = _machine.getState();
+    ProfileScope profile(_stateProbes >= 0 ? _stateProbes + (int8_t)state : -1);
+    _key = _hardware->getKey();
     bool btn1_is_pressed = _hardware->isButton1Pressed();
     bool btn1_was_pressed = _hardware->wasButton1Pressed();
     bool btn2_is_pressed = _hardware->isButton2Pressed();
     bool btn2_was_pressed = _hardware->wasButton2Pressed();
 
-    String command = _network->getReceivedMessage();
-    if (command == "CMD:FORCE_END_GAME") {
-        forceEndGame();
-    }
+    // CMD:FORCE_END_GAME arriva tramite il CommandRouter in main.cpp.
 
-    switch (_currentState) {
-        case ModeState::MODE_SUB_MENU:
-            handleSubMenuInput(key, btn1_was_pressed, btn2_was_pressed);
-            break;
-        case ModeState::MENU_SETTINGS:
-            handleSettingsInput(key, btn1_was_pressed, btn2_was_pressed);
-            break;
-        case ModeState::EDIT_DURATION:
-        case ModeState::EDIT_CAPTURE_TIME:
-        case ModeState::EDIT_COUNTDOWN:
-            handleEditInput(key, btn1_was_pressed, btn2_was_pressed);
-            break;
-        case ModeState::IN_GAME_CONFIRM:
-            handleConfirmInput(btn1_was_pressed, btn2_was_pressed);
-            break;
-        case ModeState::IN_GAME_COUNTDOWN:
-            handleCountdown();
-            break;
-        case ModeState::IN_GAME_NEUTRAL:
-            handleNeutralState(btn1_is_pressed, btn2_is_pressed);
-            break;
-        case ModeState::CAPTURING_TEAM1:
-        case ModeState::CAPTURING_TEAM2:
-            handleCapturingState(btn1_is_pressed, btn2_is_pressed);
-            break;
-        case ModeState::TEAM1_CAPTURED:
-            handleCapturedState(1, btn1_is_pressed, btn2_is_pressed);
-            break;
-        case ModeState::TEAM2_CAPTURED:
-            handleCapturedState(2, btn1_is_pressed, btn2_is_pressed);
-            break;
-        case ModeState::GAME_OVER:
-            handleGameOverState(btn1_was_pressed, btn2_was_pressed, key);
-            break;
+    _machine.update();
+
+    // Gli ingressi diventano eventi, nell'ordine in cui li leggevano i singoli
+    // stati. Dopo un cambio di stato (anche durante update()) quelli rimasti
+    // vengono ignorati fino alla passata successiva.
+    ModeEvent inputs[7];
+    uint8_t inputCount = 0;
+    if (_key == '2') inputs[inputCount++] = ModeEvent::MENU_UP;
+    else if (_key == '8') inputs[inputCount++] = ModeEvent::MENU_DOWN;
+    if (isdigit(_key)) inputs[inputCount++] = ModeEvent::DIGIT;
+    else if (_key == '*') inputs[inputCount++] = ModeEvent::ERASE;
+    if (btn1_was_pressed) inputs[inputCount++] = ModeEvent::BACK;
+    if (btn2_was_pressed) inputs[inputCount++] = ModeEvent::CONFIRM;
+    if (btn1_was_pressed || btn2_was_pressed || _key != NO_KEY) inputs[inputCount++] = ModeEvent::ANY_INPUT;
+    inputs[inputCount++] = btn1_is_pressed ? ModeEvent::TEAM1_HOLD : ModeEvent::TEAM1_RELEASE;
+    inputs[inputCount++] = btn2_is_pressed ? ModeEvent::TEAM2_HOLD : ModeEvent::TEAM2_RELEASE;
+
+    for (uint8_t i = 0; i < inputCount && _machine.getState() == state; i++) {
+        _machine.handle(inputs[i]);
     }
 }
 
 void DominationMode::exit() {
     Serial.println("Uscito da modalita' Dominio");
-    _network->sendStatus("event:mode_exit;mode:domination;");
-    _settings->saveParameters();
+    _events->publish(GameEventId::MODE_EXIT, GameEventMode::DOMINATION);
+    _network->clearTimerAnchor();
+    _settings.saveParameters();
+    _hardware->effects().cancel();
     _hardware->turnOffStrip();
     _hardware->clearOled1();
     _hardware->clearOled2();
@@ -132,44 +199,6 @@ void DominationMode::displaySubMenu() {
     _hardware->printOled2("CONFERMA", 2, 18, 25);
 }
 
-void DominationMode::handleSubMenuInput(char key, bool btn1, bool btn2) {
-    String menuItems[] = { "Inizia Partita", "Impostazioni" };
-    int numItems = 2;
-
-    if (key == '2') {
-        _hardware->playTone(800, 50);
-        _subMenuIndex = (_subMenuIndex - 1 + numItems) % numItems;
-        displaySubMenu();
-    } else if (key == '8') {
-        _hardware->playTone(600, 50);
-        _subMenuIndex = (_subMenuIndex + 1) % numItems;
-        displaySubMenu();
-    }
-
-    if (btn1) {
-        _hardware->playTone(300, 70);
-        exit(); 
-        *_appStatePtr = APP_STATE_MAIN_MENU;
-        _mainMenuDisplayFunc();
-        return;
-    }
-
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        switch (_subMenuIndex) {
-            case 0: // Inizia Partita
-                _currentState = ModeState::IN_GAME_CONFIRM;
-                displayConfirmScreen();
-                break;
-            case 1: // Impostazioni
-                _currentState = ModeState::MENU_SETTINGS;
-                _menuIndex = 0;
-                displaySettingsMenu();
-                break;
-        }
-    }
-}
-
 void DominationMode::displaySettingsMenu() {
     _hardware->clearLcd();
     _hardware->printLcd(0, 0, "IMPOSTAZIONI DOMINIO");
@@ -181,40 +210,65 @@ void DominationMode::displaySettingsMenu() {
     }
     _hardware->printOled1("INDIETRO", 2, 10, 25);
     _hardware->printOled2("CONFERMA", 2, 18, 25);
+    _hardware->setStripColor(0, 255, 255);
 }
 
-void DominationMode::handleSettingsInput(char key, bool btn1, bool btn2) {
-    String menuItems[] = { "Durata Partita", "Tempo Conquista", "Durata Countdown" };
-    int numItems = 3;
-
-    if (key == '2') {
-        _hardware->playTone(800, 50);
-        _menuIndex = (_menuIndex - 1 + numItems) % numItems;
-        displaySettingsMenu();
-    } else if (key == '8') {
-        _hardware->playTone(600, 50);
-        _menuIndex = (_menuIndex + 1) % numItems;
+/** @brief Sposta la selezione verso l'alto nel menu corrente (sottomenu o impostazioni). */
+void DominationMode::selectPreviousItem() {
+    _hardware->playTone(800, 50);
+    if (_machine.getState() == ModeState::MODE_SUB_MENU) {
+        _subMenuIndex = (_subMenuIndex - 1 + 2) % 2;
+        displaySubMenu();
+    } else {
+        _menuIndex = (_menuIndex - 1 + 3) % 3;
         displaySettingsMenu();
     }
+}
 
-    if (btn1) {
-        _hardware->playTone(300, 70);
-        _currentState = ModeState::MODE_SUB_MENU;
+/** @brief Sposta la selezione verso il basso nel menu corrente (sottomenu o impostazioni). */
+void DominationMode::selectNextItem() {
+    _hardware->playTone(600, 50);
+    if (_machine.getState() == ModeState::MODE_SUB_MENU) {
+        _subMenuIndex = (_subMenuIndex + 1) % 2;
         displaySubMenu();
-        sendSettingsStatus();
-        return;
+    } else {
+        _menuIndex = (_menuIndex + 1) % 3;
+        displaySettingsMenu();
     }
+}
 
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        _currentInputBuffer = "";
-        switch (_menuIndex) {
-            case 0: _currentState = ModeState::EDIT_DURATION; break;
-            case 1: _currentState = ModeState::EDIT_CAPTURE_TIME; break;
-            case 2: _currentState = ModeState::EDIT_COUNTDOWN; break;
-        }
-        updateDisplayForCurrentState();
-    }
+void DominationMode::leaveModeWithTone() {
+    _hardware->playTone(300, 70);
+    leaveMode();
+}
+
+void DominationMode::leaveMode() {
+    exit();
+    *_appStatePtr = APP_STATE_MAIN_MENU;
+    _mainMenuDisplayFunc();
+}
+
+void DominationMode::playConfirmTone() {
+    _hardware->playTone(1200, 100);
+}
+
+void DominationMode::playBackTone() {
+    _hardware->playTone(300, 70);
+}
+
+void DominationMode::openSettings() {
+    playConfirmTone();
+    _menuIndex = 0;
+}
+
+void DominationMode::closeSettings() {
+    playBackTone();
+    sendSettingsStatus();
+}
+
+void DominationMode::startEdit() {
+    playConfirmTone();
+    _currentInputBuffer = "";
 }
 
 void DominationMode::displayEditScreen(const String& title, const String& currentValue, const String& unit) {
@@ -228,64 +282,44 @@ void DominationMode::displayEditScreen(const String& title, const String& curren
     _hardware->printOled2("CONFERMA", 2, 18, 25);
 }
 
-void DominationMode::handleEditInput(char key, bool btn1, bool btn2) {
-    if (btn1) {
-        _hardware->playTone(300, 70);
-        _currentState = ModeState::MENU_SETTINGS;
-        displaySettingsMenu();
-        _hardware->setStripColor(0, 255, 255);
-        return;
-    }
-    
-    bool displayNeedsUpdate = false;
-    if (isdigit(key)) {
-        _hardware->playTone(700, 30);
-        _currentInputBuffer += key;
-        displayNeedsUpdate = true;
-    } else if (key == '*') {
-        if (_currentInputBuffer.length() > 0) {
-            _currentInputBuffer.remove(_currentInputBuffer.length() - 1);
-        }
-        displayNeedsUpdate = true;
+void DominationMode::appendDigit() {
+    _hardware->playTone(700, 30);
+    _currentInputBuffer += _key;
+    updateDisplayForCurrentState();
+}
+
+void DominationMode::eraseDigit() {
+    if (_currentInputBuffer.length() > 0) {
+        _currentInputBuffer.remove(_currentInputBuffer.length() - 1);
     }
+    updateDisplayForCurrentState();
+}
 
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        if (_currentInputBuffer.length() > 0) {
-            int value = _currentInputBuffer.toInt();
-            if (_currentState == ModeState::EDIT_DURATION) {
-                _settings->setGameDuration(value);
-            } else if (_currentState == ModeState::EDIT_CAPTURE_TIME) {
-                _settings->setCaptureTime(value);
-            } else if (_currentState == ModeState::EDIT_COUNTDOWN) {
-                _settings->setCountdownDuration(value);
-            }
-            _currentState = ModeState::MENU_SETTINGS;
-            displaySettingsMenu();
-            _hardware->setStripColor(0, 255, 255);
-        } else {
-            _currentState = ModeState::MENU_SETTINGS;
-            displaySettingsMenu();
-            _hardware->setStripColor(0, 255, 255);
-        }
+/** @brief Applica il valore inserito al parametro dello stato di modifica da cui si esce. */
+void DominationMode::saveEdit() {
+    playConfirmTone();
+    if (_currentInputBuffer.length() == 0) {
         return;
     }
-
-    if (displayNeedsUpdate) {
-        updateDisplayForCurrentState();
+    int value = _currentInputBuffer.toInt();
+    switch (_machine.getState()) {
+        case ModeState::EDIT_DURATION:     _settings.setGameDuration(value); break;
+        case ModeState::EDIT_CAPTURE_TIME: _settings.setCaptureTime(value); break;
+        case ModeState::EDIT_COUNTDOWN:    _settings.setCountdownDuration(value); break;
+        default: break;
     }
 }
 
 void DominationMode::updateDisplayForCurrentState() {
-    switch (_currentState) {
+    switch (_machine.getState()) {
         case ModeState::EDIT_DURATION:
-            displayEditScreen("Durata Partita", String(_settings->getGameDuration()), "min");
+            displayEditScreen("Durata Partita", String(_settings.getGameDuration()), "min");
             break;
         case ModeState::EDIT_CAPTURE_TIME:
-            displayEditScreen("Tempo Conquista", String(_settings->getCaptureTime()), "s");
+            displayEditScreen("Tempo Conquista", String(_settings.getCaptureTime()), "s");
             break;
         case ModeState::EDIT_COUNTDOWN:
-            displayEditScreen("Durata Countdown", String(_settings->getCountdownDuration()), "s");
+            displayEditScreen("Durata Countdown", String(_settings.getCountdownDuration()), "s");
             break;
         default:
             break;
@@ -300,74 +334,39 @@ void DominationMode::displayConfirmScreen() {
     _hardware->printOled2("INIZIA", 2, 28, 25);
 }
 
-void DominationMode::handleConfirmInput(bool btn1, bool btn2) {
-    if (btn1) {
-        _currentState = ModeState::MODE_SUB_MENU;
-        displaySubMenu();
-    }
-    if (btn2) {
-        _currentState = ModeState::IN_GAME_COUNTDOWN;
-        _countdownStartTime = millis();
-        _lastCountdownSecond = -1;
-
-        char message[50];
-        sprintf(message, "event:countdown_start;duration:%d;", _settings->getCountdownDuration());
-        _network->sendStatus(message);
-
-        _hardware->clearLcd();
-        _hardware->printLcd(4, 1, "LA PARTITA");
-        _hardware->printLcd(3, 2, "INIZIA TRA...");
-        _hardware->setStripColor(255, 255, 255);
-        _hardware->clearOled1();
-        _hardware->clearOled2();
-    }
+void DominationMode::startCountdown() {
+    _countdownStartTime = millis();
+    _lastCountdownSecond = -1;
+
+    _events->publish(GameEventId::COUNTDOWN_START, GameEventMode::DOMINATION, 0, _settings.getCountdownDuration());
+    _network->publishTimerAnchor("countdown", _settings.getCountdownDuration() * 1000UL);
+
+    _hardware->clearLcd();
+    _hardware->printLcd(4, 1, "LA PARTITA");
+    _hardware->printLcd(3, 2, "INIZIA TRA...");
+    _hardware->setStripColor(255, 255, 255);
+    _hardware->clearOled1();
+    _hardware->clearOled2();
 }
 
 void DominationMode::handleCountdown() {
-    unsigned long countdownDuration = _settings->getCountdownDuration() * 1000;
+    unsigned long countdownDuration = _settings.getCountdownDuration() * 1000;
     unsigned long elapsedTime = millis() - _countdownStartTime;
     
     if (elapsedTime >= countdownDuration) {
-        _currentState = ModeState::IN_GAME_NEUTRAL;
-        _lastZoneState = ModeState::IN_GAME_NEUTRAL;
-        _gameStartTime = _hardware->getRTCTime();
-        _lastGameSecond = -1;
-        _team1PossessionTime = 0;
-        _team2PossessionTime = 0;
-
-        _hardware->playTone(1500, 500);
-        _hardware->setBrightness(255);
-        _hardware->turnOffStrip();
-        delay(100);
-        _hardware->setStripColor(255, 255, 255);
-        delay(500);
-        _hardware->turnOffStrip();
-        _hardware->setBrightness(80);
-
-        _hardware->clearLcd();
-        _hardware->printLcd(4, 1, "ZONA NEUTRA");
-        _hardware->printOled1("CONQUISTA", 2, 8, 25);
-        _hardware->printOled2("CONQUISTA", 2, 8, 25);
-
-        char message[50];
-        sprintf(message, "event:game_start;mode:domination;duration:%d", _settings->getGameDuration());
-        _network->sendStatus(message);
-
+        _machine.handle(ModeEvent::COUNTDOWN_DONE);
         return;
     }
 
-    int remainingSeconds = (_settings->getCountdownDuration()) - (elapsedTime / 1000);
+    int remainingSeconds = (_settings.getCountdownDuration()) - (elapsedTime / 1000);
     if (remainingSeconds != _lastCountdownSecond) {
         String secStr = String(remainingSeconds);
         if(remainingSeconds < 10) {
             secStr = "0" + secStr;
         }
         _hardware->printLcd(9, 3, secStr);
+        // Il pannello segue il conto alla rovescia dall'ancora inviata con countdown_start.
 
-        char message[50];
-        sprintf(message, "event:countdown_update;time:%d;", remainingSeconds);
-        _network->sendStatus(message);
-        
         if (remainingSeconds > 3) {
             _hardware->playTone(800, 100);
         } else if (remainingSeconds > 0) {
@@ -377,50 +376,40 @@ void DominationMode::handleCountdown() {
     }
 }
 
-void DominationMode::updateGameTimerOnRow(int row) {
-    long totalSeconds = _settings->getGameDuration() * 60;
+/** @brief Azzera tempi e possesso, accoda l'effetto di inizio e avvisa il pannello. */
+void DominationMode::startGame() {
+    _lastZoneState = ModeState::IN_GAME_NEUTRAL;
+    _gameStartTime = _hardware->getRTCTime();
+    _lastGameSecond = -1;
+    _team1PossessionTime = 0;
+    _team2PossessionTime = 0;
+
+    playStartEffect();
+
+    _events->publish(GameEventId::GAME_START, GameEventMode::DOMINATION, 0, _settings.getGameDuration());
+    _network->publishTimerAnchor("game", _settings.getGameDuration() * 60000UL);
+}
+
+/**
+ * @brief Aggiorna il tempo rimanente sulla riga indicata.
+ * @return true se il tempo è scaduto: il chiamante consegna TIME_UP e non fa altro.
+ */
+bool DominationMode::updateGameTimerOnRow(int row) {
+    long totalSeconds = _settings.getGameDuration() * 60;
 
     // ***Controllo di validità per l'ora di inizio partita ***
     // Questo previene crash o fine immediata della partita se l'RTC fornisce dati errati.
     if (_gameStartTime.year() < 2024) {
         Serial.println("ERRORE: Orario di inizio partita non valido! L'RTC potrebbe avere problemi di alimentazione.");
         _hardware->printLcd(0, 3, "ERRORE OROLOGIO RTC");
-        return; // Esce dalla funzione per questo ciclo, riproverà al prossimo.
+        return false; // Riproverà al prossimo ciclo.
     }
 
     TimeSpan elapsed = _hardware->getRTCTime() - _gameStartTime;
     long remainingSeconds = totalSeconds - elapsed.totalseconds();
 
-    if (remainingSeconds < 0) {
-        remainingSeconds = 0;
-    }
-
-    if (remainingSeconds == 0 && _currentState != ModeState::GAME_OVER) {
-        _currentState = ModeState::GAME_OVER;
-        _hardware->playTone(400, 1000);
-
-        if (_team1PossessionTime > _team2PossessionTime) _winner = 1;
-        else if (_team2PossessionTime > _team1PossessionTime) _winner = 2;
-        else _winner = 0;
-
-        char message[50];
-        sprintf(message, "event:game_end;winner:%d", _winner);
-        _network->sendStatus(message);
-
-        _hardware->clearLcd();
-        if (_winner == 1) _hardware->printLcd(2, 1, "VINCE SQUADRA 1!");
-        else if (_winner == 2) _hardware->printLcd(2, 1, "VINCE SQUADRA 2!");
-        else _hardware->printLcd(6, 1, "PAREGGIO!");
-        
-        char scoreBuffer[20];
-        sprintf(scoreBuffer, "S1: %02lu:%02lu", (_team1PossessionTime / 1000) / 60, (_team1PossessionTime / 1000) % 60);
-        _hardware->printLcd(6, 2, scoreBuffer);
-        sprintf(scoreBuffer, "S2: %02lu:%02lu", (_team2PossessionTime / 1000) / 60, (_team2PossessionTime / 1000) % 60);
-        _hardware->printLcd(6, 3, scoreBuffer);
-
-        _hardware->printOled1("ESCI", 2, 35, 25);
-        _hardware->printOled2("ESCI", 2, 35, 25);
-        return;
+    if (remainingSeconds <= 0) {
+        return true;
     }
 
     if (remainingSeconds != _lastGameSecond) {
@@ -430,45 +419,61 @@ void DominationMode::updateGameTimerOnRow(int row) {
         sprintf(timeBuffer, "%02d : %02d", minutes, seconds);
         _hardware->printLcd(6, row, timeBuffer);
 
-        char message[50];
-        sprintf(message, "event:time_update;time:%ld", remainingSeconds);
-        _network->sendStatus(message);
-
         if (remainingSeconds > 0 && remainingSeconds < totalSeconds && remainingSeconds % 60 == 0) {
-            _hardware->playTone(1500, 150);
-            _hardware->flashCurrentColor(2, 100);
+            _hardware->effects().tone(1500, 150).flash(2, 100);
         } else if (remainingSeconds == 60) {
-            _hardware->playTone(1600, 80); delay(100); _hardware->playTone(1600, 80);
+            _hardware->effects().tone(1600, 80).wait(100).tone(1600, 80);
         } else if (remainingSeconds <= 10 && remainingSeconds > 3) {
-            _hardware->playTone(800, 100);
-            _hardware->flashCurrentColor(1, 100);
+            _hardware->effects().tone(800, 100).flash(1, 100);
         } else if (remainingSeconds <= 3 && remainingSeconds > 0) {
-            _hardware->playTone(1200, 150);
-            _hardware->flashCurrentColor(1, 100);
+            _hardware->effects().tone(1200, 150).flash(1, 100);
         }
         
         _lastGameSecond = remainingSeconds;
     }
+    return false;
 }
 
-void DominationMode::handleNeutralState(bool btn1_is_pressed, bool btn2_is_pressed) {
-    updateGameTimerOnRow(2);
-    _hardware->updateBreathingEffect(255, 255, 255);
-    
-    if (btn1_is_pressed) {
-        _currentState = ModeState::CAPTURING_TEAM1;
-        _captureStartTime = millis();
-        _captureSoundLastUpdate = 0;
-        displayCapturingScreen(1);
-        _network->sendStatus("event:capture_start;team:1;");
+/** @brief Schermata della zona per lo stato corrente: neutra, rossa (squadra 1) o verde (squadra 2). */
+void DominationMode::displayZoneScreen() {
+    _hardware->clearLcd();
+    switch (_machine.getState()) {
+        case ModeState::TEAM1_CAPTURED:
+            _hardware->printLcd(5, 1, "ZONA ROSSA");
+            _hardware->clearOled1();
+            _hardware->printOled2("CONQUISTA", 2, 8, 25);
+            break;
+        case ModeState::TEAM2_CAPTURED:
+            _hardware->printLcd(5, 1, "ZONA VERDE");
+            _hardware->printOled1("CONQUISTA", 2, 8, 25);
+            _hardware->clearOled2();
+            break;
+        default:
+            _hardware->printLcd(4, 1, "ZONA NEUTRA");
+            _hardware->printOled1("CONQUISTA", 2, 8, 25);
+            _hardware->printOled2("CONQUISTA", 2, 8, 25);
+            break;
     }
-    if (btn2_is_pressed) {
-        _currentState = ModeState::CAPTURING_TEAM2;
-        _captureStartTime = millis();
-        _captureSoundLastUpdate = 0;
-        displayCapturingScreen(2);
-        _network->sendStatus("event:capture_start;team:2;");
+}
+
+void DominationMode::handleNeutralState() {
+    if (updateGameTimerOnRow(2)) {
+        _machine.handle(ModeEvent::TIME_UP);
+        return;
     }
+    _hardware->updateBreathingEffect(255, 255, 255);
+}
+
+void DominationMode::startCapture() {
+    int team = (_machine.getState() == ModeState::CAPTURING_TEAM1) ? 1 : 2;
+    _captureStartTime = millis();
+    _captureSoundLastUpdate = 0;
+    displayCapturingScreen(team);
+    _events->publish(GameEventId::CAPTURE_START, GameEventMode::DOMINATION, team);
+}
+
+void DominationMode::stopCaptureTone() {
+    _hardware->noTone();
 }
 
 void DominationMode::displayCapturingScreen(int team) {
@@ -483,71 +488,36 @@ void DominationMode::displayCapturingScreen(int team) {
     }
 }
 
-void DominationMode::handleCapturingState(bool btn1_is_pressed, bool btn2_is_pressed) {
-    updateGameTimerOnRow(3);
-
-    int teamCapturing = (_currentState == ModeState::CAPTURING_TEAM1) ? 1 : 2;
-    bool isStillPressed = (teamCapturing == 1) ? btn1_is_pressed : btn2_is_pressed;
+void DominationMode::cancelCapture() {
+    int team = (_machine.getState() == ModeState::CAPTURING_TEAM1) ? 1 : 2;
+    _events->publish(GameEventId::CAPTURE_CANCEL, GameEventMode::DOMINATION, team);
+}
 
-    if (!isStillPressed) {
-        
-        char message[50];
-        sprintf(message, "event:capture_cancel;team:%d;", teamCapturing);
-        _network->sendStatus(message);
+void DominationMode::completeCapture() {
+    int team = (_machine.getState() == ModeState::CAPTURING_TEAM1) ? 1 : 2;
+    _hardware->effects().tone(1500, 80).wait(100).tone(1500, 80);
+    _events->publish(GameEventId::ZONE_CAPTURED, GameEventMode::DOMINATION, team);
+    _lastPossessionUpdateTime = millis();
+    _lastZoneState = (team == 1) ? ModeState::TEAM1_CAPTURED : ModeState::TEAM2_CAPTURED;
+}
 
-        _currentState = _lastZoneState;
-        if (_lastZoneState == ModeState::IN_GAME_NEUTRAL) {
-            _hardware->clearLcd();
-            _hardware->printLcd(4, 1, "ZONA NEUTRA");
-            _hardware->printOled1("CONQUISTA", 2, 8, 25);
-            _hardware->printOled2("CONQUISTA", 2, 8, 25);
-        } else if (_lastZoneState == ModeState::TEAM1_CAPTURED) {
-            _hardware->clearLcd();
-            _hardware->printLcd(5, 1, "ZONA ROSSA");
-            _hardware->clearOled1();
-            _hardware->printOled2("CONQUISTA", 2, 8, 25);
-        } else {
-            _hardware->clearLcd();
-            _hardware->printLcd(5, 1, "ZONA VERDE");
-            _hardware->printOled1("CONQUISTA", 2, 8, 25);
-            _hardware->clearOled2();
-        }
-        _hardware->noTone();
+void DominationMode::handleCapturingState() {
+    if (updateGameTimerOnRow(3)) {
+        _machine.handle(ModeEvent::TIME_UP);
         return;
     }
 
-    unsigned long captureDuration = _settings->getCaptureTime() * 1000;
+    int teamCapturing = (_machine.getState() == ModeState::CAPTURING_TEAM1) ? 1 : 2;
+    unsigned long captureDuration = _settings.getCaptureTime() * 1000;
     unsigned long elapsedTime = millis() - _captureStartTime;
 
     if (elapsedTime >= captureDuration) {
-        _hardware->noTone();
-        _hardware->playTone(1500, 80);
-        delay(100);
-        _hardware->playTone(1500, 80);
-
-        char message[50];
-        sprintf(message, "event:zone_captured;team:%d;", teamCapturing);
-        _network->sendStatus(message);
-
-        _lastPossessionUpdateTime = millis();
-        if (teamCapturing == 1) {
-            _currentState = ModeState::TEAM1_CAPTURED;
-            _lastZoneState = ModeState::TEAM1_CAPTURED;
-            _hardware->clearLcd();
-            _hardware->printLcd(5, 1, "ZONA ROSSA");
-            _hardware->clearOled1();
-            _hardware->printOled2("CONQUISTA", 2, 8, 25);
-        } else {
-            _currentState = ModeState::TEAM2_CAPTURED;
-            _lastZoneState = ModeState::TEAM2_CAPTURED;
-            _hardware->clearLcd();
-            _hardware->printLcd(5, 1, "ZONA VERDE");
-            _hardware->printOled1("CONQUISTA", 2, 8, 25);
-            _hardware->clearOled2();
-        }
+        _machine.handle(ModeEvent::CAPTURE_DONE);
         return;
     }
 
+    _events->publish(GameEventId::CAPTURE_PROGRESS, GameEventMode::DOMINATION, teamCapturing, map(elapsedTime, 0, captureDuration, 0, 100));
+
     int barWidthChars = 16;
     int totalPixels = barWidthChars * 5;
     int progressPixels = map(elapsedTime, 0, captureDuration, 0, totalPixels);
@@ -585,9 +555,13 @@ void DominationMode::handleCapturingState(bool btn1_is_pressed, bool btn2_is_pre
     }
 }
 
-void DominationMode::handleCapturedState(int team, bool btn1_is_pressed, bool btn2_is_pressed) {
-    updateGameTimerOnRow(2);
-    
+void DominationMode::handleCapturedState() {
+    if (updateGameTimerOnRow(2)) {
+        _machine.handle(ModeEvent::TIME_UP);
+        return;
+    }
+
+    int team = (_machine.getState() == ModeState::TEAM1_CAPTURED) ? 1 : 2;
     uint8_t r = (team == 1) ? 255 : 0;
     uint8_t g = (team == 2) ? 255 : 0;
     _hardware->updateBreathingEffect(r, g, 0);
@@ -600,74 +574,53 @@ void DominationMode::handleCapturedState(int team, bool btn1_is_pressed, bool bt
     }
     _lastPossessionUpdateTime = now;
 
-    char message[50];
-    sprintf(message, "event:score_update;team1_score:%lu;team2_score:%lu;", _team1PossessionTime, _team2PossessionTime);
-    _network->sendStatus(message);
-
-    bool enemyButtonPressed = (team == 1) ? btn2_is_pressed : btn1_is_pressed;
-    if (enemyButtonPressed) {
-        _currentState = (team == 1) ? ModeState::CAPTURING_TEAM2 : ModeState::CAPTURING_TEAM1;
-        _captureStartTime = millis();
-        _captureSoundLastUpdate = 0;
-        displayCapturingScreen((team == 1) ? 2 : 1);
-
-        char startMsg[50];
-        sprintf(startMsg, "event:capture_start;team:%d;", (team == 1) ? 2 : 1);
-        _network->sendStatus(startMsg);
-
-        return;
-    }
+    _events->publish(GameEventId::SCORE_UPDATE, GameEventMode::DOMINATION, 0, _team1PossessionTime, _team2PossessionTime);
 }
 
-void DominationMode::handleGameOverState(bool btn1_was_pressed, bool btn2_was_pressed, char key) {
+void DominationMode::handleGameOverState() {
     uint8_t r = 0, g = 0, b = 0;
     if (_winner == 1) { r = 255; }
     else if (_winner == 2) { g = 255; }
     else { r = 255; g = 255; b = 255; }
     _hardware->updateWinnerWaveEffect(r, g, b, 0.1, 1, 10);
+}
 
-    if (btn1_was_pressed || btn2_was_pressed || key != NO_KEY) {
-        exit();
-        *_appStatePtr = APP_STATE_MAIN_MENU;
-        _mainMenuDisplayFunc();
-    }
+void DominationMode::endGameOnTime() {
+    finishGame(false);
+}
+
+void DominationMode::endGameForced() {
+    finishGame(true);
 }
 
 /**
- * @brief Termina forzatamente la partita in corso.
- * @details Chiamata quando viene ricevuto il comando di rete corrispondente.
- * Calcola il vincitore in base al tempo di possesso attuale e passa allo stato GAME_OVER.
+ * @brief Calcola il vincitore, avvisa il pannello e mostra il riepilogo.
+ * @param forced true se la partita è interrotta da comando: il possesso in corso
+ * viene conteggiato fino a ora e la schermata lo indica.
  */
-void DominationMode::forceEndGame() {
-    Serial.println("!!! COMANDO RICEVUTO: forceEndGame in Dominio !!!");
-
-    // Non fare nulla se la partita è GIA' finita
-    if (_currentState == ModeState::GAME_OVER) {
-        return;
-    }
-    
-    _currentState = ModeState::GAME_OVER;
+void DominationMode::finishGame(bool forced) {
+    _hardware->effects().cancel(); // Interrompe suoni e lampeggi in corso
     _hardware->playTone(400, 1000);
-    _hardware->noTone(); // Assicura che qualsiasi suono venga interrotto
 
-    // Aggiorna un'ultima volta i tempi di possesso prima di calcolare il vincitore
-    unsigned long now = millis();
-    if (_lastZoneState == ModeState::TEAM1_CAPTURED) {
-        _team1PossessionTime += now - _lastPossessionUpdateTime;
-    } else if (_lastZoneState == ModeState::TEAM2_CAPTURED) {
-        _team2PossessionTime += now - _lastPossessionUpdateTime;
+    if (forced) {
+        // Aggiorna un'ultima volta i tempi di possesso prima di calcolare il vincitore
+        unsigned long now = millis();
+        if (_lastZoneState == ModeState::TEAM1_CAPTURED) {
+            _team1PossessionTime += now - _lastPossessionUpdateTime;
+        } else if (_lastZoneState == ModeState::TEAM2_CAPTURED) {
+            _team2PossessionTime += now - _lastPossessionUpdateTime;
+        }
     }
 
     if (_team1PossessionTime > _team2PossessionTime) _winner = 1;
     else if (_team2PossessionTime > _team1PossessionTime) _winner = 2;
     else _winner = 0; // Pareggio
 
-    char message[50];
-    sprintf(message, "event:game_end;winner:%d", _winner);
-    _network->sendStatus(message);
+    _events->publish(GameEventId::GAME_END, GameEventMode::DOMINATION, _winner);
+    _network->clearTimerAnchor();
 
     _hardware->clearLcd();
-    _hardware->printLcd(3, 0, "PARTITA TERMINATA");
+    if (forced) _hardware->printLcd(3, 0, "PARTITA TERMINATA");
     if (_winner == 1) _hardware->printLcd(2, 1, "VINCE SQUADRA 1!");
     else if (_winner == 2) _hardware->printLcd(2, 1, "VINCE SQUADRA 2!");
     else _hardware->printLcd(6, 1, "PAREGGIO!");
@@ -682,11 +635,40 @@ void DominationMode::forceEndGame() {
     _hardware->printOled2("ESCI", 2, 35, 25);
 }
 
+/**
+ * @brief Termina forzatamente la partita in corso.
+ * @details Chiamata quando viene ricevuto il comando di rete corrispondente.
+ * Calcola il vincitore in base al tempo di possesso attuale e passa allo stato GAME_OVER.
+ */
+void DominationMode::forceEndGame() {
+    Serial.println("!!! COMANDO RICEVUTO: forceEndGame in Dominio !!!");
+    // Se la partita è già finita la guardia della transizione la ignora.
+    _machine.handle(ModeEvent::FORCE_END);
+}
+
+/**
+ * @brief Accoda l'effetto di inizio partita: nota lunga, poi un lampo bianco.
+ * @details Non bloccante: la schermata di gioco viene disegnata subito dopo.
+ */
+void DominationMode::playStartEffect() {
+    _hardware->effects()
+        .tone(1500, 500)
+        .brightness(255)
+        .stripOff(100)
+        .fill(255, 255, 255, 500)
+        .stripOff()
+        .brightness(80);
+}
+
 void DominationMode::sendSettingsStatus() {
+    sendSettingsStatus(_network, _settings);
+}
+
+void DominationMode::sendSettingsStatus(NetworkManager* network, const DominationSettings& settings) {
     char message[100];
     sprintf(message, "event:settings_update;duration:%d;capture:%d;countdown:%d;",
-            _settings->getGameDuration(),
-            _settings->getCaptureTime(),
-            _settings->getCountdownDuration());
-    _network->sendStatus(message);
+            settings.getGameDuration(),
+            settings.getCaptureTime(),
+            settings.getCountdownDuration());
+    network->sendStatus(message);
 }
\ No newline at end of file
@@ -6,29 +6,38 @@
 #include "GameMode.h"
 #include "HardwareManager.h"
 #include "NetworkManager.h"
+#include "EventBus.h"
+#include "StateMachine.h"
 #include "DominationSettings.h"
+#include "ModeRegistry.h"
 #include "app_common.h"
 
 class DominationMode : public GameMode {
 public:
-    DominationMode(HardwareManager* hardware, NetworkManager* network, DominationSettings* settings, AppState* appState, MainMenuDisplayFunction displayFunc);
+    DominationMode(HardwareManager* hardware, NetworkManager* network, EventBus* events, AppState* appState, MainMenuDisplayFunction displayFunc);
+
+    /** @brief Fabbrica per il ModeRegistry: costruisce la modalità nell'arena. */
+    static GameMode* create(void* arena, const ModeContext& context);
 
     void enter() override;
     void loop() override;
     void exit() override;
     void sendSettingsStatus();
+    /** @brief Invia le impostazioni indicate, anche senza la modalità costruita (es. dal Terminale). */
+    static void sendSettingsStatus(NetworkManager* network, const DominationSettings& settings);
     void enterInGame();
     void forceEndGame();
 
 private:
     HardwareManager* _hardware;
     NetworkManager* _network;
-    DominationSettings* _settings;
+    EventBus* _events;
+    DominationSettings _settings;       // Caricate dalla memoria flash alla costruzione
     
     AppState* _appStatePtr;
     MainMenuDisplayFunction _mainMenuDisplayFunc;
 
-    enum class ModeState {
+    enum class ModeState : uint8_t {
         MODE_SUB_MENU,
         MENU_SETTINGS,
         EDIT_DURATION,
@@ -43,8 +52,32 @@ private:
         TEAM2_CAPTURED,
         GAME_OVER
     };
-    ModeState _currentState;
+    /** @brief Eventi della macchina a stati: ingressi della passata e scadenze rilevate dagli stati. */
+    enum class ModeEvent : uint8_t {
+        MENU_UP,            // Tasto '2'
+        MENU_DOWN,          // Tasto '8'
+        DIGIT,              // Tasto numerico
+        ERASE,              // Tasto '*'
+        BACK,               // Pulsante 1 premuto
+        CONFIRM,            // Pulsante 2 premuto
+        ANY_INPUT,          // Un pulsante o un tasto qualsiasi
+        TEAM1_HOLD,         // Pulsante 1 tenuto
+        TEAM1_RELEASE,
+        TEAM2_HOLD,         // Pulsante 2 tenuto
+        TEAM2_RELEASE,
+        COUNTDOWN_DONE,
+        CAPTURE_DONE,
+        TIME_UP,
+        FORCE_END
+    };
+    typedef StateMachine<DominationMode, ModeState, ModeEvent> Machine;
+    struct Tables;          // Tabelle di stati e transizioni, in DominationMode.cpp
+
+    Machine _machine;
     ModeState _lastZoneState;
+    static int8_t _stateProbes; // Sonda del Profiler del primo stato: una per ModeState, nello stesso ordine.
+                                // Registrate alla prima costruzione e condivise dalle successive.
+    char _key;              // Tasto della passata corrente, letto da appendDigit()
 
     int _subMenuIndex;
     int _menuIndex;
@@ -62,23 +95,56 @@ private:
     unsigned long _lastPossessionUpdateTime;
     int _winner; // 0 = Pareggio, 1 = Squadra 1, 2 = Squadra 2
 
-    // Funzioni
+    // Ingresso negli stati
     void displaySubMenu();
-    void handleSubMenuInput(char key, bool btn1, bool btn2);
     void displaySettingsMenu();
-    void handleSettingsInput(char key, bool btn1, bool btn2);
-    void displayEditScreen(const String& title, const String& currentValue, const String& unit);
-    void handleEditInput(char key, bool btn1, bool btn2);
     void updateDisplayForCurrentState();
     void displayConfirmScreen();
-    void handleConfirmInput(bool btn1, bool btn2);
+    void startCountdown();
+    void displayZoneScreen();
+    void startCapture();
+    void stopCaptureTone();
+
+    // Aggiornamento a ogni passata
     void handleCountdown();
-    void updateGameTimerOnRow(int row);
-    void handleNeutralState(bool btn1_is_pressed, bool btn2_is_pressed);
+    void handleNeutralState();
+    void handleCapturingState();
+    void handleCapturedState();
+    void handleGameOverState();
+
+    // Guardie
+    bool isStartSelected() const { return _subMenuIndex == 0; }
+    bool isSettingsSelected() const { return _subMenuIndex == 1; }
+    template <int Item> bool isSettingSelected() const { return _menuIndex == Item; }
+    bool isZoneNeutral() const { return _lastZoneState == ModeState::IN_GAME_NEUTRAL; }
+    bool isZoneTeam1() const { return _lastZoneState == ModeState::TEAM1_CAPTURED; }
+    bool isZoneTeam2() const { return _lastZoneState == ModeState::TEAM2_CAPTURED; }
+    bool isNotGameOver() const { return _machine.getState() != ModeState::GAME_OVER; }
+
+    // Azioni delle transizioni
+    void selectPreviousItem();
+    void selectNextItem();
+    void leaveModeWithTone();
+    void leaveMode();
+    void playConfirmTone();
+    void playBackTone();
+    void openSettings();
+    void closeSettings();
+    void startEdit();
+    void appendDigit();
+    void eraseDigit();
+    void saveEdit();
+    void startGame();
+    void cancelCapture();
+    void completeCapture();
+    void endGameOnTime();
+    void endGameForced();
+
+    void displayEditScreen(const String& title, const String& currentValue, const String& unit);
     void displayCapturingScreen(int team);
-    void handleCapturingState(bool btn1_is_pressed, bool btn2_is_pressed);
-    void handleCapturedState(int team, bool btn1_is_pressed, bool btn2_is_pressed);
-    void handleGameOverState(bool btn1_was_pressed, bool btn2_was_pressed, char key);
+    void playStartEffect();
+    bool updateGameTimerOnRow(int row);
+    void finishGame(bool forced);
 };
 
 #endif // DOMINATION_MODE_H
\ No newline at end of file
@@ -25,9 +25,9 @@ void DominationSettings::loadParameters() {
 }
 
 // Implementazione Getter
-int DominationSettings::getGameDuration() { return _gameDuration; }
-int DominationSettings::getCaptureTime() { return _captureTime; }
-int DominationSettings::getCountdownDuration() { return _countdownDuration; }
+int DominationSettings::getGameDuration() const { return _gameDuration; }
+int DominationSettings::getCaptureTime() const { return _captureTime; }
+int DominationSettings::getCountdownDuration() const { return _countdownDuration; }
 
 // Implementazione Setter
 void DominationSettings::setGameDuration(int duration) { _gameDuration = duration; }
@@ -13,9 +13,9 @@ public:
     void loadParameters();
 
     // Metodi getter
-    int getGameDuration();
-    int getCaptureTime();
-    int getCountdownDuration();
+    int getGameDuration() const;
+    int getCaptureTime() const;
+    int getCountdownDuration() const;
 
     // Metodi setter
     void setGameDuration(int duration);
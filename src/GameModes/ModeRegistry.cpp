@@ -0,0 +1,58 @@
+// src/GameModes/ModeRegistry.cpp
+
+#include "GameModes/ModeRegistry.h"
+
+ModeRegistry::ModeRegistry(const ModeContext& context) :
+    _context(context),
+    _count(0),
+    _activeIndex(-1),
+    _active(nullptr)
+{
+}
+
+ModeRegistry::~ModeRegistry() {
+    deactivate();
+}
+
+bool ModeRegistry::add(AppState state, const char* name, GameModeFactory factory) {
+    if (_count >= MODE_REGISTRY_MAX_MODES || factory == nullptr || indexOf(state) >= 0) {
+        return false;
+    }
+    _entries[_count++] = {state, name, factory};
+    return true;
+}
+
+GameMode* ModeRegistry::activate(AppState state) {
+    int8_t index = indexOf(state);
+    if (index < 0) {
+        return nullptr;
+    }
+    deactivate();
+    _active = _entries[index].create(_arena, _context);
+    _activeIndex = index;
+    return _active;
+}
+
+void ModeRegistry::deactivate() {
+    if (_active != nullptr) {
+        _active->~GameMode();
+        _active = nullptr;
+        _activeIndex = -1;
+    }
+}
+
+GameMode* ModeRegistry::getActive(AppState state) const {
+    if (_activeIndex < 0 || _entries[_activeIndex].state != state) {
+        return nullptr;
+    }
+    return _active;
+}
+
+int8_t ModeRegistry::indexOf(AppState state) const {
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_entries[i].state == state) {
+            return (int8_t)i;
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,111 @@
+// src/GameModes/ModeRegistry.h
+
+/**
+ * @file ModeRegistry.h
+ * @brief Elenco delle modalità del menu principale e arena della modalità attiva.
+ * @details Ogni modalità si registra con il nome del menu, l'AppState in cui è
+ * attiva e la sua fabbrica (il metodo statico create() della classe). Il menu
+ * principale e lo smistamento del loop() sono generati da questo elenco: una
+ * nuova modalità si aggiunge con una riga in setup().
+ *
+ * Viene costruita solo la modalità attiva, con placement new in un'area di
+ * memoria statica (l'arena): all'avvio nessuna modalità viene creata e la
+ * memoria occupata è quella della modalità più grande, non la somma di tutte.
+ * Le impostazioni appartengono alla modalità e vengono caricate quando viene
+ * costruita.
+ */
+
+#ifndef MODE_REGISTRY_H
+#define MODE_REGISTRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "GameMode.h"
+#include "app_common.h"
+
+class HardwareManager;
+class NetworkManager;
+class EventBus;
+class FirmwareUpdater;
+class ModeRegistry;
+
+#define MODE_REGISTRY_MAX_MODES 8   // Voci del menu principale
+#define MODE_ARENA_SIZE 512         // Byte dell'arena: almeno sizeof() della modalità più grande
+
+/**
+ * @brief Oggetti condivisi passati alle fabbriche delle modalità.
+ * @details Ogni modalità prende solo ciò che le serve.
+ */
+struct ModeContext {
+    HardwareManager* hardware;
+    NetworkManager* network;
+    EventBus* events;
+    FirmwareUpdater* updater;
+    AppState* appState;                         // Stato globale, per tornare al menu principale
+    MainMenuDisplayFunction displayMainMenu;
+    ModeRegistry* registry;                     // Per passare a un'altra modalità (es. avvio remoto)
+};
+
+/**
+ * @brief Fabbrica di una modalità: la costruisce nell'arena e la restituisce.
+ */
+typedef GameMode* (*GameModeFactory)(void* arena, const ModeContext& context);
+
+class ModeRegistry {
+public:
+    explicit ModeRegistry(const ModeContext& context);
+    ~ModeRegistry();
+
+    /**
+     * @brief Registra una modalità; l'ordine di registrazione è l'ordine del menu.
+     * @details Mode deve avere il metodo statico create() con la firma di GameModeFactory.
+     * Le dimensioni della classe sono verificate in compilazione contro l'arena.
+     * @return false se l'elenco è pieno o lo stato è già registrato.
+     */
+    template <typename Mode>
+    bool add(AppState state, const char* name) {
+        static_assert(sizeof(Mode) <= MODE_ARENA_SIZE, "Modalita' piu' grande dell'arena: aumentare MODE_ARENA_SIZE");
+        static_assert(alignof(Mode) <= alignof(max_align_t), "Allineamento della modalita' non supportato dall'arena");
+        return add(state, name, &Mode::create);
+    }
+    bool add(AppState state, const char* name, GameModeFactory factory);
+
+    uint8_t getCount() const { return _count; }
+    const char* getName(uint8_t index) const { return _entries[index].name; }
+    AppState getState(uint8_t index) const { return _entries[index].state; }
+
+    /**
+     * @brief Distrugge la modalità attiva e costruisce quella dello stato indicato.
+     * @details Non chiama enter() né exit(): il chiamante decide come entrare
+     * (enter() dal menu, enterInGame() da remoto). La modalità precedente deve
+     * aver già eseguito exit(); se activate() viene chiamata da un suo metodo,
+     * dopo il ritorno quel metodo non deve più usare i propri membri.
+     * @return La nuova modalità, nullptr se lo stato non è registrato.
+     */
+    GameMode* activate(AppState state);
+    /** @brief Distrugge la modalità attiva, se c'è (es. al ritorno nel menu principale). */
+    void deactivate();
+
+    /** @brief La modalità costruita nell'arena, nullptr se nessuna. */
+    GameMode* getActive() const { return _active; }
+    /** @brief La modalità costruita, solo se è quella dello stato indicato. */
+    GameMode* getActive(AppState state) const;
+
+private:
+    struct Entry {
+        AppState state;
+        const char* name;
+        GameModeFactory create;
+    };
+
+    int8_t indexOf(AppState state) const;
+
+    ModeContext _context;
+    Entry _entries[MODE_REGISTRY_MAX_MODES];
+    uint8_t _count;
+    int8_t _activeIndex;
+    GameMode* _active;
+    alignas(max_align_t) uint8_t _arena[MODE_ARENA_SIZE];
+};
+
+#endif // MODE_REGISTRY_H
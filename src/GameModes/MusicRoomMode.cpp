@@ -1,4 +1,5 @@
 #include "GameModes/MusicRoomMode.h"
+#include <new>
 
 // Lista delle melodie disponibili
 const Tune tunes[] = {
@@ -16,6 +17,10 @@ MusicRoomMode::MusicRoomMode(HardwareManager* hardware, AppState* appState, Main
       _currentlyPlayingIndex(-1) {
 }
 
+GameMode* MusicRoomMode::create(void* arena, const ModeContext& context) {
+    return new (arena) MusicRoomMode(context.hardware, context.appState, context.displayMainMenu);
+}
+
 void MusicRoomMode::enter() {
     Serial.println("Entrato in Stanza dei Suoni");
     _menuIndex = 0;
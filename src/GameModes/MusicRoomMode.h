@@ -5,6 +5,7 @@
 
 #include "GameMode.h"
 #include "HardwareManager.h"
+#include "ModeRegistry.h"
 #include "app_common.h"
 #include "melodies.h" // Includiamo le melodie
 
@@ -18,6 +19,8 @@ struct Tune {
 class MusicRoomMode : public GameMode {
 public:
     MusicRoomMode(HardwareManager* hardware, AppState* appState, MainMenuDisplayFunction displayFunc);
+    /** @brief Fabbrica per il ModeRegistry: costruisce la modalità nell'arena. */
+    static GameMode* create(void* arena, const ModeContext& context);
 
     void enter() override;
     void loop() override;
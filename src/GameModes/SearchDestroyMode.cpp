@@ -6,19 +6,162 @@
  */
 
 #include "SearchDestroyMode.h"
+#include "Profiler.h"
+#include <new>
+
+/**
+ * @brief Tabelle della macchina a stati di Cerca & Distruggi.
+ * @details Ogni passata del loop() esegue l'aggiornamento dello stato corrente
+ * (timer della bomba, barre di avanzamento, scadenze) e poi consegna gli
+ * ingressi come eventi (vedi loop()). Le schermate si disegnano all'ingresso
+ * negli stati; suoni, messaggi e impostazioni stanno nelle azioni.
+ */
+struct SearchDestroyMode::Tables {
+    typedef SearchDestroyMode D;
+    typedef D::ModeState S;
+    typedef D::ModeEvent E;
+
+    static constexpr Machine::StateSpec STATES[] = {
+        // stato                         nome                        ingresso                           aggiornamento                  uscita
+        { S::MODE_SUB_MENU,            "MODE_SUB_MENU",            &D::displaySubMenu,                nullptr,                       nullptr },
+        { S::MENU_SETTINGS,            "MENU_SETTINGS",            &D::displaySettingsMenu,           nullptr,                       nullptr },
+        { S::EDIT_BOMB_TIME,           "EDIT_BOMB_TIME",           &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::EDIT_ARM_PIN,             "EDIT_ARM_PIN",             &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::EDIT_DISARM_PIN,          "EDIT_DISARM_PIN",          &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::EDIT_ARM_TIME,            "EDIT_ARM_TIME",            &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::EDIT_DEFUSE_TIME,         "EDIT_DEFUSE_TIME",         &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::EDIT_USE_ARM_PIN,         "EDIT_USE_ARM_PIN",         &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::EDIT_USE_DISARM_PIN,      "EDIT_USE_DISARM_PIN",      &D::updateDisplayForCurrentState,  nullptr,                       nullptr },
+        { S::IN_GAME_CONFIRM,          "IN_GAME_CONFIRM",          &D::displayConfirmScreen,          nullptr,                       nullptr },
+        { S::IN_GAME_AWAIT_ARM,        "IN_GAME_AWAIT_ARM",        &D::displayAwaitArmScreen,         &D::handleAwaitArmState,       nullptr },
+        { S::IN_GAME_IS_ARMING,        "IN_GAME_IS_ARMING",        &D::startArming,                   &D::handleArmingState,         &D::stopActionTone },
+        { S::IN_GAME_ENTER_ARM_PIN,    "IN_GAME_ENTER_ARM_PIN",    &D::updateDisplayForCurrentState,   &D::handleEnterArmPinState,    nullptr },
+        { S::IN_GAME_ARMED,            "IN_GAME_ARMED",            &D::showBombArmed,                 &D::handleArmedState,          nullptr },
+        { S::IN_GAME_COUNTDOWN,        "IN_GAME_COUNTDOWN",        &D::displayCountdownLayout,        &D::handleCountdownState,      nullptr },
+        { S::IN_GAME_IS_DEFUSING,      "IN_GAME_IS_DEFUSING",      &D::startDefusing,                 &D::handleDefusingState,       &D::stopActionTone },
+        { S::IN_GAME_ENTER_DEFUSE_PIN, "IN_GAME_ENTER_DEFUSE_PIN", &D::updateDisplayForCurrentState,   &D::handleEnterDefusePinState, nullptr },
+        { S::IN_GAME_DEFUSED,          "IN_GAME_DEFUSED",          &D::displayExitPrompt,             &D::handleDefusedState,        nullptr },
+        { S::IN_GAME_ENDED,            "IN_GAME_ENDED",            nullptr,                           nullptr,                       nullptr },
+    };
+
+    static constexpr Machine::Transition TRANSITIONS[] = {
+        // da                            evento                guardia                      azione                    a
+        { S::MODE_SUB_MENU,            E::MENU_UP,          nullptr,                     &D::selectPreviousItem,   S::MODE_SUB_MENU },
+        { S::MODE_SUB_MENU,            E::MENU_DOWN,        nullptr,                     &D::selectNextItem,       S::MODE_SUB_MENU },
+        { S::MODE_SUB_MENU,            E::BACK,             nullptr,                     &D::leaveModeWithTone,    S::MODE_SUB_MENU },
+        { S::MODE_SUB_MENU,            E::CONFIRM,          &D::isStartSelected,         &D::playConfirmTone,      S::IN_GAME_CONFIRM },
+        { S::MODE_SUB_MENU,            E::CONFIRM,          &D::isSettingsSelected,      &D::openSettings,         S::MENU_SETTINGS },
+
+        { S::MENU_SETTINGS,            E::MENU_UP,          nullptr,                     &D::selectPreviousItem,   S::MENU_SETTINGS },
+        { S::MENU_SETTINGS,            E::MENU_DOWN,        nullptr,                     &D::selectNextItem,       S::MENU_SETTINGS },
+        { S::MENU_SETTINGS,            E::BACK,             nullptr,                     &D::closeSettings,        S::MODE_SUB_MENU },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<0>,    &D::startEdit,            S::EDIT_BOMB_TIME },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<1>,    &D::startEdit,            S::EDIT_ARM_PIN },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<2>,    &D::startEdit,            S::EDIT_DISARM_PIN },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<3>,    &D::startEdit,            S::EDIT_ARM_TIME },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<4>,    &D::startEdit,            S::EDIT_DEFUSE_TIME },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<5>,    &D::startEdit,            S::EDIT_USE_ARM_PIN },
+        { S::MENU_SETTINGS,            E::CONFIRM,          &D::isSettingSelected<6>,    &D::startEdit,            S::EDIT_USE_DISARM_PIN },
+
+        // Modifica di un valore: un valore non valido mostra l'errore e resta nella schermata.
+        { S::EDIT_BOMB_TIME,           E::CHARACTER,        nullptr,                     &D::appendCharacter,      S::EDIT_BOMB_TIME },
+        { S::EDIT_BOMB_TIME,           E::ERASE,            nullptr,                     &D::eraseCharacter,       S::EDIT_BOMB_TIME },
+        { S::EDIT_BOMB_TIME,           E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_BOMB_TIME,           E::CONFIRM,          &D::isEditValid,             &D::saveEdit,             S::MENU_SETTINGS },
+        { S::EDIT_BOMB_TIME,           E::CONFIRM,          nullptr,                     &D::showInvalidValue,     S::EDIT_BOMB_TIME },
+
+        { S::EDIT_ARM_PIN,             E::CHARACTER,        nullptr,                     &D::appendCharacter,      S::EDIT_ARM_PIN },
+        { S::EDIT_ARM_PIN,             E::ERASE,            nullptr,                     &D::eraseCharacter,       S::EDIT_ARM_PIN },
+        { S::EDIT_ARM_PIN,             E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_ARM_PIN,             E::CONFIRM,          &D::isEditValid,             &D::saveEdit,             S::MENU_SETTINGS },
+        { S::EDIT_ARM_PIN,             E::CONFIRM,          nullptr,                     &D::showInvalidValue,     S::EDIT_ARM_PIN },
+
+        { S::EDIT_DISARM_PIN,          E::CHARACTER,        nullptr,                     &D::appendCharacter,      S::EDIT_DISARM_PIN },
+        { S::EDIT_DISARM_PIN,          E::ERASE,            nullptr,                     &D::eraseCharacter,       S::EDIT_DISARM_PIN },
+        { S::EDIT_DISARM_PIN,          E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_DISARM_PIN,          E::CONFIRM,          &D::isEditValid,             &D::saveEdit,             S::MENU_SETTINGS },
+        { S::EDIT_DISARM_PIN,          E::CONFIRM,          nullptr,                     &D::showInvalidValue,     S::EDIT_DISARM_PIN },
+
+        { S::EDIT_ARM_TIME,            E::CHARACTER,        nullptr,                     &D::appendCharacter,      S::EDIT_ARM_TIME },
+        { S::EDIT_ARM_TIME,            E::ERASE,            nullptr,                     &D::eraseCharacter,       S::EDIT_ARM_TIME },
+        { S::EDIT_ARM_TIME,            E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_ARM_TIME,            E::CONFIRM,          &D::isEditValid,             &D::saveEdit,             S::MENU_SETTINGS },
+        { S::EDIT_ARM_TIME,            E::CONFIRM,          nullptr,                     &D::showInvalidValue,     S::EDIT_ARM_TIME },
+
+        { S::EDIT_DEFUSE_TIME,         E::CHARACTER,        nullptr,                     &D::appendCharacter,      S::EDIT_DEFUSE_TIME },
+        { S::EDIT_DEFUSE_TIME,         E::ERASE,            nullptr,                     &D::eraseCharacter,       S::EDIT_DEFUSE_TIME },
+        { S::EDIT_DEFUSE_TIME,         E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_DEFUSE_TIME,         E::CONFIRM,          &D::isEditValid,             &D::saveEdit,             S::MENU_SETTINGS },
+        { S::EDIT_DEFUSE_TIME,         E::CONFIRM,          nullptr,                     &D::showInvalidValue,     S::EDIT_DEFUSE_TIME },
+
+        { S::EDIT_USE_ARM_PIN,         E::MENU_UP,          nullptr,                     &D::toggleSelection,      S::EDIT_USE_ARM_PIN },
+        { S::EDIT_USE_ARM_PIN,         E::MENU_DOWN,        nullptr,                     &D::toggleSelection,      S::EDIT_USE_ARM_PIN },
+        { S::EDIT_USE_ARM_PIN,         E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_USE_ARM_PIN,         E::CONFIRM,          nullptr,                     &D::saveBooleanEdit,      S::MENU_SETTINGS },
+
+        { S::EDIT_USE_DISARM_PIN,      E::MENU_UP,          nullptr,                     &D::toggleSelection,      S::EDIT_USE_DISARM_PIN },
+        { S::EDIT_USE_DISARM_PIN,      E::MENU_DOWN,        nullptr,                     &D::toggleSelection,      S::EDIT_USE_DISARM_PIN },
+        { S::EDIT_USE_DISARM_PIN,      E::BACK,             nullptr,                     &D::playBackTone,         S::MENU_SETTINGS },
+        { S::EDIT_USE_DISARM_PIN,      E::CONFIRM,          nullptr,                     &D::saveBooleanEdit,      S::MENU_SETTINGS },
+
+        { S::IN_GAME_CONFIRM,          E::BACK,             nullptr,                     &D::resetRound,           S::MODE_SUB_MENU },
+        { S::IN_GAME_CONFIRM,          E::CONFIRM,          nullptr,                     &D::startRound,           S::IN_GAME_AWAIT_ARM },
+
+        { S::IN_GAME_AWAIT_ARM,        E::ARM_HOLD,         nullptr,                     nullptr,                  S::IN_GAME_IS_ARMING },
+
+        { S::IN_GAME_IS_ARMING,        E::ARM_RELEASE,      nullptr,                     &D::cancelArming,         S::IN_GAME_AWAIT_ARM },
+        { S::IN_GAME_IS_ARMING,        E::ARM_DONE,         &D::usesArmingPin,           &D::clearInput,           S::IN_GAME_ENTER_ARM_PIN },
+        { S::IN_GAME_IS_ARMING,        E::ARM_DONE,         nullptr,                     nullptr,                  S::IN_GAME_ARMED },
+
+        { S::IN_GAME_ENTER_ARM_PIN,    E::CHARACTER,        nullptr,                     &D::appendPinCharacter,   S::IN_GAME_ENTER_ARM_PIN },
+        { S::IN_GAME_ENTER_ARM_PIN,    E::ERASE,            nullptr,                     &D::erasePinCharacter,    S::IN_GAME_ENTER_ARM_PIN },
+        { S::IN_GAME_ENTER_ARM_PIN,    E::BACK,             nullptr,                     nullptr,                  S::IN_GAME_AWAIT_ARM },
+        { S::IN_GAME_ENTER_ARM_PIN,    E::PIN_ENTERED,      &D::isArmingPinCorrect,      nullptr,                  S::IN_GAME_ARMED },
+        { S::IN_GAME_ENTER_ARM_PIN,    E::PIN_ENTERED,      nullptr,                     &D::showWrongPin,         S::IN_GAME_ENTER_ARM_PIN },
+
+        { S::IN_GAME_ARMED,            E::ARMED_DELAY_DONE, nullptr,                     &D::startBombTimer,       S::IN_GAME_COUNTDOWN },
+
+        { S::IN_GAME_COUNTDOWN,        E::DEFUSE_PRESS,     nullptr,                     nullptr,                  S::IN_GAME_IS_DEFUSING },
+
+        { S::IN_GAME_IS_DEFUSING,      E::DEFUSE_RELEASE,   nullptr,                     &D::cancelDefusing,       S::IN_GAME_COUNTDOWN },
+        { S::IN_GAME_IS_DEFUSING,      E::DEFUSE_DONE,      &D::usesDisarmingPin,        &D::clearInput,           S::IN_GAME_ENTER_DEFUSE_PIN },
+        { S::IN_GAME_IS_DEFUSING,      E::DEFUSE_DONE,      nullptr,                     &D::defuseBomb,           S::IN_GAME_DEFUSED },
+
+        { S::IN_GAME_ENTER_DEFUSE_PIN, E::CHARACTER,        nullptr,                     &D::appendPinCharacter,   S::IN_GAME_ENTER_DEFUSE_PIN },
+        { S::IN_GAME_ENTER_DEFUSE_PIN, E::ERASE,            nullptr,                     &D::erasePinCharacter,    S::IN_GAME_ENTER_DEFUSE_PIN },
+        { S::IN_GAME_ENTER_DEFUSE_PIN, E::BACK,             nullptr,                     nullptr,                  S::IN_GAME_COUNTDOWN },
+        { S::IN_GAME_ENTER_DEFUSE_PIN, E::PIN_ENTERED,      &D::isDisarmingPinCorrect,   &D::defuseBomb,           S::IN_GAME_DEFUSED },
+        { S::IN_GAME_ENTER_DEFUSE_PIN, E::PIN_ENTERED,      nullptr,                     &D::showWrongPin,         S::IN_GAME_ENTER_DEFUSE_PIN },
+
+        { S::IN_GAME_DEFUSED,          E::ANY_INPUT,        nullptr,                     &D::leaveMode,            S::IN_GAME_DEFUSED },
+        { S::IN_GAME_ENDED,            E::ANY_INPUT,        nullptr,                     &D::leaveMode,            S::IN_GAME_ENDED },
+
+        // TIME_UP arriva solo dagli stati con la bomba innescata; FORCE_END (CMD:FORCE_END_GAME) da qualunque stato.
+        { Machine::ANY,                E::TIME_UP,          nullptr,                     &D::explodeBomb,          S::IN_GAME_ENDED },
+        { Machine::ANY,                E::FORCE_END,        &D::isNotGameOver,           &D::endGameForced,        S::IN_GAME_DEFUSED },
+    };
+
+    static constexpr size_t STATE_COUNT = sizeof(STATES) / sizeof(STATES[0]);
+    static constexpr size_t TRANSITION_COUNT = sizeof(TRANSITIONS) / sizeof(TRANSITIONS[0]);
+    static constexpr Machine::StateTable<STATE_COUNT, TRANSITION_COUNT> TABLE{ STATES, TRANSITIONS };
+
+    static_assert(STATE_COUNT == (size_t)S::IN_GAME_ENDED + 1, "Una riga per ogni ModeState");
+    static_assert(TABLE.isValid(), "Stati nell'ordine di ModeState, transizioni raggruppate per stato");
+};
 
 /**
  * @brief Costruttore.
  * @details Inizializza tutte le variabili membro con i loro valori di default.
  * Viene chiamato una sola volta in main.cpp alla creazione dell'oggetto sdMode.
  */
-SearchDestroyMode::SearchDestroyMode(HardwareManager* hardware, NetworkManager* network, SearchDestroySettings* settings, AppState* appState, MainMenuDisplayFunction displayFunc)
+SearchDestroyMode::SearchDestroyMode(HardwareManager* hardware, NetworkManager* network, EventBus* events, AppState* appState, MainMenuDisplayFunction displayFunc)
     : _hardware(hardware),
       _network(network),
-      _settings(settings),
+      _events(events),
       _appStatePtr(appState),
       _mainMenuDisplayFunc(displayFunc),
-      _currentState(ModeState::MODE_SUB_MENU),
+      _machine(this, Tables::TABLE, ModeState::MODE_SUB_MENU),
+      _key(NO_KEY),
       _menuIndex(0),
       _subMenuIndex(0),
       _tempBoolSelection(true),
@@ -27,7 +170,17 @@ SearchDestroyMode::SearchDestroyMode(HardwareManager* hardware, NetworkManager*
       _defusingStartTime(0),
       _stateChangeTime(0),
       _lastDisplayedSeconds(-1),
-      _gameIsActive(false) {
+      _showingMessage(false) {
+    if (_stateProbes < 0) {
+        _stateProbes = profiler.addGroup("sd", Tables::TABLE.names, Tables::STATE_COUNT);
+    }
+}
+
+int8_t SearchDestroyMode::_stateProbes = -1;
+
+GameMode* SearchDestroyMode::create(void* arena, const ModeContext& context) {
+    return new (arena) SearchDestroyMode(context.hardware, context.network, context.events,
+                                         context.appState, context.displayMainMenu);
 }
 
 /**
@@ -38,12 +191,11 @@ SearchDestroyMode::SearchDestroyMode(HardwareManager* hardware, NetworkManager*
  */
 void SearchDestroyMode::enter() {
     Serial.println("Entrato in modalita' Cerca & Distruggi");
-    _currentState = ModeState::MODE_SUB_MENU;
     _subMenuIndex = 0;
-    _gameIsActive = false;
-    displaySubMenu();
+    _showingMessage = false;
+    _machine.start(ModeState::MODE_SUB_MENU);
     _hardware->setStripColor(255, 100, 0);  // Colore arancione tipico della modalità
-    _network->sendStatus("event:mode_enter;mode:sd;");
+    _events->publish(GameEventId::MODE_ENTER, GameEventMode::SEARCH_DESTROY);
     sendSettingsStatus();
 }
 
@@ -51,61 +203,56 @@ void SearchDestroyMode::enter() {
  * @brief Funzione di ingresso diretto in partita, saltando i menu.
  */
 void SearchDestroyMode::enterInGame() {
-    _network->sendStatus("event:mode_enter;mode:sd;");
+    _events->publish(GameEventId::MODE_ENTER, GameEventMode::SEARCH_DESTROY);
     sendSettingsStatus();
     Serial.println("Entrato in Cerca & Distruggi (remoto)");
-    // _network->sendStatus("event:game_start;");
+    _showingMessage = false;
     _hardware->playTone(1500, 150);
-    _currentState = ModeState::IN_GAME_AWAIT_ARM; 
-    displayAwaitArmScreen();
+    _machine.start(ModeState::IN_GAME_AWAIT_ARM);
 }
 
 /**
  * @brief Ciclo principale della modalità.
  * @details Chiamata ad ogni iterazione del loop() di main.cpp quando questa modalità è attiva.
- * Legge lo stato dei pulsanti e, in base allo stato interno (_currentState),
- * delega il lavoro alla funzione di gestione appropriata (es. handleSubMenuInput, handleInGame, etc.).
+ * Esegue l'aggiornamento dello stato corrente (timer, barre di avanzamento) e
+ * consegna gli ingressi della passata alla macchina a stati come eventi.
  */
 void SearchDestroyMode::loop() {
-    char key = _hardware->getKey();
+    // La passata è attribuita allo stato in cui inizia.
+    ModeState state = _machine.getState();
+    ProfileScope profile(_stateProbes >= 0 ? _stateProbes + (int8_t)state : -1);
+    _key = _hardware->getKey();
     bool btn1_is_pressed = _hardware->isButton1Pressed(); 
     bool btn1_was_pressed = _hardware->wasButton1Pressed();
     bool btn2_is_pressed = _hardware->isButton2Pressed();
     bool btn2_was_pressed = _hardware->wasButton2Pressed();
 
-    String command = _network->getReceivedMessage();
-    if (command == "CMD:FORCE_END_GAME") {
-        forceEndGame();
+    // CMD:FORCE_END_GAME arriva tramite il CommandRouter in main.cpp.
+
+    _machine.update();
+
+    // Durante un messaggio temporaneo l'input è sospeso.
+    if (_showingMessage) {
+        return;
     }
 
-    // La logica è divisa in due macrogruppi: gestione dei menu e gestione del gioco vero e proprio.
-    if (_currentState >= ModeState::IN_GAME_CONFIRM) {
-        handleInGame(key, btn1_is_pressed, btn1_was_pressed, btn2_is_pressed, btn2_was_pressed);
-    } else {
-        // Gestisce la logica dei vari sottomenu
-        switch (_currentState) {
-            case ModeState::MODE_SUB_MENU:
-                handleSubMenuInput(key, btn1_was_pressed, btn2_was_pressed);
-                break;
-            case ModeState::MENU_SETTINGS:
-                handleSettingsInput(key, btn1_was_pressed, btn2_was_pressed);
-                break;
-            case ModeState::EDIT_BOMB_TIME:
-            case ModeState::EDIT_ARM_PIN:
-            case ModeState::EDIT_DISARM_PIN:
-            case ModeState::EDIT_ARM_TIME:
-            case ModeState::EDIT_DEFUSE_TIME:
-                handleEditInput(key, btn1_was_pressed, btn2_was_pressed);
-                break;
-            case ModeState::EDIT_USE_ARM_PIN:
-            case ModeState::EDIT_USE_DISARM_PIN:
-                handleBooleanEditInput(key, btn1_was_pressed, btn2_was_pressed);
-                break;
-            default:
-                _currentState = ModeState::MODE_SUB_MENU;
-                displaySubMenu();
-                break;
-        }
+    // Gli ingressi diventano eventi; dopo un cambio di stato (anche durante
+    // update()) quelli rimasti vengono ignorati fino alla passata successiva.
+    ModeEvent inputs[8];
+    uint8_t inputCount = 0;
+    if (_key == '2') inputs[inputCount++] = ModeEvent::MENU_UP;
+    else if (_key == '8') inputs[inputCount++] = ModeEvent::MENU_DOWN;
+    if (isalnum(_key)) inputs[inputCount++] = ModeEvent::CHARACTER;
+    else if (_key == '*') inputs[inputCount++] = ModeEvent::ERASE;
+    if (btn1_was_pressed) inputs[inputCount++] = ModeEvent::BACK;
+    if (btn2_was_pressed) inputs[inputCount++] = ModeEvent::CONFIRM;
+    if (btn1_was_pressed || btn2_was_pressed || _key != NO_KEY) inputs[inputCount++] = ModeEvent::ANY_INPUT;
+    inputs[inputCount++] = btn1_is_pressed ? ModeEvent::ARM_HOLD : ModeEvent::ARM_RELEASE;
+    if (!btn2_is_pressed) inputs[inputCount++] = ModeEvent::DEFUSE_RELEASE;
+    else if (btn2_was_pressed) inputs[inputCount++] = ModeEvent::DEFUSE_PRESS;
+
+    for (uint8_t i = 0; i < inputCount && _machine.getState() == state; i++) {
+        _machine.handle(inputs[i]);
     }
 }
 
@@ -116,458 +263,403 @@ void SearchDestroyMode::loop() {
  */
 void SearchDestroyMode::exit() {
     Serial.println("Uscito da modalita' Cerca & Distruggi");
-    _network->sendStatus("event:mode_exit;mode:sd;");
-    _settings->saveParameters();
+    _events->publish(GameEventId::MODE_EXIT, GameEventMode::SEARCH_DESTROY);
+    _network->clearTimerAnchor();
+    _settings.saveParameters();
+    stopEffects();
     _hardware->turnOffStrip();
     _hardware->clearOled1();
     _hardware->clearOled2();
 }
 
-// --- Funzioni di Gestione Input ---
+// --- Azioni dei Menu ---
 
-/**
- * @brief Gestisce la logica del sottomenu principale ("Inizia Partita", "Impostazioni").
- * @details Fase del gioco: Menu.
- */
-void SearchDestroyMode::handleSubMenuInput(char key, bool btn1, bool btn2) {
-    String menuItems[] = { "Inizia Partita", "Impostazioni" };
-    int numItems = 2;
-    if (key == '2') {
-        _hardware->playTone(800, 50);
-        _subMenuIndex = (_subMenuIndex - 1 + numItems) % numItems;
+/** @brief Sposta la selezione verso l'alto nel menu corrente (sottomenu o impostazioni). */
+void SearchDestroyMode::selectPreviousItem() {
+    _hardware->playTone(800, 50);
+    if (_machine.getState() == ModeState::MODE_SUB_MENU) {
+        _subMenuIndex = (_subMenuIndex - 1 + 2) % 2;
         displaySubMenu();
-    } else if (key == '8') {
-        _hardware->playTone(600, 50);
-        _subMenuIndex = (_subMenuIndex + 1) % numItems;
+    } else {
+        _menuIndex = (_menuIndex - 1 + 7) % 7;
+        displaySettingsMenu();
+    }
+}
+
+/** @brief Sposta la selezione verso il basso nel menu corrente (sottomenu o impostazioni). */
+void SearchDestroyMode::selectNextItem() {
+    _hardware->playTone(600, 50);
+    if (_machine.getState() == ModeState::MODE_SUB_MENU) {
+        _subMenuIndex = (_subMenuIndex + 1) % 2;
         displaySubMenu();
+    } else {
+        _menuIndex = (_menuIndex + 1) % 7;
+        displaySettingsMenu();
+    }
+}
+
+void SearchDestroyMode::leaveModeWithTone() {
+    _hardware->playTone(300, 70);
+    leaveMode();
+}
+
+void SearchDestroyMode::leaveMode() {
+    exit();
+    *_appStatePtr = APP_STATE_MAIN_MENU;
+    _mainMenuDisplayFunc();
+}
+
+void SearchDestroyMode::playConfirmTone() {
+    _hardware->playTone(1200, 100);
+}
+
+void SearchDestroyMode::playBackTone() {
+    _hardware->playTone(300, 70);
+}
+
+void SearchDestroyMode::openSettings() {
+    playConfirmTone();
+    _menuIndex = 0;
+}
+
+void SearchDestroyMode::closeSettings() {
+    playBackTone();
+    sendSettingsStatus();
+}
+
+/** @brief Prepara la schermata di modifica della voce selezionata nelle impostazioni. */
+void SearchDestroyMode::startEdit() {
+    playConfirmTone();
+    _currentInputBuffer = "";
+    if (_menuIndex == 5) _tempBoolSelection = _settings.getUseArmingPin();
+    else if (_menuIndex == 6) _tempBoolSelection = _settings.getUseDisarmingPin();
+}
+
+/** @brief Aggiunge il tasto al valore in modifica; i PIN hanno al massimo 8 caratteri. */
+void SearchDestroyMode::appendCharacter() {
+    _hardware->playTone(700, 30);
+    ModeState state = _machine.getState();
+    bool isPinEdit = (state == ModeState::EDIT_ARM_PIN || state == ModeState::EDIT_DISARM_PIN);
+    if (!isPinEdit || _currentInputBuffer.length() < 8) _currentInputBuffer += _key;
+    updateDisplayForCurrentState();
+}
+
+void SearchDestroyMode::eraseCharacter() {
+    _hardware->playTone(700, 30);
+    if (_currentInputBuffer.length() > 0) _currentInputBuffer.remove(_currentInputBuffer.length() - 1);
+    updateDisplayForCurrentState();
+}
+
+/** @brief Un PIN deve avere da 1 a 8 caratteri, gli altri valori almeno una cifra. */
+bool SearchDestroyMode::isEditValid() const {
+    ModeState state = _machine.getState();
+    bool isPinEdit = (state == ModeState::EDIT_ARM_PIN || state == ModeState::EDIT_DISARM_PIN);
+    if (isPinEdit) return _currentInputBuffer.length() >= 1 && _currentInputBuffer.length() <= 8;
+    return _currentInputBuffer.length() > 0;
+}
+
+/** @brief Salva il valore inserito nel parametro dello stato di modifica da cui si esce. */
+void SearchDestroyMode::saveEdit() {
+    playConfirmTone();
+    switch (_machine.getState()) {
+        case ModeState::EDIT_BOMB_TIME: _settings.setBombTime(_currentInputBuffer.toInt()); break;
+        case ModeState::EDIT_ARM_PIN: _settings.setArmingPin(_currentInputBuffer); break;
+        case ModeState::EDIT_DISARM_PIN: _settings.setDisarmingPin(_currentInputBuffer); break;
+        case ModeState::EDIT_ARM_TIME: _settings.setArmingTime(_currentInputBuffer.toInt()); break;
+        case ModeState::EDIT_DEFUSE_TIME: _settings.setDefuseTime(_currentInputBuffer.toInt()); break;
+        default: break;
     }
-    if (btn1) {
-        _hardware->playTone(300, 70);
-        exit(); 
-        *_appStatePtr = APP_STATE_MAIN_MENU;
-        _mainMenuDisplayFunc();
+    _settings.saveParameters();
+}
+
+void SearchDestroyMode::showInvalidValue() {
+    playConfirmTone();
+    ModeState state = _machine.getState();
+    bool isPinEdit = (state == ModeState::EDIT_ARM_PIN || state == ModeState::EDIT_DISARM_PIN);
+    // Il messaggio resta 2 s senza fermare il loop(), poi endMessage() ridisegna la schermata.
+    EffectTimeline& effects = _hardware->effects();
+    _showingMessage = true;
+    effects.lcdClear().lcdText(0, 1, "Errore!");
+    if (isPinEdit) { effects.lcdText(0, 2, "Il PIN deve avere").lcdText(0, 3, "da 1 a 8 caratteri."); }
+    else { effects.lcdText(0, 2, "Valore non valido."); }
+    effects.wait(2000).call(onMessageDone, this);
+}
+
+void SearchDestroyMode::toggleSelection() {
+    _hardware->playTone(700, 30);
+    _tempBoolSelection = !_tempBoolSelection;
+    updateDisplayForCurrentState();
+}
+
+void SearchDestroyMode::saveBooleanEdit() {
+    playConfirmTone();
+    if (_machine.getState() == ModeState::EDIT_USE_ARM_PIN) _settings.setUseArmingPin(_tempBoolSelection);
+    else _settings.setUseDisarmingPin(_tempBoolSelection);
+    _settings.saveParameters();
+}
+
+// --- Azioni di Gioco ---
+
+void SearchDestroyMode::resetRound() {
+    _events->publish(GameEventId::ROUND_RESET, GameEventMode::SEARCH_DESTROY);
+}
+
+void SearchDestroyMode::startRound() {
+    _events->publish(GameEventId::GAME_START, GameEventMode::SEARCH_DESTROY);
+    _hardware->playTone(1500, 150);
+}
+
+/** @brief La partita è iniziata: il dispositivo attende che la squadra T inneschi la bomba. */
+void SearchDestroyMode::handleAwaitArmState() {
+    _hardware->updateBreathingEffect(120, 120, 120);
+}
+
+void SearchDestroyMode::startArming() {
+    _events->publish(GameEventId::ARM_START, GameEventMode::SEARCH_DESTROY);
+    _armingStartTime = millis();
+    _armingSoundLastUpdate = 0;
+    _hardware->clearLcd();
+    _hardware->printLcd(2, 1, "INNESCO IN CORSO");
+}
+
+/** @brief Un giocatore T sta tenendo premuto il pulsante di innesco. */
+void SearchDestroyMode::handleArmingState() {
+    unsigned long armTime = _settings.getArmingTime() * 1000;
+    unsigned long elapsed = millis() - _armingStartTime;
+    if (elapsed >= armTime) {
+        _machine.handle(ModeEvent::ARM_DONE);
         return;
     }
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        switch (_subMenuIndex) {
-            case 0: _currentState = ModeState::IN_GAME_CONFIRM; displayConfirmScreen(); break;
-            case 1: _currentState = ModeState::MENU_SETTINGS; _menuIndex = 0; displaySettingsMenu(); break;
-        }
+    displayArmingScreen(elapsed);
+    _events->publish(GameEventId::ARM_PROGRESS, GameEventMode::SEARCH_DESTROY, 0, map(elapsed, 0, armTime, 0, 100));
+    if (millis() - _armingSoundLastUpdate > 50) {
+        _armingSoundLastUpdate = millis();
+        int freq = map(elapsed, 0, armTime, 400, 1200);
+        _hardware->updateTone(freq);
     }
 }
 
-/**
- * @brief Gestisce la logica del menu delle impostazioni.
- * @details Fase del gioco: Menu.
- */
-void SearchDestroyMode::handleSettingsInput(char key, bool btn1, bool btn2) {
-    String menuItems[] = { "Timer Bomba", "PIN Armamento", "PIN Disarmo", "Tempo Armamento", "Tempo Disarmo", "Usa PIN armamento", "Usa PIN disarmo" };
-    int numItems = sizeof(menuItems) / sizeof(menuItems[0]);
-    if (key == '2') {
-        _hardware->playTone(800, 50); _menuIndex = (_menuIndex - 1 + numItems) % numItems; displaySettingsMenu();
-    } else if (key == '8') {
-        _hardware->playTone(600, 50); _menuIndex = (_menuIndex + 1) % numItems; displaySettingsMenu();
+void SearchDestroyMode::stopActionTone() {
+    _hardware->noTone();
+}
+
+void SearchDestroyMode::cancelArming() {
+    _events->publish(GameEventId::ARM_CANCEL, GameEventMode::SEARCH_DESTROY);
+}
+
+void SearchDestroyMode::clearInput() {
+    _currentInputBuffer = "";
+}
+
+void SearchDestroyMode::appendPinCharacter() {
+    _hardware->playTone(700, 30);
+    _currentInputBuffer += _key;
+    updateDisplayForCurrentState();
+}
+
+void SearchDestroyMode::erasePinCharacter() {
+    _hardware->playTone(700, 30);
+    if (_currentInputBuffer.length() > 0) {
+        _currentInputBuffer.remove(_currentInputBuffer.length() - 1);
     }
-    if (btn1) {
-        _hardware->playTone(300, 70);
-        _currentState = ModeState::MODE_SUB_MENU;
-        displaySubMenu();
-        sendSettingsStatus();
-        return;
+    updateDisplayForCurrentState();
+}
+
+/** @brief Gestisce l'inserimento del PIN di innesco: a PIN completo ne chiede la verifica. */
+void SearchDestroyMode::handleEnterArmPinState() {
+    if (!_showingMessage && _currentInputBuffer.length() >= _settings.getArmingPin().length()) {
+        _machine.handle(ModeEvent::PIN_ENTERED);
     }
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        _currentInputBuffer = "";
-        switch (_menuIndex) {
-            case 0: _currentState = ModeState::EDIT_BOMB_TIME; break;
-            case 1: _currentState = ModeState::EDIT_ARM_PIN; break;
-            case 2: _currentState = ModeState::EDIT_DISARM_PIN; break;
-            case 3: _currentState = ModeState::EDIT_ARM_TIME; break;
-            case 4: _currentState = ModeState::EDIT_DEFUSE_TIME; break;
-            case 5: _currentState = ModeState::EDIT_USE_ARM_PIN; _tempBoolSelection = _settings->getUseArmingPin(); break;
-            case 6: _currentState = ModeState::EDIT_USE_DISARM_PIN; _tempBoolSelection = _settings->getUseDisarmingPin(); break;
-        }
-        updateDisplayForCurrentState();
+}
+
+void SearchDestroyMode::showWrongPin() {
+    bool arming = (_machine.getState() == ModeState::IN_GAME_ENTER_ARM_PIN);
+    _events->publish(arming ? GameEventId::ARM_PIN_WRONG : GameEventId::DEFUSE_PIN_WRONG, GameEventMode::SEARCH_DESTROY);
+    _currentInputBuffer = "";
+    _showingMessage = true;
+    _hardware->effects().lcdClear()
+        .lcdText(5, 1, "PIN ERRATO")
+        .lcdText(5, 2, "Riprovare")
+        .tone(200, 500)
+        .wait(2000)
+        .call(onMessageDone, this);
+}
+
+/** @brief Stato transitorio dopo l'innesco, prima che parta il timer. */
+void SearchDestroyMode::showBombArmed() {
+    _hardware->clearLcd();
+    _hardware->printLcd(2, 1, "BOMBA INNESCATA!");
+    _hardware->setStripColor(255, 0, 0);
+    _hardware->effects().tone(1000, 80).tone(1200, 80).tone(1500, 100);
+    _stateChangeTime = millis();
+}
+
+void SearchDestroyMode::handleArmedState() {
+    if (millis() - _stateChangeTime > 1000) {
+        _machine.handle(ModeEvent::ARMED_DELAY_DONE);
     }
 }
 
+void SearchDestroyMode::startBombTimer() {
+    _events->publish(GameEventId::BOMB_ARMED, GameEventMode::SEARCH_DESTROY);
+    _roundStartTime = _hardware->getRTCTime();
+    _lastDisplayedSeconds = -1;
+    _network->publishTimerAnchor("bomb", _settings.getBombTime() * 60000UL);
+}
+
 /**
- * @brief Gestisce la logica delle schermate di modifica dei valori (numeri o stringhe).
- * @details Fase del gioco: Menu Impostazioni.
+ * @brief Timer principale della bomba, comune agli stati con la bomba innescata.
+ * @details Calcola il tempo rimanente, aggiorna il display e gestisce gli eventi sonori/visivi del timer.
+ * @return true se il tempo è scaduto: il chiamante consegna TIME_UP e non fa altro.
  */
-void SearchDestroyMode::handleEditInput(char key, bool btn1, bool btn2) {
-    if (btn1) {
-        _hardware->playTone(300, 70); _currentState = ModeState::MENU_SETTINGS;
-        displaySettingsMenu(); _hardware->setStripColor(255, 100, 0); return;
+bool SearchDestroyMode::updateBombTimer() {
+    bool counting = (_machine.getState() == ModeState::IN_GAME_COUNTDOWN);
+    long totalSeconds = _settings.getBombTime() * 60;
+    TimeSpan elapsed = _hardware->getRTCTime() - _roundStartTime;
+    long remainingSeconds = totalSeconds - elapsed.totalseconds();
+    if (remainingSeconds <= 0) {
+        return true;
     }
-    bool displayNeedsUpdate = false;
-    if (isalnum(key) || key == '*') {
-        _hardware->playTone(700, 30);
-        if (key == '*') { if (_currentInputBuffer.length() > 0) _currentInputBuffer.remove(_currentInputBuffer.length() - 1); }
-        else {
-            bool isPinEdit = (_currentState == ModeState::EDIT_ARM_PIN || _currentState == ModeState::EDIT_DISARM_PIN);
-            if (isPinEdit) { if (_currentInputBuffer.length() < 8) _currentInputBuffer += key; }
-            else { _currentInputBuffer += key; }
+
+    if (remainingSeconds != _lastDisplayedSeconds) {
+        // Il pannello calcola da sé il tempo rimanente dall'ancora inviata all'innesco.
+        if (counting) {
+            updateCountdownDisplay(remainingSeconds);
+        } else {
+            char timeBuffer[10];
+            sprintf(timeBuffer, "%02d : %02d", (int)(remainingSeconds/60), (int)(remainingSeconds%60));
+            _hardware->printLcd(6, 3, timeBuffer);
+        }
+        if (remainingSeconds > 60 && remainingSeconds % 60 == 0) {
+            _hardware->effects().tone(1500, 150)
+                .brightness(255).fill(255, 0, 0, 400)
+                .stripOff(500) // Pausa
+                .fill(255, 0, 0, 400);
+        } else if (remainingSeconds == 60 || remainingSeconds == 30) {
+            _hardware->effects().tone(1600, 80).wait(100).tone(1600, 80)
+                .brightness(255).fill(255, 0, 0, 200)
+                .stripOff(100)
+                .fill(255, 0, 0, 200);
         }
-        displayNeedsUpdate = true;
+        _lastDisplayedSeconds = remainingSeconds;
     }
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        bool isValid = false;
-        bool isPinEdit = (_currentState == ModeState::EDIT_ARM_PIN || _currentState == ModeState::EDIT_DISARM_PIN);
-        if (isPinEdit) { if (_currentInputBuffer.length() >= 1 && _currentInputBuffer.length() <= 8) isValid = true; }
-        else { if (_currentInputBuffer.length() > 0) isValid = true; }
-        if (isValid) {
-            switch (_currentState) {
-                case ModeState::EDIT_BOMB_TIME: _settings->setBombTime(_currentInputBuffer.toInt()); break;
-                case ModeState::EDIT_ARM_PIN: _settings->setArmingPin(_currentInputBuffer); break;
-                case ModeState::EDIT_DISARM_PIN: _settings->setDisarmingPin(_currentInputBuffer); break;
-                case ModeState::EDIT_ARM_TIME: _settings->setArmingTime(_currentInputBuffer.toInt()); break;
-                case ModeState::EDIT_DEFUSE_TIME: _settings->setDefuseTime(_currentInputBuffer.toInt()); break;
-                default: break;
-            }
-            _settings->saveParameters();
-            _currentState = ModeState::MENU_SETTINGS; displaySettingsMenu(); _hardware->setStripColor(255, 100, 0);
+
+    if (remainingSeconds <= 10) {
+        int interval = map(remainingSeconds, 10, 1, 1000, 100);
+        int frequency = map(remainingSeconds, 10, 1, 1200, 2200);
+        if(millis() % interval < (interval / 2)) {
+            _hardware->setBrightness(255); _hardware->setStripColor(255, 0, 0);
+            _hardware->updateTone(frequency);
         } else {
-            _hardware->clearLcd(); _hardware->printLcd(0, 1, "Errore!");
-            if (isPinEdit) { _hardware->printLcd(0, 2, "Il PIN deve avere"); _hardware->printLcd(0, 3, "da 1 a 8 caratteri."); }
-            else { _hardware->printLcd(0, 2, "Valore non valido."); }
-            delay(2000); updateDisplayForCurrentState();
+            _hardware->turnOffStrip(); _hardware->noTone();
         }
-        return;
+    } else if (counting) {
+        _hardware->updateBreathingEffect(255, 0, 0);
     }
-    if (displayNeedsUpdate) updateDisplayForCurrentState();
+    return false;
 }
 
-/**
- * @brief Gestisce la logica delle schermate di modifica dei valori booleani (Sì/No).
- * @details Fase del gioco: Menu Impostazioni.
- */
-void SearchDestroyMode::handleBooleanEditInput(char key, bool btn1, bool btn2) {
-    if (btn1) {
-        _hardware->playTone(300, 70); _currentState = ModeState::MENU_SETTINGS;
-        displaySettingsMenu(); _hardware->setStripColor(255, 100, 0); return;
+/** @brief La bomba è innescata, il timer scorre e si attende un disinnesco. */
+void SearchDestroyMode::handleCountdownState() {
+    if (updateBombTimer()) {
+        _machine.handle(ModeEvent::TIME_UP);
+    }
+}
+
+void SearchDestroyMode::startDefusing() {
+    _events->publish(GameEventId::DEFUSE_START, GameEventMode::SEARCH_DESTROY);
+    _defusingStartTime = millis();
+    _armingSoundLastUpdate = 0;
+    displayCountdownLayout();
+    _hardware->printLcd(5, 1, "DISINNESCO");
+}
+
+/** @brief Un giocatore CT sta tenendo premuto il pulsante di disinnesco. */
+void SearchDestroyMode::handleDefusingState() {
+    if (updateBombTimer()) {
+        _machine.handle(ModeEvent::TIME_UP);
+        return;
     }
-    if (key == '2' || key == '8') {
-        _hardware->playTone(700, 30); _tempBoolSelection = !_tempBoolSelection; updateDisplayForCurrentState();
+    unsigned long defuseTime = _settings.getDefuseTime() * 1000;
+    unsigned long elapsed = millis() - _defusingStartTime;
+    if (elapsed >= defuseTime) {
+        _machine.handle(ModeEvent::DEFUSE_DONE);
+        return;
     }
-    if (btn2) {
-        _hardware->playTone(1200, 100);
-        if (_currentState == ModeState::EDIT_USE_ARM_PIN) _settings->setUseArmingPin(_tempBoolSelection);
-        else if (_currentState == ModeState::EDIT_USE_DISARM_PIN) _settings->setUseDisarmingPin(_tempBoolSelection);
-        _settings->saveParameters(); _currentState = ModeState::MENU_SETTINGS;
-        displaySettingsMenu(); _hardware->setStripColor(255, 100, 0); return;
+    displayDefusingScreen(elapsed);
+    _events->publish(GameEventId::DEFUSE_PROGRESS, GameEventMode::SEARCH_DESTROY, 0, map(elapsed, 0, defuseTime, 0, 100));
+    if (millis() - _armingSoundLastUpdate > 50) {
+        _armingSoundLastUpdate = millis();
+        int freq = map(elapsed, 0, defuseTime, 1200, 400);
+        _hardware->updateTone(freq);
     }
 }
 
-/**
- * @brief Gestisce tutta la logica quando la partita è in corso.
- * @details Fase del gioco: Dalla conferma di inizio fino alla fine della partita.
- * Contiene la logica del timer e una macchina a stati per gestire le azioni
- * del giocatore (innesco, disinnesco, inserimento PIN, ecc.).
- */
-void SearchDestroyMode::handleInGame(char key, bool btn1_is_pressed, bool btn1_was_pressed, bool btn2_is_pressed, bool btn2_was_pressed) {
-    // Prima parte: gestione del timer principale della bomba (se attivo)
-    if (_gameIsActive) {
-        //Calcola il tempo rimanente, aggiorna il display e gestisce gli eventi sonori/visivi del timer
-        long totalSeconds = _settings->getBombTime() * 60;
-        TimeSpan elapsed = _hardware->getRTCTime() - _roundStartTime;
-        long remainingSeconds = totalSeconds - elapsed.totalseconds();
-        if (remainingSeconds < 0) remainingSeconds = 0;
-
-        if (remainingSeconds != _lastDisplayedSeconds) {
-
-            char message[50];
-            sprintf(message, "event:time_update;time:%ld;", remainingSeconds);
-            _network->sendStatus(message);
-
-            if (_currentState == ModeState::IN_GAME_COUNTDOWN) {
-                updateCountdownDisplay(remainingSeconds);
-            } else {
-                char timeBuffer[10];
-                sprintf(timeBuffer, "%02d : %02d", (int)(remainingSeconds/60), (int)(remainingSeconds%60));
-                _hardware->printLcd(6, 3, timeBuffer);
-            }
-            if (remainingSeconds > 60 && remainingSeconds % 60 == 0) {
-                _hardware->playTone(1500, 150);
-                _hardware->setBrightness(255); _hardware->setStripColor(255, 0, 0); delay(400);
-                _hardware->turnOffStrip(); delay(500); // Pausa
-                _hardware->setStripColor(255, 0, 0); delay(400);
-            } else if (remainingSeconds == 60 || remainingSeconds == 30) {
-                _hardware->playTone(1600, 80); delay(100); _hardware->playTone(1600, 80);
-                _hardware->setBrightness(255); _hardware->setStripColor(255, 0, 0); delay(200);
-                _hardware->turnOffStrip(); delay(100);
-                _hardware->setBrightness(255); _hardware->setStripColor(255, 0, 0); delay(200);
-            }
-            _lastDisplayedSeconds = remainingSeconds;
-        }
-
-        if (remainingSeconds <= 10 && remainingSeconds > 0) {
-            int interval = map(remainingSeconds, 10, 1, 1000, 100);
-            int frequency = map(remainingSeconds, 10, 1, 1200, 2200);
-            if(millis() % interval < (interval / 2)) {
-                _hardware->setBrightness(255); _hardware->setStripColor(255, 0, 0);
-                _hardware->updateTone(frequency);
-            } else {
-                _hardware->turnOffStrip(); _hardware->noTone();
-            }
-        } else if (remainingSeconds > 0 && _currentState == ModeState::IN_GAME_COUNTDOWN) {
-            _hardware->updateBreathingEffect(255, 0, 0);
-        }
+void SearchDestroyMode::cancelDefusing() {
+    _events->publish(GameEventId::DEFUSE_CANCEL, GameEventMode::SEARCH_DESTROY);
+}
 
-        if (remainingSeconds <= 0) {
-            _currentState = ModeState::IN_GAME_ENDED; _gameIsActive = false;
-            _network->sendStatus("event:game_end;winner:terrorists;");
-            _hardware->noTone();
-            _hardware->clearLcd();
-            _hardware->printLcd(3, 1, "BOMBA ESPLOSA!");
-            _hardware->printLcd(0, 2, "Vince la squadra T!");
-            _hardware->printOled1("ESCI", 2, 35, 25);
-            _hardware->printOled2("ESCI", 2, 35, 25);
-            for(int i=0; i<3; i++) {
-                _hardware->setBrightness(255);
-                _hardware->setStripColor(255, 255, 255); _hardware->playTone(2000, 50);
-                _hardware->setStripColor(255, 100, 0); _hardware->playTone(1000, 80);
-                _hardware->setStripColor(255, 0, 0); _hardware->playTone(400, 100);
-            }
-            _hardware->playTone(150, 3000); return;
-        }
+/** @brief Gestisce l'inserimento del PIN di disinnesco con il timer che continua a scorrere. */
+void SearchDestroyMode::handleEnterDefusePinState() {
+    if (updateBombTimer()) {
+        _machine.handle(ModeEvent::TIME_UP);
+        return;
     }
+    if (_showingMessage) return;
+    if(millis() % 1000 < 500) 
+        _hardware->setStripColor(0,255,0); 
+    else 
+        _hardware->turnOffStrip();
+    if (_currentInputBuffer.length() >= _settings.getDisarmingPin().length()) {
+        _machine.handle(ModeEvent::PIN_ENTERED);
+    }
+}
 
-    // Seconda parte: macchina a stati per le azioni del giocatore
-    switch (_currentState) {
-        case ModeState::IN_GAME_CONFIRM:    // case IN_GAME_CONFIRM: gestisce la schermata "Iniziare la partita?"
-            if (btn1_was_pressed) { _currentState = ModeState::MODE_SUB_MENU; displaySubMenu();_network->sendStatus("event:round_reset;");}
-            if (btn2_was_pressed) { 
-                _network->sendStatus("event:game_start;");
-                _hardware->playTone(1500, 150);
-                _currentState = ModeState::IN_GAME_AWAIT_ARM; 
-                displayAwaitArmScreen(); 
-            }
-            break;
-        case ModeState::IN_GAME_AWAIT_ARM:  // case IN_GAME_AWAIT_ARM: la partita è iniziata, il dispositivo attende che la squadra T inneschi la bomba.
-            _hardware->updateBreathingEffect(120, 120, 120);
-            if (btn1_is_pressed) {
-                _network->sendStatus("event:arm_start;");
-                _currentState = ModeState::IN_GAME_IS_ARMING; 
-                _armingStartTime = millis(); 
-                _armingSoundLastUpdate = 0;
-                _hardware->clearLcd(); 
-                _hardware->printLcd(2, 1, "INNESCO IN CORSO");
-            }
-            break;
-        case ModeState::IN_GAME_IS_ARMING: {    // case IN_GAME_IS_ARMING: un giocatore T sta tenendo premuto il pulsante di innesco.
-            unsigned long armTime = _settings->getArmingTime() * 1000;
-            unsigned long elapsed = millis() - _armingStartTime;
-            if (!btn1_is_pressed) {
-                _network->sendStatus("event:arm_cancel;");
-                _currentState = ModeState::IN_GAME_AWAIT_ARM; 
-                displayAwaitArmScreen(); 
-                _hardware->noTone();
-                return;
-            }
-            if (elapsed >= armTime) {
-                _hardware->noTone();
-                if (_settings->getUseArmingPin()) {
-                    _currentState = ModeState::IN_GAME_ENTER_ARM_PIN;   // case IN_GAME_ENTER_ARM_PIN: gestisce l'inserimento del PIN di innesco.
-                    _currentInputBuffer = "";
-                    displayEnterPinScreen("INSERIRE PIN INNESCO");
-                } else {
-                    _currentState = ModeState::IN_GAME_ARMED;   // case IN_GAME_ARMED: stato transitorio dopo l'innesco, prima che parta il timer.
-                    _hardware->clearLcd(); 
-                    _hardware->printLcd(2, 1, "BOMBA INNESCATA!");
-                    _hardware->setStripColor(255, 0, 0); 
-                    _hardware->playTone(1000, 80); 
-                    _hardware->playTone(1200, 80); 
-                    _hardware->playTone(1500, 100);
-                    _stateChangeTime = millis();
-                }
-                return;
-            }
-            displayArmingScreen(elapsed);
-            if (millis() - _armingSoundLastUpdate > 50) {
-                _armingSoundLastUpdate = millis();
-                int freq = map(elapsed, 0, armTime, 400, 1200);
-                _hardware->updateTone(freq);
-            }
-            break;
-        }
-        case ModeState::IN_GAME_ENTER_ARM_PIN: {
-            if (btn1_was_pressed) { 
-                _currentState = ModeState::IN_GAME_AWAIT_ARM; 
-                displayAwaitArmScreen(); 
-                return; 
-            }
-            bool needsUpdate = false;
-            if (isalnum(key)) { 
-                _hardware->playTone(700, 30); 
-                _currentInputBuffer += key; 
-                needsUpdate = true;
-            } else if (key == '*') { 
-                _hardware->playTone(700, 30); 
-                if (_currentInputBuffer.length() > 0) { 
-                    _currentInputBuffer.remove(_currentInputBuffer.length() - 1); 
-                } 
-                needsUpdate = true; 
-            }
-            if (needsUpdate) { 
-                displayEnterPinScreen("INSERIRE PIN INNESCO"); 
-            }
-            if (_currentInputBuffer.length() >= _settings->getArmingPin().length()) {
-                if (_currentInputBuffer == _settings->getArmingPin()) {
-                    _currentState = ModeState::IN_GAME_ARMED; 
-                    _hardware->clearLcd(); 
-                    _hardware->printLcd(2, 1, "BOMBA INNESCATA!");
-                    _hardware->setStripColor(255, 0, 0); 
-                    _hardware->playTone(1000, 80); 
-                    _hardware->playTone(1200, 80); 
-                    _hardware->playTone(1500, 100);
-                    _stateChangeTime = millis();
-                } else {
-                    _network->sendStatus("event:arm_pin_wrong;");
-                    _hardware->clearLcd(); 
-                    _hardware->printLcd(5, 1, "PIN ERRATO"); 
-                    _hardware->printLcd(5, 2, "Riprovare"); 
-                    _hardware->playTone(200, 500); 
-                    delay(2000); 
-                    _currentInputBuffer = "";
-                    displayEnterPinScreen("INSERIRE PIN INNESCO");
-                }
-            }
-            break;
-        }
-        case ModeState::IN_GAME_ARMED:
-            if (millis() - _stateChangeTime > 1000) {
-                _network->sendStatus("event:bomb_armed;");
-                _currentState = ModeState::IN_GAME_COUNTDOWN; 
-                _roundStartTime = _hardware->getRTCTime();
-                _lastDisplayedSeconds = -1; 
-                _gameIsActive = true; 
-                displayCountdownLayout();
-            }
-            break;
-        case ModeState::IN_GAME_COUNTDOWN:  // case IN_GAME_COUNTDOWN: la bomba è innescata, il timer scorre e si attende un disinnesco.
-            if (btn2_is_pressed && btn2_was_pressed) {
-                _network->sendStatus("event:defuse_start;");
-                _currentState = ModeState::IN_GAME_IS_DEFUSING; 
-                _defusingStartTime = millis(); 
-                _armingSoundLastUpdate = 0;
-                _hardware->clearLcd(); 
-                displayCountdownLayout();
-                _hardware->printLcd(5, 1, "DISINNESCO");
-            }
-            break;
-        case ModeState::IN_GAME_IS_DEFUSING: {  // case IN_GAME_IS_DEFUSING: un giocatore CT sta tenendo premuto il pulsante di disinnesco.
-            unsigned long defuseTime = _settings->getDefuseTime() * 1000;
-            unsigned long elapsed = millis() - _defusingStartTime;
-            if (!btn2_is_pressed) {
-                _network->sendStatus("event:defuse_cancel;");
-                _currentState = ModeState::IN_GAME_COUNTDOWN; 
-                _hardware->noTone(); 
-                displayCountdownLayout(); 
-                return;
-            }
-            if (elapsed >= defuseTime) {
-                _hardware->noTone();
-                if (_settings->getUseDisarmingPin()) {
-                    _currentState = ModeState::IN_GAME_ENTER_DEFUSE_PIN;    // case IN_GAME_ENTER_DEFUSE_PIN: gestisce l'inserimento del PIN di disinnesco.
-                    _currentInputBuffer = "";
-                    displayEnterPinScreen("INSERIRE PIN");
-                } else {
-                    _network->sendStatus("event:game_end;winner:counter-terrorists;");
-                    _currentState = ModeState::IN_GAME_DEFUSED; // case IN_GAME_DEFUSED: la partita è finita, i CT hanno vinto.
-                    _gameIsActive = false; 
-                    _hardware->clearLcd();
-                    _hardware->printLcd(1, 1, "BOMBA DISINNESCATA"); 
-                    _hardware->printLcd(0, 2, "Vince la squadra CT!");
-                    _hardware->playTone(1500, 80); 
-                    _hardware->playTone(1800, 80); 
-                    _hardware->playTone(2200, 100);
-                }
-                return;
-            }
-            displayDefusingScreen(elapsed);
-            if (millis() - _armingSoundLastUpdate > 50) {
-                _armingSoundLastUpdate = millis();
-                int freq = map(elapsed, 0, defuseTime, 1200, 400);
-                _hardware->updateTone(freq);
-            }
-            break;
-        }
-        case ModeState::IN_GAME_ENTER_DEFUSE_PIN: {
-            if (btn1_was_pressed) { 
-                _currentState = ModeState::IN_GAME_COUNTDOWN; 
-                displayCountdownLayout(); 
-                return; 
-            }
-            bool needsUpdate = false;
-            if (isalnum(key)) { 
-                _hardware->playTone(700, 30); 
-                _currentInputBuffer += key; 
-                needsUpdate = true;
-            } else if (key == '*') { 
-                _hardware->playTone(700, 30); 
-                if (_currentInputBuffer.length() > 0) { 
-                    _currentInputBuffer.remove(_currentInputBuffer.length()-1); 
-                } 
-                needsUpdate = true; 
-            }
-            if (needsUpdate) { 
-                displayEnterPinScreen("INSERIRE PIN"); 
-            }
-            if(millis() % 1000 < 500) 
-                _hardware->setStripColor(0,255,0); 
-            else 
-                _hardware->turnOffStrip();
-            if (_currentInputBuffer.length() >= _settings->getDisarmingPin().length()) {
-                if (_currentInputBuffer == _settings->getDisarmingPin()) {
-                    _network->sendStatus("event:game_end;winner:counter-terrorists;");
-                    _currentState = ModeState::IN_GAME_DEFUSED; 
-                    _gameIsActive = false;
-                    _hardware->clearLcd(); 
-                    _hardware->printLcd(1, 1, "BOMBA DISINNESCATA");
-                    _hardware->printLcd(0, 2, "Vince la squadra CT!");
-                    _hardware->playTone(1500, 80); 
-                    _hardware->playTone(1800, 80); 
-                    _hardware->playTone(2200, 100);
-                } else {
-                    _network->sendStatus("event:defuse_pin_wrong;");
-                    _hardware->clearLcd(); 
-                    _hardware->printLcd(5, 1, "PIN ERRATO");
-                    _hardware->printLcd(5, 2, "Riprovare"); 
-                    _hardware->playTone(200, 500);
-                    delay(2000); 
-                    _currentInputBuffer = ""; 
-                    displayEnterPinScreen("INSERIRE PIN");
-                }
-            }
-            break;
-        }
-        case ModeState::IN_GAME_DEFUSED:
-            _hardware->printOled1("ESCI", 2, 35, 25);
-            _hardware->printOled2("ESCI", 2, 35, 25);
-            _hardware->updateBreathingEffect(0, 255, 0);
-            if (btn1_was_pressed || btn2_was_pressed || key != NO_KEY) {
-            exit();
-            *_appStatePtr = APP_STATE_MAIN_MENU;
-            _mainMenuDisplayFunc();
-            }
-            break;
-        case ModeState::IN_GAME_ENDED:  // case IN_GAME_ENDED: la partita è finita, i T hanno vinto.
-            if (btn1_was_pressed || btn2_was_pressed || key != NO_KEY) {
-                exit();
-                *_appStatePtr = APP_STATE_MAIN_MENU;
-                _mainMenuDisplayFunc();
-            }
-            break;
+/** @brief La partita è finita, i CT hanno vinto. */
+void SearchDestroyMode::defuseBomb() {
+    _events->publish(GameEventId::GAME_END, GameEventMode::SEARCH_DESTROY, SD_TEAM_COUNTER_TERRORISTS);
+    _network->clearTimerAnchor();
+    stopEffects();
+    _hardware->clearLcd();
+    _hardware->printLcd(1, 1, "BOMBA DISINNESCATA");
+    _hardware->printLcd(0, 2, "Vince la squadra CT!");
+    _hardware->effects().tone(1500, 80).tone(1800, 80).tone(2200, 100);
+}
+
+void SearchDestroyMode::handleDefusedState() {
+    _hardware->updateBreathingEffect(0, 255, 0);
+}
+
+/** @brief Il tempo è scaduto: la partita è finita, i T hanno vinto. */
+void SearchDestroyMode::explodeBomb() {
+    _events->publish(GameEventId::GAME_END, GameEventMode::SEARCH_DESTROY, SD_TEAM_TERRORISTS);
+    _network->clearTimerAnchor();
+    stopEffects();
+    _hardware->noTone();
+    _hardware->clearLcd();
+    _hardware->printLcd(3, 1, "BOMBA ESPLOSA!");
+    _hardware->printLcd(0, 2, "Vince la squadra T!");
+    _hardware->printOled1("ESCI", 2, 35, 25);
+    _hardware->printOled2("ESCI", 2, 35, 25);
+    EffectTimeline& effects = _hardware->effects();
+    effects.brightness(255);
+    for(int i=0; i<3; i++) {
+        effects.fill(255, 255, 255).tone(2000, 50);
+        effects.fill(255, 100, 0).tone(1000, 80);
+        effects.fill(255, 0, 0).tone(400, 100);
     }
+    effects.tone(150, 3000);
+}
+
+bool SearchDestroyMode::isNotGameOver() const {
+    ModeState state = _machine.getState();
+    return state != ModeState::IN_GAME_DEFUSED && state != ModeState::IN_GAME_ENDED;
 }
 
 
 // --- Funzioni di Visualizzazione (display...) ---
 // Ognuna di queste funzioni è responsabile del disegno di una specifica schermata sull'LCD e sugli OLED.
-// Vengono chiamate dalle funzioni di gestione dell'input per aggiornare l'interfaccia utente.
+// Vengono chiamate all'ingresso negli stati e dalle azioni delle transizioni.
 
 void SearchDestroyMode::displaySubMenu() {
     _hardware->clearLcd(); _hardware->printLcd(0, 0, "CERCA & DISTRUGGI");
@@ -599,6 +691,7 @@ void SearchDestroyMode::displaySettingsMenu() {
 
     _hardware->printOled1("INDIETRO", 2, 10, 25);
     _hardware->printOled2("CONFERMA", 2, 18, 25);
+    _hardware->setStripColor(255, 100, 0);
 }
 void SearchDestroyMode::displayEditScreen(const String& title, const String& currentValue, const String& unit) {
     _hardware->clearLcd(); _hardware->printLcd(0, 0, title);
@@ -628,14 +721,14 @@ void SearchDestroyMode::displayConfirmScreen() {
 void SearchDestroyMode::displayAwaitArmScreen() {
     _hardware->clearLcd(); _hardware->printLcd(2, 0, "PIANTA LA BOMBA");
     _hardware->printLcd(0, 2, "Tieni premuto ROSSO");
-    String secondsText = "per " + String(_settings->getArmingTime()) + " secondi";
+    String secondsText = "per " + String(_settings.getArmingTime()) + " secondi";
     _hardware->printLcd(0, 3, secondsText);
     
     _hardware->printOled1("INNESCA", 2, 22, 25);
     _hardware->clearOled2();
 }
 void SearchDestroyMode::displayArmingScreen(unsigned long progress) {
-    unsigned long totalDuration = _settings->getArmingTime() * 1000;
+    unsigned long totalDuration = _settings.getArmingTime() * 1000;
     if (totalDuration == 0) totalDuration = 1;
     int ledsToShow = map(progress, 0, totalDuration, 0, _hardware->getStripLedCount());
     for(int i=0; i < _hardware->getStripLedCount(); i++){ _hardware->setPixelColor(i, (i < ledsToShow) ? 255 : 0, 0, 0); }
@@ -669,6 +762,10 @@ void SearchDestroyMode::displayCountdownLayout() {
     _hardware->clearOled1();
     _hardware->printOled2("DISINNESCA", 2, 4, 30);
 }
+void SearchDestroyMode::displayExitPrompt() {
+    _hardware->printOled1("ESCI", 2, 35, 25);
+    _hardware->printOled2("ESCI", 2, 35, 25);
+}
 void SearchDestroyMode::updateCountdownDisplay(long remainingSeconds) {
     int minutes = remainingSeconds / 60;
     int seconds = remainingSeconds % 60;
@@ -678,25 +775,27 @@ void SearchDestroyMode::updateCountdownDisplay(long remainingSeconds) {
 }
 
 /**
- * @brief Funzione helper chiamata quando si deve aggiornare una schermata di modifica.
+ * @brief Funzione helper chiamata quando si deve aggiornare una schermata di modifica o di inserimento PIN.
  * @details Controlla lo stato attuale e chiama la funzione di `display` corretta
  * con i parametri giusti (titolo, valore attuale, unità di misura).
  */
 void SearchDestroyMode::updateDisplayForCurrentState() {
-    switch (_currentState) {
-        case ModeState::EDIT_BOMB_TIME: displayEditScreen("Mod. Timer Bomba", String(_settings->getBombTime()), "min"); break;
-        case ModeState::EDIT_ARM_PIN: displayEditScreen("Mod. PIN Armamento", _settings->getArmingPin(), ""); break;
-        case ModeState::EDIT_DISARM_PIN: displayEditScreen("Mod. PIN Disarmo", _settings->getDisarmingPin(), ""); break;
-        case ModeState::EDIT_ARM_TIME: displayEditScreen("Mod. Tempo Armamento", String(_settings->getArmingTime()), "s"); break;
-        case ModeState::EDIT_DEFUSE_TIME: displayEditScreen("Mod. Tempo Disarmo", String(_settings->getDefuseTime()), "s"); break;
+    switch (_machine.getState()) {
+        case ModeState::EDIT_BOMB_TIME: displayEditScreen("Mod. Timer Bomba", String(_settings.getBombTime()), "min"); break;
+        case ModeState::EDIT_ARM_PIN: displayEditScreen("Mod. PIN Armamento", _settings.getArmingPin(), ""); break;
+        case ModeState::EDIT_DISARM_PIN: displayEditScreen("Mod. PIN Disarmo", _settings.getDisarmingPin(), ""); break;
+        case ModeState::EDIT_ARM_TIME: displayEditScreen("Mod. Tempo Armamento", String(_settings.getArmingTime()), "s"); break;
+        case ModeState::EDIT_DEFUSE_TIME: displayEditScreen("Mod. Tempo Disarmo", String(_settings.getDefuseTime()), "s"); break;
         case ModeState::EDIT_USE_ARM_PIN: displayBooleanEditScreen("Usare PIN armamento?", _tempBoolSelection); break;
         case ModeState::EDIT_USE_DISARM_PIN: displayBooleanEditScreen("Usare PIN disinnesco", _tempBoolSelection); break;
+        case ModeState::IN_GAME_ENTER_ARM_PIN: displayEnterPinScreen("INSERIRE PIN INNESCO"); break;
+        case ModeState::IN_GAME_ENTER_DEFUSE_PIN: displayEnterPinScreen("INSERIRE PIN"); break;
         default: break;
     }
 }
 void SearchDestroyMode::displayDefusingScreen(unsigned long progress) {
     _hardware->printLcd(5, 1, "DISINNESCO      ");
-    unsigned long totalDuration = _settings->getDefuseTime() * 1000;
+    unsigned long totalDuration = _settings.getDefuseTime() * 1000;
     if (totalDuration == 0) totalDuration = 1;
     
     int greenLeds = map(progress, 0, totalDuration, 0, _hardware->getStripLedCount());
@@ -723,16 +822,20 @@ void SearchDestroyMode::displayDefusingScreen(unsigned long progress) {
  * @details Chiamata all'ingresso della modalità e all'uscita dal menu impostazioni.
  */
 void SearchDestroyMode::sendSettingsStatus() {
+    sendSettingsStatus(_network, _settings);
+}
+
+void SearchDestroyMode::sendSettingsStatus(NetworkManager* network, const SearchDestroySettings& settings) {
     char message[200];
     sprintf(message, "event:settings_update;bomb_time:%d;arm_pin:%s;disarm_pin:%s;arm_time:%d;defuse_time:%d;use_arm_pin:%d;use_disarm_pin:%d;",
-            _settings->getBombTime(),
-            _settings->getArmingPin().c_str(),
-            _settings->getDisarmingPin().c_str(),
-            _settings->getArmingTime(),
-            _settings->getDefuseTime(),
-            _settings->getUseArmingPin(),
-            _settings->getUseDisarmingPin());
-    _network->sendStatus(message);
+            settings.getBombTime(),
+            settings.getArmingPin().c_str(),
+            settings.getDisarmingPin().c_str(),
+            settings.getArmingTime(),
+            settings.getDefuseTime(),
+            settings.getUseArmingPin(),
+            settings.getUseDisarmingPin());
+    network->sendStatus(message);
 }
 
 /**
@@ -741,24 +844,40 @@ void SearchDestroyMode::sendSettingsStatus() {
  */
 void SearchDestroyMode::forceEndGame() {
     Serial.println("!!! COMANDO RICEVUTO: forceEndGame in Cerca & Distruggi !!!");
-    
-    // Non fare nulla se la partita è GIA' finita
-    if (_currentState == ModeState::IN_GAME_DEFUSED || _currentState == ModeState::IN_GAME_ENDED) {
-        return;
-    }
+    // Se la partita è già finita la guardia della transizione la ignora.
+    _machine.handle(ModeEvent::FORCE_END);
+}
 
-    _network->sendStatus("event:game_end;winner:counter-terrorists;");
-    _currentState = ModeState::IN_GAME_DEFUSED; 
-    _gameIsActive = false; 
+void SearchDestroyMode::endGameForced() {
+    _events->publish(GameEventId::GAME_END, GameEventMode::SEARCH_DESTROY, SD_TEAM_COUNTER_TERRORISTS);
+    _network->clearTimerAnchor();
+    stopEffects();
     _hardware->noTone();
 
     _hardware->clearLcd();
     _hardware->printLcd(1, 1, "PARTITA TERMINATA"); 
     _hardware->printLcd(0, 2, "Vince la squadra CT!");
     
-    _hardware->playTone(1500, 80); 
-    delay(100);
-    _hardware->playTone(1800, 80); 
-    delay(100);
-    _hardware->playTone(2200, 100);
+    _hardware->effects().tone(1500, 80).wait(100).tone(1800, 80).wait(100).tone(2200, 100);
+}
+
+/**
+ * @brief Chiamata dalla timeline degli effetti alla fine di un messaggio temporaneo.
+ */
+void SearchDestroyMode::onMessageDone(void* context) {
+    static_cast<SearchDestroyMode*>(context)->endMessage();
+}
+
+/**
+ * @brief Riabilita l'input e ridisegna la schermata coperta dal messaggio.
+ * @details Se nel frattempo la partita è finita lo stato è cambiato e non si ridisegna nulla.
+ */
+void SearchDestroyMode::endMessage() {
+    _showingMessage = false;
+    updateDisplayForCurrentState();
+}
+
+void SearchDestroyMode::stopEffects() {
+    _hardware->effects().cancel();
+    _showingMessage = false;
 }
\ No newline at end of file
@@ -11,7 +11,10 @@
 #include "GameMode.h"
 #include "HardwareManager.h"
 #include "NetworkManager.h"
+#include "EventBus.h"
+#include "StateMachine.h"
 #include "SearchDestroySettings.h"
+#include "ModeRegistry.h"
 #include "app_common.h"
 
 /**
@@ -27,11 +30,14 @@ public:
      * @brief Costruttore della modalità di gioco.
      * @param hardware Puntatore all'oggetto HardwareManager.
      * @param network Puntatore all'oggetto NetworkManager.
-     * @param settings Puntatore all'oggetto con le impostazioni specifiche di questa modalità.
+     * @param events Bus degli eventi di gioco.
      * @param appState Puntatore allo stato globale dell'applicazione.
      * @param displayFunc Puntatore alla funzione per ridisegnare il menu principale.
      */
-    SearchDestroyMode(HardwareManager* hardware, NetworkManager* network, SearchDestroySettings* settings, AppState* appState, MainMenuDisplayFunction displayFunc);
+    SearchDestroyMode(HardwareManager* hardware, NetworkManager* network, EventBus* events, AppState* appState, MainMenuDisplayFunction displayFunc);
+
+    /** @brief Fabbrica per il ModeRegistry: costruisce la modalità nell'arena. */
+    static GameMode* create(void* arena, const ModeContext& context);
 
     void enter() override;
     void loop() override;
@@ -39,6 +45,8 @@ public:
 
     // Funzione di utilità per inviare le impostazioni via rete
     void sendSettingsStatus();
+    /** @brief Invia le impostazioni indicate, anche senza la modalità costruita (es. dal Terminale). */
+    static void sendSettingsStatus(NetworkManager* network, const SearchDestroySettings& settings);
     void enterInGame();
     void forceEndGame();
 
@@ -46,7 +54,8 @@ private:
     // Puntatori agli oggetti principali
     HardwareManager* _hardware;
     NetworkManager* _network;
-    SearchDestroySettings* _settings;
+    EventBus* _events;
+    SearchDestroySettings _settings;    // Caricate dalla memoria flash alla costruzione
     
     AppState* _appStatePtr;
     MainMenuDisplayFunction _mainMenuDisplayFunc;
@@ -55,7 +64,7 @@ private:
      * @enum ModeState
      * @brief Definisce tutti i possibili stati interni della modalità di gioco.
      */
-    enum class ModeState {
+    enum class ModeState : uint8_t {
         // Stati dei Menu
 
         MODE_SUB_MENU,          // Sottomenu principale (Inizia Partita / Impostazioni)
@@ -81,7 +90,37 @@ private:
         IN_GAME_DEFUSED,            // La partita è finita perché la bomba è stata disinnescata
         IN_GAME_ENDED               // La partita è finita perché il tempo è scaduto (bomba esplosa)
     };
-    ModeState _currentState;
+
+    /**
+     * @enum ModeEvent
+     * @brief Eventi della macchina a stati: ingressi della passata e scadenze rilevate dagli stati.
+     */
+    enum class ModeEvent : uint8_t {
+        MENU_UP,            // Tasto '2'
+        MENU_DOWN,          // Tasto '8'
+        CHARACTER,          // Tasto alfanumerico
+        ERASE,              // Tasto '*'
+        BACK,               // Pulsante 1 premuto
+        CONFIRM,            // Pulsante 2 premuto
+        ANY_INPUT,          // Un pulsante o un tasto qualsiasi
+        ARM_HOLD,           // Pulsante 1 tenuto
+        ARM_RELEASE,
+        DEFUSE_PRESS,       // Pulsante 2 appena premuto e tenuto
+        DEFUSE_RELEASE,
+        ARM_DONE,           // Tempo di innesco raggiunto
+        ARMED_DELAY_DONE,   // Fine della conferma "BOMBA INNESCATA!"
+        DEFUSE_DONE,        // Tempo di disinnesco raggiunto
+        PIN_ENTERED,        // Inserite tante cifre quante ne ha il PIN
+        TIME_UP,            // Timer della bomba scaduto
+        FORCE_END
+    };
+    typedef StateMachine<SearchDestroyMode, ModeState, ModeEvent> Machine;
+    struct Tables;              // Tabelle di stati e transizioni, in SearchDestroyMode.cpp
+
+    Machine _machine;
+    static int8_t _stateProbes; // Sonda del Profiler del primo stato: una per ModeState, nello stesso ordine.
+                                // Registrate alla prima costruzione e condivise dalle successive.
+    char _key;                  // Tasto della passata corrente, letto dalle azioni di inserimento
 
     // Variabili di stato per i menu e l'input
     String _currentInputBuffer; // Memorizza l'input dal tastierino
@@ -98,7 +137,7 @@ private:
     unsigned long _stateChangeTime;
     int _lastDisplayedSeconds;
 
-    bool _gameIsActive;
+    bool _showingMessage;   // Un messaggio temporaneo (errore, PIN errato) è sull'LCD: input sospeso
 
     // --- Funzioni Private ---
 
@@ -114,21 +153,74 @@ private:
     void displayCountdownLayout();
     void updateCountdownDisplay(long remainingSeconds);
     void displayDefusingScreen(unsigned long progress);
-
-    // Funzioni che contengono la logica per ogni stato
-    void handleSubMenuInput(char key, bool btn1, bool btn2);
-    void handleSettingsInput(char key, bool btn1, bool btn2);
-    void handleEditInput(char key, bool btn1, bool btn2);
-    void handleBooleanEditInput(char key, bool btn1, bool btn2);
-    void handleInGame(char key, bool btn1_is_pressed, bool btn1_was_pressed, bool btn2_is_pressed, bool btn2_was_pressed);
+    void displayExitPrompt();
+
+    // Ingresso e uscita dagli stati
+    void startArming();
+    void showBombArmed();
+    void startDefusing();
+    void stopActionTone();
+
+    // Aggiornamento a ogni passata
+    void handleAwaitArmState();
+    void handleArmingState();
+    void handleEnterArmPinState();
     void handleArmedState();
-    void handleCountdownState(char key, bool btn1_was_pressed, bool btn2_is_pressed, bool btn2_was_pressed);
-    void handleIsDefusingInput(bool btn2_is_pressed);
-    void handleEnterDefusePinInput(char key, bool btn1_was_pressed, bool btn2_was_pressed);
+    void handleCountdownState();
+    void handleDefusingState();
+    void handleEnterDefusePinState();
+    void handleDefusedState();
+    bool updateBombTimer();
+
+    // Guardie
+    bool isStartSelected() const { return _subMenuIndex == 0; }
+    bool isSettingsSelected() const { return _subMenuIndex == 1; }
+    template <int Item> bool isSettingSelected() const { return _menuIndex == Item; }
+    bool isEditValid() const;
+    bool usesArmingPin() const { return _settings.getUseArmingPin(); }
+    bool usesDisarmingPin() const { return _settings.getUseDisarmingPin(); }
+    bool isArmingPinCorrect() const { return _currentInputBuffer == _settings.getArmingPin(); }
+    bool isDisarmingPinCorrect() const { return _currentInputBuffer == _settings.getDisarmingPin(); }
+    bool isNotGameOver() const;
+
+    // Azioni delle transizioni
+    void selectPreviousItem();
+    void selectNextItem();
+    void leaveModeWithTone();
+    void leaveMode();
+    void playConfirmTone();
+    void playBackTone();
+    void openSettings();
+    void closeSettings();
+    void startEdit();
+    void appendCharacter();
+    void eraseCharacter();
+    void saveEdit();
+    void showInvalidValue();
+    void toggleSelection();
+    void saveBooleanEdit();
+    void resetRound();
+    void startRound();
+    void cancelArming();
+    void clearInput();
+    void appendPinCharacter();
+    void erasePinCharacter();
+    void showWrongPin();
+    void startBombTimer();
+    void cancelDefusing();
+    void defuseBomb();
+    void explodeBomb();
+    void endGameForced();
     
     // Funzione di utilità per aggiornare le schermate di modifica
     void updateDisplayForCurrentState();
 
+    // Fine dei messaggi temporanei accodati sulla timeline degli effetti
+    static void onMessageDone(void* context);
+    void endMessage();
+    /** @brief Scarta gli effetti in coda (fine partita, uscita) e riabilita l'input. */
+    void stopEffects();
+
 };
 
 #endif // SEARCH_DESTROY_MODE_H
\ No newline at end of file
@@ -53,13 +53,13 @@ void SearchDestroySettings::loadParameters() {
 
 // --- Implementazione dei Metodi Getter ---
 // Queste funzioni semplicemente restituiscono il valore della variabile privata corrispondente.
-int SearchDestroySettings::getBombTime() { return _bombTime; }
-String SearchDestroySettings::getArmingPin() { return _armingPin; }
-String SearchDestroySettings::getDisarmingPin() { return _disarmingPin; }
-int SearchDestroySettings::getArmingTime() { return _armingTime; }
-int SearchDestroySettings::getDefuseTime() { return _defuseTime; }
-bool SearchDestroySettings::getUseArmingPin() { return _useArmingPin; }
-bool SearchDestroySettings::getUseDisarmingPin() { return _useDisarmingPin; }
+int SearchDestroySettings::getBombTime() const { return _bombTime; }
+String SearchDestroySettings::getArmingPin() const { return _armingPin; }
+String SearchDestroySettings::getDisarmingPin() const { return _disarmingPin; }
+int SearchDestroySettings::getArmingTime() const { return _armingTime; }
+int SearchDestroySettings::getDefuseTime() const { return _defuseTime; }
+bool SearchDestroySettings::getUseArmingPin() const { return _useArmingPin; }
+bool SearchDestroySettings::getUseDisarmingPin() const { return _useDisarmingPin; }
 
 // --- Implementazione dei Metodi Setter ---
 // Queste funzioni permettono di modificare il valore della variabile privata corrispondente.
@@ -37,13 +37,13 @@ public:
     void loadParameters();
 
     // --- Metodi Getter (per leggere i valori delle impostazioni) ---
-    int getBombTime();
-    String getArmingPin();
-    String getDisarmingPin();
-    int getArmingTime();
-    int getDefuseTime();
-    bool getUseArmingPin();
-    bool getUseDisarmingPin();
+    int getBombTime() const;
+    String getArmingPin() const;
+    String getDisarmingPin() const;
+    int getArmingTime() const;
+    int getDefuseTime() const;
+    bool getUseArmingPin() const;
+    bool getUseDisarmingPin() const;
 
     // --- Metodi Setter (per modificare i valori delle impostazioni) ---
     void setBombTime(int time);
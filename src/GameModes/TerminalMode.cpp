@@ -1,39 +1,29 @@
 // src/GameModes/TerminalMode.cpp
 
 #include "GameModes/TerminalMode.h"
-#include <vector>
-
-// Funzione helper per dividere la stringa dei comandi
-std::vector<String> splitString(String str, char delimiter) {
-    std::vector<String> result;
-    int last = 0;
-    for (int i = 0; i < str.length(); i++) {
-        if (str.charAt(i) == delimiter) {
-            result.push_back(str.substring(last, i));
-            last = i + 1;
-        }
-    }
-    result.push_back(str.substring(last));
-    return result;
-}
+#include "GameModes/DominationMode.h"
+#include "GameModes/SearchDestroyMode.h"
+#include <new>
 
 // Costruttore
-TerminalMode::TerminalMode(HardwareManager* hardware, NetworkManager* network, AppState* appState, MainMenuDisplayFunction displayFunc, 
-                         DominationSettings* domSettings, DominationMode* domMode,
-                         SearchDestroySettings* sdSettings, SearchDestroyMode* sdMode)
+TerminalMode::TerminalMode(HardwareManager* hardware, NetworkManager* network, EventBus* events, ModeRegistry* registry,
+                           AppState* appState, MainMenuDisplayFunction displayFunc)
     : _hardware(hardware),
       _network(network),
+      _events(events),
+      _registry(registry),
       _appStatePtr(appState),
-      _mainMenuDisplayFunc(displayFunc),
-      _domSettings(domSettings),
-      _domMode(domMode),
-      _sdSettings(sdSettings),
-      _sdMode(sdMode) {
+      _mainMenuDisplayFunc(displayFunc) {
+}
+
+GameMode* TerminalMode::create(void* arena, const ModeContext& context) {
+    return new (arena) TerminalMode(context.hardware, context.network, context.events, context.registry,
+                                    context.appState, context.displayMainMenu);
 }
 
 void TerminalMode::enter() {
     Serial.println("Entrato in Modalita' Terminale");
-    _network->sendStatus("event:mode_enter;mode:terminal;");
+    _events->publish(GameEventId::MODE_ENTER, GameEventMode::TERMINAL);
     
     _hardware->clearLcd();
     _hardware->printLcd(0, 1, "MODALITA' TERMINALE");
@@ -44,11 +34,7 @@ void TerminalMode::enter() {
 }
 
 void TerminalMode::loop() {
-    String command = _network->getReceivedMessage();
-    if (command != "") {
-        parseCommand(command);
-    }
-    
+    // I comandi remoti arrivano dal CommandRouter (vedi registerCommands()).
     if (_hardware->wasButton1Pressed()) {
         exit();
         *_appStatePtr = APP_STATE_MAIN_MENU;
@@ -58,73 +44,93 @@ void TerminalMode::loop() {
 
 void TerminalMode::exit() {
     Serial.println("Uscito da Modalita' Terminale");
-    _network->sendStatus("event:mode_exit;mode:terminal;");
+    _events->publish(GameEventId::MODE_EXIT, GameEventMode::TERMINAL);
     _hardware->turnOffStrip();
 }
 
-void TerminalMode::parseCommand(String command) {
-    Serial.print("Comando ricevuto in TerminalMode: ");
-    Serial.println(command);
+TerminalMode* TerminalMode::activeIn(void* registry) {
+    TerminalMode* self = static_cast<TerminalMode*>(static_cast<ModeRegistry*>(registry)->getActive(APP_STATE_TERMINAL_MODE));
+    return (self != nullptr && self->isActive()) ? self : nullptr;
+}
 
-    std::vector<String> parts = splitString(command, ';');
-    String cmd_event = "";
+void TerminalMode::registerCommands(CommandRouter& router, ModeRegistry& registry) {
+    router.on(CMD_SET_DOM_SETTINGS, [](const ParsedCommand& command, void* context) {
+        TerminalMode* self = activeIn(context);
+        if (self) self->applyDominationSettings(command);
+    }, &registry);
+    router.on(CMD_START_DOM_GAME, [](const ParsedCommand&, void* context) {
+        TerminalMode* self = activeIn(context);
+        if (self) self->startDominationGame();
+    }, &registry);
+    router.on(CMD_SET_SD_SETTINGS, [](const ParsedCommand& command, void* context) {
+        TerminalMode* self = activeIn(context);
+        if (self) self->applySearchDestroySettings(command);
+    }, &registry);
+    router.on(CMD_START_SD_GAME, [](const ParsedCommand&, void* context) {
+        TerminalMode* self = activeIn(context);
+        if (self) self->startSearchDestroyGame();
+    }, &registry);
+}
 
-    for (const auto& part : parts) {
-        if (part.startsWith("CMD:")) {
-            cmd_event = part.substring(4);
-            break;
-        }
+void TerminalMode::applyDominationSettings(const ParsedCommand& command) {
+    if (command.has(FIELD_DURATION)) {
+        _domSettings.setGameDuration(command[FIELD_DURATION].toInt());
     }
+    if (command.has(FIELD_CAPTURE)) {
+        _domSettings.setCaptureTime(command[FIELD_CAPTURE].toInt());
+    }
+    _domSettings.saveParameters();
+    Serial.println("Impostazioni Dominio aggiornate da remoto.");
+    DominationMode::sendSettingsStatus(_network, _domSettings);
+}
 
-    if (cmd_event == "SET_DOM_SETTINGS") {
-        for (const auto& part : parts) {
-            if (part.startsWith("DURATION:")) {
-                _domSettings->setGameDuration(part.substring(9).toInt());
-            } else if (part.startsWith("CAPTURE:")) {
-                _domSettings->setCaptureTime(part.substring(8).toInt());
-            }
-        }
-        _domSettings->saveParameters();
-        Serial.println("Impostazioni Dominio aggiornate da remoto.");
-        _domMode->sendSettingsStatus();
-
-    } else if (cmd_event == "START_DOM_GAME") {
-        Serial.println("Avvio partita Dominio da remoto...");
-        
-        _network->sendStatus("event:remote_start;mode:domination;");
-        
-        *_appStatePtr = APP_STATE_DOMINATION_MODE;
-        _domMode->enterInGame();
-
-    } else if (cmd_event == "SET_SD_SETTINGS") {
-        // --- INIZIO MODIFICA ---
-        for (const auto& part : parts) {
-            if (part.startsWith("BOMB_TIME:")) {
-                _sdSettings->setBombTime(part.substring(10).toInt());
-            } else if (part.startsWith("ARM_TIME:")) {
-                _sdSettings->setArmingTime(part.substring(9).toInt());
-            } else if (part.startsWith("DEFUSE_TIME:")) {
-                _sdSettings->setDefuseTime(part.substring(12).toInt());
-            } else if (part.startsWith("USE_ARM_PIN:")) {
-                _sdSettings->setUseArmingPin(part.substring(12).toInt() == 1);
-            } else if (part.startsWith("ARM_PIN:")) {
-                _sdSettings->setArmingPin(part.substring(8));
-            } else if (part.startsWith("USE_DEFUSE_PIN:")) {
-                _sdSettings->setUseDisarmingPin(part.substring(15).toInt() == 1);
-            } else if (part.startsWith("DEFUSE_PIN:")) {
-                _sdSettings->setDisarmingPin(part.substring(11));
-            }
-        }
-        // --- FINE MODIFICA ---
-        
-        _sdSettings->saveParameters();
-        Serial.println("Impostazioni C&D aggiornate da remoto.");
-        _sdMode->sendSettingsStatus(); // Notifica il pannello delle nuove impostazioni
+void TerminalMode::startDominationGame() {
+    Serial.println("Avvio partita Dominio da remoto...");
+    
+    _events->publish(GameEventId::REMOTE_START, GameEventMode::DOMINATION);
+    
+    // activate() distrugge questa modalità: da qui in poi solo variabili locali.
+    ModeRegistry* registry = _registry;
+    *_appStatePtr = APP_STATE_DOMINATION_MODE;
+    static_cast<DominationMode*>(registry->activate(APP_STATE_DOMINATION_MODE))->enterInGame();
+}
 
-    } else if (cmd_event == "START_SD_GAME") {
-        Serial.println("Avvio partita C&D da remoto...");
-        _network->sendStatus("event:remote_start;mode:sd;");
-        *_appStatePtr = APP_STATE_SEARCH_DESTROY_MODE;
-        _sdMode->enterInGame();
+void TerminalMode::applySearchDestroySettings(const ParsedCommand& command) {
+    char pin[16];
+    if (command.has(FIELD_BOMB_TIME)) {
+        _sdSettings.setBombTime(command[FIELD_BOMB_TIME].toInt());
+    }
+    if (command.has(FIELD_ARM_TIME)) {
+        _sdSettings.setArmingTime(command[FIELD_ARM_TIME].toInt());
+    }
+    if (command.has(FIELD_DEFUSE_TIME)) {
+        _sdSettings.setDefuseTime(command[FIELD_DEFUSE_TIME].toInt());
+    }
+    if (command.has(FIELD_USE_ARM_PIN)) {
+        _sdSettings.setUseArmingPin(command[FIELD_USE_ARM_PIN].toInt() == 1);
+    }
+    if (command.has(FIELD_ARM_PIN)) {
+        command[FIELD_ARM_PIN].copyTo(pin, sizeof(pin));
+        _sdSettings.setArmingPin(pin);
     }
-}
\ No newline at end of file
+    if (command.has(FIELD_USE_DEFUSE_PIN)) {
+        _sdSettings.setUseDisarmingPin(command[FIELD_USE_DEFUSE_PIN].toInt() == 1);
+    }
+    if (command.has(FIELD_DEFUSE_PIN)) {
+        command[FIELD_DEFUSE_PIN].copyTo(pin, sizeof(pin));
+        _sdSettings.setDisarmingPin(pin);
+    }
+    
+    _sdSettings.saveParameters();
+    Serial.println("Impostazioni C&D aggiornate da remoto.");
+    SearchDestroyMode::sendSettingsStatus(_network, _sdSettings); // Notifica il pannello delle nuove impostazioni
+}
+
+void TerminalMode::startSearchDestroyGame() {
+    Serial.println("Avvio partita C&D da remoto...");
+    _events->publish(GameEventId::REMOTE_START, GameEventMode::SEARCH_DESTROY);
+    // activate() distrugge questa modalità: da qui in poi solo variabili locali.
+    ModeRegistry* registry = _registry;
+    *_appStatePtr = APP_STATE_SEARCH_DESTROY_MODE;
+    static_cast<SearchDestroyMode*>(registry->activate(APP_STATE_SEARCH_DESTROY_MODE))->enterInGame();
+}
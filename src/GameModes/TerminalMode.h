@@ -5,34 +5,49 @@
 
 #include "GameMode.h"
 #include "HardwareManager.h"
-#include "NetworkManager.h"
+#include "EventBus.h"
 #include "app_common.h"
+#include "NetworkManager.h"
 #include "GameModes/DominationSettings.h"
-#include "GameModes/DominationMode.h"
 #include "GameModes/SearchDestroySettings.h"
-#include "GameModes/SearchDestroyMode.h"
+#include "GameModes/ModeRegistry.h"
+#include "Network/CommandRouter.h"
 
 class TerminalMode : public GameMode {
 public:
-    TerminalMode(HardwareManager* hardware, NetworkManager* network, AppState* appState, MainMenuDisplayFunction displayFunc, 
-                 DominationSettings* domSettings, DominationMode* domMode,
-                 SearchDestroySettings* sdSettings, SearchDestroyMode* sdMode);
+    TerminalMode(HardwareManager* hardware, NetworkManager* network, EventBus* events, ModeRegistry* registry,
+                 AppState* appState, MainMenuDisplayFunction displayFunc);
+    /** @brief Fabbrica per il ModeRegistry: costruisce la modalità nell'arena. */
+    static GameMode* create(void* arena, const ModeContext& context);
 
     void enter() override;
     void loop() override;
     void exit() override;
+    /**
+     * @brief Registra sul router i comandi remoti gestiti dalla modalità terminale.
+     * @details Si chiama una volta in setup(), anche se la modalità non è costruita:
+     * i comandi vengono eseguiti solo mentre la modalità è attiva nel registro.
+     */
+    static void registerCommands(CommandRouter& router, ModeRegistry& registry);
 
 private:
     HardwareManager* _hardware;
     NetworkManager* _network;
+    EventBus* _events;
+    ModeRegistry* _registry;
     AppState* _appStatePtr;
     MainMenuDisplayFunction _mainMenuDisplayFunc;
-    DominationSettings* _domSettings;
-    DominationMode* _domMode;
-    SearchDestroySettings* _sdSettings;
-    SearchDestroyMode* _sdMode;
+    // Impostazioni modificate da remoto: le modalità le ricaricano quando vengono costruite.
+    DominationSettings _domSettings;
+    SearchDestroySettings _sdSettings;
 
-    void parseCommand(String command);
+    /** @brief La modalità terminale del registro, se è costruita ed è lo stato corrente. */
+    static TerminalMode* activeIn(void* registry);
+    bool isActive() const { return *_appStatePtr == APP_STATE_TERMINAL_MODE; }
+    void applyDominationSettings(const ParsedCommand& command);
+    void startDominationGame();
+    void applySearchDestroySettings(const ParsedCommand& command);
+    void startSearchDestroyGame();
 };
 
 #endif // TERMINAL_MODE_H
\ No newline at end of file
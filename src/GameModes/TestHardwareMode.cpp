@@ -0,0 +1,169 @@
+// src/GameModes/TestHardwareMode.cpp
+
+#include "GameModes/TestHardwareMode.h"
+#include "Profiler.h"
+#include <new>
+
+// Costruttore
+TestHardwareMode::TestHardwareMode(HardwareManager* hardware, EventBus* events, FirmwareUpdater* updater,
+                                   AppState* appState, MainMenuDisplayFunction displayFunc)
+    : _hardware(hardware),
+      _events(events),
+      _updater(updater),
+      _appStatePtr(appState),
+      _mainMenuDisplayFunc(displayFunc),
+      _subState(TEST_MAIN),
+      _lastKey(NO_KEY) {
+}
+
+GameMode* TestHardwareMode::create(void* arena, const ModeContext& context) {
+    return new (arena) TestHardwareMode(context.hardware, context.events, context.updater,
+                                        context.appState, context.displayMainMenu);
+}
+
+void TestHardwareMode::enter() {
+    _events->publish(GameEventId::MODE_ENTER, GameEventMode::TEST_HARDWARE);
+    _subState = TEST_MAIN; // Imposta il sottomenu iniziale
+    _lastKey = NO_KEY;
+    displayMainScreen();
+}
+
+/**
+ * @brief Gestisce la logica della modalità di test hardware e dei suoi sottomenù.
+ */
+void TestHardwareMode::loop() {
+    char key = _hardware->getKey();
+    bool btn1_pressed = _hardware->wasButton1Pressed();
+    bool btn2_pressed = _hardware->wasButton2Pressed();
+
+    if (_subState == TEST_MAIN) {
+        handleMainScreen(key, btn1_pressed, btn2_pressed);
+    } else if (_subState == TEST_KEYS) {
+        handleKeyTestScreen(btn1_pressed);
+    }
+}
+
+void TestHardwareMode::exit() {
+    _hardware->turnOffStrip();
+    _events->publish(GameEventId::MODE_EXIT, GameEventMode::TEST_HARDWARE);
+}
+
+/**
+ * @brief Disegna la schermata principale del Test Hardware.
+ */
+void TestHardwareMode::displayMainScreen() {
+    _hardware->clearLcd();
+    _hardware->printLcd(0, 0, "Test Hardware");
+    _hardware->printLcd(0, 1, "A:RFID B:Key C:OTA");
+    _hardware->printLcd(0, 2, "1,2,3 LED *# Profilo");
+    _hardware->setStripColor(255, 255, 255);
+    _hardware->printOled1("INDIETRO", 2, 10, 25);
+    _hardware->printOled2("TEST", 2, 35, 25);
+}
+
+/**
+ * @brief Disegna la schermata per il test delle chiavi.
+ */
+void TestHardwareMode::displayKeyTestScreen() {
+    _hardware->clearLcd();
+    _hardware->printLcd(0, 0, "Test Interruttori");
+    _hardware->printLcd(0, 2, "Chiave 1:");
+    _hardware->printLcd(0, 3, "Chiave 2:");
+    _hardware->printOled1("INDIETRO", 2, 10, 25);
+    _hardware->clearOled2();
+}
+
+void TestHardwareMode::handleMainScreen(char key, bool btn1_pressed, bool btn2_pressed) {
+    if (key != NO_KEY) {
+        Serial.printf("INPUT: '%c' premuto\n", key);
+        _hardware->playTone(700, 40);
+
+        if (key == 'A') {
+            _hardware->printLcd(0, 1, "                    "); // Pulisce la riga
+            _hardware->printLcd(0, 1, "Avvicina una card...");
+            String uid = _hardware->readRFID(5000); // Timeout di 5s
+            displayMainScreen(); // Ridisegna il menu dopo il test
+            _hardware->printLcd(0, 2, "UID:");
+            _hardware->printLcd(0, 3, uid);
+        } else if (key == 'B') {
+            // Passa al sottomenu di test delle chiavi
+            _subState = TEST_KEYS;
+            displayKeyTestScreen();
+        } else if (key == 'C') { // Usiamo il tasto 'C' per l'aggiornamento
+            _updater->checkForUpdates();
+            // Dopo il controllo, ridisegna il menu di test
+            displayMainScreen();
+        } else if (_lastKey == '*' && (key == '#' || key == '0')) {
+            printProfile();
+            if (key == '0') {
+                profiler.reset();
+            }
+            _hardware->printLcd(0, 1, key == '0' ? "Profilo azzerato    " : "Profilo su seriale  ");
+        } else {
+            _hardware->printLcd(0, 1, "Tasto premuto: " + String(key) + "   ");
+            if (key == '1') _hardware->setStripColor(255, 0, 0);
+            if (key == '2') _hardware->setStripColor(0, 255, 0);
+            if (key == '3') _hardware->setStripColor(0, 0, 255);
+        }
+        _lastKey = key;
+    }
+
+    if (btn2_pressed) {
+        Serial.println("INPUT: Pulsante 2 (Conferma) premuto");
+        _hardware->playTone(1200, 100);
+        _hardware->printLcd(0, 1, "Pulsante 2 OK!");
+    }
+
+    if (btn1_pressed) {
+        // Esce dalla modalità Test Hardware
+        Serial.println("INPUT: Pulsante 1 (Indietro) premuto");
+        _hardware->playTone(300, 70);
+        exit();
+        Serial.println("TRANSIZIONE: Test Hardware -> Main Menu");
+        *_appStatePtr = APP_STATE_MAIN_MENU;
+        _mainMenuDisplayFunc();
+    }
+}
+
+void TestHardwareMode::handleKeyTestScreen(bool btn1_pressed) {
+    bool key1_state = _hardware->isKey1Turned();
+    bool key2_state = _hardware->isKey2Turned();
+
+    // Aggiorna LCD
+    _hardware->printLcd(10, 2, key1_state ? "ON " : "OFF");
+    _hardware->printLcd(10, 3, key2_state ? "ON " : "OFF");
+
+    // Aggiorna LED Striscia
+    int half_leds = _hardware->getStripLedCount() / 2;
+    // Chiave 1 - Prima metà (Verde)
+    for (int i = 0; i < half_leds; i++) {
+        _hardware->setPixelColor(i, key1_state ? 255 : 0, 0, 0);
+    }
+    // Chiave 2 - Seconda metà (Blu)
+    for (int i = half_leds; i < _hardware->getStripLedCount(); i++) {
+        _hardware->setPixelColor(i, 0, key2_state ? 255 : 0, 0);
+    }
+    _hardware->showStrip();
+
+    if (btn1_pressed) {
+        // Torna al menu principale di test
+        Serial.println("INPUT: Pulsante 1 (Indietro) premuto");
+        _hardware->playTone(300, 70);
+        _subState = TEST_MAIN;
+        displayMainScreen();
+    }
+}
+
+void TestHardwareMode::printProfile() {
+    Serial.printf("[PROF] %-26s %8s %9s %9s %9s %9s %10s\n", "sonda", "n", "min", "p50", "p99", "max", "totale");
+    for (uint8_t i = 0; i < profiler.getProbeCount(); i++) {
+        ProfilerSummary summary;
+        profiler.summarize(i, summary);
+        if (summary.count == 0) {
+            continue;
+        }
+        Serial.printf("[PROF] %-26s %8lu %9.1f %9.1f %9.1f %9.1f %10.0f\n",
+                      summary.name, (unsigned long)summary.count, summary.minUs,
+                      summary.p50Us, summary.p99Us, summary.maxUs, summary.totalUs);
+    }
+}
@@ -0,0 +1,52 @@
+// src/GameModes/TestHardwareMode.h
+
+#ifndef TEST_HARDWARE_MODE_H
+#define TEST_HARDWARE_MODE_H
+
+#include "GameMode.h"
+#include "HardwareManager.h"
+#include "EventBus.h"
+#include "FirmwareUpdater.h"
+#include "ModeRegistry.h"
+#include "app_common.h"
+
+/**
+ * @class TestHardwareMode
+ * @brief Verifica dei componenti: RFID, chiavi, LED, aggiornamento OTA e stampa del Profiler.
+ */
+class TestHardwareMode : public GameMode {
+public:
+    TestHardwareMode(HardwareManager* hardware, EventBus* events, FirmwareUpdater* updater,
+                     AppState* appState, MainMenuDisplayFunction displayFunc);
+    /** @brief Fabbrica per il ModeRegistry: costruisce la modalità nell'arena. */
+    static GameMode* create(void* arena, const ModeContext& context);
+
+    void enter() override;
+    void loop() override;
+    void exit() override;
+
+private:
+    // Sottomenu del test
+    enum SubState {
+        TEST_MAIN,
+        TEST_KEYS
+    };
+
+    HardwareManager* _hardware;
+    EventBus* _events;
+    FirmwareUpdater* _updater;
+    AppState* _appStatePtr;
+    MainMenuDisplayFunction _mainMenuDisplayFunc;
+
+    SubState _subState;
+    char _lastKey;  // Per le combinazioni "*#" (stampa profilo) e "*0" (stampa e azzera)
+
+    void displayMainScreen();
+    void displayKeyTestScreen();
+    void handleMainScreen(char key, bool btn1, bool btn2);
+    void handleKeyTestScreen(bool btn1);
+    /** @brief Stampa sulla seriale il riassunto di tutte le sonde del Profiler, in microsecondi. */
+    void printProfile();
+};
+
+#endif // TEST_HARDWARE_MODE_H
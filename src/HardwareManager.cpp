@@ -7,6 +7,8 @@
 
 #include "HardwareManager.h" // Collegamento al file .h
 #include <Wire.h> // Libreria per I2C. Qui si inizializzano i bus
+#include "Profiler.h" // Sonde sulle chiamate di I/O
+#include <string.h>
 
 // RIASSUNTO PIN ESP32
     // Lato sinistro: VIN (5V), GND, D13, D12, D14, D27, D26, D25, D33, D32, D35, D34, VN, VP, EN
@@ -51,6 +53,11 @@ char hexaKeys[ROWS][COLS] = {
 byte rowPins[ROWS] = {27, 26, 25, 14};
 byte colPins[COLS] = {4, 5, 16, 17};
 
+static_assert(LCD_COLS <= LCD_SHADOW_COLS && LCD_ROWS <= LCD_SHADOW_ROWS, "La copia in memoria deve contenere l'LCD");
+// Nella memoria dati dell'HD44780 20x4 la riga 0 prosegue nella 2, la 2 nella 1,
+// la 1 nella 3 e la 3 nella 0: un testo oltre l'ultima colonna continua lì.
+static const uint8_t LCD_NEXT_ROW[LCD_ROWS] = {2, 3, 1, 0};
+
 /**
  * @brief Costruttore della classe.
  * @details Viene eseguito quando viene creato l'oggetto 'hardware' in main.cpp.
@@ -69,7 +76,8 @@ HardwareManager::HardwareManager() :
     _rtc(),
     _oled1(OLED_RES_X, OLED_RES_Y, &Wire, -1),
     _i2c_2(1), // Inizializza il secondo bus I2C con ID 1
-    _oled2(OLED_RES_X, OLED_RES_Y, &_i2c_2, -1)
+    _oled2(OLED_RES_X, OLED_RES_Y, &_i2c_2, -1),
+    _effects(this)
 
 {
     // Inizializza le variabili di stato per la gestione interna
@@ -93,6 +101,26 @@ HardwareManager::HardwareManager() :
 
     _nfc_i2c = nullptr;
     _nfc = nullptr;
+
+    _busWaitHook = nullptr;
+    _busWaitContext = nullptr;
+
+    // initialize() pulisce l'LCD: copia e display partono vuoti.
+    memset(_lcdShadow, ' ', sizeof(_lcdShadow));
+    memset(_lcdSent, ' ', sizeof(_lcdSent));
+    _lcdCursorCol = 0;
+    _lcdCursorRow = 0;
+    _lcdSentCol = -1;
+    _lcdSentRow = -1;
+    _lcdDirty = false;
+    memset(_lcdGlyphs, 0, sizeof(_lcdGlyphs));
+    _lcdGlyphsLoaded = 0;
+
+    _toneTimed = false;
+    _toneStartTime = 0;
+    _toneDuration = 0;
+    _savedPixels = new uint32_t[LED_STRIP_COUNT];
+    _savedBrightness = 80;
 }
 
 /**
@@ -133,6 +161,7 @@ void HardwareManager::initialize() {
         Serial.println("ERRORE: Modulo PN532 non trovato!");
         printLcd(0, 1, "Errore Lettore");
         printLcd(0, 2, "RFID!");
+        flushLcd();
         while(1) delay(10);
     }
     Serial.print("Trovato chip PN5"); Serial.println((versiondata >> 24) & 0xFF, HEX);
@@ -182,6 +211,7 @@ void HardwareManager::initialize() {
     if (!_rtc.begin()) {
         Serial.println("ERRORE: modulo RTC non trovato!");
         printLcd(0, 0, "Errore RTC!");
+        flushLcd();
         while (1) delay(10);
     }
     Serial.println("OK.");
@@ -201,6 +231,7 @@ void HardwareManager::initialize() {
 // Sono "wrapper" che nascondono i dettagli delle librerie sottostanti.
 
 void HardwareManager::updateButtons() { 
+    PROFILE_SCOPE("hw", "buttons");
     _button1.update();
     _button2.update();
     _key1.update();
@@ -209,7 +240,10 @@ void HardwareManager::updateButtons() {
 
 bool HardwareManager::wasButton1Pressed() { return _button1.wasPressed(); }
 bool HardwareManager::wasButton2Pressed() { return _button2.wasPressed(); }
-char HardwareManager::getKey() { return _keypad.getKey(); }
+char HardwareManager::getKey() {
+    PROFILE_SCOPE("hw", "keypad");
+    return _keypad.getKey();
+}
 bool HardwareManager::isButton1Pressed() { return _button1.isPressed(); }
 bool HardwareManager::isButton2Pressed() { return _button2.isPressed(); }
 // --- GESTIONE INTERRUTTORI A CHIAVE ---
@@ -218,16 +252,20 @@ bool HardwareManager::isKey2Turned() { return _key2.isPressed(); }
 
 // --- GESTIONE OUTPUT LED ---
 void HardwareManager::updateRainbowEffect() {
-    if (millis() - _rainbowLastUpdate < 25) return;
+    if (_effects.usesStrip()) return; // La striscia è della timeline degli effetti
+    // Il passo da 25 ms lo scandisce il lavoro "leds" del loop(): il margine evita
+    // di saltare un passo quando un'esecuzione parte con qualche ms di ritardo.
+    if (millis() - _rainbowLastUpdate < 20) return;
     _rainbowLastUpdate = millis();
     for (int i = 0; i < LED_STRIP_COUNT; i++) {
         int pixelHue = _rainbowFirstPixelHue + static_cast<int>(i * (65536.0f / LED_STRIP_COUNT));
         _strip.setPixelColor(i, _strip.gamma32(_strip.ColorHSV(pixelHue)));
     }
-    _strip.show();
+    showStrip();
     _rainbowFirstPixelHue = (_rainbowFirstPixelHue + 256) % 65536;
 }
 void HardwareManager::updateBreathingEffect(uint8_t r, uint8_t g, uint8_t b) {
+    if (_effects.usesStrip()) return;
     if(millis() - _breathingLastUpdate < 25) { return; }
     _breathingLastUpdate = millis();
     if(_breathingUp) {
@@ -244,45 +282,41 @@ void HardwareManager::updateBreathingEffect(uint8_t r, uint8_t g, uint8_t b) {
 }
 void HardwareManager::setStripColor(uint8_t r, uint8_t g, uint8_t b) {
     _strip.fill(_strip.Color(r, g, b));
-    _strip.show();
+    showStrip();
 }
 void HardwareManager::setPixelColor(uint16_t pixel, uint8_t r, uint8_t g, uint8_t b) {
     if (pixel < _strip.numPixels()) {
         _strip.setPixelColor(pixel, _strip.Color(r, g, b));
     }
 }
-void HardwareManager::showStrip() { _strip.show(); }
-void HardwareManager::turnOffStrip() { _strip.clear(); _strip.show(); }
-void HardwareManager::setBrightness(uint8_t brightness) { _strip.setBrightness(brightness); _strip.show(); }
+void HardwareManager::showStrip() {
+    PROFILE_SCOPE("hw", "strip_show");
+    _strip.show();
+}
+void HardwareManager::turnOffStrip() { _strip.clear(); showStrip(); }
+void HardwareManager::setBrightness(uint8_t brightness) { _strip.setBrightness(brightness); showStrip(); }
 int HardwareManager::getStripLedCount() {
     return LED_STRIP_COUNT;
 }
 void HardwareManager::flashCurrentColor(int count, int duration) {
-    uint32_t pixels[LED_STRIP_COUNT];
-    for(int i=0; i < LED_STRIP_COUNT; i++) {
-        pixels[i] = _strip.getPixelColor(i);
-    }
-    uint8_t originalBrightness = _strip.getBrightness();
-    
-    setBrightness(255);
-    for (int i = 0; i < count; i++) {
-        _strip.show(); // Mostra i colori attuali a massima luminosità
-        delay(duration);
-        turnOffStrip();
-        if (i < count - 1) {
-            delay(500);
-        }
+    _effects.flash(count, duration);
+}
+void HardwareManager::saveStrip() {
+    for (int i = 0; i < LED_STRIP_COUNT; i++) {
+        _savedPixels[i] = _strip.getPixelColor(i);
     }
-    
-    // Ripristina i pixel originali
-    for(int i=0; i < LED_STRIP_COUNT; i++) {
-        _strip.setPixelColor(i, pixels[i]);
+    _savedBrightness = _strip.getBrightness();
+}
+void HardwareManager::restoreStrip() {
+    _strip.setBrightness(_savedBrightness);
+    for (int i = 0; i < LED_STRIP_COUNT; i++) {
+        _strip.setPixelColor(i, _savedPixels[i]);
     }
-    _strip.show();
-    setBrightness(originalBrightness);
+    showStrip();
 }
 
 void HardwareManager::updateWinnerWaveEffect(uint8_t r, uint8_t g, uint8_t b, float base_brightness, float peak_brightness, int wave_width) {
+    if (_effects.usesStrip()) return;
     if(millis() - _waveLastUpdate < 50) { return; }
     _waveLastUpdate = millis();
 
@@ -299,7 +333,7 @@ void HardwareManager::updateWinnerWaveEffect(uint8_t r, uint8_t g, uint8_t b, fl
         
         _strip.setPixelColor(i, r * brightness, g * brightness, b * brightness);
     }
-    _strip.show();
+    showStrip();
 
     _waveCenter++;
     if (_waveCenter >= _strip.numPixels()) {
@@ -308,27 +342,100 @@ void HardwareManager::updateWinnerWaveEffect(uint8_t r, uint8_t g, uint8_t b, fl
 }
 
 // --- GESTIONE RTC ---
-DateTime HardwareManager::getRTCTime() { return _rtc.now(); }
+DateTime HardwareManager::getRTCTime() {
+    PROFILE_SCOPE("hw", "rtc");
+    return _rtc.now();
+}
 
 // --- GESTIONE LCD ---
-void HardwareManager::printLcd(int col, int row, const String& text) { _lcd.setCursor(col, row); _lcd.print(text); }
-void HardwareManager::clearLcd() { _lcd.clear(); }
+// printLcd() e clearLcd() lavorano sulla copia in memoria; le sonde "lcd_print"
+// e "lcd_clear" contano le chiamate, "lcd_flush" le scritture sul bus.
+void HardwareManager::printLcd(int col, int row, const String& text) {
+    PROFILE_SCOPE("hw", "lcd_print");
+    // Come setCursor() della libreria: una riga oltre l'ultima diventa l'ultima.
+    _lcdCursorRow = row < 0 ? 0 : (row >= _lcdRows ? _lcdRows - 1 : row);
+    _lcdCursorCol = col < 0 ? 0 : col;
+    const char* chars = text.c_str();
+    for (unsigned int i = 0; i < text.length(); i++) {
+        putLcdChar((uint8_t)chars[i]);
+    }
+}
+void HardwareManager::clearLcd() {
+    PROFILE_SCOPE("hw", "lcd_clear");
+    memset(_lcdShadow, ' ', sizeof(_lcdShadow));
+    _lcdCursorCol = 0;
+    _lcdCursorRow = 0;
+    _lcdDirty = true;
+}
+void HardwareManager::putLcdChar(uint8_t ch) {
+    // Oltre l'ultima colonna (solo con setCursor() fuori schermo) la scrittura non è visibile.
+    if (_lcdCursorCol < _lcdCols) {
+        if (_lcdShadow[_lcdCursorRow][_lcdCursorCol] != ch) {
+            _lcdShadow[_lcdCursorRow][_lcdCursorCol] = ch;
+            _lcdDirty = true;
+        }
+    }
+    _lcdCursorCol++;
+    if (_lcdCursorCol == _lcdCols) {
+        _lcdCursorCol = 0;
+        _lcdCursorRow = LCD_NEXT_ROW[_lcdCursorRow];
+    }
+}
+// La sonda si chiude prima di busWait(): i lavori urgenti eseguiti lì non sono tempo di I/O.
+void HardwareManager::flushLcd() {
+    if (!_lcdDirty) {
+        return;
+    }
+    _lcdDirty = false;
+    for (int row = 0; row < _lcdRows; row++) {
+        int col = 0;
+        while (col < _lcdCols) {
+            if (_lcdShadow[row][col] == _lcdSent[row][col]) {
+                col++;
+                continue;
+            }
+            int start = col;
+            while (col < _lcdCols && _lcdShadow[row][col] != _lcdSent[row][col]) {
+                col++;
+            }
+            {
+                PROFILE_SCOPE("hw", "lcd_flush");
+                if (_lcdSentRow != row || _lcdSentCol != start) {
+                    _lcd.setCursor(start, row);
+                }
+                for (int i = start; i < col; i++) {
+                    _lcd.write(_lcdShadow[row][i]);
+                    _lcdSent[row][i] = _lcdShadow[row][i];
+                }
+            }
+            // A fine riga il cursore dell'LCD prosegue su un'altra riga: meglio non contarci.
+            _lcdSentRow = row;
+            _lcdSentCol = col < _lcdCols ? col : -1;
+            busWait();
+        }
+    }
+}
 
 // --- GESTIONE BUZZER E MELODIE ---
 void HardwareManager::playTone(unsigned int frequency, unsigned long duration) {
+    PROFILE_SCOPE("hw", "buzzer");
     ledcWriteTone(_buzzerChannel, frequency);
-    if (duration > 0) {
-        delay(duration);
-        noTone();
-    }
+    // Il silenzio lo dà updateEffects(): il chiamante non resta fermo per la durata.
+    _toneTimed = duration > 0;
+    _toneStartTime = millis();
+    _toneDuration = duration;
 }
 void HardwareManager::noTone() {
+    PROFILE_SCOPE("hw", "buzzer");
+    _toneTimed = false;
     ledcWrite(_buzzerChannel, 0); // Imposta il duty cycle a 0 per il silenzio assoluto
 }
 void HardwareManager::updateTone(unsigned int frequency) {
+    _toneTimed = false; // Un suono continuo sostituisce quello a tempo
     if (frequency == 0) {
         noTone();
     } else {
+        PROFILE_SCOPE("hw", "buzzer");
         ledcWriteTone(_buzzerChannel, frequency);
     }
 }
@@ -388,6 +495,16 @@ bool HardwareManager::isMidiTunePlaying() {
     return _currentMidiTune != nullptr;
 }
 
+// --- GESTIONE EFFETTI ---
+EffectTimeline& HardwareManager::effects() { return _effects; }
+
+void HardwareManager::updateEffects() {
+    if (_toneTimed && millis() - _toneStartTime >= _toneDuration) {
+        noTone();
+    }
+    _effects.update(millis());
+}
+
 // --- GETTERS ---
 int HardwareManager::getLcdRows() { return _lcdRows; }
 int HardwareManager::getLcdCols() { return _lcdCols; }
@@ -399,35 +516,69 @@ void HardwareManager::createProgressBarChars() {
     byte p3[]={B11100,B11100,B11100,B11100,B11100,B11100,B11100,B11100};
     byte p4[]={B11110,B11110,B11110,B11110,B11110,B11110,B11110,B11110};
     byte p5[]={B11111,B11111,B11111,B11111,B11111,B11111,B11111,B11111};
-    _lcd.createChar(0, p1); _lcd.createChar(1, p2); _lcd.createChar(2, p3);
-    _lcd.createChar(3, p4); _lcd.createChar(4, p5);
+    loadCustomChar(0, p1); loadCustomChar(1, p2); loadCustomChar(2, p3);
+    loadCustomChar(3, p4); loadCustomChar(4, p5);
+}
+void HardwareManager::loadCustomChar(uint8_t location, const uint8_t charmap[8]) {
+    if (location >= LCD_CUSTOM_CHAR_COUNT) {
+        return;
+    }
+    if ((_lcdGlyphsLoaded & (1 << location)) && memcmp(_lcdGlyphs[location], charmap, 8) == 0) {
+        return;
+    }
+    memcpy(_lcdGlyphs[location], charmap, 8);
+    _lcdGlyphsLoaded |= 1 << location;
+    // Le celle che mostrano il carattere si aggiornano da sole; il cursore invece
+    // resta nella memoria dei caratteri, e il prossimo invio deve riposizionarlo.
+    _lcd.createChar(location, _lcdGlyphs[location]);
+    _lcdSentCol = -1;
+    _lcdSentRow = -1;
+}
+void HardwareManager::writeCustomChar(uint8_t charIndex) {
+    PROFILE_SCOPE("hw", "lcd_print");
+    putLcdChar(charIndex);
 }
-void HardwareManager::writeCustomChar(uint8_t charIndex) { _lcd.write(byte(charIndex)); }
 
 // --- FUNZIONI PER GLI OLED ---
 void HardwareManager::clearOled1() {
-    _oled1.clearDisplay();
-    _oled1.display();
+    {
+        PROFILE_SCOPE("hw", "oled_clear");
+        _oled1.clearDisplay();
+        _oled1.display();
+    }
+    busWait();
 }
 void HardwareManager::printOled1(const String& text, int size, int x, int y) {
-    _oled1.clearDisplay();
-    _oled1.setTextSize(size);
-    _oled1.setTextColor(SSD1306_WHITE);
-    _oled1.setCursor(x, y);
-    _oled1.println(text);
-    _oled1.display();
+    {
+        PROFILE_SCOPE("hw", "oled_print");
+        _oled1.clearDisplay();
+        _oled1.setTextSize(size);
+        _oled1.setTextColor(SSD1306_WHITE);
+        _oled1.setCursor(x, y);
+        _oled1.println(text);
+        _oled1.display();
+    }
+    busWait();
 }
 void HardwareManager::clearOled2() {
-    _oled2.clearDisplay();
-    _oled2.display();
+    {
+        PROFILE_SCOPE("hw", "oled_clear");
+        _oled2.clearDisplay();
+        _oled2.display();
+    }
+    busWait();
 }
 void HardwareManager::printOled2(const String& text, int size, int x, int y) {
-    _oled2.clearDisplay();
-    _oled2.setTextSize(size);
-    _oled2.setTextColor(SSD1306_WHITE);
-    _oled2.setCursor(x, y);
-    _oled2.println(text);
-    _oled2.display();
+    {
+        PROFILE_SCOPE("hw", "oled_print");
+        _oled2.clearDisplay();
+        _oled2.setTextSize(size);
+        _oled2.setTextColor(SSD1306_WHITE);
+        _oled2.setCursor(x, y);
+        _oled2.println(text);
+        _oled2.display();
+    }
+    busWait();
 }
 
 /**
@@ -436,6 +587,8 @@ void HardwareManager::printOled2(const String& text, int size, int x, int y) {
  * @return Una stringa con l'UID in formato esadecimale, o un messaggio di errore.
  */
 String HardwareManager::readRFID(uint16_t timeout) {
+    flushLcd();     // L'attesa blocca il loop(): il messaggio per l'utente va mostrato prima
+    PROFILE_SCOPE("hw", "rfid");    // Attesa della card compresa
     uint8_t success;
     uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
     uint8_t uidLength;
@@ -457,8 +610,21 @@ String HardwareManager::readRFID(uint16_t timeout) {
             return uidString;
         }
         delay(10); // Piccola pausa per non sovraccaricare il bus I2C
+        busWait();
     }
     
     // Se il ciclo finisce senza aver trovato nulla
     return "Nessuna card trovata";
-}
\ No newline at end of file
+}
+
+// --- ATTESA SUL BUS I2C ---
+void HardwareManager::setBusWaitHook(void (*hook)(void*), void* context) {
+    _busWaitHook = hook;
+    _busWaitContext = context;
+}
+
+void HardwareManager::busWait() {
+    if (_busWaitHook != nullptr) {
+        _busWaitHook(_busWaitContext);
+    }
+}
@@ -0,0 +1,61 @@
+// src/Network/ClockSync.cpp
+
+/**
+ * @file ClockSync.cpp
+ * @brief Implementazione della classe ClockSync.
+ */
+
+#include "Network/ClockSync.h"
+
+// Una risposta arrivata dopo questo tempo appartiene a una richiesta ormai persa.
+static const uint32_t MAX_ROUND_TRIP_MS = 2000;
+
+ClockSync::ClockSync() {
+    reset();
+}
+
+void ClockSync::reset() {
+    _count = 0;
+    _next = 0;
+    _offset = 0;
+    _roundTrip = 0;
+}
+
+int32_t ClockSync::difference(uint32_t a, uint32_t b) {
+    uint32_t diff = (a - b) & SERVER_TIME_MASK;
+    // Estende il segno del 31° bit.
+    return diff > (SERVER_TIME_MASK >> 1) ? (int32_t)diff - (int32_t)SERVER_TIME_MASK - 1 : (int32_t)diff;
+}
+
+bool ClockSync::addSample(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3) {
+    uint32_t elapsed = t3 - t0;
+    int32_t serverHold = difference(t2, t1);
+    if (elapsed > MAX_ROUND_TRIP_MS || serverHold < 0 || (uint32_t)serverHold > elapsed) {
+        return false;
+    }
+
+    // Scarto visto all'andata e al ritorno: la media elimina il ritardo se il percorso è simmetrico.
+    uint32_t outbound = (t1 - t0) & SERVER_TIME_MASK;
+    uint32_t inbound = (t2 - t3) & SERVER_TIME_MASK;
+    Sample& sample = _samples[_next];
+    sample.offset = (outbound + difference(inbound, outbound) / 2) & SERVER_TIME_MASK;
+    sample.roundTrip = elapsed - (uint32_t)serverHold;
+
+    _next = (_next + 1) % CLOCK_SYNC_SAMPLES;
+    if (_count < CLOCK_SYNC_SAMPLES) {
+        _count++;
+    }
+    selectBest();
+    return true;
+}
+
+void ClockSync::selectBest() {
+    const Sample* best = &_samples[0];
+    for (uint8_t i = 1; i < _count; i++) {
+        if (_samples[i].roundTrip < best->roundTrip) {
+            best = &_samples[i];
+        }
+    }
+    _offset = best->offset;
+    _roundTrip = best->roundTrip;
+}
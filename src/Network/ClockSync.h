@@ -0,0 +1,81 @@
+// src/Network/ClockSync.h
+
+/**
+ * @file ClockSync.h
+ * @brief Dichiarazione della classe ClockSync, che stima lo scarto tra l'orologio del dispositivo e quello del server.
+ * @details Scambio in stile NTP attraverso il bridge:
+ * @code
+ *   dispositivo -> bridge : event:time_sync;t0:<millis() all'invio>;
+ *   bridge -> dispositivo : CMD:TIME_SYNC;T0:<t0>;T1:<ricezione>;T2:<risposta>;
+ *   (il dispositivo annota t3 = millis() alla ricezione)
+ *   scarto  = ((T1 - t0) + (T2 - t3)) / 2
+ *   ritardo = (t3 - t0) - (T2 - T1)
+ * @endcode
+ * Il "tempo server" è il tempo Unix del bridge in millisecondi ridotto a 31 bit
+ * (SERVER_TIME_MASK): entra in un intero positivo a 32 bit, quindi viaggia come
+ * intero anche nel protocollo binario, e si ripete ogni ~24 giorni. Chi lo riceve
+ * lo ricostruisce per intero confrontandolo con il proprio orologio.
+ * Tra gli ultimi campioni si usa quello con il ritardo minimo (il meno disturbato
+ * da code e ritrasmissioni WiFi). Non dipende da Arduino.
+ */
+
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include <stdint.h>
+
+/** @brief Il tempo server è espresso in millisecondi modulo 2^31. */
+#define SERVER_TIME_MASK 0x7FFFFFFFu
+/** @brief Numero di campioni conservati per la scelta di quello a ritardo minimo. */
+#define CLOCK_SYNC_SAMPLES 8
+
+/**
+ * @class ClockSync
+ * @brief Converte millis() locali in tempo server a partire dagli scambi con il bridge.
+ */
+class ClockSync {
+public:
+    ClockSync();
+
+    /**
+     * @brief Aggiunge il risultato di uno scambio.
+     * @param t0 millis() all'invio della richiesta.
+     * @param t1 Tempo server alla ricezione della richiesta.
+     * @param t2 Tempo server all'invio della risposta.
+     * @param t3 millis() alla ricezione della risposta.
+     * @return false se il campione è incoerente (risposta a una richiesta troppo vecchia).
+     */
+    bool addSample(uint32_t t0, uint32_t t1, uint32_t t2, uint32_t t3);
+    /** @brief Ritorna true se è disponibile almeno un campione valido. */
+    bool isSynced() const { return _count > 0; }
+    /** @brief Converte un istante locale (millis()) in tempo server. */
+    uint32_t toServerTime(uint32_t localMs) const { return (localMs + _offset) & SERVER_TIME_MASK; }
+    /** @brief Scarto stimato (tempo server - millis()), modulo 2^31. */
+    uint32_t getOffset() const { return _offset; }
+    /** @brief Ritardo di andata e ritorno del campione in uso (ms). */
+    uint32_t getRoundTrip() const { return _roundTrip; }
+    /** @brief Scarta tutti i campioni (es. dopo una lunga disconnessione). */
+    void reset();
+
+    /**
+     * @brief Differenza con segno a - b tra due tempi server (ms).
+     * @details Calcolata modulo 2^31: vale per istanti distanti meno di ~12 giorni.
+     */
+    static int32_t difference(uint32_t a, uint32_t b);
+
+private:
+    /** @brief Ricalcola scarto e ritardo scegliendo il campione con il ritardo minimo. */
+    void selectBest();
+
+    struct Sample {
+        uint32_t offset;
+        uint32_t roundTrip;
+    };
+    Sample _samples[CLOCK_SYNC_SAMPLES];
+    uint8_t _count;     // Campioni validi (al massimo CLOCK_SYNC_SAMPLES)
+    uint8_t _next;      // Prossimo slot da sovrascrivere
+    uint32_t _offset;
+    uint32_t _roundTrip;
+};
+
+#endif // CLOCK_SYNC_H
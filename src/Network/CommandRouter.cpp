@@ -0,0 +1,190 @@
+// src/Network/CommandRouter.cpp
+
+/**
+ * @file CommandRouter.cpp
+ * @brief Implementazione del tokenizer dei comandi e della classe CommandRouter.
+ */
+
+#include "Network/CommandRouter.h"
+
+// Tabelle calcolate in compilazione: se non esiste un seme senza collisioni la build fallisce.
+static constexpr PerfectHashTable<CMD_COUNT, 8> COMMAND_TABLE(COMMAND_NAMES);
+static constexpr PerfectHashTable<FIELD_COUNT, 16> FIELD_TABLE(FIELD_NAMES);
+static_assert(COMMAND_TABLE.seed() != 0, "Nessun hash perfetto per i nomi dei comandi");
+static_assert(FIELD_TABLE.seed() != 0, "Nessun hash perfetto per i nomi dei campi");
+static_assert(FIELD_COUNT <= 16, "ParsedCommand::present ha 16 bit");
+
+long TextView::toInt() const {
+    size_t i = 0;
+    bool negative = false;
+    if (i < length && (data[i] == '-' || data[i] == '+')) {
+        negative = data[i] == '-';
+        i++;
+    }
+    long value = 0;
+    for (; i < length && data[i] >= '0' && data[i] <= '9'; i++) {
+        value = value * 10 + (data[i] - '0');
+    }
+    return negative ? -value : value;
+}
+
+size_t TextView::copyTo(char* out, size_t capacity) const {
+    if (capacity == 0) {
+        return 0;
+    }
+    size_t n = length < capacity - 1 ? length : capacity - 1;
+    memcpy(out, data, n);
+    out[n] = '\0';
+    return n;
+}
+
+bool CommandTokenizer::next(TextView& key, TextView& value) {
+    // Salta i separatori vuoti (";;" o ';' finale).
+    while (*_cursor == ';') {
+        _cursor++;
+    }
+    if (*_cursor == '\0') {
+        return false;
+    }
+
+    const char* start = _cursor;
+    const char* colon = nullptr;
+    while (*_cursor != '\0' && *_cursor != ';') {
+        if (colon == nullptr && *_cursor == ':') {
+            colon = _cursor;
+        }
+        _cursor++;
+    }
+
+    if (colon != nullptr) {
+        key = { start, (uint16_t)(colon - start) };
+        value = { colon + 1, (uint16_t)(_cursor - colon - 1) };
+    } else {
+        key = { start, (uint16_t)(_cursor - start) };
+        value = { nullptr, 0 };
+    }
+    return true;
+}
+
+CommandRouter::CommandRouter() {
+    for (int i = 0; i < CMD_COUNT; i++) {
+        _routes[i].handler = nullptr;
+        _routes[i].context = nullptr;
+    }
+    for (int i = 0; i < COMMAND_SCHEDULE_SLOTS; i++) {
+        _scheduled[i].pending = false;
+    }
+}
+
+void CommandRouter::on(CommandId id, CommandHandler handler, void* context) {
+    if (id < CMD_COUNT) {
+        _routes[id].handler = handler;
+        _routes[id].context = context;
+    }
+}
+
+CommandId CommandRouter::lookupCommand(const TextView& name) {
+    return (CommandId)COMMAND_TABLE.lookup(name);
+}
+
+FieldId CommandRouter::lookupField(const TextView& name) {
+    return (FieldId)FIELD_TABLE.lookup(name);
+}
+
+bool CommandRouter::parse(const char* text, ParsedCommand& out) {
+    out.id = CMD_UNKNOWN;
+    out.present = 0;
+    for (int i = 0; i < FIELD_COUNT; i++) {
+        out.fields[i] = { text, 0 };
+    }
+
+    CommandTokenizer tokenizer(text);
+    TextView key;
+    TextView value;
+    bool commandSeen = false;
+    while (tokenizer.next(key, value)) {
+        if (value.data != nullptr && key.length == 3 && memcmp(key.data, "CMD", 3) == 0) {
+            // Vale il primo "CMD:" del messaggio, come nel parser precedente.
+            if (!commandSeen) {
+                out.id = lookupCommand(value);
+                commandSeen = true;
+            }
+            continue;
+        }
+        FieldId field = lookupField(key);
+        if (field != FIELD_UNKNOWN && value.data != nullptr) {
+            out.fields[field] = value;
+            out.present |= (uint16_t)(1u << field);
+        }
+    }
+    return out.id != CMD_UNKNOWN;
+}
+
+bool CommandRouter::dispatch(const char* text) const {
+    ParsedCommand command;
+    if (!parse(text, command) || _routes[command.id].handler == nullptr) {
+        return false;
+    }
+    _routes[command.id].handler(command, _routes[command.id].context);
+    return true;
+}
+
+bool CommandRouter::dispatch(const char* text, const ClockSync& clock, uint32_t localNow) {
+    ParsedCommand command;
+    if (!parse(text, command) || _routes[command.id].handler == nullptr) {
+        return false;
+    }
+    uint32_t at;
+    if (isScheduled(command, clock, localNow, at)) {
+        int slot = findFreeSlot(text);
+        if (slot < 0) {
+            return false;
+        }
+        strcpy(_scheduled[slot].text, text);
+        _scheduled[slot].at = at;
+        _scheduled[slot].pending = true;
+        return true;
+    }
+    _routes[command.id].handler(command, _routes[command.id].context);
+    return true;
+}
+
+bool CommandRouter::canAccept(const char* text, const ClockSync& clock, uint32_t localNow) const {
+    ParsedCommand command;
+    uint32_t at;
+    if (!parse(text, command) || _routes[command.id].handler == nullptr ||
+        !isScheduled(command, clock, localNow, at)) {
+        return true;
+    }
+    return findFreeSlot(text) >= 0;
+}
+
+bool CommandRouter::isScheduled(const ParsedCommand& command, const ClockSync& clock, uint32_t localNow, uint32_t& at) {
+    if (!command.has(FIELD_AT) || !clock.isSynced()) {
+        return false;
+    }
+    at = (uint32_t)command[FIELD_AT].toInt() & SERVER_TIME_MASK;
+    return ClockSync::difference(at, clock.toServerTime(localNow)) > 0;
+}
+
+int CommandRouter::findFreeSlot(const char* text) const {
+    if (strlen(text) >= COMMAND_SCHEDULE_MAX_LEN) {
+        return -1;
+    }
+    for (int i = 0; i < COMMAND_SCHEDULE_SLOTS; i++) {
+        if (!_scheduled[i].pending) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void CommandRouter::runDue(const ClockSync& clock, uint32_t localNow) {
+    uint32_t now = clock.toServerTime(localNow);
+    for (int i = 0; i < COMMAND_SCHEDULE_SLOTS; i++) {
+        if (_scheduled[i].pending && ClockSync::difference(now, _scheduled[i].at) >= 0) {
+            dispatch(_scheduled[i].text);
+            _scheduled[i].pending = false;
+        }
+    }
+}
@@ -0,0 +1,267 @@
+// src/Network/CommandRouter.h
+
+/**
+ * @file CommandRouter.h
+ * @brief Dichiarazione del tokenizer dei comandi e della classe CommandRouter.
+ * @details I comandi del pannello hanno la forma "CMD:NOME;CHIAVE:valore;...".
+ * Il tokenizer scorre il buffer di ricezione senza copiarlo e restituisce viste
+ * (puntatore + lunghezza) su chiavi e valori. Nomi di comandi e campi vengono
+ * riconosciuti con tabelle di hash perfetto calcolate in fase di compilazione:
+ * un hash e un solo confronto per token, nessuna allocazione.
+ *
+ * Per aggiungere un comando o un campo basta aggiungerne il nome in coda alla
+ * tabella e il valore corrispondente all'enum, nello stesso ordine.
+ */
+
+#ifndef COMMAND_ROUTER_H
+#define COMMAND_ROUTER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include "Network/ClockSync.h"
+
+/** @brief Numero massimo di comandi in attesa del loro istante di esecuzione (AT:). */
+#define COMMAND_SCHEDULE_SLOTS 4
+/** @brief Lunghezza massima (terminatore incluso) di un comando programmato. */
+#define COMMAND_SCHEDULE_MAX_LEN 256
+
+/**
+ * @struct TextView
+ * @brief Vista non proprietaria su una porzione del buffer di ricezione.
+ */
+struct TextView {
+    const char* data;
+    uint16_t length;
+
+    bool isEmpty() const { return length == 0; }
+    bool equals(const char* text) const { return strlen(text) == length && memcmp(data, text, length) == 0; }
+    /** @brief Converte in intero (decimale, segno opzionale). Ritorna 0 se non numerico. */
+    long toInt() const;
+    /** @brief Copia il testo in un buffer terminato da '\0', troncando se necessario. */
+    size_t copyTo(char* out, size_t capacity) const;
+};
+
+/**
+ * @class CommandTokenizer
+ * @brief Scorre le coppie "chiave:valore" separate da ';' senza modificare il testo.
+ */
+class CommandTokenizer {
+public:
+    explicit CommandTokenizer(const char* text) : _cursor(text) {}
+    /**
+     * @brief Estrae la prossima coppia. I token senza ':' hanno valore nullo (data == nullptr).
+     * @return false quando il testo è finito.
+     */
+    bool next(TextView& key, TextView& value);
+
+private:
+    const char* _cursor;
+};
+
+/** @brief Comandi riconosciuti. L'ordine deve corrispondere a COMMAND_NAMES. */
+enum CommandId : uint8_t {
+    CMD_FORCE_END_GAME,
+    CMD_SET_DOM_SETTINGS,
+    CMD_START_DOM_GAME,
+    CMD_SET_SD_SETTINGS,
+    CMD_START_SD_GAME,
+    CMD_PROFILE,           // Riassunto del Profiler (vedi Profiler.h)
+    CMD_COUNT,
+    CMD_UNKNOWN = CMD_COUNT
+};
+
+/** @brief Campi riconosciuti. L'ordine deve corrispondere a FIELD_NAMES. */
+enum FieldId : uint8_t {   // Al massimo 16 campi (vedi ParsedCommand::present)
+    FIELD_DURATION,
+    FIELD_CAPTURE,
+    FIELD_BOMB_TIME,
+    FIELD_ARM_TIME,
+    FIELD_DEFUSE_TIME,
+    FIELD_USE_ARM_PIN,
+    FIELD_ARM_PIN,
+    FIELD_USE_DEFUSE_PIN,
+    FIELD_DEFUSE_PIN,
+    FIELD_AT,              // Istante di esecuzione in tempo server (vedi ClockSync)
+    FIELD_RESET,           // PROFILE: azzera le sonde dopo l'invio
+    FIELD_COUNT,
+    FIELD_UNKNOWN = FIELD_COUNT
+};
+
+static constexpr const char* COMMAND_NAMES[CMD_COUNT] = {
+    "FORCE_END_GAME", "SET_DOM_SETTINGS", "START_DOM_GAME", "SET_SD_SETTINGS", "START_SD_GAME",
+    "PROFILE"
+};
+
+static constexpr const char* FIELD_NAMES[FIELD_COUNT] = {
+    "DURATION", "CAPTURE", "BOMB_TIME", "ARM_TIME", "DEFUSE_TIME",
+    "USE_ARM_PIN", "ARM_PIN", "USE_DEFUSE_PIN", "DEFUSE_PIN", "AT",
+    "RESET"
+};
+
+/**
+ * @brief Hash FNV-1a con seme, valutabile sia in compilazione sia a runtime.
+ * @details Il rimescolamento finale porta i bit alti in quelli bassi, gli unici
+ * usati per scegliere lo slot.
+ */
+constexpr uint32_t hashName(const char* text, size_t length, uint32_t seed) {
+    uint32_t hash = 2166136261u ^ seed;
+    for (size_t i = 0; i < length; i++) {
+        hash = (hash ^ (uint8_t)text[i]) * 16777619u;
+    }
+    hash ^= hash >> 16;
+    hash *= 0x85EBCA6Bu;
+    hash ^= hash >> 13;
+    return hash;
+}
+
+constexpr size_t constLength(const char* text) {
+    size_t length = 0;
+    while (text[length] != '\0') {
+        length++;
+    }
+    return length;
+}
+
+/**
+ * @class PerfectHashTable
+ * @brief Tabella di hash perfetto su un insieme fisso di nomi.
+ * @details Il costruttore constexpr cerca il primo seme per cui nessun nome
+ * collide: la ricerca avviene una sola volta, durante la compilazione.
+ * @tparam N Numero di nomi.
+ * @tparam SLOTS Dimensione della tabella (potenza di 2, maggiore di N).
+ */
+template <size_t N, size_t SLOTS>
+class PerfectHashTable {
+    static_assert((SLOTS & (SLOTS - 1)) == 0, "SLOTS deve essere una potenza di 2");
+    static_assert(SLOTS > N, "La tabella deve avere piu' slot che nomi");
+
+public:
+    constexpr PerfectHashTable(const char* const (&names)[N]) : _names(names), _seed(0), _slots() {
+        for (uint32_t seed = 1; seed < 100000; seed++) {
+            for (size_t s = 0; s < SLOTS; s++) {
+                _slots[s] = -1;
+            }
+            bool collision = false;
+            for (size_t i = 0; i < N && !collision; i++) {
+                size_t slot = hashName(names[i], constLength(names[i]), seed) & (SLOTS - 1);
+                if (_slots[slot] >= 0) {
+                    collision = true;
+                } else {
+                    _slots[slot] = (int8_t)i;
+                }
+            }
+            if (!collision) {
+                _seed = seed;
+                return;
+            }
+        }
+    }
+
+    /** @brief Ritorna l'indice del nome, oppure N se non è nella tabella. */
+    size_t lookup(const TextView& name) const {
+        int8_t index = _slots[hashName(name.data, name.length, _seed) & (SLOTS - 1)];
+        if (index < 0 || !name.equals(_names[index])) {
+            return N;
+        }
+        return (size_t)index;
+    }
+
+    constexpr uint32_t seed() const { return _seed; }
+
+private:
+    const char* const (&_names)[N];
+    uint32_t _seed;
+    int8_t _slots[SLOTS];
+};
+
+/**
+ * @struct ParsedCommand
+ * @brief Comando riconosciuto, con una vista sul valore di ogni campo presente.
+ * @details Le viste puntano al buffer originale e ne condividono la durata.
+ */
+struct ParsedCommand {
+    CommandId id;
+    uint16_t present;               // Bit i = campo i presente nel messaggio
+    TextView fields[FIELD_COUNT];   // Campo assente = vista vuota
+
+    bool has(FieldId field) const { return (present >> field) & 1; }
+    const TextView& operator[](FieldId field) const { return fields[field]; }
+};
+
+/** @brief Gestore di un comando. Il contesto è quello passato a CommandRouter::on(). */
+typedef void (*CommandHandler)(const ParsedCommand& command, void* context);
+
+/**
+ * @class CommandRouter
+ * @brief Riconosce i comandi ricevuti e li consegna al gestore registrato.
+ * @details Un comando con il campo "AT:<tempo server>" può essere eseguito più
+ * tardi, allo stesso istante su più dispositivi: il testo viene copiato in uno
+ * slot e consegnato da runDue() quando l'orologio sincronizzato raggiunge AT.
+ */
+class CommandRouter {
+public:
+    CommandRouter();
+
+    /** @brief Registra il gestore di un comando (sostituisce l'eventuale precedente). */
+    void on(CommandId id, CommandHandler handler, void* context);
+    /**
+     * @brief Analizza il testo senza allocare memoria.
+     * @return false se manca il token "CMD:" o il comando è sconosciuto.
+     */
+    static bool parse(const char* text, ParsedCommand& out);
+    /**
+     * @brief Analizza il testo e chiama il gestore del comando.
+     * @return true se il comando è stato riconosciuto e gestito.
+     */
+    bool dispatch(const char* text) const;
+    /**
+     * @brief Come dispatch(), ma rispetta il campo AT: se indica un istante futuro.
+     * @details Se l'istante è già passato o l'orologio non è ancora sincronizzato
+     * il comando viene eseguito subito.
+     * @param localNow millis() corrente.
+     * @return false se il comando non è riconosciuto o non ci sono slot liberi.
+     */
+    bool dispatch(const char* text, const ClockSync& clock, uint32_t localNow);
+    /**
+     * @brief Ritorna false se dispatch() dovrebbe scartare un comando riconosciuto.
+     * @details Succede solo a un comando con AT: futuro quando gli slot sono tutti
+     * occupati o il testo non entra in uno slot. Va chiesto prima di confermare
+     * il comando al bridge: senza conferma il bridge lo ritrasmette e, se gli
+     * slot restano occupati, lo segnala al pannello come fallito.
+     */
+    bool canAccept(const char* text, const ClockSync& clock, uint32_t localNow) const;
+    /**
+     * @brief Esegue i comandi programmati il cui istante è arrivato.
+     * @details Da chiamare ad ogni ciclo del loop(): la precisione dell'avvio
+     * programmato è quella del ciclo.
+     */
+    void runDue(const ClockSync& clock, uint32_t localNow);
+
+    static CommandId lookupCommand(const TextView& name);
+    static FieldId lookupField(const TextView& name);
+
+private:
+    /**
+     * @brief Istante di esecuzione del comando, se è nel futuro.
+     * @return false se il comando va eseguito subito.
+     */
+    static bool isScheduled(const ParsedCommand& command, const ClockSync& clock, uint32_t localNow, uint32_t& at);
+    /** @brief Indice di uno slot libero per il testo, -1 se manca. */
+    int findFreeSlot(const char* text) const;
+
+    struct Route {
+        CommandHandler handler;
+        void* context;
+    };
+    Route _routes[CMD_COUNT];
+
+    struct ScheduledCommand {
+        bool pending;
+        uint32_t at;    // Tempo server di esecuzione
+        char text[COMMAND_SCHEDULE_MAX_LEN];
+    };
+    ScheduledCommand _scheduled[COMMAND_SCHEDULE_SLOTS];
+};
+
+#endif // COMMAND_ROUTER_H
@@ -0,0 +1,94 @@
+// src/Network/DatagramBatcher.cpp
+
+/**
+ * @file DatagramBatcher.cpp
+ * @brief Implementazione della classe DatagramBatcher.
+ */
+
+#include "Network/DatagramBatcher.h"
+#include "Network/WireCodec.h"
+#include <stdio.h>
+#include <string.h>
+
+DatagramBatcher::DatagramBatcher() :
+    _length(0),
+    _count(0),
+    _binary(false),
+    _nextSeq(0),
+    _wireHandle(0),
+    _deviceId("")
+{}
+
+void DatagramBatcher::reset(uint16_t wireHandle, const char* deviceId) {
+    _length = 0;
+    _count = 0;
+    _binary = false;
+    _wireHandle = wireHandle;
+    _deviceId = deviceId;
+}
+
+bool DatagramBatcher::append(const char* text, size_t length, uint32_t seq) {
+    if (_wireHandle != 0) {
+        uint8_t message[256];
+        size_t encoded = WireCodec::encodeMessage(text, length, message, sizeof(message));
+        if (encoded > 0) {
+            return appendBinary(message, encoded, seq);
+        }
+        // Evento non codificabile: va in un datagramma testuale a parte.
+    }
+    return appendText(text, length, seq);
+}
+
+bool DatagramBatcher::appendBinary(const uint8_t* message, size_t length, uint32_t seq) {
+    if (_count > 0 && (!_binary || seq != _nextSeq)) {
+        return false; // Formato diverso o sequenza non consecutiva: serve un nuovo frame
+    }
+    if (_count == 0) {
+        _length = WireCodec::writeHeader(_wireHandle, seq, _buffer, sizeof(_buffer));
+        _binary = true;
+    }
+    if (_length + length > sizeof(_buffer)) {
+        return false;
+    }
+    memcpy(_buffer + _length, message, length);
+    _length += length;
+    _nextSeq = seq + 1;
+    _count++;
+    return true;
+}
+
+bool DatagramBatcher::appendText(const char* text, size_t length, uint32_t seq) {
+    if (_count > 0 && _binary) {
+        return false;
+    }
+
+    // Riga: <evento>[;]seq:N;[wire:V;]id:<MAC>;  (preceduta da '\n' se non è la prima)
+    char suffix[96];
+    int suffixLength = snprintf(suffix, sizeof(suffix), "%sseq:%lu;",
+                                (length > 0 && text[length - 1] != ';') ? ";" : "", (unsigned long)seq);
+    if (_wireHandle == 0 && _count == 0) {
+        // Finché il bridge non assegna un handle, si annuncia il supporto binario.
+        suffixLength += snprintf(suffix + suffixLength, sizeof(suffix) - suffixLength, "wire:%d;", WIRE_PROTOCOL_VERSION);
+    }
+    suffixLength += snprintf(suffix + suffixLength, sizeof(suffix) - suffixLength, "id:%s;", _deviceId);
+
+    size_t separator = (_count > 0) ? 1 : 0;
+    size_t needed = separator + length + suffixLength;
+    if (_length + needed > sizeof(_buffer)) {
+        if (_count > 0) {
+            return false;
+        }
+        length = sizeof(_buffer) - suffixLength; // Evento singolo troppo lungo: viene troncato
+    }
+
+    if (separator) {
+        _buffer[_length++] = '\n';
+    }
+    memcpy(_buffer + _length, text, length);
+    _length += length;
+    memcpy(_buffer + _length, suffix, suffixLength);
+    _length += suffixLength;
+    _binary = false;
+    _count++;
+    return true;
+}
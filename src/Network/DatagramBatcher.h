@@ -0,0 +1,62 @@
+// src/Network/DatagramBatcher.h
+
+/**
+ * @file DatagramBatcher.h
+ * @brief Dichiarazione della classe DatagramBatcher, che impacchetta più eventi in un datagramma.
+ * @details Gli eventi prodotti nello stesso tick del loop vengono trasmessi insieme,
+ * fino alla dimensione massima del datagramma. Ogni evento porta il proprio numero
+ * di sequenza, così il bridge può rilevare perdite e riordinamenti.
+ *
+ * Formato testuale: un evento per riga, separati da '\\n':
+ * @code
+ *   event:...;seq:N;id:<MAC>;
+ * @endcode
+ * Formato binario: un frame WireCodec con i messaggi in sequenza consecutiva.
+ */
+
+#ifndef DATAGRAM_BATCHER_H
+#define DATAGRAM_BATCHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Dimensione massima del payload di un datagramma (sotto l'MTU WiFi/Ethernet). */
+#define NET_MAX_DATAGRAM 1400
+
+class DatagramBatcher {
+public:
+    DatagramBatcher();
+
+    /**
+     * @brief Svuota il datagramma e fissa i parametri per i prossimi eventi.
+     * @param wireHandle Handle del protocollo binario, 0 per il formato testuale.
+     * @param deviceId ID testuale del dispositivo (usato solo nel formato testuale).
+     */
+    void reset(uint16_t wireHandle, const char* deviceId);
+    /**
+     * @brief Aggiunge un evento al datagramma corrente.
+     * @return false se l'evento non può stare in questo datagramma: va inviato il
+     * datagramma corrente e ripetuta la chiamata dopo reset(). Su un datagramma
+     * vuoto la chiamata riesce sempre.
+     */
+    bool append(const char* text, size_t length, uint32_t seq);
+
+    bool isEmpty() const { return _count == 0; }
+    const uint8_t* data() const { return _buffer; }
+    size_t length() const { return _length; }
+    uint16_t count() const { return _count; }
+
+private:
+    bool appendBinary(const uint8_t* message, size_t length, uint32_t seq);
+    bool appendText(const char* text, size_t length, uint32_t seq);
+
+    uint8_t _buffer[NET_MAX_DATAGRAM];
+    size_t _length;
+    uint16_t _count;
+    bool _binary;           // Formato del datagramma corrente (deciso dal primo evento)
+    uint32_t _nextSeq;      // Sequenza attesa per il prossimo messaggio binario
+    uint16_t _wireHandle;
+    const char* _deviceId;
+};
+
+#endif // DATAGRAM_BATCHER_H
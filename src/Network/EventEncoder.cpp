@@ -0,0 +1,105 @@
+// src/Network/EventEncoder.cpp
+
+/**
+ * @file EventEncoder.cpp
+ * @brief Implementazione della classe EventEncoder.
+ */
+
+#include "Network/EventEncoder.h"
+#include <stdio.h>
+
+/** @brief Nome della modalità nel campo "mode:" dei messaggi. */
+static const char* modeName(GameEventMode mode) {
+    switch (mode) {
+        case GameEventMode::MAIN_MENU:      return "main_menu";
+        case GameEventMode::TEST_HARDWARE:  return "testhw";
+        case GameEventMode::SEARCH_DESTROY: return "sd";
+        case GameEventMode::DOMINATION:     return "domination";
+        case GameEventMode::TERMINAL:       return "terminal";
+        default:                            return "none";
+    }
+}
+
+size_t EventEncoder::encode(const GameEvent& event, char* out, size_t capacity) {
+    int length = 0;
+    switch (event.id) {
+        case GameEventId::MODE_ENTER:
+            length = snprintf(out, capacity, "event:mode_enter;mode:%s;", modeName(event.mode));
+            break;
+        case GameEventId::MODE_EXIT:
+            length = snprintf(out, capacity, "event:mode_exit;mode:%s;", modeName(event.mode));
+            break;
+        case GameEventId::REMOTE_START:
+            length = snprintf(out, capacity, "event:remote_start;mode:%s;", modeName(event.mode));
+            break;
+        case GameEventId::GAME_START:
+            if (event.mode == GameEventMode::DOMINATION) {
+                length = snprintf(out, capacity, "event:game_start;mode:domination;duration:%ld", (long)event.value);
+            } else {
+                length = snprintf(out, capacity, "event:game_start;");
+            }
+            break;
+        case GameEventId::GAME_END:
+            if (event.mode == GameEventMode::SEARCH_DESTROY) {
+                length = snprintf(out, capacity, "event:game_end;winner:%s;",
+                                  event.team == SD_TEAM_TERRORISTS ? "terrorists" : "counter-terrorists");
+            } else {
+                length = snprintf(out, capacity, "event:game_end;winner:%d", event.team);
+            }
+            break;
+        case GameEventId::ROUND_RESET:      length = snprintf(out, capacity, "event:round_reset;"); break;
+        case GameEventId::COUNTDOWN_START:
+            length = snprintf(out, capacity, "event:countdown_start;duration:%ld;", (long)event.value);
+            break;
+        case GameEventId::ARM_START:        length = snprintf(out, capacity, "event:arm_start;"); break;
+        case GameEventId::ARM_PROGRESS:
+            length = snprintf(out, capacity, "event:arm_progress;progress:%ld;", (long)event.value);
+            break;
+        case GameEventId::ARM_CANCEL:       length = snprintf(out, capacity, "event:arm_cancel;"); break;
+        case GameEventId::ARM_PIN_WRONG:    length = snprintf(out, capacity, "event:arm_pin_wrong;"); break;
+        case GameEventId::BOMB_ARMED:       length = snprintf(out, capacity, "event:bomb_armed;"); break;
+        case GameEventId::DEFUSE_START:     length = snprintf(out, capacity, "event:defuse_start;"); break;
+        case GameEventId::DEFUSE_PROGRESS:
+            length = snprintf(out, capacity, "event:defuse_progress;progress:%ld;", (long)event.value);
+            break;
+        case GameEventId::DEFUSE_CANCEL:    length = snprintf(out, capacity, "event:defuse_cancel;"); break;
+        case GameEventId::DEFUSE_PIN_WRONG: length = snprintf(out, capacity, "event:defuse_pin_wrong;"); break;
+        case GameEventId::CAPTURE_START:
+            length = snprintf(out, capacity, "event:capture_start;team:%d;", event.team);
+            break;
+        case GameEventId::CAPTURE_PROGRESS:
+            length = snprintf(out, capacity, "event:capture_progress;team:%d;progress:%ld;", event.team, (long)event.value);
+            break;
+        case GameEventId::CAPTURE_CANCEL:
+            length = snprintf(out, capacity, "event:capture_cancel;team:%d;", event.team);
+            break;
+        case GameEventId::ZONE_CAPTURED:
+            length = snprintf(out, capacity, "event:zone_captured;team:%d;", event.team);
+            break;
+        case GameEventId::SCORE_UPDATE:
+            length = snprintf(out, capacity, "event:score_update;team1_score:%lu;team2_score:%lu;",
+                              (unsigned long)event.value, (unsigned long)event.value2);
+            break;
+        default:
+            return 0;
+    }
+    if (length <= 0 || (size_t)length >= capacity) {
+        return 0;
+    }
+    return (size_t)length;
+}
+
+bool EventEncoder::isTelemetry(GameEventId id, TelemetryKey* key) {
+    switch (id) {
+        case GameEventId::ARM_PROGRESS:
+        case GameEventId::DEFUSE_PROGRESS:
+        case GameEventId::CAPTURE_PROGRESS:
+            *key = TELEMETRY_PROGRESS;
+            return true;
+        case GameEventId::SCORE_UPDATE:
+            *key = TELEMETRY_SCORE;
+            return true;
+        default:
+            return false;
+    }
+}
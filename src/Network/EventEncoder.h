@@ -0,0 +1,34 @@
+// src/Network/EventEncoder.h
+
+/**
+ * @file EventEncoder.h
+ * @brief Traduzione degli eventi del bus di gioco (EventBus) nei messaggi testuali del pannello.
+ * @details È l'unico punto che conosce il formato "event:nome;chiave:valore;"
+ * degli eventi di gioco: le modalità pubblicano solo GameEvent. I messaggi
+ * prodotti sono identici a quelli che le modalità formattavano a mano, così
+ * pannello, bridge e WireCodec non cambiano.
+ * Non dipende da Arduino.
+ */
+
+#ifndef EVENT_ENCODER_H
+#define EVENT_ENCODER_H
+
+#include <stddef.h>
+#include "EventBus.h"
+#include "Network/TelemetryPublisher.h"
+
+class EventEncoder {
+public:
+    /**
+     * @brief Scrive il messaggio dell'evento in out.
+     * @return Lunghezza del messaggio, 0 se l'evento non ha un messaggio o lo spazio non basta.
+     */
+    static size_t encode(const GameEvent& event, char* out, size_t capacity);
+    /**
+     * @brief Ritorna true se l'evento è un valore continuo da accorpare (avanzamento, punteggio).
+     * @param key Se l'evento è telemetria, riceve la chiave del TelemetryPublisher.
+     */
+    static bool isTelemetry(GameEventId id, TelemetryKey* key);
+};
+
+#endif // EVENT_ENCODER_H
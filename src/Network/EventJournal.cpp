@@ -0,0 +1,165 @@
+// src/Network/EventJournal.cpp
+
+/**
+ * @file EventJournal.cpp
+ * @brief Implementazione della classe EventJournal.
+ */
+
+#include "Network/EventJournal.h"
+#include <stddef.h>
+
+static const char* JOURNAL_PATH = "/events.jnl";
+// Cambia se cambia il formato dei record: un diario di un'altra versione viene ricreato.
+static const uint32_t JOURNAL_MAGIC = 0x4A4E4C31;   // "JNL1"
+
+EventJournal::EventJournal() :
+    _ready(false),
+    _dirty(false),
+    _boot(0),
+    _head(0),
+    _count(0),
+    _nextSeq(0),
+    _overwritten(0)
+{}
+
+bool EventJournal::begin() {
+    if (!SPIFFS.begin(true)) {
+        Serial.println("ERRORE: SPIFFS non disponibile, diario eventi disattivato.");
+        return false;
+    }
+
+    Header header;
+    bool valid = false;
+    if (SPIFFS.exists(JOURNAL_PATH)) {
+        _file = SPIFFS.open(JOURNAL_PATH, "r+");
+        valid = _file && _file.size() == recordOffset(JOURNAL_CAPACITY) &&
+                _file.read((uint8_t*)&header, sizeof(header)) == sizeof(header) &&
+                header.magic == JOURNAL_MAGIC && header.head < JOURNAL_CAPACITY &&
+                header.count <= JOURNAL_CAPACITY;
+    }
+    if (!valid) {
+        if (_file) {
+            _file.close();
+        }
+        return create();
+    }
+
+    _boot = header.boot + 1;
+    _head = header.head;
+    _count = header.count;
+    _nextSeq = header.nextSeq;
+    _ready = true;
+    writeHeader();
+    Serial.printf("Diario eventi: %u eventi in attesa di invio.\n", _count);
+    return true;
+}
+
+bool EventJournal::create() {
+    // Il file si crea subito della dimensione finale: le scritture successive non lo allungano.
+    _file = SPIFFS.open(JOURNAL_PATH, "w+");
+    if (!_file) {
+        Serial.println("ERRORE: impossibile creare il diario eventi.");
+        return false;
+    }
+    JournalRecord empty;
+    memset(&empty, 0, sizeof(empty));
+    Header header;
+    memset(&header, 0, sizeof(header));
+    _file.write((const uint8_t*)&header, sizeof(header));
+    for (int i = 0; i < JOURNAL_CAPACITY; i++) {
+        _file.write((const uint8_t*)&empty, sizeof(empty));
+    }
+
+    _boot = 1;
+    _head = 0;
+    _count = 0;
+    _nextSeq = 0;
+    _ready = true;
+    writeHeader();
+    Serial.println("Diario eventi creato.");
+    return true;
+}
+
+void EventJournal::writeHeader() {
+    Header header;
+    header.magic = JOURNAL_MAGIC;
+    header.boot = _boot;
+    header.head = _head;
+    header.count = _count;
+    header.reserved = 0;
+    header.nextSeq = _nextSeq;
+    _file.seek(0, SeekSet);
+    _file.write((const uint8_t*)&header, sizeof(header));
+    _file.flush();
+    _dirty = false;
+}
+
+void EventJournal::sync() {
+    if (_ready && _dirty) {
+        writeHeader();
+    }
+}
+
+bool EventJournal::append(uint32_t seq, uint32_t time, bool serverTime, const char* data, uint16_t length) {
+    if (!_ready) {
+        return false;
+    }
+    if (_count == JOURNAL_CAPACITY) {
+        // Diario pieno: si perde l'evento più vecchio, non quelli recenti.
+        _head = (_head + 1) % JOURNAL_CAPACITY;
+        _count--;
+        _overwritten++;
+        _dirty = true;
+    }
+
+    JournalRecord record;
+    record.seq = seq;
+    record.time = time;
+    record.boot = _boot;
+    record.serverTime = serverTime ? 1 : 0;
+    record.reserved = 0;
+    record.length = length < JOURNAL_RECORD_DATA_LEN ? length : JOURNAL_RECORD_DATA_LEN - 1;
+    memcpy(record.data, data, record.length);
+    record.data[record.length] = '\0';
+
+    // Solo i byte usati: il resto dello slot non viene letto.
+    uint16_t slot = (_head + _count) % JOURNAL_CAPACITY;
+    size_t used = offsetof(JournalRecord, data) + record.length + 1;
+    _file.seek(recordOffset(slot), SeekSet);
+    if (_file.write((const uint8_t*)&record, used) != used) {
+        return false;
+    }
+    _count++;
+    _nextSeq = seq + 1;
+    _dirty = true;
+    return true;
+}
+
+bool EventJournal::peek(uint16_t index, JournalRecord& record) {
+    if (!_ready || index >= _count) {
+        return false;
+    }
+    uint16_t slot = (_head + index) % JOURNAL_CAPACITY;
+    _file.seek(recordOffset(slot), SeekSet);
+    size_t header = offsetof(JournalRecord, data);
+    if (_file.read((uint8_t*)&record, header) != header || record.length >= JOURNAL_RECORD_DATA_LEN) {
+        return false;
+    }
+    if (_file.read((uint8_t*)record.data, record.length + 1) != (size_t)record.length + 1) {
+        return false;
+    }
+    record.data[record.length] = '\0';
+    return true;
+}
+
+void EventJournal::discard(uint16_t count) {
+    if (count > _count) {
+        count = _count;
+    }
+    if (count == 0) {
+        return;
+    }
+    _head = (_head + count) % JOURNAL_CAPACITY;
+    _count -= count;
+    _dirty = true;
+}
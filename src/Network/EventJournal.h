@@ -0,0 +1,104 @@
+// src/Network/EventJournal.h
+
+/**
+ * @file EventJournal.h
+ * @brief Dichiarazione della classe EventJournal, il diario persistente degli eventi non ancora inviati.
+ * @details Quando il collegamento è assente gli eventi passano dalla coda in RAM
+ * a questo diario nella partizione SPIFFS (vedi default_ota.csv), così la storia
+ * della partita sopravvive a disconnessioni lunghe e anche a un riavvio.
+ * Il diario è un unico file di dimensione fissa: un'intestazione e un anello di
+ * JOURNAL_CAPACITY record. Se si riempie, il record più vecchio viene sovrascritto.
+ * Ogni record conserva la sequenza e l'istante originale dell'evento: in tempo
+ * server se l'orologio era già sincronizzato, altrimenti come millis() dell'avvio
+ * di origine, da convertire al reinvio se nel frattempo l'orologio si sincronizza.
+ * append() e discard() scrivono solo il record; l'intestazione va in flash con
+ * sync(), una volta per gruppo di operazioni. Le scritture in flash bloccano per
+ * qualche millisecondo: va usato solo dal task di rete. Durante la scrittura la
+ * cache della flash è spenta su entrambi i core, quindi si ferma anche il task di
+ * gioco (tranne il codice in IRAM): chi scrive raggruppa le operazioni.
+ */
+
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+#include <Arduino.h>
+#include <SPIFFS.h>
+
+/** @brief Numero di record del diario (~120 KB nella partizione SPIFFS). */
+#define JOURNAL_CAPACITY 512
+/** @brief Lunghezza massima (terminatore incluso) del testo di un record. Uguale a OUTBOUND_EVENT_MAX_LEN. */
+#define JOURNAL_RECORD_DATA_LEN 224
+
+/**
+ * @struct JournalRecord
+ * @brief Evento conservato nel diario, scritto in flash così com'è.
+ */
+struct JournalRecord {
+    uint32_t seq;       // Numero di sequenza originale
+    uint32_t time;      // Tempo server se serverTime, altrimenti millis() all'accodamento
+    uint16_t boot;      // Avvio in cui l'evento è stato generato
+    uint8_t serverTime;
+    uint8_t reserved;
+    uint16_t length;
+    char data[JOURNAL_RECORD_DATA_LEN];
+};
+
+class EventJournal {
+public:
+    EventJournal();
+
+    /**
+     * @brief Monta SPIFFS (formattandola al primo uso) e apre o crea il diario.
+     * @details Conta anche un nuovo avvio (vedi getBoot()). Da chiamare una sola volta nel setup().
+     * @return false se la partizione non è utilizzabile: il diario resta disattivato.
+     */
+    bool begin();
+
+    bool isReady() const { return _ready; }
+    bool isEmpty() const { return _count == 0; }
+    uint16_t size() const { return _count; }
+    /** @brief Identificativo dell'avvio corrente, da confrontare con JournalRecord::boot. */
+    uint16_t getBoot() const { return _boot; }
+    /** @brief Sequenza successiva all'ultimo record (0 se il diario è vuoto). */
+    uint32_t getNextSeq() const { return _nextSeq; }
+    /** @brief Record sovrascritti perché il diario era pieno. */
+    uint32_t getOverwrittenCount() const { return _overwritten; }
+
+    /**
+     * @brief Aggiunge un evento in coda; se il diario è pieno sostituisce il più vecchio.
+     * @param time Istante dell'evento: tempo server se serverTime, altrimenti millis().
+     */
+    bool append(uint32_t seq, uint32_t time, bool serverTime, const char* data, uint16_t length);
+    /** @brief Legge l'i-esimo record dal più vecchio, senza rimuoverlo. */
+    bool peek(uint16_t index, JournalRecord& record);
+    /** @brief Rimuove i count record più vecchi (già inviati). */
+    void discard(uint16_t count);
+    /** @brief Scrive l'intestazione se append() o discard() l'hanno cambiata. */
+    void sync();
+
+private:
+    /** @brief Intestazione del file, all'offset 0. */
+    struct Header {
+        uint32_t magic;
+        uint16_t boot;
+        uint16_t head;      // Indice del record più vecchio
+        uint16_t count;
+        uint16_t reserved;
+        uint32_t nextSeq;
+    };
+
+    bool create();
+    void writeHeader();
+    size_t recordOffset(uint16_t slot) const { return sizeof(Header) + (size_t)slot * sizeof(JournalRecord); }
+
+    File _file;
+    bool _ready;
+    bool _dirty;        // Intestazione in RAM più recente di quella in flash
+    uint16_t _boot;
+    uint16_t _head;
+    uint16_t _count;
+    uint32_t _nextSeq;
+    uint32_t _overwritten;
+};
+
+#endif // EVENT_JOURNAL_H
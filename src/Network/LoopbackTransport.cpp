@@ -0,0 +1,96 @@
+// src/Network/LoopbackTransport.cpp
+
+/**
+ * @file LoopbackTransport.cpp
+ * @brief Implementazione della classe LoopbackTransport.
+ */
+
+#include "Network/LoopbackTransport.h"
+#include <string.h>
+
+// Maschera /24 nel formato di (uint32_t)IPAddress (primo ottetto nel byte meno significativo).
+static const uint32_t LOOPBACK_SUBNET_MASK = 0x00FFFFFFu;
+
+LoopbackTransport::LoopbackTransport(uint32_t address, const char* deviceId) :
+    _address(address),
+    _deviceId(deviceId),
+    _port(0),
+    _peer(nullptr),
+    _linkUp(true),
+    _dropped(0),
+    _head(0),
+    _count(0)
+{}
+
+void LoopbackTransport::connect(LoopbackTransport& a, LoopbackTransport& b) {
+    a._peer = &b;
+    b._peer = &a;
+}
+
+uint32_t LoopbackTransport::makeAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) {
+    return (uint32_t)a | ((uint32_t)b << 8) | ((uint32_t)c << 16) | ((uint32_t)d << 24);
+}
+
+void LoopbackTransport::begin(uint16_t port) {
+    _port = port;
+}
+
+uint32_t LoopbackTransport::localAddress() const {
+    return isLinkUp() ? _address : 0;
+}
+
+uint32_t LoopbackTransport::broadcastAddress() const {
+    return isLinkUp() ? (_address | ~LOOPBACK_SUBNET_MASK) : 0;
+}
+
+bool LoopbackTransport::resolve(const char* host, uint32_t& address) {
+    (void)host;
+    if (!isLinkUp() || _peer == nullptr) {
+        return false;
+    }
+    address = _peer->_address;
+    return true;
+}
+
+bool LoopbackTransport::send(uint32_t address, uint16_t port, const uint8_t* data, size_t length) {
+    if (!isLinkUp() || _peer == nullptr || length > LOOPBACK_MAX_DATAGRAM) {
+        return false;
+    }
+    // Come in UDP, un datagramma senza destinatario in ascolto si perde senza errori.
+    bool toPeer = address == _peer->_address || address == broadcastAddress();
+    if (toPeer && port == _peer->_port && _peer->isLinkUp()) {
+        _peer->deliver(_address, data, length);
+    }
+    return true;
+}
+
+void LoopbackTransport::deliver(uint32_t from, const uint8_t* data, size_t length) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_count == LOOPBACK_QUEUE_SIZE) {
+        _dropped++;
+        return;
+    }
+    Datagram& slot = _queue[(_head + _count) % LOOPBACK_QUEUE_SIZE];
+    slot.from = from;
+    slot.length = (uint16_t)length;
+    memcpy(slot.data, data, length);
+    _count++;
+}
+
+int LoopbackTransport::receive(uint8_t* buffer, size_t capacity, uint32_t& fromAddress, bool& truncated) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_count == 0) {
+        return -1;
+    }
+    Datagram& slot = _queue[_head];
+    _head = (_head + 1) % LOOPBACK_QUEUE_SIZE;
+    _count--;
+
+    fromAddress = slot.from;
+    truncated = slot.length > capacity;
+    if (truncated) {
+        return 0;
+    }
+    memcpy(buffer, slot.data, slot.length);
+    return slot.length;
+}
@@ -0,0 +1,81 @@
+// src/Network/LoopbackTransport.h
+
+/**
+ * @file LoopbackTransport.h
+ * @brief Dichiarazione della classe LoopbackTransport: Transport in memoria tra due endpoint.
+ * @details Due istanze collegate con connect() si scambiano i datagrammi attraverso
+ * una coda protetta da mutex, quindi possono stare su thread diversi (es. un
+ * dispositivo simulato e un bridge di prova in un programma sull'host).
+ * Ogni endpoint ha una coda di ricezione finita: se è piena il datagramma viene
+ * scartato e conteggiato, come farebbe il buffer di un socket UDP.
+ * Non dipende da Arduino.
+ */
+
+#ifndef LOOPBACK_TRANSPORT_H
+#define LOOPBACK_TRANSPORT_H
+
+#include <atomic>
+#include <mutex>
+#include "Network/Transport.h"
+
+/** @brief Dimensione massima di un datagramma trasportato. */
+#define LOOPBACK_MAX_DATAGRAM 1500
+/** @brief Datagrammi in attesa per endpoint. */
+#define LOOPBACK_QUEUE_SIZE 64
+
+class LoopbackTransport : public Transport {
+public:
+    /**
+     * @param address Indirizzo dell'endpoint (rete /24, vedi makeAddress()).
+     * @param deviceId Identificativo restituito da deviceId().
+     */
+    LoopbackTransport(uint32_t address, const char* deviceId);
+
+    /** @brief Collega due endpoint: ciò che uno invia, l'altro riceve. */
+    static void connect(LoopbackTransport& a, LoopbackTransport& b);
+    /** @brief Compone un indirizzo nello stesso formato di (uint32_t)IPAddress. */
+    static uint32_t makeAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d);
+
+    /** @brief Simula la caduta o il ritorno del collegamento. Thread-safe. */
+    void setLinkUp(bool up) { _linkUp.store(up); }
+    /** @brief Datagrammi scartati perché la coda di ricezione era piena. */
+    uint32_t getDroppedCount() const { return _dropped.load(); }
+
+    void begin(uint16_t port) override;
+    void poll() override {}
+    bool isLinkUp() const override { return _linkUp.load(); }
+
+    uint32_t localAddress() const override;
+    uint32_t broadcastAddress() const override;
+    const char* deviceId() const override { return _deviceId; }
+
+    /** @brief Ogni nome si risolve nell'indirizzo del peer (il "server"). */
+    bool resolve(const char* host, uint32_t& address) override;
+
+    bool send(uint32_t address, uint16_t port, const uint8_t* data, size_t length) override;
+    int receive(uint8_t* buffer, size_t capacity, uint32_t& fromAddress, bool& truncated) override;
+
+private:
+    /** @brief Accoda un datagramma in arrivo dal peer. */
+    void deliver(uint32_t from, const uint8_t* data, size_t length);
+
+    struct Datagram {
+        uint32_t from;
+        uint16_t length;
+        uint8_t data[LOOPBACK_MAX_DATAGRAM];
+    };
+
+    uint32_t _address;
+    const char* _deviceId;
+    uint16_t _port;
+    LoopbackTransport* _peer;
+    std::atomic<bool> _linkUp;
+    std::atomic<uint32_t> _dropped;
+
+    std::mutex _mutex;
+    Datagram _queue[LOOPBACK_QUEUE_SIZE];
+    size_t _head;
+    size_t _count;
+};
+
+#endif // LOOPBACK_TRANSPORT_H
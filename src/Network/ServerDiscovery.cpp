@@ -0,0 +1,67 @@
+// src/Network/ServerDiscovery.cpp
+
+/**
+ * @file ServerDiscovery.cpp
+ * @brief Implementazione della classe ServerDiscovery.
+ */
+
+#include "Network/ServerDiscovery.h"
+#include <stdio.h>
+#include <string.h>
+
+ServerDiscovery::ServerDiscovery() :
+    _reply(0),
+    _state(DISCOVERY_IDLE),
+    _probesSent(0),
+    _nextProbeTime(0),
+    _server(0)
+{}
+
+void ServerDiscovery::start(uint32_t now) {
+    _reply.store(0);
+    _state = DISCOVERY_PROBING;
+    _probesSent = 0;
+    _nextProbeTime = now;
+}
+
+bool ServerDiscovery::update(Transport& transport, uint16_t port, uint32_t now) {
+    if (_state != DISCOVERY_PROBING) {
+        return false;
+    }
+
+    uint32_t reply = _reply.load();
+    if (reply != 0) {
+        _server = reply;
+        _state = DISCOVERY_FOUND;
+        return true;
+    }
+
+    if ((int32_t)(now - _nextProbeTime) < 0) {
+        return false;
+    }
+    if (_probesSent >= DISCOVERY_PROBES) {
+        // L'ultima sonda ha avuto il suo intervallo per la risposta.
+        _state = DISCOVERY_NOT_FOUND;
+        return true;
+    }
+
+    char probe[48];
+    int length = snprintf(probe, sizeof(probe), "event:discover;id:%s;", transport.deviceId());
+    uint32_t broadcast = transport.broadcastAddress();
+    if (broadcast != 0 && length > 0 && length < (int)sizeof(probe)) {
+        transport.send(broadcast, port, (const uint8_t*)probe, length);
+    }
+    _probesSent++;
+    _nextProbeTime = now + DISCOVERY_PROBE_INTERVAL_MS;
+    return false;
+}
+
+bool ServerDiscovery::handleReply(const char* packet, uint32_t from) {
+    if (strncmp(packet, "CMD:SERVER_HERE;", 16) != 0) {
+        return false;
+    }
+    if (from != 0) {
+        _reply.store(from);
+    }
+    return true;
+}
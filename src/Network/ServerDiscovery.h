@@ -0,0 +1,67 @@
+// src/Network/ServerDiscovery.h
+
+/**
+ * @file ServerDiscovery.h
+ * @brief Dichiarazione della classe ServerDiscovery, che cerca il bridge sulla rete locale.
+ * @details Alla connessione il dispositivo invia in broadcast sulla sottorete
+ * @code
+ *   event:discover;id:<MAC>;
+ * @endcode
+ * e il bridge che lo riceve risponde direttamente con "CMD:SERVER_HERE;". Il
+ * mittente della risposta è l'indirizzo del server da usare. Se dopo alcune
+ * sonde nessuno risponde la ricerca termina e si ripiega sul nome DDNS.
+ * Non dipende da Arduino: il tempo viene passato dal chiamante in millisecondi.
+ */
+
+#ifndef SERVER_DISCOVERY_H
+#define SERVER_DISCOVERY_H
+
+#include <atomic>
+#include <stdint.h>
+#include "Network/Transport.h"
+
+/** @brief Numero di sonde inviate prima di dichiarare il server assente dalla LAN. */
+#define DISCOVERY_PROBES 3
+/** @brief Intervallo tra le sonde (ms); la ricerca dura al più DISCOVERY_PROBES intervalli. */
+#define DISCOVERY_PROBE_INTERVAL_MS 300
+
+class ServerDiscovery {
+public:
+    enum State : uint8_t {
+        DISCOVERY_IDLE,       // Nessuna ricerca avviata
+        DISCOVERY_PROBING,    // Sonde in corso
+        DISCOVERY_FOUND,      // Il bridge ha risposto: getServerAddress() è valido
+        DISCOVERY_NOT_FOUND   // Nessuna risposta: usare il DNS
+    };
+
+    ServerDiscovery();
+
+    /** @brief Avvia una nuova ricerca; la prima sonda parte al prossimo update(). */
+    void start(uint32_t now);
+    /**
+     * @brief Invia le sonde dovute e chiude la ricerca alla risposta o allo scadere.
+     * @return true quando la ricerca termina (stato FOUND o NOT_FOUND).
+     */
+    bool update(Transport& transport, uint16_t port, uint32_t now);
+    /**
+     * @brief Riconosce la risposta del bridge e ne annota il mittente.
+     * @details Può essere chiamata da un task diverso da quello di update().
+     * @return true se il pacchetto era una risposta di ricerca (già consumata).
+     */
+    bool handleReply(const char* packet, uint32_t from);
+
+    State getState() const { return _state; }
+    bool isProbing() const { return _state == DISCOVERY_PROBING; }
+    /** @brief Indirizzo del bridge trovato (valido nello stato FOUND). */
+    uint32_t getServerAddress() const { return _server; }
+
+private:
+    // Mittente dell'ultima risposta (0 = nessuna): scritto da handleReply(), letto da update().
+    std::atomic<uint32_t> _reply;
+    State _state;
+    uint8_t _probesSent;
+    uint32_t _nextProbeTime;
+    uint32_t _server;
+};
+
+#endif // SERVER_DISCOVERY_H
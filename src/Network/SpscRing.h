@@ -0,0 +1,89 @@
+// src/Network/SpscRing.h
+
+/**
+ * @file SpscRing.h
+ * @brief Coda circolare lock-free a produttore singolo / consumatore singolo.
+ * @details Usata per passare dati tra il loop di gioco e il task di rete senza
+ * mutex né allocazioni dinamiche. Un solo thread può scrivere (produttore) e un
+ * solo thread può leggere (consumatore); gli indici sono atomici e la visibilità
+ * degli slot è garantita dalla coppia release/acquire.
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "La capacita' deve essere una potenza di 2");
+
+public:
+    SpscRing() : _head(0), _tail(0) {}
+
+    /**
+     * @brief Ritorna lo slot libero in cui il produttore può scrivere, o nullptr se la coda è piena.
+     * @details Lo slot diventa visibile al consumatore solo dopo commitPush().
+     */
+    T* beginPush() {
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= N) {
+            return nullptr;
+        }
+        return &_slots[head & (N - 1)];
+    }
+    /** @brief Pubblica lo slot ottenuto con beginPush(). */
+    void commitPush() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+    /** @brief Copia un elemento in coda. Ritorna false se la coda è piena. */
+    bool push(const T& item) {
+        T* slot = beginPush();
+        if (slot == nullptr) {
+            return false;
+        }
+        *slot = item;
+        commitPush();
+        return true;
+    }
+
+    /** @brief Ritorna il primo elemento da consumare, o nullptr se la coda è vuota. */
+    T* front() {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        return &_slots[tail & (N - 1)];
+    }
+    /** @brief Ritorna l'elemento in posizione index dal primo (0 = front()), o nullptr se non c'è. */
+    T* peek(size_t index) {
+        uint32_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) - tail <= index) {
+            return nullptr;
+        }
+        return &_slots[(tail + index) & (N - 1)];
+    }
+    /** @brief Libera l'elemento ottenuto con front(). */
+    void pop() {
+        pop(1);
+    }
+    /** @brief Libera i primi count elementi, letti con front() o peek(). */
+    void pop(size_t count) {
+        _tail.store(_tail.load(std::memory_order_relaxed) + (uint32_t)count, std::memory_order_release);
+    }
+
+    /** @brief Numero di elementi in coda (valore indicativo se letto dall'altro thread). */
+    size_t size() const {
+        return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+    }
+    static constexpr size_t capacity() { return N; }
+
+private:
+    std::atomic<uint32_t> _head; // Scritto solo dal produttore
+    std::atomic<uint32_t> _tail; // Scritto solo dal consumatore
+    T _slots[N];
+};
+
+#endif // SPSC_RING_H
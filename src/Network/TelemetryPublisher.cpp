@@ -0,0 +1,42 @@
+// src/Network/TelemetryPublisher.cpp
+
+/**
+ * @file TelemetryPublisher.cpp
+ * @brief Implementazione della classe TelemetryPublisher.
+ */
+
+#include "Network/TelemetryPublisher.h"
+#include <string.h>
+
+TelemetryPublisher::TelemetryPublisher() :
+    _dirtyMask(0),
+    _intervalMs(1000 / TELEMETRY_DEFAULT_RATE_HZ),
+    _lastFlushTime(0)
+{
+    memset(_slots, 0, sizeof(_slots));
+}
+
+void TelemetryPublisher::setRate(uint16_t hz) {
+    _intervalMs = (hz == 0) ? 0 : 1000 / hz;
+}
+
+void TelemetryPublisher::publish(TelemetryKey key, const char* message) {
+    if (key >= TELEMETRY_KEY_COUNT) {
+        return;
+    }
+    strncpy(_slots[key], message, TELEMETRY_MAX_LEN - 1);
+    _slots[key][TELEMETRY_MAX_LEN - 1] = '\0';
+    _dirtyMask |= (1 << key);
+}
+
+bool TelemetryPublisher::isDue(unsigned long now) const {
+    return _dirtyMask != 0 && (now - _lastFlushTime) >= _intervalMs;
+}
+
+const char* TelemetryPublisher::take(TelemetryKey key) {
+    if (key >= TELEMETRY_KEY_COUNT || !(_dirtyMask & (1 << key))) {
+        return nullptr;
+    }
+    _dirtyMask &= ~(1 << key);
+    return _slots[key];
+}
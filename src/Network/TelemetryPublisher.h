@@ -0,0 +1,66 @@
+// src/Network/TelemetryPublisher.h
+
+/**
+ * @file TelemetryPublisher.h
+ * @brief Dichiarazione della classe TelemetryPublisher, che accorpa la telemetria di gioco.
+ * @details I valori continui (punteggio, tempo, avanzamento) cambiano ad ogni ciclo
+ * del loop ma al pannello interessa solo l'ultimo. Il publisher conserva l'ultimo
+ * messaggio per ogni chiave e lo rilascia al massimo una volta per periodo.
+ */
+
+#ifndef TELEMETRY_PUBLISHER_H
+#define TELEMETRY_PUBLISHER_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Frequenza di invio predefinita della telemetria (Hz). */
+#define TELEMETRY_DEFAULT_RATE_HZ 5
+/** @brief Lunghezza massima (terminatore incluso) di un messaggio di telemetria. */
+#define TELEMETRY_MAX_LEN 96
+
+/**
+ * @enum TelemetryKey
+ * @brief Le grandezze continue soggette ad accorpamento. Ogni chiave ha un solo slot.
+ */
+enum TelemetryKey {
+    TELEMETRY_SCORE,     // Tempi di possesso (Dominio)
+    TELEMETRY_PROGRESS,  // Avanzamento di conquista / innesco / disinnesco
+    TELEMETRY_KEY_COUNT
+};
+
+/**
+ * @class TelemetryPublisher
+ * @brief Conserva l'ultimo valore per chiave e ne limita la frequenza di invio.
+ * @details Non dipende da Arduino: il tempo viene passato dal chiamante in millisecondi.
+ */
+class TelemetryPublisher {
+public:
+    TelemetryPublisher();
+
+    /** @brief Imposta la frequenza massima di invio (Hz). 0 disabilita l'accorpamento. */
+    void setRate(uint16_t hz);
+    /** @brief Sovrascrive il valore della chiave; verrà inviato al prossimo flush. */
+    void publish(TelemetryKey key, const char* message);
+    /** @brief Ritorna true se c'è almeno un valore in attesa e il periodo è trascorso. */
+    bool isDue(unsigned long now) const;
+    /** @brief Ritorna true se c'è almeno un valore in attesa, a prescindere dal periodo. */
+    bool hasPending() const { return _dirtyMask != 0; }
+    /**
+     * @brief Estrae il messaggio in attesa per la chiave, o nullptr se non c'è nulla da inviare.
+     * @details Il puntatore resta valido fino alla successiva publish() sulla stessa chiave.
+     */
+    const char* take(TelemetryKey key);
+    /** @brief Segna l'istante dell'ultimo flush, da cui parte il periodo successivo. */
+    void markFlushed(unsigned long now) { _lastFlushTime = now; }
+    /** @brief Scarta tutti i valori in attesa. */
+    void clear() { _dirtyMask = 0; }
+
+private:
+    char _slots[TELEMETRY_KEY_COUNT][TELEMETRY_MAX_LEN];
+    uint8_t _dirtyMask;
+    unsigned long _intervalMs;
+    unsigned long _lastFlushTime;
+};
+
+#endif // TELEMETRY_PUBLISHER_H
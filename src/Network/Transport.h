@@ -0,0 +1,67 @@
+// src/Network/Transport.h
+
+/**
+ * @file Transport.h
+ * @brief Interfaccia Transport: il canale a datagrammi usato da NetworkManager.
+ * @details Separa la logica di rete (code, batching, protocollo) dal mezzo fisico.
+ * L'implementazione sul dispositivo è UdpTransport (WiFi + UDP); LoopbackTransport
+ * collega due endpoint nello stesso processo e permette di provare e misurare i
+ * percorsi di rete sull'host, senza hardware.
+ *
+ * Gli indirizzi IPv4 sono uint32_t nello stesso formato di (uint32_t)IPAddress.
+ * Salvo diversa indicazione, dopo begin() i metodi vanno chiamati solo dal task
+ * di rete, che passa i pacchetti ricevuti al loop di gioco tramite una coda.
+ */
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+class Transport {
+public:
+    virtual ~Transport() {}
+
+    /** @brief Avvia il collegamento (in background) e l'ascolto sulla porta indicata. */
+    virtual void begin(uint16_t port) = 0;
+    /** @brief Fa avanzare la gestione del collegamento. Non bloccante. */
+    virtual void poll() = 0;
+    /** @brief true se il collegamento è attivo e si può trasmettere. */
+    virtual bool isLinkUp() const = 0;
+
+    /** @brief Indirizzo locale (0 se il collegamento non è attivo). */
+    virtual uint32_t localAddress() const = 0;
+    /** @brief Indirizzo di broadcast della rete locale (0 se non disponibile). */
+    virtual uint32_t broadcastAddress() const = 0;
+    /** @brief Identificativo testuale e stabile del dispositivo (es. MAC). */
+    virtual const char* deviceId() const = 0;
+
+    /**
+     * @brief Risolve un nome host. Può bloccare: solo dal task di rete.
+     * @return true se la risoluzione è riuscita.
+     */
+    virtual bool resolve(const char* host, uint32_t& address) = 0;
+    /** @brief Ultimo indirizzo risolto con successo e conservato tra i riavvii (0 se nessuno). */
+    virtual uint32_t lastResolvedAddress() const { return 0; }
+    /**
+     * @brief Conserva l'indirizzo del server trovato senza DNS (es. in LAN).
+     * @details Verrà restituito da lastResolvedAddress() dopo il riavvio.
+     */
+    virtual void saveServerAddress(uint32_t address) { (void)address; }
+
+    /**
+     * @brief Invia un datagramma.
+     * @return false se l'invio è fallito.
+     */
+    virtual bool send(uint32_t address, uint16_t port, const uint8_t* data, size_t length) = 0;
+    /**
+     * @brief Legge il prossimo datagramma ricevuto, se presente.
+     * @param truncated Impostato a true se il datagramma non stava nel buffer:
+     * in quel caso la parte eccedente è scartata e il contenuto non va usato.
+     * @return La lunghezza letta, oppure -1 se non ci sono datagrammi.
+     */
+    virtual int receive(uint8_t* buffer, size_t capacity, uint32_t& fromAddress, bool& truncated) = 0;
+};
+
+#endif // TRANSPORT_H
@@ -0,0 +1,79 @@
+// src/Network/UdpTransport.cpp
+
+/**
+ * @file UdpTransport.cpp
+ * @brief Implementazione della classe UdpTransport.
+ */
+
+#include "Network/UdpTransport.h"
+
+UdpTransport::UdpTransport(const WifiCredential* networks, int count) :
+    _wifi(networks, count, &_cache)
+{
+    _deviceId[0] = '\0';
+}
+
+void UdpTransport::begin(uint16_t port) {
+    // Al riavvio si parte dai parametri dell'ultima connessione riuscita.
+    _cache.loadParameters();
+    _wifi.begin();
+
+    strncpy(_deviceId, WiFi.macAddress().c_str(), sizeof(_deviceId) - 1);
+    _deviceId[sizeof(_deviceId) - 1] = '\0';
+
+    _udp.begin(port);
+}
+
+void UdpTransport::poll() {
+    _wifi.update();
+}
+
+bool UdpTransport::isLinkUp() const {
+    return _wifi.isConnected() && WiFi.status() == WL_CONNECTED;
+}
+
+uint32_t UdpTransport::localAddress() const {
+    return isLinkUp() ? (uint32_t)WiFi.localIP() : 0;
+}
+
+uint32_t UdpTransport::broadcastAddress() const {
+    if (!isLinkUp()) {
+        return 0;
+    }
+    return (uint32_t)WiFi.localIP() | ~(uint32_t)WiFi.subnetMask();
+}
+
+bool UdpTransport::resolve(const char* host, uint32_t& address) {
+    if (!isLinkUp()) {
+        return false;
+    }
+    IPAddress resolved;
+    if (!WiFi.hostByName(host, resolved) || (uint32_t)resolved == 0) {
+        return false;
+    }
+    address = resolved;
+    _cache.saveServer(resolved);
+    return true;
+}
+
+bool UdpTransport::send(uint32_t address, uint16_t port, const uint8_t* data, size_t length) {
+    if (!_udp.beginPacket(IPAddress(address), port)) {
+        return false;
+    }
+    _udp.write(data, length);
+    return _udp.endPacket();
+}
+
+int UdpTransport::receive(uint8_t* buffer, size_t capacity, uint32_t& fromAddress, bool& truncated) {
+    int packetSize = _udp.parsePacket();
+    if (packetSize <= 0) {
+        return -1;
+    }
+    fromAddress = _udp.remoteIP();
+    truncated = (size_t)packetSize > capacity;
+    if (truncated) {
+        _udp.flush();
+        return 0;
+    }
+    return _udp.read(buffer, capacity);
+}
@@ -0,0 +1,52 @@
+// src/Network/UdpTransport.h
+
+/**
+ * @file UdpTransport.h
+ * @brief Dichiarazione della classe UdpTransport: Transport su WiFi e UDP.
+ * @details Riunisce la macchina a stati della connessione (WifiConnector), la
+ * cache NVS per la riconnessione rapida (WifiCache) e il socket WiFiUDP.
+ */
+
+#ifndef UDP_TRANSPORT_H
+#define UDP_TRANSPORT_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WiFiUdp.h>
+#include "Network/Transport.h"
+#include "Network/WifiCache.h"
+#include "Network/WifiConnector.h"
+
+class UdpTransport : public Transport {
+public:
+    /**
+     * @param networks Reti WiFi conosciute, in ordine di preferenza.
+     * @param count Numero di reti.
+     */
+    UdpTransport(const WifiCredential* networks, int count);
+
+    void begin(uint16_t port) override;
+    void poll() override;
+    bool isLinkUp() const override;
+
+    uint32_t localAddress() const override;
+    uint32_t broadcastAddress() const override;
+    const char* deviceId() const override { return _deviceId; }
+
+    bool resolve(const char* host, uint32_t& address) override;
+    uint32_t lastResolvedAddress() const override { return (uint32_t)_cache.getServer(); }
+    void saveServerAddress(uint32_t address) override { _cache.saveServer(IPAddress(address)); }
+
+    bool send(uint32_t address, uint16_t port, const uint8_t* data, size_t length) override;
+    int receive(uint8_t* buffer, size_t capacity, uint32_t& fromAddress, bool& truncated) override;
+
+private:
+    WifiCache _cache;
+    WifiConnector _wifi;
+    // Oggetto per la gestione del protocollo UDP.
+    WiFiUDP _udp;
+    // MAC del dispositivo in formato testuale ("AA:BB:CC:DD:EE:FF").
+    char _deviceId[18];
+};
+
+#endif // UDP_TRANSPORT_H
@@ -0,0 +1,74 @@
+// src/Network/WifiCache.cpp
+
+/**
+ * @file WifiCache.cpp
+ * @brief Implementazione della classe WifiCache.
+ */
+
+#include "Network/WifiCache.h"
+
+WifiCache::WifiCache() :
+    _hasLink(false),
+    _channel(0),
+    _server(0)
+{
+    _ssid[0] = '\0';
+    memset(_bssid, 0, sizeof(_bssid));
+}
+
+bool WifiCache::loadParameters() {
+    preferences.begin("net-cache", true);
+    String ssid = preferences.getString("ssid", "");
+    size_t bssidLength = preferences.getBytes("bssid", _bssid, sizeof(_bssid));
+    _channel = preferences.getUChar("channel", 0);
+    _server = preferences.getUInt("server", 0);
+    preferences.end();
+
+    strncpy(_ssid, ssid.c_str(), sizeof(_ssid) - 1);
+    _ssid[sizeof(_ssid) - 1] = '\0';
+    _hasLink = _ssid[0] != '\0' && bssidLength == sizeof(_bssid) &&
+               _channel >= 1 && _channel <= 14;
+    Serial.printf("Cache rete %s.\n", _hasLink ? "caricata" : "assente");
+    return _hasLink;
+}
+
+void WifiCache::saveLink(const char* ssid, const uint8_t* bssid, uint8_t channel) {
+    if (_hasLink && strcmp(_ssid, ssid) == 0 && memcmp(_bssid, bssid, sizeof(_bssid)) == 0 &&
+        _channel == channel) {
+        return; // Niente di nuovo: si risparmia una scrittura in flash
+    }
+
+    strncpy(_ssid, ssid, sizeof(_ssid) - 1);
+    _ssid[sizeof(_ssid) - 1] = '\0';
+    memcpy(_bssid, bssid, sizeof(_bssid));
+    _channel = channel;
+    _hasLink = true;
+
+    preferences.begin("net-cache", false);
+    preferences.putString("ssid", _ssid);
+    preferences.putBytes("bssid", _bssid, sizeof(_bssid));
+    preferences.putUChar("channel", _channel);
+    preferences.end();
+    Serial.println("Cache rete salvata.");
+}
+
+void WifiCache::clearLink() {
+    if (!_hasLink) {
+        return;
+    }
+    _hasLink = false;
+    preferences.begin("net-cache", false);
+    preferences.putString("ssid", "");
+    preferences.end();
+    Serial.println("Cache rete invalidata.");
+}
+
+void WifiCache::saveServer(IPAddress server) {
+    if ((uint32_t)server == 0 || (uint32_t)server == _server) {
+        return;
+    }
+    _server = server;
+    preferences.begin("net-cache", false);
+    preferences.putUInt("server", _server);
+    preferences.end();
+}
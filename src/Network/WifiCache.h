@@ -0,0 +1,56 @@
+// src/Network/WifiCache.h
+
+/**
+ * @file WifiCache.h
+ * @brief Dichiarazione della classe WifiCache, che memorizza in NVS i parametri dell'ultima connessione riuscita.
+ * @details Con SSID, BSSID e canale il riavvio può collegarsi direttamente
+ * all'access point, senza scansione. L'indirizzo IP arriva sempre dal DHCP: un
+ * lease scaduto riusato come IP statico potrebbe essere già di un altro host.
+ * Viene memorizzato anche l'ultimo indirizzo del server, così il primo pacchetto
+ * parte senza attendere la risoluzione DNS. I dati stanno nel namespace "net-cache".
+ */
+
+#ifndef WIFI_CACHE_H
+#define WIFI_CACHE_H
+
+#include <Arduino.h>
+#include <IPAddress.h>
+#include <Preferences.h>
+
+class WifiCache {
+public:
+    WifiCache();
+
+    /**
+     * @brief Carica i parametri dalla memoria non volatile.
+     * @return true se esiste un collegamento memorizzato e valido.
+     */
+    bool loadParameters();
+    /**
+     * @brief Memorizza i parametri del collegamento attuale.
+     * @details Scrive in flash solo se qualcosa è cambiato rispetto ai dati caricati.
+     */
+    void saveLink(const char* ssid, const uint8_t* bssid, uint8_t channel);
+    /** @brief Dimentica il collegamento memorizzato (es. dopo un tentativo diretto fallito). */
+    void clearLink();
+    /** @brief Memorizza l'indirizzo del server, se diverso da quello salvato. */
+    void saveServer(IPAddress server);
+
+    bool hasLink() const { return _hasLink; }
+    const char* getSsid() const { return _ssid; }
+    const uint8_t* getBssid() const { return _bssid; }
+    uint8_t getChannel() const { return _channel; }
+    /** @brief Ultimo indirizzo del server (0.0.0.0 se mai risolto). */
+    IPAddress getServer() const { return IPAddress(_server); }
+
+private:
+    bool _hasLink;
+    char _ssid[33];
+    uint8_t _bssid[6];
+    uint8_t _channel;
+    uint32_t _server;
+
+    Preferences preferences;
+};
+
+#endif // WIFI_CACHE_H
@@ -0,0 +1,205 @@
+// src/Network/WifiConnector.cpp
+
+/**
+ * @file WifiConnector.cpp
+ * @brief Implementazione della classe WifiConnector.
+ */
+
+#include "Network/WifiConnector.h"
+
+// Tempo massimo per un singolo tentativo di connessione.
+const unsigned long WIFI_CONNECT_TIMEOUT_MS = 10000;
+// Tempo massimo per la connessione diretta con i parametri in cache.
+const unsigned long WIFI_FAST_CONNECT_TIMEOUT_MS = 3000;
+// Tempo massimo per una scansione (normalmente 2-4 secondi).
+const unsigned long WIFI_SCAN_TIMEOUT_MS = 15000;
+// Backoff tra un giro di tentativi fallito e il successivo: raddoppia fino al massimo.
+const unsigned long WIFI_BACKOFF_MIN_MS = 1000;
+const unsigned long WIFI_BACKOFF_MAX_MS = 30000;
+
+WifiConnector::WifiConnector(const WifiCredential* networks, int count, WifiCache* cache) :
+    _networks(networks),
+    _networkCount(count > WIFI_MAX_KNOWN_NETWORKS ? WIFI_MAX_KNOWN_NETWORKS : count),
+    _cache(cache),
+    _fastPath(false),
+    _state(WIFI_STATE_IDLE),
+    _stateStart(0),
+    _candidateCount(0),
+    _candidateIndex(0),
+    _lastNetwork(-1),
+    _backoffMs(WIFI_BACKOFF_MIN_MS)
+{}
+
+void WifiConnector::begin() {
+    WiFi.mode(WIFI_STA);
+    WiFi.disconnect(); // Assicura di partire da uno stato pulito
+    WiFi.setAutoReconnect(false); // La riconnessione la gestisce questa classe
+    if (!startFastConnect()) {
+        startScan();
+    }
+}
+
+bool WifiConnector::startFastConnect() {
+    if (!_cache->hasLink()) {
+        return false;
+    }
+    int network = -1;
+    for (int i = 0; i < _networkCount; i++) {
+        if (strcmp(_networks[i].ssid, _cache->getSsid()) == 0) {
+            network = i;
+            break;
+        }
+    }
+    if (network < 0) {
+        return false; // Rete tolta dalla lista delle conosciute
+    }
+
+    Serial.printf("WiFi: connessione diretta a %s (canale %d)...\n",
+                  _networks[network].ssid, _cache->getChannel());
+    // Solo l'access point viene dalla cache: l'indirizzo si chiede sempre al DHCP.
+    WiFi.begin(_networks[network].ssid, _networks[network].password, _cache->getChannel(), _cache->getBssid());
+
+    _candidates[0] = network;
+    _candidateCount = 1;
+    _candidateIndex = 0;
+    _fastPath = true;
+    setState(WIFI_STATE_CONNECTING);
+    return true;
+}
+
+void WifiConnector::saveLinkToCache() {
+    uint8_t* bssid = WiFi.BSSID();
+    if (bssid == nullptr) {
+        return;
+    }
+    _cache->saveLink(_networks[_lastNetwork].ssid, bssid, WiFi.channel());
+}
+
+const char* WifiConnector::getSsid() const {
+    if (_state == WIFI_STATE_CONNECTING && _candidateIndex < _candidateCount) {
+        return _networks[_candidates[_candidateIndex]].ssid;
+    }
+    if (_state == WIFI_STATE_CONNECTED && _lastNetwork >= 0) {
+        return _networks[_lastNetwork].ssid;
+    }
+    return "";
+}
+
+void WifiConnector::setState(WifiState state) {
+    _state = state;
+    _stateStart = millis();
+}
+
+void WifiConnector::startScan() {
+    Serial.println("WiFi: avvio scansione reti...");
+    WiFi.scanDelete();
+    WiFi.scanNetworks(true); // Asincrona: il risultato si legge con scanComplete()
+    setState(WIFI_STATE_SCANNING);
+}
+
+void WifiConnector::collectCandidates(int visibleCount) {
+    // Le reti conosciute restano nell'ordine di preferenza della lista.
+    _candidateCount = 0;
+    for (int i = 0; i < _networkCount; i++) {
+        for (int j = 0; j < visibleCount; j++) {
+            if (strcmp(_networks[i].ssid, WiFi.SSID(j).c_str()) == 0) {
+                _candidates[_candidateCount++] = i;
+                break;
+            }
+        }
+    }
+    _candidateIndex = 0;
+    WiFi.scanDelete();
+}
+
+void WifiConnector::connectToCandidate() {
+    const WifiCredential& network = _networks[_candidates[_candidateIndex]];
+    Serial.printf("WiFi: connessione a %s...\n", network.ssid);
+    WiFi.disconnect();
+    WiFi.begin(network.ssid, network.password);
+    setState(WIFI_STATE_CONNECTING);
+}
+
+void WifiConnector::nextCandidate() {
+    _candidateIndex++;
+    if (_candidateIndex < _candidateCount) {
+        connectToCandidate();
+    } else {
+        enterBackoff();
+    }
+}
+
+void WifiConnector::enterBackoff() {
+    Serial.printf("WiFi: nessuna rete disponibile, nuovo tentativo tra %lu ms.\n", _backoffMs);
+    WiFi.disconnect();
+    setState(WIFI_STATE_BACKOFF);
+}
+
+void WifiConnector::update() {
+    unsigned long elapsed = millis() - _stateStart;
+
+    switch (_state) {
+        case WIFI_STATE_IDLE:
+            break;
+
+        case WIFI_STATE_SCANNING: {
+            int result = WiFi.scanComplete();
+            if (result == WIFI_SCAN_RUNNING && elapsed < WIFI_SCAN_TIMEOUT_MS) {
+                break;
+            }
+            if (result < 0) {
+                Serial.println("WiFi: scansione fallita.");
+                enterBackoff();
+                break;
+            }
+            Serial.printf("WiFi: trovate %d reti.\n", result);
+            collectCandidates(result);
+            if (_candidateCount == 0) {
+                enterBackoff();
+            } else {
+                connectToCandidate();
+            }
+            break;
+        }
+
+        case WIFI_STATE_CONNECTING:
+            if (WiFi.status() == WL_CONNECTED) {
+                _lastNetwork = _candidates[_candidateIndex];
+                _backoffMs = WIFI_BACKOFF_MIN_MS;
+                _fastPath = false;
+                Serial.printf("WiFi: connesso a %s in %lu ms, IP %s\n", _networks[_lastNetwork].ssid,
+                              elapsed, WiFi.localIP().toString().c_str());
+                saveLinkToCache();
+                setState(WIFI_STATE_CONNECTED);
+            } else if (_fastPath && (elapsed > WIFI_FAST_CONNECT_TIMEOUT_MS || WiFi.status() == WL_CONNECT_FAILED)) {
+                // L'access point è cambiato o non risponde: si passa al percorso completo.
+                Serial.println("WiFi: connessione diretta fallita, passo alla scansione.");
+                _fastPath = false;
+                _cache->clearLink();
+                WiFi.disconnect();
+                startScan();
+            } else if (elapsed > WIFI_CONNECT_TIMEOUT_MS || WiFi.status() == WL_CONNECT_FAILED) {
+                Serial.println("WiFi: connessione fallita, provo la prossima rete.");
+                nextCandidate();
+            }
+            break;
+
+        case WIFI_STATE_CONNECTED:
+            if (WiFi.status() != WL_CONNECTED) {
+                Serial.println("WiFi: collegamento perso, riconnessione...");
+                // Prima si riprova la stessa rete, senza attendere una scansione.
+                _candidates[0] = _lastNetwork;
+                _candidateCount = 1;
+                _candidateIndex = 0;
+                connectToCandidate();
+            }
+            break;
+
+        case WIFI_STATE_BACKOFF:
+            if (elapsed >= _backoffMs) {
+                _backoffMs = (_backoffMs * 2 > WIFI_BACKOFF_MAX_MS) ? WIFI_BACKOFF_MAX_MS : _backoffMs * 2;
+                startScan();
+            }
+            break;
+    }
+}
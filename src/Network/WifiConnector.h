@@ -0,0 +1,98 @@
+// src/Network/WifiConnector.h
+
+/**
+ * @file WifiConnector.h
+ * @brief Dichiarazione della classe WifiConnector, macchina a stati non bloccante per la connessione WiFi.
+ * @details Sostituisce la scansione e la connessione bloccanti dell'avvio. Ogni
+ * chiamata a update() esegue un solo passo e ritorna subito: scansione
+ * asincrona, tentativo di connessione alle reti conosciute visibili, attesa con
+ * backoff esponenziale dopo un giro fallito e riconnessione automatica se il
+ * collegamento cade. Va aggiornata sempre dallo stesso task (il task di rete).
+ *
+ * Al riavvio, se la WifiCache contiene l'ultimo collegamento riuscito, si tenta
+ * prima una connessione diretta (BSSID e canale precedenti): niente scansione.
+ * L'indirizzo arriva comunque dal DHCP. Se fallisce si torna al percorso con
+ * scansione.
+ */
+
+#ifndef WIFI_CONNECTOR_H
+#define WIFI_CONNECTOR_H
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include "Network/WifiCache.h"
+
+/**
+ * @struct WifiCredential
+ * @brief Credenziali di una rete WiFi conosciuta.
+ */
+struct WifiCredential {
+    const char* ssid;
+    const char* password;
+};
+
+/** @brief Stati della connessione. */
+enum WifiState {
+    WIFI_STATE_IDLE,        // Non ancora avviata
+    WIFI_STATE_SCANNING,    // Scansione asincrona in corso
+    WIFI_STATE_CONNECTING,  // Tentativo di connessione a una rete candidata
+    WIFI_STATE_CONNECTED,   // Collegamento attivo
+    WIFI_STATE_BACKOFF      // Attesa prima di un nuovo giro di tentativi
+};
+
+/** @brief Numero massimo di reti conosciute gestite. */
+#define WIFI_MAX_KNOWN_NETWORKS 8
+
+class WifiConnector {
+public:
+    /**
+     * @param networks Reti conosciute, in ordine di preferenza.
+     * @param count Numero di reti (al massimo WIFI_MAX_KNOWN_NETWORKS).
+     * @param cache Parametri dell'ultimo collegamento riuscito, aggiornati a ogni connessione.
+     */
+    WifiConnector(const WifiCredential* networks, int count, WifiCache* cache);
+
+    /**
+     * @brief Mette il WiFi in modalità stazione e avvia il primo tentativo.
+     * @details Connessione diretta con i parametri in cache se disponibili,
+     * altrimenti scansione.
+     */
+    void begin();
+    /** @brief Esegue un passo della macchina a stati. Non bloccante. */
+    void update();
+
+    bool isConnected() const { return _state == WIFI_STATE_CONNECTED; }
+    WifiState getState() const { return _state; }
+    /** @brief SSID della rete a cui si è connessi o che si sta tentando. */
+    const char* getSsid() const;
+
+private:
+    bool startFastConnect();
+    void startScan();
+    void saveLinkToCache();
+    void collectCandidates(int visibleCount);
+    void connectToCandidate();
+    void nextCandidate();
+    void enterBackoff();
+    void setState(WifiState state);
+
+    const WifiCredential* _networks;
+    int _networkCount;
+    WifiCache* _cache;
+    // true durante il tentativo diretto.
+    bool _fastPath;
+
+    WifiState _state;
+    unsigned long _stateStart;
+
+    // Indici (in _networks) delle reti conosciute trovate dall'ultima scansione.
+    int _candidates[WIFI_MAX_KNOWN_NETWORKS];
+    int _candidateCount;
+    int _candidateIndex;
+    // Ultima rete a cui si era connessi: dopo una caduta si riprova subito quella.
+    int _lastNetwork;
+
+    unsigned long _backoffMs;
+};
+
+#endif // WIFI_CONNECTOR_H
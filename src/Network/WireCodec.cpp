@@ -0,0 +1,298 @@
+// src/Network/WireCodec.cpp
+
+/**
+ * @file WireCodec.cpp
+ * @brief Implementazione della codifica binaria dei messaggi di rete.
+ */
+
+#include "Network/WireCodec.h"
+#include <string.h>
+
+// --- Tabelle dei nomi ---
+// L'indice nella tabella è l'identificativo trasmesso. Aggiungere solo in coda
+// e replicare la modifica in ControlPanel/udp_bridge.py (WIRE_EVENTS / WIRE_FIELDS).
+static const char* const WIRE_EVENTS[] = {
+    "heartbeat", "device_online", "mode_enter", "mode_exit", "settings_update",
+    "remote_start", "round_reset", "game_start", "game_end", "countdown_start",
+    "countdown_update", "time_update", "capture_start", "capture_cancel", "capture_progress",
+    "zone_captured", "score_update", "arm_start", "arm_cancel", "arm_progress",
+    "arm_pin_wrong", "bomb_armed", "defuse_start", "defuse_cancel", "defuse_progress",
+    "defuse_pin_wrong", "ack", "time_sync", "timer_anchor"
+};
+static const uint8_t WIRE_EVENT_COUNT = sizeof(WIRE_EVENTS) / sizeof(WIRE_EVENTS[0]);
+
+static const char* const WIRE_FIELDS[] = {
+    "status", "version", "mode", "duration", "capture",
+    "countdown", "time", "team", "progress", "team1_score",
+    "team2_score", "winner", "bomb_time", "arm_pin", "disarm_pin",
+    "arm_time", "defuse_time", "use_arm_pin", "use_disarm_pin", "txq_hw",
+    "txq_drop", "wire", "cid",
+    "rxq_drop", "rx_trunc", "ts", "t0", "rtt",
+    "timer", "running", "remaining", "ends_at", "replay",
+    "evq_hw", "evq_drop"
+};
+static const uint8_t WIRE_FIELD_COUNT = sizeof(WIRE_FIELDS) / sizeof(WIRE_FIELDS[0]);
+
+static const uint8_t FIELD_KIND_INT = 0;
+static const uint8_t FIELD_KIND_STRING = 1;
+
+/** @brief Cerca un nome (non terminato) in una tabella. Ritorna l'indice o -1. */
+static int lookupName(const char* const* table, uint8_t count, const char* name, size_t length) {
+    for (uint8_t i = 0; i < count; i++) {
+        if (strncmp(table[i], name, length) == 0 && table[i][length] == '\0') {
+            return i;
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Interpreta il valore come intero solo se la sua forma decimale è canonica.
+ * @details "0123" o "+5" restano stringhe, così la decodifica restituisce
+ * esattamente il testo originale (es. i PIN).
+ */
+static bool parseCanonicalInt(const char* text, size_t length, int32_t* value) {
+    if (length == 0 || length > 10) {
+        return false;
+    }
+    size_t i = 0;
+    bool negative = false;
+    if (text[0] == '-') {
+        negative = true;
+        i = 1;
+        if (length == 1 || text[1] == '0') {
+            return false; // "-" e "-0..." non sono canonici
+        }
+    }
+    if (text[i] == '0' && length > i + 1) {
+        return false;
+    }
+    int64_t result = 0;
+    for (; i < length; i++) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        result = result * 10 + (text[i] - '0');
+    }
+    if (negative) {
+        result = -result;
+    }
+    if (result < INT32_MIN || result > INT32_MAX) {
+        return false;
+    }
+    *value = (int32_t)result;
+    return true;
+}
+
+bool WireCodec::isBinaryFrame(const uint8_t* data, size_t length) {
+    return length >= 2 && (data[0] & 0xF0) == WIRE_FRAME_MAGIC;
+}
+
+size_t WireCodec::writeVarint(uint32_t value, uint8_t* out, size_t capacity) {
+    size_t written = 0;
+    do {
+        if (written >= capacity) {
+            return 0;
+        }
+        uint8_t byte = value & 0x7F;
+        value >>= 7;
+        out[written++] = byte | (value ? 0x80 : 0);
+    } while (value);
+    return written;
+}
+
+size_t WireCodec::readVarint(const uint8_t* data, size_t length, uint32_t* value) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < length && i < 5; i++) {
+        result |= (uint32_t)(data[i] & 0x7F) << (7 * i);
+        if (!(data[i] & 0x80)) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
+size_t WireCodec::writeHeader(uint16_t handle, uint32_t firstSeq, uint8_t* out, size_t capacity) {
+    if (capacity < 1) {
+        return 0;
+    }
+    out[0] = WIRE_FRAME_MAGIC | WIRE_PROTOCOL_VERSION;
+    size_t n = writeVarint(handle, out + 1, capacity - 1);
+    if (n == 0) {
+        return 0;
+    }
+    size_t m = writeVarint(firstSeq, out + 1 + n, capacity - 1 - n);
+    return m ? 1 + n + m : 0;
+}
+
+size_t WireCodec::readHeader(const uint8_t* data, size_t length, uint8_t* version, uint16_t* handle, uint32_t* firstSeq) {
+    if (!isBinaryFrame(data, length)) {
+        return 0;
+    }
+    uint32_t value;
+    size_t n = readVarint(data + 1, length - 1, &value);
+    if (n == 0 || value > 0xFFFF) {
+        return 0;
+    }
+    size_t m = readVarint(data + 1 + n, length - 1 - n, firstSeq);
+    if (m == 0) {
+        return 0;
+    }
+    *version = data[0] & 0x0F;
+    *handle = (uint16_t)value;
+    return 1 + n + m;
+}
+
+size_t WireCodec::encodeMessage(const char* text, size_t textLength, uint8_t* out, size_t capacity) {
+    if (capacity < 2) {
+        return 0;
+    }
+    size_t pos = 2; // Tipo evento e numero di campi vengono scritti alla fine
+    uint8_t fieldCount = 0;
+    int eventId = -1;
+
+    size_t start = 0;
+    while (start < textLength) {
+        const char* token = text + start;
+        const char* end = (const char*)memchr(token, ';', textLength - start);
+        size_t tokenLength = end ? (size_t)(end - token) : textLength - start;
+        start += tokenLength + 1;
+        if (tokenLength == 0) {
+            continue;
+        }
+
+        const char* colon = (const char*)memchr(token, ':', tokenLength);
+        if (colon == nullptr) {
+            return 0;
+        }
+        size_t keyLength = colon - token;
+        const char* value = colon + 1;
+        size_t valueLength = tokenLength - keyLength - 1;
+
+        if (eventId < 0) {
+            // Il primo token deve essere sempre "event:<nome>"
+            if (keyLength != 5 || strncmp(token, "event", 5) != 0) {
+                return 0;
+            }
+            eventId = lookupName(WIRE_EVENTS, WIRE_EVENT_COUNT, value, valueLength);
+            if (eventId < 0) {
+                return 0;
+            }
+            continue;
+        }
+
+        int fieldId = lookupName(WIRE_FIELDS, WIRE_FIELD_COUNT, token, keyLength);
+        if (fieldId < 0 || fieldCount >= WIRE_MAX_FIELDS || pos >= capacity) {
+            return 0;
+        }
+
+        int32_t number;
+        size_t n;
+        if (parseCanonicalInt(value, valueLength, &number)) {
+            out[pos++] = (fieldId << 1) | FIELD_KIND_INT;
+            uint32_t zigzag = ((uint32_t)number << 1) ^ (uint32_t)(number >> 31);
+            n = writeVarint(zigzag, out + pos, capacity - pos);
+            if (n == 0) {
+                return 0;
+            }
+            pos += n;
+        } else {
+            out[pos++] = (fieldId << 1) | FIELD_KIND_STRING;
+            n = writeVarint(valueLength, out + pos, capacity - pos);
+            if (n == 0 || pos + n + valueLength > capacity) {
+                return 0;
+            }
+            pos += n;
+            memcpy(out + pos, value, valueLength);
+            pos += valueLength;
+        }
+        fieldCount++;
+    }
+
+    if (eventId < 0) {
+        return 0;
+    }
+    out[0] = (uint8_t)eventId;
+    out[1] = fieldCount;
+    return pos;
+}
+
+/** @brief Appende una stringa al buffer di uscita, rispettandone la capacità. */
+static bool appendText(char* out, size_t capacity, size_t* pos, const char* text, size_t length) {
+    if (*pos + length >= capacity) {
+        return false;
+    }
+    memcpy(out + *pos, text, length);
+    *pos += length;
+    return true;
+}
+
+size_t WireCodec::decodeMessage(const uint8_t* data, size_t length, size_t* consumed, char* out, size_t capacity) {
+    if (length < 2 || capacity == 0 || data[0] >= WIRE_EVENT_COUNT) {
+        return 0;
+    }
+    const char* eventName = WIRE_EVENTS[data[0]];
+    uint8_t fieldCount = data[1];
+    size_t in = 2;
+    size_t pos = 0;
+
+    if (!appendText(out, capacity, &pos, "event:", 6) ||
+        !appendText(out, capacity, &pos, eventName, strlen(eventName)) ||
+        !appendText(out, capacity, &pos, ";", 1)) {
+        return 0;
+    }
+
+    for (uint8_t f = 0; f < fieldCount; f++) {
+        if (in >= length) {
+            return 0;
+        }
+        uint8_t tag = data[in++];
+        uint8_t fieldId = tag >> 1;
+        if (fieldId >= WIRE_FIELD_COUNT) {
+            return 0;
+        }
+        const char* key = WIRE_FIELDS[fieldId];
+        if (!appendText(out, capacity, &pos, key, strlen(key)) || !appendText(out, capacity, &pos, ":", 1)) {
+            return 0;
+        }
+
+        uint32_t raw;
+        size_t n = readVarint(data + in, length - in, &raw);
+        if (n == 0) {
+            return 0;
+        }
+        in += n;
+        if ((tag & 1) == FIELD_KIND_INT) {
+            int32_t number = (int32_t)(raw >> 1) ^ -(int32_t)(raw & 1);
+            char digits[12];
+            int len = 0;
+            uint32_t magnitude = number < 0 ? 0u - (uint32_t)number : (uint32_t)number;
+            do {
+                digits[len++] = '0' + (magnitude % 10);
+                magnitude /= 10;
+            } while (magnitude);
+            if (number < 0) {
+                digits[len++] = '-';
+            }
+            if (pos + len >= capacity) {
+                return 0;
+            }
+            while (len > 0) {
+                out[pos++] = digits[--len];
+            }
+        } else {
+            if (in + raw > length || !appendText(out, capacity, &pos, (const char*)data + in, raw)) {
+                return 0;
+            }
+            in += raw;
+        }
+        if (!appendText(out, capacity, &pos, ";", 1)) {
+            return 0;
+        }
+    }
+
+    out[pos] = '\0';
+    *consumed = in;
+    return pos;
+}
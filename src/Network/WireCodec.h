@@ -0,0 +1,74 @@
+// src/Network/WireCodec.h
+
+/**
+ * @file WireCodec.h
+ * @brief Codifica binaria compatta dei messaggi "event:...;chiave:valore;".
+ * @details Il protocollo testuale resta il formato di riferimento (e di riserva):
+ * questo modulo traduce un messaggio testuale in un frame binario e viceversa,
+ * senza allocazioni e senza dipendenze da Arduino, così può essere compilato
+ * anche per l'host (benchmark e test).
+ *
+ * Formato del frame (versione 2):
+ * @code
+ *   [0xB0 | versione] [handle dispositivo: varint] [sequenza primo messaggio: varint] [messaggio]+
+ *   messaggio = [tipo evento: 1 byte] [numero campi: 1 byte] [campo]*
+ *   campo     = [tag: (id campo << 1) | tipo] [valore]
+ *               tipo 0 -> intero con segno, varint zigzag
+ *               tipo 1 -> stringa, lunghezza varint + byte
+ * @endcode
+ * I messaggi di un frame hanno numeri di sequenza consecutivi a partire da
+ * quello dell'intestazione. La versione 1 (un solo messaggio, senza sequenza)
+ * non è più supportata.
+ * Gli identificativi di eventi e campi sono gli indici delle tabelle in
+ * WireCodec.cpp e DEVONO restare allineati con quelle di ControlPanel/udp_bridge.py.
+ * Un nuovo nome si aggiunge solo in coda, mai in mezzo.
+ */
+
+#ifndef WIRE_CODEC_H
+#define WIRE_CODEC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/** @brief Versione del protocollo binario supportata dal firmware. */
+#define WIRE_PROTOCOL_VERSION 2
+/** @brief Nibble alto del primo byte di un frame binario (il testo inizia sempre con una lettera). */
+#define WIRE_FRAME_MAGIC 0xB0
+/** @brief Numero massimo di campi in un singolo messaggio. */
+#define WIRE_MAX_FIELDS 16
+
+class WireCodec {
+public:
+    /** @brief Ritorna true se il datagramma è un frame binario. */
+    static bool isBinaryFrame(const uint8_t* data, size_t length);
+
+    /**
+     * @brief Scrive l'intestazione del frame (magic/versione, handle, sequenza del primo messaggio).
+     * @return Byte scritti, 0 se lo spazio non basta.
+     */
+    static size_t writeHeader(uint16_t handle, uint32_t firstSeq, uint8_t* out, size_t capacity);
+    /**
+     * @brief Legge l'intestazione di un frame binario.
+     * @return Byte consumati, 0 se l'intestazione non è valida.
+     */
+    static size_t readHeader(const uint8_t* data, size_t length, uint8_t* version, uint16_t* handle, uint32_t* firstSeq);
+
+    /**
+     * @brief Codifica un messaggio testuale "event:nome;chiave:valore;...".
+     * @return Byte scritti in out, 0 se il messaggio contiene eventi o campi
+     * sconosciuti (in quel caso va inviato in formato testo) o se lo spazio non basta.
+     */
+    static size_t encodeMessage(const char* text, size_t textLength, uint8_t* out, size_t capacity);
+    /**
+     * @brief Decodifica un messaggio binario nel formato testuale canonico (ogni campo chiuso da ';').
+     * @param consumed Byte del messaggio letti da data.
+     * @return Caratteri scritti in out (terminatore escluso), 0 se il messaggio non è valido.
+     */
+    static size_t decodeMessage(const uint8_t* data, size_t length, size_t* consumed, char* out, size_t capacity);
+
+    // Primitive varint, esposte per i chiamanti che costruiscono frame composti.
+    static size_t writeVarint(uint32_t value, uint8_t* out, size_t capacity);
+    static size_t readVarint(const uint8_t* data, size_t length, uint32_t* value);
+};
+
+#endif // WIRE_CODEC_H
@@ -1,140 +1,645 @@
 // src/NetworkManager.cpp
 
 #include "NetworkManager.h"
+#include "Network/EventEncoder.h"
 
-String deviceId = "";
+// --- Ricerca del server ---
+// Alla connessione si cerca prima il bridge sulla LAN (vedi ServerDiscovery);
+// il nome DDNS si usa solo se in LAN non risponde nessuno.
+const char* SERVER_HOSTNAME = "zuluserver.ddns.net";
+// Con il server in LAN la ricerca si ripete periodicamente, come il rinnovo DNS.
+const unsigned long DISCOVERY_REFRESH_MS = 300000;   // 5 minuti
 
-// --- Lista delle reti Wi-Fi conosciute ---
-// Aggiungi qui tutte le reti a cui vuoi che il dispositivo si connetta.
-// Puoi aggiungerne quante ne vuoi.
-struct WifiCredential {
-    const char* ssid;
-    const char* password;
-};
+// --- Cache DNS del server ---
+// Validità dell'indirizzo risolto: scaduto questo tempo il task lo rinnova in background.
+const unsigned long DNS_CACHE_TTL_MS = 300000;   // 5 minuti
+// Se la risoluzione fallisce si riprova più spesso, nel frattempo si usa il broadcast.
+const unsigned long DNS_RETRY_MS = 10000;        // 10 secondi
 
-const WifiCredential knownNetworks[] = {
-    {"MELONE", "wirelessmelone"},               // Rete casa
-    {"Som🅱️​rero🔆", "cristone"},       //
-    {"S20Lorenzo", "Satana666"}   // hotspot
-};
-const int numKnownNetworks = sizeof(knownNetworks) / sizeof(knownNetworks[0]);
+// --- Sincronizzazione dell'orologio con il server ---
+// Alla connessione parte una raffica di richieste ravvicinate: tra queste si sceglie
+// quella con il ritardo minimo. Poi una richiesta periodica segue la deriva del quarzo.
+const uint8_t TIME_SYNC_BURST = 4;
+const unsigned long TIME_SYNC_BURST_INTERVAL_MS = 250;
+const unsigned long TIME_SYNC_PERIOD_MS = 30000;   // 30 secondi
 
-// --- MODIFICA: L'hostname del server ora è definito qui ---
-const char* SERVER_HOSTNAME = "zuluserver.ddns.net";
+// --- Ricezione ---
+// Con il collegamento attivo il task di rete controlla il socket almeno a questo
+// intervallo: è il ritardo massimo aggiunto a un comando in arrivo.
+const unsigned long RX_POLL_INTERVAL_MS = 5;
+// Senza collegamento basta far avanzare la connessione.
+const unsigned long LINK_POLL_INTERVAL_MS = 100;
+
+// Ripetizione dell'ancora del timer attivo, contro la perdita di un datagramma.
+const unsigned long TIMER_ANCHOR_REFRESH_MS = 15000;   // 15 secondi
+
+// --- Diario degli eventi ---
+// Al ritorno del collegamento il diario si svuota un datagramma alla volta a questo
+// intervallo, senza saturare il bridge né ritardare troppo gli eventi nuovi.
+const unsigned long JOURNAL_REPLAY_INTERVAL_MS = 50;
+// Durante una scrittura in SPIFFS la cache della flash è spenta su entrambi i core:
+// anche il loop di gioco si ferma per qualche millisecondo. La coda va nel diario a
+// gruppi, al più a questo intervallo (prima se è piena a metà).
+const unsigned long JOURNAL_WRITE_INTERVAL_MS = 250;
+// Spazio per "ts:" e "replay:1;" aggiunti all'invio.
+const size_t EVENT_STAMP_MAX_LEN = 32;
+
+static_assert(JOURNAL_RECORD_DATA_LEN == OUTBOUND_EVENT_MAX_LEN, "Un evento in coda deve entrare in un record del diario");
 
 // Costruttore
-NetworkManager::NetworkManager() :
-    _udpPort(1234) // Inizializza solo la porta
+NetworkManager::NetworkManager(Transport* transport) :
+    _transport(transport),
+    _udpPort(1234), // Inizializza solo la porta
+    _broadcastIP(0, 0, 0, 0),
+    _serverIP(0, 0, 0, 0),
+    _nextResolveTime(0),
+    _firstDatagramSent(false),
+    _txHighWater(0),
+    _txDropped(0),
+    _nextSeq(0),
+    _nextReplayTime(0),
+    _nextJournalTime(0),
+    _wireHandle(0),
+    _anchorDeadline(0),
+    _anchorRemaining(0),
+    _anchorRunning(false),
+    _anchorActive(false),
+    _nextAnchorTime(0),
+    _networkTaskHandle(nullptr),
+    _recentCommandIndex(0),
+    _commandFilter(nullptr),
+    _commandFilterContext(nullptr),
+    _rxHeld(false),
+    _rxOverflow(0),
+    _rxTruncated(0),
+    _nextTimeSyncTime(0),
+    _timeSyncBurst(0),
+    _serverOffset(0),
+    _serverOffsetValid(false),
+    _connected(false),
+    _linkUpEvent(false),
+    _linkDownEvent(false)
 {
-    // Le credenziali non vengono più inizializzate qui
+    memset(_recentCommandIds, 0, sizeof(_recentCommandIds));
+    _anchorTimer[0] = '\0';
 }
 
-void NetworkManager::initialize(HardwareManager* hardware) {
+void NetworkManager::initialize() {
     Serial.println("--- Inizializzazione Rete (Multi-WiFi) ---");
-    hardware->clearLcd();
-    hardware->printLcd(0, 1, "Scansione Reti WiFi");
-    
-    WiFi.mode(WIFI_STA);
-    WiFi.disconnect(); // Assicura di partire da uno stato pulito
-    delay(100);
-
-    Serial.println("Avvio scansione reti...");
-    int numVisibleNetworks = WiFi.scanNetworks();
-    Serial.printf("Trovate %d reti.\n", numVisibleNetworks);
-
-    if (numVisibleNetworks == 0) {
-        hardware->printLcd(0, 2, "Nessuna rete trovata!");
-        return; // O entra in un loop di attesa
-    }
-
-    // Cerca una corrispondenza tra le reti conosciute e quelle visibili
-    bool connected = false;
-    for (int i = 0; i < numKnownNetworks; i++) {
-        for (int j = 0; j < numVisibleNetworks; j++) {
-            if (strcmp(knownNetworks[i].ssid, WiFi.SSID(j).c_str()) == 0) {
-                Serial.printf("Rete conosciuta trovata: %s. Tento la connessione...\n", knownNetworks[i].ssid);
-                hardware->clearLcd();
-                hardware->printLcd(0, 1, "Trovata Rete:");
-                hardware->printLcd(0, 2, knownNetworks[i].ssid);
-
-                WiFi.begin(knownNetworks[i].ssid, knownNetworks[i].password);
-
-                // Attendi la connessione con un timeout di 10 secondi
-                int attempts = 20;
-                while (WiFi.status() != WL_CONNECTED && attempts > 0) {
-                    delay(500);
-                    Serial.print(".");
-                    attempts--;
-                }
-
-                if (WiFi.status() == WL_CONNECTED) {
-                    connected = true;
-                    goto connection_success; // Salta fuori da entrambi i loop
-                } else {
-                    Serial.println(" Connessione fallita. Provo la prossima.");
-                    WiFi.disconnect();
-                }
+
+    // La connessione prosegue in background nel task di rete: l'avvio non attende.
+    _transport->begin(_udpPort);
+    // Ultimo indirizzo noto del server: i primi invii non attendono il DNS.
+    _serverIP = IPAddress(_transport->lastResolvedAddress());
+    // Eventi rimasti dall'avvio precedente: le sequenze proseguono dopo di loro,
+    // così il bridge non li scambia per duplicati né per un riavvio.
+    if (_journal.begin() && !_journal.isEmpty()) {
+        _nextSeq = _journal.getNextSeq();
+    }
+
+    Serial.printf("ID Dispositivo (MAC): %s\n", _transport->deviceId());
+    Serial.print("In ascolto su porta UDP: ");
+    Serial.println(_udpPort);
+
+    if (_networkTaskHandle == nullptr) {
+        xTaskCreatePinnedToCore(networkTask, "net", 4096, this, 1, &_networkTaskHandle, NETWORK_TASK_CORE);
+    }
+    Serial.println("---------------------------");
+}
+
+void NetworkManager::onLinkUp() {
+    // Broadcast della sottorete: destinazione di riserva se il server non è risolvibile.
+    _broadcastIP = IPAddress(_transport->broadcastAddress());
+
+    // L'indirizzo del server potrebbe essere cambiato mentre eravamo scollegati:
+    // si cerca di nuovo il bridge in LAN. Nel frattempo i dati partono verso
+    // l'indirizzo in cache o, in mancanza, in broadcast (il bridge in LAN li riceve comunque).
+    _discovery.start(millis());
+    _timeSyncBurst = TIME_SYNC_BURST;
+    _nextTimeSyncTime = millis();
+
+    _connected.store(true);
+    _linkUpEvent.store(true);
+}
+
+void NetworkManager::onLinkDown() {
+    _connected.store(false);
+    _linkDownEvent.store(true);
+}
+
+void NetworkManager::update() {
+    if (_telemetry.isDue(millis())) {
+        flushTelemetry();
+    }
+
+    if (_anchorActive && (long)(millis() - _nextAnchorTime) >= 0) {
+        sendTimerAnchor();
+    }
+
+    // Fine del tick: gli eventi accodati finora partono nello stesso datagramma.
+    if (_networkTaskHandle != nullptr && _txQueue.size() > 0) {
+        xTaskNotifyGive(_networkTaskHandle);
+    }
+}
+
+void NetworkManager::drainSocket() {
+    while (true) {
+        InboundPacket* slot = _rxQueue.beginPush();
+        if (slot == nullptr) {
+            // Coda piena: i comandi in attesa non vengono confermati e il bridge li ritrasmetterà.
+            uint8_t discard[INBOUND_PACKET_MAX_LEN];
+            uint32_t from;
+            bool truncated;
+            if (_transport->receive(discard, sizeof(discard), from, truncated) < 0) {
+                break;
             }
+            _rxOverflow++;
+            continue;
+        }
+        uint32_t from = 0;
+        bool truncated = false;
+        int len = _transport->receive((uint8_t*)slot->data, INBOUND_PACKET_MAX_LEN - 1, from, truncated);
+        if (len < 0) {
+            break;
+        }
+        if (truncated) {
+            // Un comando troncato sarebbe applicato a metà: meglio scartarlo.
+            _rxTruncated++;
+            continue;
+        }
+        if (len == 0) {
+            continue;
+        }
+        slot->receivedAt = millis();
+        slot->data[len] = '\0';
+        slot->length = len;
+
+        if (_discovery.handleReply(slot->data, from) || handleWireCommand(slot->data)) {
+            continue;
+        }
+        _rxQueue.commitPush();
+        Serial.printf("Ricevuto pacchetto da %s: %s\n", IPAddress(from).toString().c_str(), slot->data);
+    }
+}
+
+bool NetworkManager::handleWireCommand(const char* packet) {
+    if (strncmp(packet, "CMD:WIRE;", 9) != 0) {
+        return false;
+    }
+    const char* ver = strstr(packet, "VER:");
+    const char* handle = strstr(packet, "HANDLE:");
+    int version = ver ? atoi(ver + 4) : 0;
+
+    if (version == WIRE_PROTOCOL_VERSION && handle != nullptr) {
+        long value = atol(handle + 7);
+        if (value > 0 && value <= 0xFFFF) {
+            _wireHandle.store((uint16_t)value);
+            Serial.printf("Protocollo binario v%d attivo, handle %ld\n", version, value);
+            return true;
         }
     }
+    // Versione non supportata o handle sconosciuto al bridge: si torna al testo
+    // e il prossimo messaggio riproporrà la negoziazione.
+    _wireHandle.store(0);
+    Serial.println("Protocollo testuale attivo.");
+    return true;
+}
 
-connection_success:
-    if (connected) {
-        Serial.println("\nCONNESSO!");
-        Serial.print("Indirizzo IP: ");
-        Serial.println(WiFi.localIP());
+bool NetworkManager::handleTimeSync(const char* packet, uint32_t receivedAt) {
+    if (strncmp(packet, "CMD:TIME_SYNC;", 14) != 0) {
+        return false;
+    }
+    const char* t0 = strstr(packet, "T0:");
+    const char* t1 = strstr(packet, "T1:");
+    const char* t2 = strstr(packet, "T2:");
+    if (t0 == nullptr || t1 == nullptr || t2 == nullptr) {
+        return true;
+    }
+    bool wasSynced = _clock.isSynced();
+    if (_clock.addSample(strtoul(t0 + 3, nullptr, 10), strtoul(t1 + 3, nullptr, 10),
+                         strtoul(t2 + 3, nullptr, 10), receivedAt)) {
+        _serverOffset.store(_clock.getOffset());
+        _serverOffsetValid.store(true);
+    }
+    if (_clock.isSynced() && !wasSynced) {
+        Serial.printf("Orologio sincronizzato col server (ritardo %lu ms).\n",
+                      (unsigned long)_clock.getRoundTrip());
+        // Un timer già in corso ora può indicare la scadenza in tempo server.
+        _nextAnchorTime = millis();
+    }
+    return true;
+}
 
-        hardware->clearLcd();
-        hardware->printLcd(6, 1, "Connesso!");
-        hardware->printLcd(4, 2, WiFi.localIP().toString());
-        delay(2000);
+const char* NetworkManager::acknowledgeCommand(const char* packet) {
+    if (strncmp(packet, "CID:", 4) != 0) {
+        return packet; // Comando senza ID: consegna diretta, come in passato
+    }
+    char* end;
+    uint32_t cid = strtoul(packet + 4, &end, 10);
+    const char* command = (*end == ';') ? end + 1 : end;
+    char ack[32];
+    snprintf(ack, sizeof(ack), "event:ack;cid:%lu;", (unsigned long)cid);
 
-        deviceId = WiFi.macAddress();
-        Serial.printf("ID Dispositivo (MAC): %s\n", deviceId.c_str());
+    for (int i = 0; i < COMMAND_ID_HISTORY; i++) {
+        if (cid != 0 && _recentCommandIds[i] == cid) {
+            // La conferma si ripete: se la precedente è andata persa il bridge ritrasmette.
+            enqueue(ack);
+            Serial.printf("Comando %lu duplicato, ignorato.\n", (unsigned long)cid);
+            return nullptr;
+        }
+    }
+    if (_commandFilter != nullptr && !_commandFilter(command, _commandFilterContext)) {
+        Serial.printf("Comando %lu rifiutato, attendo la ritrasmissione.\n", (unsigned long)cid);
+        return nullptr;
+    }
+    enqueue(ack);
+    _recentCommandIds[_recentCommandIndex] = cid;
+    _recentCommandIndex = (_recentCommandIndex + 1) % COMMAND_ID_HISTORY;
+    return command;
+}
 
-        _udp.begin(_udpPort);
-        Serial.print("In ascolto su porta UDP: ");
-        Serial.println(_udpPort);
+void NetworkManager::setCommandFilter(CommandFilter filter, void* context) {
+    _commandFilter = filter;
+    _commandFilterContext = context;
+}
+
+const char* NetworkManager::nextReceivedMessage() {
+    if (_rxHeld) {
+        _rxQueue.pop();
+        _rxHeld = false;
+    }
+    InboundPacket* packet;
+    while ((packet = _rxQueue.front()) != nullptr) {
+        if (handleTimeSync(packet->data, packet->receivedAt)) {
+            _rxQueue.pop();
+            continue;
+        }
+        const char* command = acknowledgeCommand(packet->data);
+        if (command == nullptr) {
+            _rxQueue.pop();
+            continue;
+        }
+        // Lo slot appartiene al consumatore fino al pop(): il prefisso si toglie sul posto.
+        packet->length -= command - packet->data;
+        memmove(packet->data, command, packet->length + 1);
+        _rxHeld = true;
+        return packet->data;
+    }
+    return nullptr;
+}
+
+void NetworkManager::sendStatus(const char* status) {
+    // Gli eventi discreti partono subito, ma dopo la telemetria già pubblicata.
+    if (_telemetry.hasPending()) {
+        flushTelemetry();
+    }
+    enqueue(status);
+}
+
+void NetworkManager::publishTelemetry(TelemetryKey key, const char* status) {
+    _telemetry.publish(key, status);
+}
+
+void NetworkManager::setTelemetryRate(uint16_t hz) {
+    _telemetry.setRate(hz);
+}
+
+void NetworkManager::sendGameEvent(const GameEvent& event) {
+    char message[OUTBOUND_EVENT_MAX_LEN];
+    if (EventEncoder::encode(event, message, sizeof(message)) == 0) {
+        return;
+    }
+    TelemetryKey key;
+    if (EventEncoder::isTelemetry(event.id, &key)) {
+        publishTelemetry(key, message);
     } else {
-        Serial.println("\nNessuna rete WiFi conosciuta trovata.");
-        hardware->clearLcd();
-        hardware->printLcd(0, 1, "Nessuna Rete Nota");
-        hardware->printLcd(0, 2, "Trovata!");
+        sendStatus(message);
     }
-    Serial.println("---------------------------");
 }
 
-void NetworkManager::update() {
-    int packetSize = _udp.parsePacket();
-    if (packetSize) {
-        _lastSenderIP = _udp.remoteIP();
-        char incomingPacket[255];
-        int len = _udp.read(incomingPacket, 255);
-        if (len > 0) {
-            incomingPacket[len] = 0;
+void NetworkManager::publishTimerAnchor(const char* timer, uint32_t remainingMs, bool running) {
+    strncpy(_anchorTimer, timer, TIMER_ANCHOR_NAME_LEN - 1);
+    _anchorTimer[TIMER_ANCHOR_NAME_LEN - 1] = '\0';
+    _anchorDeadline = millis() + remainingMs;
+    _anchorRemaining = remainingMs;
+    _anchorRunning = running;
+    _anchorActive = true;
+    sendTimerAnchor();
+}
+
+void NetworkManager::sendTimerAnchor() {
+    uint32_t now = millis();
+    uint32_t remaining = _anchorRemaining;
+    if (_anchorRunning) {
+        remaining = (long)(_anchorDeadline - now) > 0 ? _anchorDeadline - now : 0;
+    }
+
+    char message[112];
+    int length = snprintf(message, sizeof(message), "event:timer_anchor;timer:%s;running:%d;remaining:%lu;",
+                          _anchorTimer, _anchorRunning ? 1 : 0, (unsigned long)remaining);
+    if (_anchorRunning && _clock.isSynced() && length > 0 && length < (int)sizeof(message)) {
+        snprintf(message + length, sizeof(message) - length, "ends_at:%lu;",
+                 (unsigned long)_clock.toServerTime(_anchorDeadline));
+    }
+    sendStatus(message);
+    _nextAnchorTime = now + TIMER_ANCHOR_REFRESH_MS;
+}
+
+void NetworkManager::flushTelemetry() {
+    for (int key = 0; key < TELEMETRY_KEY_COUNT; key++) {
+        const char* message = _telemetry.take((TelemetryKey)key);
+        if (message != nullptr) {
+            enqueue(message);
         }
-        _lastMessage = String(incomingPacket);
-        Serial.printf("Ricevuto pacchetto da %s: %s\n", _lastSenderIP.toString().c_str(), _lastMessage.c_str());
+    }
+    _telemetry.markFlushed(millis());
+}
+
+void NetworkManager::enqueue(const char* status) {
+    if (_networkTaskHandle == nullptr) {
+        Serial.println("ERRORE: Rete non inizializzata, evento non inviato.");
+        return;
+    }
+
+    OutboundEvent* slot = _txQueue.beginPush();
+    if (slot == nullptr) {
+        _txDropped++;
+        return;
+    }
+    size_t length = strlen(status);
+    if (length >= OUTBOUND_EVENT_MAX_LEN) {
+        length = OUTBOUND_EVENT_MAX_LEN - 1;
+    }
+    memcpy(slot->data, status, length);
+    slot->data[length] = '\0';
+    slot->length = length;
+    slot->seq = _nextSeq++;
+    slot->queuedAt = millis();
+    _txQueue.commitPush();
+
+    uint32_t queued = _txQueue.size();
+    if (queued > _txHighWater) {
+        _txHighWater = queued;
     }
 }
 
-String NetworkManager::getReceivedMessage() {
-    if (_lastMessage != "") {
-        String msg = _lastMessage;
-        _lastMessage = "";
-        return msg;
+IPAddress NetworkManager::getDestinationAddress() {
+    if ((uint32_t)_serverIP != 0) {
+        return _serverIP;
     }
-    return "";
+    return _broadcastIP;
 }
 
-void NetworkManager::sendStatus(const char* status) {
-    IPAddress remote_addr;
-    if (WiFi.hostByName(SERVER_HOSTNAME, remote_addr)) {
-        _udp.beginPacket(remote_addr, _udpPort);
-        String messageWithId = String(status) + "id:" + deviceId + ";";
-        _udp.print(messageWithId);
-        _udp.endPacket();
+bool NetworkManager::toServerTime(uint32_t localMs, uint32_t& serverMs) const {
+    if (!_serverOffsetValid.load()) {
+        return false;
+    }
+    serverMs = (localMs + _serverOffset.load()) & SERVER_TIME_MASK;
+    return true;
+}
+
+size_t NetworkManager::formatEvent(char* out, size_t size, const char* data, uint16_t length,
+                                   bool hasTime, uint32_t serverMs, bool replay) const {
+    memcpy(out, data, length);
+    size_t pos = length;
+    if ((hasTime || replay) && pos > 0 && out[pos - 1] != ';') {
+        out[pos++] = ';';
+    }
+    if (hasTime) {
+        // Tempo server dell'evento: il pannello ordina e confronta gli eventi di più dispositivi.
+        pos += snprintf(out + pos, size - pos, "ts:%lu;", (unsigned long)serverMs);
+    }
+    if (replay) {
+        pos += snprintf(out + pos, size - pos, "replay:1;");
+    }
+    return pos;
+}
+
+void NetworkManager::drainQueue() {
+    _batcher.reset(_wireHandle.load(), _transport->deviceId());
+
+    char text[OUTBOUND_EVENT_MAX_LEN + EVENT_STAMP_MAX_LEN];
+    // Gli eventi del datagramma in costruzione restano in coda finché l'invio non riesce.
+    size_t batched = 0;
+    bool failed = false;
+    OutboundEvent* event;
+    while ((event = _txQueue.peek(batched)) != nullptr) {
+        uint32_t serverMs = 0;
+        bool hasTime = toServerTime(event->queuedAt, serverMs);
+        size_t length = formatEvent(text, sizeof(text), event->data, event->length, hasTime, serverMs, false);
+        if (!_batcher.append(text, length, event->seq)) {
+            // Il datagramma è pieno o cambia formato: si invia e se ne inizia uno nuovo.
+            if (!sendDatagram()) {
+                failed = true;
+                break;
+            }
+            _txQueue.pop(batched);
+            batched = 0;
+            _batcher.reset(_wireHandle.load(), _transport->deviceId());
+            _batcher.append(text, length, event->seq);
+        }
+        batched++;
+    }
+    if (!failed && batched > 0) {
+        if (sendDatagram()) {
+            _txQueue.pop(batched);
+        } else {
+            failed = true;
+        }
+    }
+    if (failed) {
+        // Nessuna destinazione (ricerca in corso, DNS non risolto) o invio fallito:
+        // gli eventi passano nel diario con il loro tempo e vengono reinviati. Fino
+        // alla prossima scrittura di gruppo restano in coda e si ritenta l'invio.
+        journalQueue();
+    }
+}
+
+void NetworkManager::journalQueue() {
+    if (!_journal.isReady()) {
+        return; // Senza diario gli eventi attendono in coda, come in passato.
+    }
+    if (_txQueue.size() < OUTBOUND_QUEUE_SIZE / 2 && (long)(millis() - _nextJournalTime) < 0) {
+        return; // Gli eventi attendono in coda la prossima scrittura di gruppo.
+    }
+    _nextJournalTime = millis() + JOURNAL_WRITE_INTERVAL_MS;
+    OutboundEvent* event;
+    while ((event = _txQueue.front()) != nullptr) {
+        // Senza collegamento battiti e conferme non servono: valgono solo sul momento
+        // e il bridge ritrasmette i comandi da sé.
+        if (!_connected.load() &&
+            (strncmp(event->data, "event:heartbeat;", 16) == 0 || strncmp(event->data, "event:ack;", 10) == 0)) {
+            _txQueue.pop();
+            continue;
+        }
+        // Se l'orologio è già sincronizzato si conserva direttamente il tempo server:
+        // dopo un riavvio millis() non sarebbe più convertibile.
+        uint32_t serverMs = 0;
+        bool hasTime = toServerTime(event->queuedAt, serverMs);
+        _journal.append(event->seq, hasTime ? serverMs : event->queuedAt, hasTime, event->data, event->length);
+        _txQueue.pop();
+    }
+    _journal.sync();
+}
+
+void NetworkManager::replayJournal() {
+    _batcher.reset(_wireHandle.load(), _transport->deviceId());
+
+    char text[OUTBOUND_EVENT_MAX_LEN + EVENT_STAMP_MAX_LEN];
+    JournalRecord record;
+    uint16_t count = 0;
+    while (_journal.peek(count, record)) {
+        uint32_t serverMs = record.time;
+        bool hasTime = record.serverTime != 0;
+        if (!hasTime && record.boot == _journal.getBoot()) {
+            hasTime = toServerTime(record.time, serverMs);
+        }
+        size_t length = formatEvent(text, sizeof(text), record.data, record.length, hasTime, serverMs, true);
+        if (!_batcher.append(text, length, record.seq)) {
+            break; // Il resto al prossimo turno
+        }
+        count++;
+    }
+    if (count > 0 && sendDatagram()) {
+        _journal.discard(count);
+        _journal.sync();
+        if (_journal.isEmpty()) {
+            Serial.println("Diario eventi reinviato completamente.");
+        }
+    }
+}
+
+bool NetworkManager::sendDatagram() {
+    IPAddress remote_addr = getDestinationAddress();
+    if ((uint32_t)remote_addr == 0 || !_transport->isLinkUp()) {
+        return false;
+    }
+
+    if (!_transport->send((uint32_t)remote_addr, _udpPort, _batcher.data(), _batcher.length())) {
+        // L'invio è fallito: l'indirizzo in cache potrebbe non essere più valido.
+        Serial.println("ERRORE: Invio UDP fallito, anticipo il rinnovo DNS.");
+        _nextResolveTime = millis();
+        return false;
+    }
+    if (!_firstDatagramSent) {
+        _firstDatagramSent = true;
+        Serial.printf("Primo pacchetto UDP inviato a %lu ms dall'avvio.\n", millis());
+    }
+    return true;
+}
+
+void NetworkManager::sendTimeSyncRequest() {
+    IPAddress remote_addr = getDestinationAddress();
+    if ((uint32_t)remote_addr == 0) {
+        return;
+    }
+    char request[64];
+    int length = snprintf(request, sizeof(request), "event:time_sync;t0:%lu;id:%s;",
+                          (unsigned long)millis(), _transport->deviceId());
+    if (length > 0 && length < (int)sizeof(request)) {
+        _transport->send((uint32_t)remote_addr, _udpPort, (const uint8_t*)request, length);
+    }
+}
+
+void NetworkManager::onDiscoveryFinished() {
+    if (_discovery.getState() == ServerDiscovery::DISCOVERY_FOUND) {
+        _serverIP = IPAddress(_discovery.getServerAddress());
+        _transport->saveServerAddress(_discovery.getServerAddress());
+        _nextResolveTime = millis() + DISCOVERY_REFRESH_MS;
+        Serial.printf("Server trovato in LAN: %s\n", _serverIP.toString().c_str());
     } else {
+        Serial.println("Nessun server in LAN, uso il nome DDNS.");
+        bool ok = resolveServerAddress();
+        _nextResolveTime = millis() + (ok ? DNS_CACHE_TTL_MS : DNS_RETRY_MS);
+    }
+}
+
+bool NetworkManager::resolveServerAddress() {
+    uint32_t resolved = 0;
+    if (!_transport->resolve(SERVER_HOSTNAME, resolved)) {
+        // Si mantiene l'ultimo indirizzo valido: meglio un dato vecchio che nessun dato.
         Serial.println("ERRORE: Impossibile risolvere l'hostname del server!");
+        return false;
+    }
+
+    _serverIP = IPAddress(resolved);
+    Serial.printf("Server %s risolto in %s\n", SERVER_HOSTNAME, _serverIP.toString().c_str());
+    return true;
+}
+
+/**
+ * @brief Task di rete, eseguito sul core 0 insieme allo stack WiFi.
+ * @details Si sveglia alla fine di ogni tick del loop di gioco con eventi in coda
+ * (o al più ogni RX_POLL_INTERVAL_MS, LINK_POLL_INTERVAL_MS senza collegamento) e
+ * fa avanzare la gestione del collegamento del transport. Quando il collegamento
+ * è attivo legge i pacchetti arrivati nella coda di ricezione, svuota la coda
+ * di trasmissione impacchettando gli eventi in datagrammi e cerca il server:
+ * prima in LAN, poi con il DNS quando nessuno risponde.
+ * La ricerca si ripete alla scadenza del periodo o dopo un invio fallito.
+ * Invia inoltre le richieste di sincronizzazione dell'orologio.
+ * Mentre il collegamento è assente gli eventi passano nel diario in flash. Alla
+ * riconnessione, concluse la ricerca del server e la raffica di sincronizzazione,
+ * il diario viene reinviato un datagramma ogni JOURNAL_REPLAY_INTERVAL_MS; finché
+ * non è vuoto anche gli eventi nuovi vi si accodano, così l'ordine delle sequenze
+ * resta quello di generazione. Le chiamate bloccanti a endPacket(), hostByName()
+ * e le scritture in flash avvengono solo qui, mai nel loop di gioco. Le scritture in
+ * flash fermano comunque anche il loop di gioco (cache spenta su entrambi i core):
+ * la coda va nel diario a gruppi, vedi JOURNAL_WRITE_INTERVAL_MS.
+ * Non chiama mai HardwareManager: display, LED e buzzer sono del task di gioco.
+ */
+void NetworkManager::networkTask(void* param) {
+    NetworkManager* self = static_cast<NetworkManager*>(param);
+
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(self->_connected.load() ? RX_POLL_INTERVAL_MS : LINK_POLL_INTERVAL_MS));
+        self->runNetworkRound();
+    }
+}
+
+/**
+ * @brief Un giro del task di rete, vedi networkTask().
+ */
+void NetworkManager::runNetworkRound() {
+    bool wasConnected = _connected.load();
+    _transport->poll();
+    bool connected = _transport->isLinkUp();
+    if (connected && !wasConnected) {
+        onLinkUp();
+    } else if (!connected && wasConnected) {
+        onLinkDown();
+    }
+    if (!connected) {
+        journalQueue();
+        return;
+    }
+    drainSocket();
+
+    if (_discovery.update(*_transport, _udpPort, millis())) {
+        onDiscoveryFinished();
+    }
+    if (!_discovery.isProbing() && (long)(millis() - _nextResolveTime) >= 0) {
+        // Ogni rinnovo riparte dalla LAN: un bridge acceso più tardi viene preferito al DDNS.
+        _discovery.start(millis());
+    }
+
+    if ((long)(millis() - _nextTimeSyncTime) >= 0) {
+        sendTimeSyncRequest();
+        if (_timeSyncBurst > 0) {
+            _timeSyncBurst--;
+        }
+        _nextTimeSyncTime = millis() + (_timeSyncBurst > 0 ? TIME_SYNC_BURST_INTERVAL_MS : TIME_SYNC_PERIOD_MS);
     }
-}
\ No newline at end of file
+
+    if (_journal.isEmpty()) {
+        drainQueue();
+        return;
+    }
+    journalQueue();
+    // Il reinvio attende l'indirizzo del server e l'orologio: un evento reinviato
+    // verso un indirizzo vecchio sarebbe perso, senza orologio resterebbe senza tempo.
+    if (!_discovery.isProbing() && _timeSyncBurst == 0 &&
+        (long)(millis() - _nextReplayTime) >= 0) {
+        replayJournal();
+        _nextReplayTime = millis() + JOURNAL_REPLAY_INTERVAL_MS;
+    }
+}
@@ -0,0 +1,144 @@
+// src/Profiler.cpp
+
+/**
+ * @file Profiler.cpp
+ * @brief Implementazione della classe Profiler.
+ */
+
+#include "Profiler.h"
+#include <stdio.h>
+#include <string.h>
+
+Profiler profiler;
+
+int8_t Profiler::add(const char* group, const char* name) {
+    char label[PROFILER_NAME_LEN];
+    formatName(label, group, name);
+    // Più punti di misura possono condividere la stessa sonda (es. ogni show() della striscia).
+    for (uint8_t i = 0; i < _count; i++) {
+        if (strcmp(_probes[i].name, label) == 0) {
+            return (int8_t)i;
+        }
+    }
+    return append(label);
+}
+
+int8_t Profiler::addGroup(const char* group, const char* const* names, uint8_t count) {
+    if (_count + count > PROFILER_MAX_PROBES) {
+        return -1;
+    }
+    int8_t first = (int8_t)_count;
+    char label[PROFILER_NAME_LEN];
+    for (uint8_t i = 0; i < count; i++) {
+        formatName(label, group, names[i]);
+        append(label);
+    }
+    return first;
+}
+
+void Profiler::record(int8_t index, uint32_t cycles) {
+    if (index < 0) {
+        return;
+    }
+    Probe& probe = _probes[index];
+    if (probe.count == 0 || cycles < probe.minCycles) probe.minCycles = cycles;
+    if (probe.count == 0 || cycles > probe.maxCycles) probe.maxCycles = cycles;
+    probe.count++;
+    probe.totalCycles += cycles;
+
+    uint16_t& bucket = probe.buckets[bucketOf(cycles)];
+    if (bucket == UINT16_MAX) {
+        // Dimezzare tutte le classi conserva le proporzioni, quindi i percentili.
+        for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+            probe.buckets[i] >>= 1;
+        }
+    }
+    bucket++;
+}
+
+void Profiler::summarize(uint8_t index, ProfilerSummary& summary) const {
+    const Probe& probe = _probes[index];
+    summary.name = probe.name;
+    summary.count = probe.count;
+    if (probe.count == 0) {
+        summary.minUs = summary.p50Us = summary.p99Us = summary.maxUs = summary.totalUs = 0;
+        return;
+    }
+
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+        total += probe.buckets[i];
+    }
+    summary.minUs = toUs(probe.minCycles);
+    summary.p50Us = toUs(percentile(probe, (total + 1) / 2));
+    summary.p99Us = toUs(percentile(probe, (uint32_t)(((uint64_t)total * 99 + 99) / 100)));
+    summary.maxUs = toUs(probe.maxCycles);
+    summary.totalUs = toUs(probe.totalCycles);
+}
+
+void Profiler::reset() {
+    for (uint8_t i = 0; i < _count; i++) {
+        Probe& probe = _probes[i];
+        probe.count = 0;
+        probe.totalCycles = 0;
+        memset(probe.buckets, 0, sizeof(probe.buckets));
+    }
+}
+
+int8_t Profiler::append(const char* label) {
+    if (_count >= PROFILER_MAX_PROBES) {
+        return -1;
+    }
+    Probe& probe = _probes[_count];
+    snprintf(probe.name, sizeof(probe.name), "%s", label);
+    probe.count = 0;
+    return (int8_t)_count++;
+}
+
+void Profiler::formatName(char* out, const char* group, const char* name) {
+    if (group != nullptr) {
+        snprintf(out, PROFILER_NAME_LEN, "%s.%s", group, name);
+    } else {
+        snprintf(out, PROFILER_NAME_LEN, "%s", name);
+    }
+}
+
+uint8_t Profiler::bucketOf(uint32_t cycles) {
+    if (cycles < 4) {
+        return (uint8_t)cycles;
+    }
+    uint8_t msb = 31 - __builtin_clz(cycles);
+    uint8_t sub = (cycles >> (msb - 2)) & 3;     // I due bit sotto quello più alto
+    return 4 * (msb - 1) + sub;
+}
+
+uint32_t Profiler::bucketUpperBound(uint8_t bucket) {
+    if (bucket < 4) {
+        return bucket;
+    }
+    uint8_t shift = bucket / 4 - 1;              // msb - 2
+    uint32_t lower = (uint32_t)(4 | (bucket & 3)) << shift;
+    return lower + ((1u << shift) - 1);
+}
+
+uint32_t Profiler::percentile(const Probe& probe, uint32_t rank) {
+    if (rank == 0) {
+        rank = 1;
+    }
+    uint32_t seen = 0;
+    uint32_t value = probe.maxCycles;
+    for (uint8_t i = 0; i < PROFILER_BUCKETS; i++) {
+        seen += probe.buckets[i];
+        if (seen >= rank) {
+            value = bucketUpperBound(i);
+            break;
+        }
+    }
+    if (value < probe.minCycles) value = probe.minCycles;
+    if (value > probe.maxCycles) value = probe.maxCycles;
+    return value;
+}
+
+float Profiler::toUs(uint64_t cycles) const {
+    return _cyclesPerUs ? (float)cycles / _cyclesPerUs : (float)cycles;
+}
@@ -0,0 +1,144 @@
+// src/Profiler.h
+
+/**
+ * @file Profiler.h
+ * @brief Dichiarazione della classe Profiler, il profilatore a cicli di clock sempre attivo.
+ * @details Ogni sonda misura in cicli di CPU (ESP.getCycleCount()) un tratto di
+ * codice: un gestore di stato, una modalità in un suo ModeState, una chiamata
+ * di I/O di HardwareManager. Le durate finiscono in un istogramma logaritmico
+ * di dimensione fissa, da cui si ricavano min, p50, p99 e max senza conservare
+ * i singoli campioni.
+ *
+ * L'istogramma ha 4 classi per ottava: un percentile è stimato con il limite
+ * superiore della sua classe (errore massimo 25%), riportato nell'intervallo
+ * [min, max], che invece sono esatti. Un campione costa due letture del
+ * contatore di cicli e qualche istruzione: il profilatore resta attivo anche
+ * sul campo.
+ *
+ * Va usato da un solo task (quello di gioco): le sonde non sono protette da lock.
+ * Non dipende da Arduino fuori dalla lettura del contatore: sull'host i "cicli"
+ * sono nanosecondi di std::chrono.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef ARDUINO
+#include <Arduino.h>
+#else
+#include <chrono>
+#endif
+
+/** @brief Numero massimo di sonde registrabili. Le registrazioni oltre il limite vengono ignorate. */
+#define PROFILER_MAX_PROBES 56
+/** @brief Lunghezza massima (terminatore incluso) del nome di una sonda. */
+#define PROFILER_NAME_LEN 28
+/** @brief Classi dell'istogramma: 4 valori esatti (0-3), poi 4 classi per ognuna delle 30 ottave fino a 2^32. */
+#define PROFILER_BUCKETS 124
+
+/**
+ * @struct ProfilerSummary
+ * @brief Riassunto di una sonda dall'ultimo reset(), in microsecondi.
+ */
+struct ProfilerSummary {
+    const char* name;
+    uint32_t count;
+    float minUs;
+    float p50Us;
+    float p99Us;
+    float maxUs;
+    float totalUs;
+};
+
+class Profiler {
+public:
+    /** @brief Legge il contatore di cicli della CPU. */
+    static inline uint32_t cycles() {
+#ifdef ARDUINO
+        return ESP.getCycleCount();
+#else
+        return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+    }
+
+    /**
+     * @brief Registra una sonda.
+     * @param group Prefisso del nome (es. "hw"), o nullptr.
+     * @param name Nome della sonda; viene copiato.
+     * @return Indice della sonda (quello esistente se il nome è già registrato), -1 se la tabella è piena.
+     */
+    int8_t add(const char* group, const char* name);
+    /**
+     * @brief Registra count sonde consecutive, una per nome (es. una per stato di un enum).
+     * @return Indice della prima sonda, -1 se non c'è posto per tutte.
+     */
+    int8_t addGroup(const char* group, const char* const* names, uint8_t count);
+
+    /** @brief Aggiunge un campione alla sonda. Indici negativi (registrazione fallita) sono ignorati. */
+    void record(int8_t probe, uint32_t cycles);
+
+    /** @brief Cicli di CPU per microsecondo, per la conversione dei riassunti (es. getCpuFrequencyMhz()). */
+    void setCyclesPerUs(uint32_t cyclesPerUs) { _cyclesPerUs = cyclesPerUs; }
+    uint8_t getProbeCount() const { return _count; }
+    /** @brief Calcola il riassunto della sonda index. */
+    void summarize(uint8_t index, ProfilerSummary& summary) const;
+    /** @brief Azzera i campioni di tutte le sonde, mantenendo le registrazioni. */
+    void reset();
+
+private:
+    struct Probe {
+        char name[PROFILER_NAME_LEN];
+        uint32_t count;
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint16_t buckets[PROFILER_BUCKETS];   // Dimezzati tutti insieme quando uno satura
+    };
+
+    /** @brief Aggiunge una sonda senza cercare duplicati. */
+    int8_t append(const char* label);
+    static void formatName(char* out, const char* group, const char* name);
+    static uint8_t bucketOf(uint32_t cycles);
+    static uint32_t bucketUpperBound(uint8_t bucket);
+    /** @brief Limite superiore della classe che contiene il campione di posizione rank (da 1). */
+    static uint32_t percentile(const Probe& probe, uint32_t rank);
+    float toUs(uint64_t cycles) const;
+
+    Probe _probes[PROFILER_MAX_PROBES];
+    uint8_t _count;
+    uint32_t _cyclesPerUs;
+};
+
+/** @brief Profilatore globale del firmware. */
+extern Profiler profiler;
+
+/**
+ * @class ProfileScope
+ * @brief Misura il tempo tra la costruzione e la distruzione e lo registra sulla sonda.
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(int8_t probe) : _probe(probe), _start(Profiler::cycles()) {}
+    ~ProfileScope() { profiler.record(_probe, Profiler::cycles() - _start); }
+
+private:
+    int8_t _probe;
+    uint32_t _start;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+/**
+ * @brief Misura il resto del blocco corrente sulla sonda group.name.
+ * @details La sonda si registra alla prima esecuzione; group e name devono essere costanti.
+ */
+#define PROFILE_SCOPE(group, name) \
+    static const int8_t PROFILE_CONCAT(_profileProbe, __LINE__) = profiler.add(group, name); \
+    ProfileScope PROFILE_CONCAT(_profileScope, __LINE__)(PROFILE_CONCAT(_profileProbe, __LINE__))
+
+#endif // PROFILER_H
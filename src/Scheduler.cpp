@@ -0,0 +1,107 @@
+// src/Scheduler.cpp
+
+/**
+ * @file Scheduler.cpp
+ * @brief Implementazione della classe Scheduler.
+ */
+
+#include "Scheduler.h"
+#include <string.h>
+
+Scheduler::Scheduler() :
+    _count(0),
+    _inRun(false),
+    _inUrgent(false)
+{
+    memset(_jobs, 0, sizeof(_jobs));
+}
+
+int8_t Scheduler::add(const char* name, uint32_t periodUs, uint32_t budgetUs,
+                      SchedulerJobFunction function, void* context, bool urgent) {
+    if (_count >= SCHEDULER_MAX_JOBS || function == nullptr) {
+        return -1;
+    }
+    Job& job = _jobs[_count];
+    job.name = name;
+    job.periodUs = periodUs;
+    job.budgetUs = budgetUs;
+    job.function = function;
+    job.context = context;
+    job.urgent = urgent;
+    job.started = false;
+    job.release = 0;
+    memset(&job.stats, 0, sizeof(job.stats));
+    return _count++;
+}
+
+void Scheduler::run(uint32_t (*now)()) {
+    _inRun = true;
+    for (uint8_t i = 0; i < _count; i++) {
+        runJob(_jobs[i], now);
+    }
+    _inRun = false;
+}
+
+void Scheduler::runUrgent(uint32_t (*now)()) {
+    if (!_inRun || _inUrgent) {
+        return;
+    }
+    for (uint8_t i = 0; i < _count; i++) {
+        if (_jobs[i].urgent) {
+            runJob(_jobs[i], now);
+        }
+    }
+}
+
+void Scheduler::runJob(Job& job, uint32_t (*now)()) {
+    uint32_t start = now();
+    if (!job.started) {
+        // Il primo rilascio è la prima passata dopo la registrazione.
+        job.started = true;
+        job.release = start;
+    }
+    if ((int32_t)(start - job.release) < 0) {
+        return;
+    }
+    // Per i lavori a ogni passata il rilascio coincide con l'avvio: conta solo la durata.
+    uint32_t release = job.periodUs > 0 ? job.release : start;
+
+    if (job.urgent) {
+        _inUrgent = true;
+    }
+    job.function(job.context);
+    _inUrgent = false;
+    uint32_t end = now();
+
+    SchedulerJobStats& stats = job.stats;
+    uint32_t jitter = start - release;
+    uint32_t duration = end - start;
+    stats.runs++;
+    stats.totalDurationUs += duration;
+    if (jitter > stats.maxJitterUs) {
+        stats.maxJitterUs = jitter;
+    }
+    if (duration > stats.maxDurationUs) {
+        stats.maxDurationUs = duration;
+    }
+    if (end - release > job.budgetUs) {
+        stats.overruns++;
+    }
+
+    if (job.periodUs > 0) {
+        // Si resta sulla griglia dei rilasci, saltando i periodi già trascorsi.
+        uint32_t skipped = jitter / job.periodUs;
+        stats.missed += skipped;
+        job.release += (skipped + 1) * job.periodUs;
+    } else {
+        // Il rilascio segue l'ultimo avvio: fermo al primo, dopo 2^31 us (circa 36
+        // minuti) il confronto con segno qui sopra fermerebbe il lavoro.
+        job.release = start;
+    }
+}
+
+void Scheduler::resetStats() {
+    for (uint8_t i = 0; i < _count; i++) {
+        memset(&_jobs[i].stats, 0, sizeof(_jobs[i].stats));
+    }
+}
@@ -0,0 +1,105 @@
+// src/Scheduler.h
+
+/**
+ * @file Scheduler.h
+ * @brief Dichiarazione della classe Scheduler, lo schedulatore cooperativo a periodo fisso del loop().
+ * @details Il loop() non chiama più tutto a ogni passata: registra dei lavori
+ * periodici (ingressi, LED, rete, logica di modalità, battito) e a ogni passata
+ * esegue, in ordine di registrazione, quelli il cui istante di rilascio è arrivato.
+ * L'ordine di registrazione è la priorità.
+ *
+ * Ogni lavoro ha un periodo e una scadenza relativa (budget): deve terminare
+ * entro budget microsecondi dal rilascio. Per ogni lavoro si registrano:
+ * - jitter: ritardo dell'avvio rispetto al rilascio;
+ * - sforamenti: esecuzioni terminate oltre la scadenza;
+ * - rilasci persi: periodi saltati interi perché il lavoro era troppo in ritardo.
+ * Un lavoro in ritardo non recupera i periodi persi: riparte dal rilascio successivo,
+ * così un'esecuzione lenta non produce una raffica di esecuzioni ravvicinate.
+ *
+ * Essendo cooperativo, un lavoro lungo non può essere interrotto. I lavori
+ * "urgenti" (ingressi) possono però essere eseguiti anche dentro un lavoro lungo,
+ * dai punti di attesa come le scritture I2C sui display: vedi runUrgent().
+ * Non dipende da Arduino: il tempo viene passato dal chiamante in microsecondi.
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+
+/** @brief Numero massimo di lavori registrabili. */
+#define SCHEDULER_MAX_JOBS 8
+
+/** @brief Funzione eseguita da un lavoro; context è quello passato alla registrazione. */
+typedef void (*SchedulerJobFunction)(void* context);
+
+/**
+ * @struct SchedulerJobStats
+ * @brief Statistiche di un lavoro dall'ultimo resetStats().
+ */
+struct SchedulerJobStats {
+    uint32_t runs;
+    uint32_t overruns;        // Esecuzioni terminate oltre la scadenza
+    uint32_t missed;          // Periodi saltati per ritardo
+    uint32_t maxJitterUs;
+    uint32_t maxDurationUs;
+    uint32_t totalDurationUs;
+};
+
+class Scheduler {
+public:
+    Scheduler();
+
+    /**
+     * @brief Registra un lavoro. I lavori registrati prima hanno la precedenza.
+     * @param name Nome per le statistiche (stringa costante).
+     * @param periodUs Periodo in microsecondi; 0 = a ogni passata.
+     * @param budgetUs Scadenza relativa al rilascio; oltre è uno sforamento.
+     * @param urgent true se il lavoro può girare anche dentro un altro lavoro (runUrgent()).
+     * @return Indice del lavoro, -1 se la tabella è piena.
+     */
+    int8_t add(const char* name, uint32_t periodUs, uint32_t budgetUs,
+               SchedulerJobFunction function, void* context, bool urgent = false);
+
+    /**
+     * @brief Esegue una passata: tutti i lavori dovuti, in ordine di priorità.
+     * @param now Funzione che ritorna il tempo corrente in microsecondi (es. micros()).
+     */
+    void run(uint32_t (*now)());
+    /**
+     * @brief Punto di attesa dentro un lavoro lungo: esegue solo i lavori urgenti dovuti.
+     * @details Non ha effetto se chiamata da un lavoro urgente o fuori da run().
+     */
+    void runUrgent(uint32_t (*now)());
+
+    uint8_t getJobCount() const { return _count; }
+    const char* getJobName(uint8_t index) const { return _jobs[index].name; }
+    uint32_t getJobPeriod(uint8_t index) const { return _jobs[index].periodUs; }
+    uint32_t getJobBudget(uint8_t index) const { return _jobs[index].budgetUs; }
+    const SchedulerJobStats& getStats(uint8_t index) const { return _jobs[index].stats; }
+    /** @brief Azzera le statistiche di tutti i lavori (es. dopo averle stampate). */
+    void resetStats();
+
+private:
+    struct Job {
+        const char* name;
+        uint32_t periodUs;
+        uint32_t budgetUs;
+        SchedulerJobFunction function;
+        void* context;
+        bool urgent;
+        bool started;           // false fino alla prima esecuzione
+        uint32_t release;       // Prossimo istante di rilascio
+        SchedulerJobStats stats;
+    };
+
+    /** @brief Esegue il lavoro se dovuto e ne aggiorna statistiche e prossimo rilascio. */
+    void runJob(Job& job, uint32_t (*now)());
+
+    Job _jobs[SCHEDULER_MAX_JOBS];
+    uint8_t _count;
+    bool _inRun;        // Dentro run(): runUrgent() è ammessa
+    bool _inUrgent;     // Dentro un lavoro urgente: runUrgent() non rientra
+};
+
+#endif // SCHEDULER_H
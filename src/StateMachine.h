@@ -0,0 +1,201 @@
+// src/StateMachine.h
+
+/**
+ * @file StateMachine.h
+ * @brief Macchina a stati dichiarata con tabelle constexpr, per le modalità di gioco.
+ * @details Una modalità descrive il proprio comportamento con due tabelle:
+ * - stati: per ogni stato, nell'ordine dell'enum, il nome e le azioni di
+ *   ingresso, di aggiornamento (a ogni passata del loop()) e di uscita;
+ * - transizioni: (stato di partenza, evento, guardia, azione, stato di arrivo).
+ * Le azioni e le guardie sono metodi della modalità (puntatori a membro).
+ *
+ * handle(evento) cerca, tra le righe dello stato corrente e poi tra quelle
+ * valide in ogni stato (ANY), la prima con lo stesso evento e la guardia
+ * soddisfatta, ed esegue nell'ordine: uscita dal vecchio stato, azione,
+ * ingresso nel nuovo. L'azione vede ancora lo stato di partenza. Una riga con
+ * arrivo uguale alla partenza è una transizione interna: solo l'azione.
+ *
+ * Le tabelle sono validate in compilazione (StateTable::isValid(): stati in
+ * ordine, righe raggruppate per stato di partenza, arrivi esistenti) e gli
+ * indici delle righe di ogni stato sono calcolati in constexpr. update() è un
+ * accesso indicizzato alla tabella degli stati; handle() è una ricerca lineare
+ * sulle righe dello stato corrente seguite dalle righe ANY, quindi costa quanto
+ * quelle righe e non quanto l'intera tabella.
+ * Non dipende da Arduino.
+ */
+
+#ifndef STATE_MACHINE_H
+#define STATE_MACHINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+template <typename Owner, typename State, typename Event>
+class StateMachine {
+public:
+    /** @brief Azione: ingresso, aggiornamento, uscita o effetto di una transizione. */
+    typedef void (Owner::*Action)();
+    /** @brief Guardia di una transizione: la riga vale solo se ritorna true. */
+    typedef bool (Owner::*Guard)() const;
+
+    /** @brief Stato di partenza delle righe valide in ogni stato. */
+    static constexpr State ANY = static_cast<State>(0xFF);
+
+    struct StateSpec {
+        State state;
+        const char* name;
+        Action onEnter;     // nullptr = nessuna azione
+        Action onUpdate;
+        Action onExit;
+    };
+
+    struct Transition {
+        State from;         // ANY = in ogni stato
+        Event event;
+        Guard guard;        // nullptr = sempre
+        Action action;      // nullptr = solo cambio di stato
+        State to;           // Uguale a from: transizione interna
+    };
+
+    /**
+     * @brief Le tabelle di una modalità, con l'indice delle righe per stato.
+     * @details Va dichiarata constexpr: l'indice è calcolato in compilazione.
+     * Le righe di uno stato devono essere consecutive e nell'ordine dell'enum,
+     * le righe ANY in fondo (vedi isValid()).
+     */
+    template <size_t StateCount, size_t TransitionCount>
+    struct StateTable {
+        const StateSpec* states;
+        const Transition* transitions;
+        const char* names[StateCount];
+        uint16_t first[StateCount + 1];     // Righe dello stato s: [first[s], first[s + 1])
+        uint16_t firstAny;                  // Righe ANY: [firstAny, TransitionCount)
+
+        constexpr StateTable(const StateSpec (&stateSpecs)[StateCount],
+                             const Transition (&transitionRows)[TransitionCount]) :
+            states(stateSpecs), transitions(transitionRows), names(), first(), firstAny(0)
+        {
+            for (size_t s = 0; s < StateCount; s++) {
+                names[s] = stateSpecs[s].name;
+            }
+            uint16_t row = 0;
+            for (size_t s = 0; s < StateCount; s++) {
+                first[s] = row;
+                while (row < TransitionCount && transitionRows[row].from == static_cast<State>(s)) {
+                    row++;
+                }
+            }
+            first[StateCount] = row;
+            firstAny = row;
+        }
+
+        /** @brief true se stati e righe rispettano l'ordine richiesto e ogni arrivo esiste. */
+        constexpr bool isValid() const {
+            for (size_t s = 0; s < StateCount; s++) {
+                if (states[s].state != static_cast<State>(s) || states[s].name == nullptr) {
+                    return false;
+                }
+            }
+            for (size_t row = 0; row < TransitionCount; row++) {
+                // Tutte le righe devono essere state indicizzate: un ordine sbagliato
+                // ferma l'indice prima della fine o fuori dalle righe ANY.
+                if (row >= firstAny && transitions[row].from != ANY) {
+                    return false;
+                }
+                if (static_cast<size_t>(transitions[row].to) >= StateCount) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        /** @brief Numero di righe che partono dallo stato s (ANY escluse). */
+        constexpr size_t countFrom(State s) const {
+            return first[static_cast<size_t>(s) + 1] - first[static_cast<size_t>(s)];
+        }
+    };
+
+    /**
+     * @param owner Modalità su cui chiamare azioni e guardie.
+     * @param table Tabelle constexpr della modalità.
+     * @param initial Stato iniziale; la sua azione di ingresso non viene eseguita (vedi start()).
+     */
+    template <size_t StateCount, size_t TransitionCount>
+    StateMachine(Owner* owner, const StateTable<StateCount, TransitionCount>& table, State initial) :
+        _owner(owner),
+        _states(table.states),
+        _transitions(table.transitions),
+        _first(table.first),
+        _firstAny(table.firstAny),
+        _transitionCount(TransitionCount),
+        _state(initial)
+    {
+    }
+
+    /** @brief Porta la macchina nello stato indicato eseguendone solo l'ingresso (es. all'enter() della modalità). */
+    void start(State state) {
+        _state = state;
+        call(_states[index(_state)].onEnter);
+    }
+
+    /** @brief Esegue l'azione di aggiornamento dello stato corrente. Da chiamare a ogni passata. */
+    void update() {
+        call(_states[index(_state)].onUpdate);
+    }
+
+    /**
+     * @brief Consegna un evento alla macchina.
+     * @return true se è scattata una transizione (anche interna).
+     */
+    bool handle(Event event) {
+        size_t s = index(_state);
+        for (size_t row = _first[s]; row < _first[s + 1]; row++) {
+            if (tryFire(_transitions[row], event)) {
+                return true;
+            }
+        }
+        for (size_t row = _firstAny; row < _transitionCount; row++) {
+            if (tryFire(_transitions[row], event)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    State getState() const { return _state; }
+    const char* getStateName() const { return _states[index(_state)].name; }
+
+private:
+    static size_t index(State state) { return static_cast<size_t>(state); }
+
+    void call(Action action) {
+        if (action != nullptr) {
+            (_owner->*action)();
+        }
+    }
+
+    bool tryFire(const Transition& row, Event event) {
+        if (row.event != event || (row.guard != nullptr && !(_owner->*row.guard)())) {
+            return false;
+        }
+        if (row.to == _state) {
+            call(row.action);
+            return true;
+        }
+        call(_states[index(_state)].onExit);
+        call(row.action);
+        _state = row.to;
+        call(_states[index(_state)].onEnter);
+        return true;
+    }
+
+    Owner* _owner;
+    const StateSpec* _states;
+    const Transition* _transitions;
+    const uint16_t* _first;
+    uint16_t _firstAny;
+    size_t _transitionCount;
+    State _state;
+};
+
+#endif // STATE_MACHINE_H
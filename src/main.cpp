@@ -21,27 +21,46 @@
 #include "melodies.h"
 #include "GameModes/MusicRoomMode.h"
 #include "GameMode.h" 
+#include "GameModes/ModeRegistry.h"
 #include "GameModes/SearchDestroyMode.h"
-#include "GameModes/SearchDestroySettings.h"
 #include "GameModes/DominationMode.h"
-#include "GameModes/DominationSettings.h"
 #include "GameModes/TerminalMode.h"
+#include "GameModes/TestHardwareMode.h"
+#include "Network/CommandRouter.h"
+#include "Network/UdpTransport.h"
+#include "Scheduler.h"
+#include "Profiler.h"
+#include "EventBus.h"
+
+// --- Lista delle reti Wi-Fi conosciute ---
+// Aggiungi qui tutte le reti a cui vuoi che il dispositivo si connetta,
+// in ordine di preferenza (al massimo WIFI_MAX_KNOWN_NETWORKS).
+const WifiCredential knownNetworks[] = {
+    {"MELONE", "wirelessmelone"},               // Rete casa
+    {"Som🅱️​rero🔆", "cristone"},       //
+    {"S20Lorenzo", "Satana666"}   // hotspot
+};
+const int numKnownNetworks = sizeof(knownNetworks) / sizeof(knownNetworks[0]);
 
 /** --- Istanze Globali --- 
  * Vengono creati gli oggetti principali che verranno usati in tutto il programma.
- * 'hardware' e 'networkManager' sono oggetti concreti.
- * Le modalità di gioco e le loro impostazioni sono puntatori, verranno creati
- * dinamicamente nella funzione setup().
+ * 'hardware' e 'networkManager' sono oggetti concreti; la rete usa WiFi e UDP
+ * tramite 'wifiTransport'.
+ * Le modalità di gioco sono elencate in 'modeRegistry' (vedi setup()), che
+ * costruisce solo quella attiva.
+ * Tutto ciò che segue appartiene al task di gioco (setup()/loop(), core 1); il
+ * task di rete usa solo 'wifiTransport' e lo stato interno di 'networkManager'.
 */
 HardwareManager hardware;
-NetworkManager networkManager;
+UdpTransport wifiTransport(knownNetworks, numKnownNetworks);
+NetworkManager networkManager(&wifiTransport);
 FirmwareUpdater updater(&hardware);
-SearchDestroySettings* sdSettings = nullptr;
-SearchDestroyMode* sdMode = nullptr;
-DominationSettings* domSettings = nullptr;
-DominationMode* domMode = nullptr;
-MusicRoomMode* musicRoomMode = nullptr;
-TerminalMode* terminalMode = nullptr;
+// Smista i comandi ricevuti dalla rete, in qualunque stato si trovi l'applicazione.
+CommandRouter commandRouter;
+// Esegue i lavori periodici del loop() (vedi registerJobs()).
+Scheduler scheduler;
+// Eventi di gioco pubblicati dalle modalità; la rete è uno degli iscritti.
+EventBus eventBus;
 
 /** --- Dichiarazioni Anticipate ---
  * Prototipo di funzione per displayMainMenu(). Permette di usare la funzione
@@ -54,33 +73,29 @@ void displayMainMenu();
 */
 AppState currentAppState = APP_STATE_WELCOME;
 
+// Modalità del menu principale; solo quella attiva è costruita, nella sua arena.
+ModeRegistry modeRegistry({&hardware, &networkManager, &eventBus, &updater,
+                           &currentAppState, displayMainMenu, &modeRegistry});
+
 // --- Stato e Menu Globale ---
-// Variabili per la gestione del menu principale.
+// Indice della voce selezionata nel menu principale, cioè nel registro delle modalità.
 int mainMenuIndex = 0;
-String mainMenuOptions[] = { "Cerca & Distruggi", "Dominio", "Stanza dei Suoni", "Mod. Terminale", "Test Hardware" };
-int numMainMenuOptions = sizeof(mainMenuOptions) / sizeof(mainMenuOptions[0]);
-
-// --- Variabili per il sottomenu di Test Hardware ---
-enum TestHardwareSubState {
-    TEST_MAIN,
-    TEST_KEYS
-};
-TestHardwareSubState currentTestSubState = TEST_MAIN;
 
 // --- Dichiarazioni Funzioni di Stato ---
 // Prototipi per le funzioni che gestiscono gli stati non legati a una classe specifica.
 void displayMainMenu();
 void handleWelcomeState();
 void handleMainMenuState();
-void handleTestHardwareState();
-void displayTestHardwareMainMenu();
-void displayKeyTestMenu();
+void handleForceEndGame(const ParsedCommand& command, void* context);
+void handleProfileCommand(const ParsedCommand& command, void* context);
+void sendProfileReport();
+void registerJobs();
 
 // --- SETUP ---
 /**
  * @brief Funzione di setup, eseguita una sola volta all'avvio del dispositivo.
  * @details Inizializza la comunicazione seriale, la memoria NVS per le impostazioni,
- * crea gli oggetti per le modalità di gioco e inizializza l'hardware e la rete.
+ * registra le modalità di gioco e inizializza l'hardware e la rete.
  */
 void setup() {
     Serial.begin(115200);
@@ -94,85 +109,292 @@ void setup() {
     ESP_ERROR_CHECK(ret);
     Serial.println("NVS Inizializzato.");
 
-    // Creazione dinamica degli oggetti per le impostazioni e le modalità di gioco.
-    // Viene passato un puntatore (&) all'hardware, alla rete e allo stato globale,
-    // in modo che tutte le modalità possano interagire con gli stessi componenti.
-    sdSettings = new SearchDestroySettings();
-    sdMode = new SearchDestroyMode(&hardware, &networkManager, sdSettings, &currentAppState, displayMainMenu);
-
-    domSettings = new DominationSettings();
-    domMode = new DominationMode(&hardware, &networkManager, domSettings, &currentAppState, displayMainMenu);
-
-    musicRoomMode = new MusicRoomMode(&hardware, &currentAppState, displayMainMenu);
-
-    terminalMode = new TerminalMode(&hardware, &networkManager, &currentAppState, displayMainMenu, domSettings, domMode, sdSettings, sdMode);
+    // Modalità del menu principale, nell'ordine delle voci. Nessuna viene costruita
+    // qui: il registro crea quella scelta (con le sue impostazioni) quando serve.
+    modeRegistry.add<SearchDestroyMode>(APP_STATE_SEARCH_DESTROY_MODE, "Cerca & Distruggi");
+    modeRegistry.add<DominationMode>(APP_STATE_DOMINATION_MODE, "Dominio");
+    modeRegistry.add<MusicRoomMode>(APP_STATE_MUSIC_ROOM, "Stanza dei Suoni");
+    modeRegistry.add<TerminalMode>(APP_STATE_TERMINAL_MODE, "Mod. Terminale");
+    modeRegistry.add<TestHardwareMode>(APP_STATE_TEST_HARDWARE, "Test Hardware");
+
+    // Registrazione dei comandi remoti.
+    commandRouter.on(CMD_FORCE_END_GAME, handleForceEndGame, nullptr);
+    commandRouter.on(CMD_PROFILE, handleProfileCommand, nullptr);
+    TerminalMode::registerCommands(commandRouter, modeRegistry);
+    // Un avvio programmato senza slot liberi resta senza conferma: il bridge lo ritrasmette.
+    networkManager.setCommandFilter([](const char* command, void*) {
+        return commandRouter.canAccept(command, networkManager.getClock(), millis());
+    }, nullptr);
+
+    // Iscritti agli eventi di gioco. Il pannello li riceve nel formato testuale di sempre.
+    eventBus.subscribe(GAME_EVENT_ALL, [](const GameEvent& event, void* context) {
+        static_cast<NetworkManager*>(context)->sendGameEvent(event);
+    }, &networkManager);
 
     // Inizializzazione dei componenti fisici e della connessione di rete.
     hardware.initialize();
-    networkManager.initialize(&hardware); 
+    hardware.clearLcd();
+    hardware.printLcd(0, 1, "Avvio rete WiFi...");
+    hardware.flushLcd();
+    networkManager.initialize();
+    registerJobs();
+    // Tutto l'I/O di HardwareManager resta su questo task (vedi NetworkManager.h).
+    if (xPortGetCoreID() != GAME_TASK_CORE) {
+        Serial.printf("ATTENZIONE: loop() sul core %d invece del core %d.\n", xPortGetCoreID(), GAME_TASK_CORE);
+    }
     Serial.println("Avvio del sistema completato.");
+    // Il messaggio di avvio parte quando il collegamento WiFi è attivo (vedi loop()).
+}
 
-    // Invia un messaggio di avvio sulla rete.
-    char startupMessage[100];
-    sprintf(startupMessage, "event:device_online;status:ready;version:%s;", FIRMWARE_VERSION);
-    networkManager.sendStatus(startupMessage);
+// --- LOOP ---
 
+// --- Lavori periodici ---
+// Periodi e scadenze in microsecondi. L'ordine di registrazione è la priorità.
+const uint32_t INPUT_PERIOD_US = 1000;          // Pulsanti e chiavi a 1 kHz
+const uint32_t INPUT_BUDGET_US = 500;
+const uint32_t AUDIO_PERIOD_US = 1000;          // Note della melodia al millisecondo
+const uint32_t AUDIO_BUDGET_US = 500;
+const uint32_t EFFECTS_PERIOD_US = 1000;        // Passi della timeline degli effetti al millisecondo
+const uint32_t EFFECTS_BUDGET_US = 5000;        // Un passo può scrivere sull'LCD
+const uint32_t NETWORK_PERIOD_US = 5000;        // Ricezione comandi e invio eventi a 200 Hz
+const uint32_t NETWORK_BUDGET_US = 5000;
+const uint32_t LED_PERIOD_US = 25000;           // Un passo dell'animazione arcobaleno
+const uint32_t LED_BUDGET_US = 10000;
+const uint32_t HEARTBEAT_PERIOD_US = 10000000;  // 10 secondi
+const uint32_t HEARTBEAT_BUDGET_US = 10000;
+const uint32_t MODE_BUDGET_US = 50000;          // Logica di modalità: a ogni passata
+const uint32_t STATS_PERIOD_US = 60000000;      // Stampa delle statistiche ogni minuto
+const uint32_t STATS_BUDGET_US = 20000;
+
+bool firstLinkUp = true;
+
+// --- Profiler ---
+// Sonde della macchina a stati principale, una per AppState nello stesso ordine.
+const char* const APP_STATE_PROBE_NAMES[] = {
+    "WELCOME", "MAIN_MENU", "TEST_HARDWARE", "SEARCH_DESTROY", "DOMINATION", "MUSIC_ROOM", "TERMINAL"
+};
+const uint8_t APP_STATE_PROBE_COUNT = sizeof(APP_STATE_PROBE_NAMES) / sizeof(APP_STATE_PROBE_NAMES[0]);
+static_assert(APP_STATE_PROBE_COUNT == APP_STATE_TERMINAL_MODE + 1, "Un nome di sonda per ogni AppState");
+int8_t appStateProbes = -1;
+// Risposta a CMD:PROFILE: un evento per sonda, pochi per esecuzione del lavoro
+// di rete per non riempire la coda di trasmissione (OUTBOUND_QUEUE_SIZE).
+const uint8_t PROFILE_EVENTS_PER_RUN = 4;
+int profileReportNext = -1;     // Prossima sonda da inviare; -1 = nessuna risposta in corso
+bool profileReportReset = false;
+
+/** @brief Orologio dello Scheduler. */
+uint32_t schedulerClock() {
+    return micros();
 }
 
-// --- LOOP ---
+/** @brief Lettura degli ingressi, anche durante le scritture lente sui display. */
+void inputJob(void*) {
+    hardware.updateButtons();
+}
 
-unsigned long lastHeartbeatTime = 0;
-const unsigned long heartbeatInterval = 10000; // 10 secondi
+void audioJob(void*) {
+    hardware.updateMidiTune();
+}
+
+/** @brief Suoni a tempo e sequenze di effetti accodate dalle modalità. */
+void effectsJob(void*) {
+    hardware.updateEffects();
+}
 
 /**
- * @brief Funzione di loop, eseguita continuamente dopo il setup().
- * @details È il cuore del programma. Ad ogni ciclo, aggiorna i componenti di input,
- * le animazioni e la rete. Utilizza una macchina a stati (switch-case) basata su
- * 'currentAppState' per delegare il controllo alla funzione o all'oggetto corretto.
+ * @brief Rete: pacchetti ricevuti, stato del collegamento e comandi remoti.
+ * @details networkManager.update() sveglia il task di rete: gli eventi accodati
+ * dagli altri lavori dall'esecuzione precedente partono nello stesso datagramma.
  */
-void loop() {
-    hardware.updateButtons();
-    hardware.updateMidiTune();
+void networkJob(void*) {
     networkManager.update();
 
-    if (millis() - lastHeartbeatTime > heartbeatInterval) {
-        lastHeartbeatTime = millis();
-        networkManager.sendStatus("event:heartbeat;");
+    // Stato del collegamento: le modalità continuano a funzionare anche offline.
+    if (networkManager.wasLinkUp()) {
+        // Annuncia il dispositivo al pannello, all'avvio e dopo ogni riconnessione.
+        char onlineMessage[100];
+        sprintf(onlineMessage, "event:device_online;status:%s;version:%s;",
+                firstLinkUp ? "ready" : "reconnected", FIRMWARE_VERSION);
+        networkManager.sendStatus(onlineMessage);
+        firstLinkUp = false;
+    }
+    if (networkManager.wasLinkDown()) {
+        Serial.println("RETE: collegamento perso, riconnessione in background.");
     }
 
+    // Comandi remoti: gestiti qui una volta per tutti gli stati.
+    // Quelli con "AT:" attendono l'istante indicato, in tempo server.
+    const char* command;
+    while ((command = networkManager.nextReceivedMessage()) != nullptr) {
+        PROFILE_SCOPE("net", "dispatch");
+        if (!commandRouter.dispatch(command, networkManager.getClock(), millis())) {
+            Serial.printf("Comando non gestito: %s\n", command);
+        }
+    }
+    commandRouter.runDue(networkManager.getClock(), millis());
+    sendProfileReport();
+}
+
+void ledJob(void*) {
     // Esegue l'animazione arcobaleno solo quando si è nei menu.
     if (currentAppState == APP_STATE_WELCOME || currentAppState == APP_STATE_MAIN_MENU) {
         hardware.updateRainbowEffect();
     }
+}
 
-    // Macchina a stati principale.
+void heartbeatJob(void*) {
+    // Il battito riporta anche le statistiche delle code di rete, per dimensionarle.
+    // "rtt" è il ritardo di andata e ritorno della sincronizzazione dell'orologio.
+    // "evq_*" sono la coda del bus degli eventi di gioco.
+    char heartbeatMessage[160];
+    sprintf(heartbeatMessage, "event:heartbeat;txq_hw:%lu;txq_drop:%lu;rxq_drop:%lu;rx_trunc:%lu;rtt:%lu;evq_hw:%u;evq_drop:%lu;",
+            (unsigned long)networkManager.getTxQueueHighWater(),
+            (unsigned long)networkManager.getTxDroppedCount(),
+            (unsigned long)networkManager.getRxOverflowCount(),
+            (unsigned long)networkManager.getRxTruncatedCount(),
+            (unsigned long)networkManager.getClock().getRoundTrip(),
+            eventBus.getQueueHighWater(),
+            (unsigned long)eventBus.getDroppedCount());
+    networkManager.sendStatus(heartbeatMessage);
+}
+
+/** @brief Macchina a stati principale: delega alla modalità corrente. */
+void modeJob(void*) {
+    // La passata è attribuita allo stato in cui inizia.
+    ProfileScope profile(appStateProbes >= 0 ? appStateProbes + (int8_t)currentAppState : -1);
     switch (currentAppState) {
         case APP_STATE_WELCOME:
             handleWelcomeState();
             break;
         case APP_STATE_MAIN_MENU:
+            // La modalità appena uscita (ha già eseguito exit()) libera l'arena.
+            modeRegistry.deactivate();
             handleMainMenuState();
             break;
+        default: {
+            // Delega il controllo alla modalità attiva del registro
+            GameMode* mode = modeRegistry.getActive(currentAppState);
+            if (mode != nullptr) {
+                mode->loop();
+            }
+            break;
+        }
+    }
+    // Consegna subito gli eventi pubblicati in questa passata (e dai comandi remoti).
+    eventBus.dispatch();
+    // Lo schermo della passata, anche dagli effetti e dai comandi remoti: solo le celle cambiate.
+    hardware.flushLcd();
+}
+
+/** @brief Stampa sulla seriale jitter, durate e sforamenti di ogni lavoro, poi li azzera. */
+void statsJob(void*) {
+    for (uint8_t i = 0; i < scheduler.getJobCount(); i++) {
+        const SchedulerJobStats& stats = scheduler.getStats(i);
+        Serial.printf("[SCHED] %-9s esecuzioni %lu, jitter max %lu us, durata media %lu us max %lu us, "
+                      "sforamenti %lu, periodi persi %lu\n",
+                      scheduler.getJobName(i), (unsigned long)stats.runs, (unsigned long)stats.maxJitterUs,
+                      (unsigned long)(stats.runs ? stats.totalDurationUs / stats.runs : 0),
+                      (unsigned long)stats.maxDurationUs, (unsigned long)stats.overruns,
+                      (unsigned long)stats.missed);
+    }
+    scheduler.resetStats();
+}
+
+/** @brief Punto di attesa delle scritture I2C: esegue i lavori urgenti dovuti. */
+void runUrgentJobs(void*) {
+    scheduler.runUrgent(schedulerClock);
+}
+
+/**
+ * @brief Registra i lavori periodici del loop(), in ordine di priorità.
+ * @details Ingressi e melodia sono urgenti: girano anche dentro la logica di
+ * modalità, alle scritture lente sui display, così un aggiornamento I2C di
+ * decine di millisecondi non fa perdere pressioni dei pulsanti.
+ */
+void registerJobs() {
+    scheduler.add("input", INPUT_PERIOD_US, INPUT_BUDGET_US, inputJob, nullptr, true);
+    scheduler.add("audio", AUDIO_PERIOD_US, AUDIO_BUDGET_US, audioJob, nullptr, true);
+    scheduler.add("effects", EFFECTS_PERIOD_US, EFFECTS_BUDGET_US, effectsJob, nullptr);
+    scheduler.add("network", NETWORK_PERIOD_US, NETWORK_BUDGET_US, networkJob, nullptr);
+    scheduler.add("leds", LED_PERIOD_US, LED_BUDGET_US, ledJob, nullptr);
+    scheduler.add("heartbeat", HEARTBEAT_PERIOD_US, HEARTBEAT_BUDGET_US, heartbeatJob, nullptr);
+    scheduler.add("mode", 0, MODE_BUDGET_US, modeJob, nullptr);
+    scheduler.add("stats", STATS_PERIOD_US, STATS_BUDGET_US, statsJob, nullptr);
+    hardware.setBusWaitHook(runUrgentJobs, nullptr);
+
+    profiler.setCyclesPerUs(getCpuFrequencyMhz());
+    appStateProbes = profiler.addGroup("app", APP_STATE_PROBE_NAMES, APP_STATE_PROBE_COUNT);
+}
+
+/**
+ * @brief Funzione di loop, eseguita continuamente dopo il setup().
+ * @details È il cuore del programma. Ad ogni ciclo lo Scheduler esegue i lavori
+ * dovuti: ingressi, melodia, effetti, rete, LED, battito e la macchina a stati basata su
+ * 'currentAppState', che delega il controllo alla funzione o all'oggetto corretto.
+ */
+void loop() {
+    scheduler.run(schedulerClock);
+}
+
+// --- Implementazione Funzioni di Gestione Stati ---
+
+/**
+ * @brief Gestore di CMD:FORCE_END_GAME, valido in ogni stato.
+ * @details Termina la partita della modalità attiva; negli altri stati non c'è
+ * nessuna partita da chiudere e il comando viene solo registrato sul log.
+ */
+void handleForceEndGame(const ParsedCommand&, void*) {
+    // Negli stati delle modalità il registro ha sempre costruito quella corrispondente.
+    GameMode* mode = modeRegistry.getActive(currentAppState);
+    switch (currentAppState) {
         case APP_STATE_SEARCH_DESTROY_MODE:
-            sdMode->loop(); // Delega il controllo alla modalità C&D
+            static_cast<SearchDestroyMode*>(mode)->forceEndGame();
             break;
         case APP_STATE_DOMINATION_MODE:
-            domMode->loop();    // Delega il controllo alla modalità Dominio
-            break;
-        case APP_STATE_MUSIC_ROOM:
-            musicRoomMode->loop();  // Delega il controllo alla Stanza dei Suoni
+            static_cast<DominationMode*>(mode)->forceEndGame();
             break;
-        case APP_STATE_TERMINAL_MODE:
-            terminalMode->loop();   // Delega il controllo alla Modalità Terminale
-            break;
-        case APP_STATE_TEST_HARDWARE:
-            handleTestHardwareState();
+        default:
+            Serial.println("FORCE_END_GAME ricevuto senza partita in corso, ignorato.");
             break;
     }
-    
 }
 
-// --- Implementazione Funzioni di Gestione Stati ---
+/**
+ * @brief Gestore di CMD:PROFILE, valido in ogni stato.
+ * @details Avvia l'invio del riassunto del Profiler, un evento "profile" per
+ * sonda seguito da "profile_end" (vedi sendProfileReport()). Con RESET:1 le
+ * sonde vengono azzerate a invio concluso.
+ */
+void handleProfileCommand(const ParsedCommand& command, void*) {
+    profileReportNext = 0;
+    profileReportReset = command.has(FIELD_RESET) && command.fields[FIELD_RESET].toInt() != 0;
+}
+
+/** @brief Invia la parte successiva della risposta a CMD:PROFILE, se in corso. */
+void sendProfileReport() {
+    if (profileReportNext < 0) {
+        return;
+    }
+    char message[OUTBOUND_EVENT_MAX_LEN];
+    for (uint8_t sent = 0; sent < PROFILE_EVENTS_PER_RUN; sent++) {
+        if (profileReportNext >= profiler.getProbeCount()) {
+            snprintf(message, sizeof(message), "event:profile_end;probes:%u;reset:%d;",
+                     profiler.getProbeCount(), profileReportReset ? 1 : 0);
+            networkManager.sendStatus(message);
+            if (profileReportReset) {
+                profiler.reset();
+            }
+            profileReportNext = -1;
+            return;
+        }
+        ProfilerSummary summary;
+        profiler.summarize(profileReportNext++, summary);
+        snprintf(message, sizeof(message), "event:profile;probe:%s;n:%lu;min:%.1f;p50:%.1f;p99:%.1f;max:%.1f;",
+                 summary.name, (unsigned long)summary.count,
+                 summary.minUs, summary.p50Us, summary.p99Us, summary.maxUs);
+        networkManager.sendStatus(message);
+    }
+}
 
 /**
  * @brief Gestisce la logica della schermata di benvenuto.
@@ -205,7 +427,7 @@ void handleWelcomeState() {
         firstEntry = true;
         currentAppState = APP_STATE_MAIN_MENU;
         displayMainMenu();
-        networkManager.sendStatus("event:mode_enter;mode:main_menu;");
+        eventBus.publish(GameEventId::MODE_ENTER, GameEventMode::MAIN_MENU);
     }
 }
 
@@ -227,9 +449,9 @@ void displayMainMenu() {
 
     for (int i = 0; i < maxRows; i++) {
         int currentItemIndex = startIdx + i;
-        if (currentItemIndex < numMainMenuOptions) {
+        if (currentItemIndex < modeRegistry.getCount()) {
             String prefix = (currentItemIndex == mainMenuIndex) ? "> " : "  ";
-            hardware.printLcd(0, i + 1, prefix + mainMenuOptions[currentItemIndex]);
+            hardware.printLcd(0, i + 1, prefix + modeRegistry.getName(currentItemIndex));
         }
     }
 
@@ -238,7 +460,7 @@ void displayMainMenu() {
     if (startIdx > 0) {
         hardware.printLcd(19, 1, "^");
     }
-    if (startIdx + maxRows < numMainMenuOptions) {
+    if (startIdx + maxRows < modeRegistry.getCount()) {
         hardware.printLcd(19, 3, "v");
     }
     
@@ -249,10 +471,11 @@ void displayMainMenu() {
 /**
  * @brief Gestisce la logica del menu principale.
  * @details Legge l'input dal tastierino per navigare nel menu e dal pulsante di conferma
- * per selezionare una modalità. Quando una modalità viene selezionata, cambia lo stato
- * globale 'currentAppState' e chiama il metodo enter() della modalità scelta.
+ * per selezionare una modalità. Quando una modalità viene selezionata, il registro
+ * la costruisce, cambia lo stato globale 'currentAppState' e ne chiama il metodo enter().
  */
 void handleMainMenuState() {
+    int numMainMenuOptions = modeRegistry.getCount();
     char key = hardware.getKey();
     bool btn1_pressed = hardware.wasButton1Pressed();
     bool btn2_pressed = hardware.wasButton2Pressed();
@@ -277,148 +500,9 @@ void handleMainMenuState() {
     if (btn2_pressed) {
         Serial.println("INPUT: Pulsante 2 (Conferma) premuto");
         hardware.playTone(1200, 100);
-        switch (mainMenuIndex) {
-            case 0:
-                Serial.println("TRANSIZIONE: Main Menu -> Cerca & Distruggi");
-                currentAppState = APP_STATE_SEARCH_DESTROY_MODE;
-                sdMode->enter();
-                break;
-            case 1:
-                Serial.println("TRANSIZIONE: Main Menu -> Dominio");
-                currentAppState = APP_STATE_DOMINATION_MODE;
-                domMode->enter();
-                break;
-            case 2:
-                Serial.println("TRANSIZIONE: Main Menu -> Stanza dei Suoni");
-                currentAppState = APP_STATE_MUSIC_ROOM;
-                musicRoomMode->enter();
-                break;
-            case 3:
-                Serial.println("TRANSIZIONE: Main Menu -> Modalita' Terminale");
-                currentAppState = APP_STATE_TERMINAL_MODE;
-                terminalMode->enter();
-                break;
-            case 4:
-                Serial.println("TRANSIZIONE: Main Menu -> Test Hardware");
-                networkManager.sendStatus("event:mode_enter;mode:testhw;");
-                currentAppState = APP_STATE_TEST_HARDWARE;
-                currentTestSubState = TEST_MAIN; // Imposta il sottomenu iniziale
-                displayTestHardwareMainMenu(); // Disegna il menu del test
-                break;
-        }
+        AppState state = modeRegistry.getState(mainMenuIndex);
+        Serial.printf("TRANSIZIONE: Main Menu -> %s\n", modeRegistry.getName(mainMenuIndex));
+        currentAppState = state;
+        modeRegistry.activate(state)->enter();
     }
 }
-
-/**
- * @brief Disegna la schermata principale del Test Hardware.
- */
-void displayTestHardwareMainMenu() {
-    hardware.clearLcd();
-    hardware.printLcd(0, 0, "Test Hardware");
-    hardware.printLcd(0, 1, "A:RFID B:Key C:OTA");
-    hardware.printLcd(0, 2, "1,2,3 Colori LED");
-    hardware.setStripColor(255, 255, 255);
-    hardware.printOled1("INDIETRO", 2, 10, 25);
-    hardware.printOled2("TEST", 2, 35, 25);
-}
-
-/**
- * @brief Disegna la schermata per il test delle chiavi.
- */
-void displayKeyTestMenu() {
-    hardware.clearLcd();
-    hardware.printLcd(0, 0, "Test Interruttori");
-    hardware.printLcd(0, 2, "Chiave 1:");
-    hardware.printLcd(0, 3, "Chiave 2:");
-    hardware.printOled1("INDIETRO", 2, 10, 25);
-    hardware.clearOled2();
-}
-
-/**
- * @brief Gestisce la logica della modalità di test hardware e dei suoi sottomenù.
- */
-void handleTestHardwareState() {
-    char key = hardware.getKey();
-    bool btn1_pressed = hardware.wasButton1Pressed();
-    bool btn2_pressed = hardware.wasButton2Pressed();
-
-    if (currentTestSubState == TEST_MAIN) {
-        // --- LOGICA DEL MENU PRINCIPALE DI TEST ---
-
-        if (key != NO_KEY) {
-            Serial.printf("INPUT: '%c' premuto\n", key);
-            hardware.playTone(700, 40);
-
-            if (key == 'A') {
-                hardware.printLcd(0, 1, "                    "); // Pulisce la riga
-                hardware.printLcd(0, 1, "Avvicina una card...");
-                String uid = hardware.readRFID(5000); // Timeout di 5s
-                displayTestHardwareMainMenu(); // Ridisegna il menu dopo il test
-                hardware.printLcd(0, 2, "UID:");
-                hardware.printLcd(0, 3, uid);
-            } else if (key == 'B') {
-                // Passa al sottomenu di test delle chiavi
-                currentTestSubState = TEST_KEYS;
-                displayKeyTestMenu();
-            }
-              else if (key == 'C') { // Usiamo il tasto 'C' per l'aggiornamento
-                updater.checkForUpdates();
-                // Dopo il controllo, ridisegna il menu di test
-                displayTestHardwareMainMenu();
-        }
-              else {
-                hardware.printLcd(0, 1, "Tasto premuto: " + String(key) + "   ");
-                if (key == '1') hardware.setStripColor(255, 0, 0);
-                if (key == '2') hardware.setStripColor(0, 255, 0);
-                if (key == '3') hardware.setStripColor(0, 0, 255);
-            }
-        }
-
-        if (btn2_pressed) {
-            Serial.println("INPUT: Pulsante 2 (Conferma) premuto");
-            hardware.playTone(1200, 100);
-            hardware.printLcd(0, 1, "Pulsante 2 OK!");
-        }
-
-        if (btn1_pressed) {
-            // Esce dalla modalità Test Hardware
-            Serial.println("INPUT: Pulsante 1 (Indietro) premuto");
-            hardware.playTone(300, 70);
-            hardware.turnOffStrip();
-            networkManager.sendStatus("event:mode_exit;mode:testhw;");
-            Serial.println("TRANSIZIONE: Test Hardware -> Main Menu");
-            currentAppState = APP_STATE_MAIN_MENU;
-            displayMainMenu();
-        }
-
-    } else if (currentTestSubState == TEST_KEYS) {
-        // --- LOGICA DEL SOTTOMENU TEST CHIAVI ---
-        
-        bool key1_state = hardware.isKey1Turned();
-        bool key2_state = hardware.isKey2Turned();
-
-        // Aggiorna LCD
-        hardware.printLcd(10, 2, key1_state ? "ON " : "OFF");
-        hardware.printLcd(10, 3, key2_state ? "ON " : "OFF");
-
-        // Aggiorna LED Striscia
-        int half_leds = hardware.getStripLedCount() / 2;
-        // Chiave 1 - Prima metà (Verde)
-        for (int i = 0; i < half_leds; i++) {
-            hardware.setPixelColor(i, key1_state ? 255 : 0, 0, 0);
-        }
-        // Chiave 2 - Seconda metà (Blu)
-        for (int i = half_leds; i < hardware.getStripLedCount(); i++) {
-            hardware.setPixelColor(i, 0, key2_state ? 255 : 0, 0);
-        }
-        hardware.showStrip();
-
-        if (btn1_pressed) {
-            // Torna al menu principale di test
-            Serial.println("INPUT: Pulsante 1 (Indietro) premuto");
-            hardware.playTone(300, 70);
-            currentTestSubState = TEST_MAIN;
-            displayTestHardwareMainMenu();
-        }
-    }
-}
\ No newline at end of file